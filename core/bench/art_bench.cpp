@@ -0,0 +1,157 @@
+#include "nexusdb/art_index.h"
+#include "nexusdb/btree.h"
+#include "nexusdb/index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Point and prefix lookup latency of ArtIndex against the comparison-based
+// trees: BTreeIndex (the BTREE index type) and BTree<std::string, ...>.
+// Keys look like session ids, "session:" followed by 16 hex digits; a
+// prefix lookup asks for every key sharing the first 4 hex digits.
+// Usage: nexusdb_art_bench [keys] [lookups]
+
+namespace {
+
+constexpr size_t DEFAULT_KEY_COUNT = 1 << 20;
+constexpr size_t DEFAULT_LOOKUP_COUNT = 1 << 20;
+constexpr size_t BTREE_DEGREE = 32;
+constexpr size_t PREFIX_LENGTH = 12;  // "session:" and 4 hex digits
+
+std::string session_key(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string key = "session:";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        key.push_back(digits[(value >> shift) & 0xf]);
+    }
+    return key;
+}
+
+// Smallest key greater than every key starting with prefix
+std::string prefix_end(std::string prefix) {
+    while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xff) {
+        prefix.pop_back();
+    }
+    if (!prefix.empty()) {
+        ++prefix.back();
+    }
+    return prefix;
+}
+
+// Runs lookup on every probe; returns nanoseconds per probe
+template<typename Lookup>
+double time_lookups(const std::vector<std::string>& probes, size_t& found, Lookup lookup) {
+    found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& probe : probes) {
+        found += lookup(probe);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(probes.size());
+}
+
+void report(const char* name, double point_ns, double prefix_ns) {
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(1) << std::setw(14) << point_ns << std::setw(15) << prefix_ns << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t key_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_KEY_COUNT;
+    size_t lookup_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : DEFAULT_LOOKUP_COUNT;
+    if (key_count == 0 || lookup_count == 0) {
+        std::cerr << "Key and lookup counts must be positive" << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 random(42);
+    std::vector<std::pair<std::string, uint64_t>> entries;
+    entries.reserve(key_count);
+    for (size_t i = 0; i < key_count; ++i) {
+        entries.emplace_back(session_key(random()), i);
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const auto& a, const auto& b) { return a.first == b.first; }),
+                  entries.end());
+
+    // Point probes hit existing keys in random order; prefix probes are
+    // prefixes of existing keys, a sixteenth as many since each visits
+    // several keys
+    std::vector<std::string> point_probes;
+    std::vector<std::string> prefix_probes;
+    point_probes.reserve(lookup_count);
+    for (size_t i = 0; i < lookup_count; ++i) {
+        point_probes.push_back(entries[random() % entries.size()].first);
+    }
+    for (size_t i = 0; i < std::max<size_t>(lookup_count / 16, 1); ++i) {
+        prefix_probes.push_back(entries[random() % entries.size()].first.substr(0, PREFIX_LENGTH));
+    }
+
+    nexusdb::ArtIndex art;
+    nexusdb::BTreeIndex btree_index;
+    nexusdb::BTree<std::string, std::vector<uint64_t>> btree(BTREE_DEGREE);
+    for (const auto& [key, record_id] : entries) {
+        art.insert(key, record_id);
+        btree_index.insert(key, record_id);
+        btree.insert(key, {record_id});
+    }
+
+    std::cout << entries.size() << " keys, " << point_probes.size() << " point and " << prefix_probes.size() << " prefix lookups\n";
+    std::cout << std::setw(12) << "index" << std::setw(14) << "point ns/op" << std::setw(15) << "prefix ns/op" << '\n';
+
+    auto index_scan = [](const nexusdb::Index& index) {
+        return [&index](const std::string& prefix) {
+            size_t count = 0;
+            index.scan(prefix, true, prefix_end(prefix), false, [&](const std::string&, uint64_t) {
+                ++count;
+                return true;
+            });
+            return count;
+        };
+    };
+    auto index_search = [](const nexusdb::Index& index) {
+        return [&index](const std::string& key) { return index.search(key).size(); };
+    };
+
+    size_t points;
+    size_t prefixes;
+    double point_ns = time_lookups(point_probes, points, index_search(art));
+    double prefix_ns = time_lookups(prefix_probes, prefixes, index_scan(art));
+    report("ART", point_ns, prefix_ns);
+    // Each index must find the same entries, or the timings compare nothing
+    size_t expected_points = points;
+    size_t expected_prefixes = prefixes;
+
+    point_ns = time_lookups(point_probes, points, index_search(btree_index));
+    prefix_ns = time_lookups(prefix_probes, prefixes, index_scan(btree_index));
+    report("BTreeIndex", point_ns, prefix_ns);
+    bool consistent = points == expected_points && prefixes == expected_prefixes;
+
+    point_ns = time_lookups(point_probes, points, [&](const std::string& key) {
+        auto value = btree.search(key);
+        return value.has_value() ? value->size() : 0;
+    });
+    prefix_ns = time_lookups(prefix_probes, prefixes, [&](const std::string& prefix) {
+        size_t count = 0;
+        for (auto it = btree.lower_bound(prefix); it != btree.end() && it.key().compare(0, prefix.size(), prefix) == 0; ++it) {
+            count += it.value().size();
+        }
+        return count;
+    });
+    report("BTree", point_ns, prefix_ns);
+    consistent = consistent && points == expected_points && prefixes == expected_prefixes;
+
+    if (!consistent) {
+        std::cerr << "Indexes disagree on the lookup results" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "nexusdb/bounded_mpmc_queue.h"
+#include "nexusdb/lock_free_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Throughput of BoundedMPMCQueue against LockFreeQueue from 1 to 64
+// threads. Every thread enqueues and then dequeues one element, over and
+// over, so producers and consumers contend on both ends at once.
+// Usage: nexusdb_queue_bench [total pairs]
+
+namespace {
+
+constexpr size_t DEFAULT_TOTAL_PAIRS = 1 << 22;
+constexpr size_t BOUNDED_CAPACITY = 1024;
+
+// Runs body(thread index) on threads threads, released together; returns seconds
+template<typename Body>
+double run_threads(size_t threads, Body body) {
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            body(t);
+        });
+    }
+    while (ready.load(std::memory_order_relaxed) != threads) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double bench_bounded(size_t threads, size_t pairs_per_thread) {
+    nexusdb::BoundedMPMCQueue<int> queue(BOUNDED_CAPACITY);
+    return run_threads(threads, [&](size_t t) {
+        for (size_t i = 0; i < pairs_per_thread; ++i) {
+            queue.enqueue(static_cast<int>(t));
+            queue.dequeue();
+        }
+    });
+}
+
+double bench_lock_free(size_t threads, size_t pairs_per_thread) {
+    nexusdb::LockFreeQueue<int> queue;
+    return run_threads(threads, [&](size_t t) {
+        for (size_t i = 0; i < pairs_per_thread; ++i) {
+            queue.enqueue(static_cast<int>(t));
+            // Every dequeue follows an enqueue, so an element is always on its way
+            while (!queue.dequeue()) {
+                std::this_thread::yield();
+            }
+        }
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t total_pairs = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TOTAL_PAIRS;
+
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "bounded Mops/s" << std::setw(18) << "lock-free Mops/s" << '\n';
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        size_t pairs_per_thread = total_pairs / threads;
+        double ops = 2.0 * static_cast<double>(pairs_per_thread * threads) / 1e6;
+        double bounded = ops / bench_bounded(threads, pairs_per_thread);
+        double lock_free = ops / bench_lock_free(threads, pairs_per_thread);
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(16) << bounded << std::setw(18) << lock_free << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef NEXUSDB_ART_INDEX_H
+#define NEXUSDB_ART_INDEX_H
+
+#include "nexusdb/index.h"
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+struct ArtNode;
+
+// Adaptive radix tree over the key bytes. Inner nodes switch between
+// 4, 16, 48 and 256 child slots as they fill and drain, paths with a single
+// child are compressed into the prefix of the node below, and a subtree
+// holding one key is just that key's leaf. A lookup touches at most one
+// node per key byte no matter how many keys there are, and never compares
+// whole keys until it reaches a leaf. Heap-resident; contents are lost on
+// restart.
+class ArtIndex : public Index {
+public:
+    ArtIndex();
+    ~ArtIndex() override;
+
+    ArtIndex(const ArtIndex&) = delete;
+    ArtIndex& operator=(const ArtIndex&) = delete;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override;
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::ART; }
+
+private:
+    ArtNode* root_;
+    size_t entry_count_;
+    size_t node_count_;
+    mutable std::shared_mutex mutex_;
+
+    // Record ids stored under key, or nullptr
+    const std::vector<uint64_t>* find(const std::string& key) const;
+    // Record ids stored under key, adding an empty leaf if there is none
+    std::vector<uint64_t>& find_or_insert(const std::string& key);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_ART_INDEX_H
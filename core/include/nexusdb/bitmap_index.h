@@ -0,0 +1,55 @@
+#ifndef NEXUSDB_BITMAP_INDEX_H
+#define NEXUSDB_BITMAP_INDEX_H
+
+#include "nexusdb/index.h"
+#include "nexusdb/roaring_bitmap.h"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// One compressed bitmap of record ids per distinct value, for columns with
+// few of them (status, region, type). Where a B-tree keeps a posting list
+// per value, bitmaps of several predicates combine with word-wide
+// AND/OR/ANDNOT before any record is read. Heap-resident; contents are lost
+// on restart.
+class BitmapIndex : public Index {
+public:
+    BitmapIndex() = default;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override;
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::BITMAP; }
+
+    // Records holding key; empty if there are none
+    RoaringBitmap bitmap(const std::string& key) const;
+    // Union of the bitmaps of keys, i.e. the records holding any of them
+    RoaringBitmap bitmap_of_any(const std::vector<std::string>& keys) const;
+    // Every record in the index
+    RoaringBitmap all_records() const;
+
+private:
+    std::map<std::string, RoaringBitmap> bitmaps_;
+    size_t entry_count_ = 0;
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_BITMAP_INDEX_H
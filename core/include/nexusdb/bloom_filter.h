@@ -0,0 +1,89 @@
+#ifndef NEXUSDB_BLOOM_FILTER_H
+#define NEXUSDB_BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nexusdb {
+
+// Blocked Bloom filter: each key sets BITS_PER_BLOCK_KEY bits inside one
+// 64-byte block, so a lookup costs a single cache miss. Filters cannot be
+// resized, so once the newest stage has taken its capacity of keys a stage
+// twice its size is chained on; lookups probe every stage. Keys can't be
+// removed, which only costs false positives until the filter is rebuilt.
+class BloomFilter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    // About a 1% false positive rate per stage
+    static constexpr size_t BITS_PER_KEY = 12;
+
+    explicit BloomFilter(size_t initial_capacity = DEFAULT_CAPACITY);
+
+    void add(const std::string& key) { add_hash(hash(key)); }
+    bool might_contain(const std::string& key) const { return might_contain_hash(hash(key)); }
+    void add_hash(uint64_t key_hash);
+    bool might_contain_hash(uint64_t key_hash) const;
+
+    size_t size() const;
+    size_t memory_usage() const;
+
+    void serialize(std::string& out) const;
+    // Reads a filter written by serialize at offset, advancing offset past it
+    static std::optional<BloomFilter> deserialize(const std::string& data, size_t& offset);
+
+    // Stable across processes, so saved filters stay valid
+    static uint64_t hash(const std::string& key);
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+    static constexpr size_t BITS_PER_BLOCK_KEY = WORDS_PER_BLOCK;
+
+    struct Stage {
+        uint64_t capacity = 0;
+        uint64_t count = 0;
+        std::vector<uint64_t> words;
+
+        size_t block_count() const { return words.size() / WORDS_PER_BLOCK; }
+    };
+
+    std::vector<Stage> stages_;
+
+    static Stage make_stage(uint64_t capacity);
+    static void set_bits(Stage& stage, uint64_t key_hash);
+    static bool test_bits(const Stage& stage, uint64_t key_hash);
+};
+
+// Filters over one column of a table: one for the whole table, so misses
+// never touch a page, and one per group of PAGES_PER_GROUP data pages, so a
+// scan for a value only reads groups that may hold it
+class ColumnBloomFilter {
+public:
+    static constexpr uint32_t MAGIC = 0x46424E58;  // "XNBF"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint64_t PAGES_PER_GROUP = 16;
+    static constexpr size_t GROUP_CAPACITY = 256;
+
+    void add(uint64_t page_id, const std::string& value);
+    bool might_contain(const std::string& value) const { return table_.might_contain(value); }
+    // False only if no record on page_id's group of pages has value
+    bool group_might_contain(uint64_t page_id, const std::string& value) const;
+    // Groups up to the last page any value was added from
+    uint64_t group_count() const { return groups_.size(); }
+
+    // Data pages are numbered from 1; page 0 holds the schema
+    static uint64_t group_of(uint64_t page_id) { return (page_id - 1) / PAGES_PER_GROUP; }
+
+    std::string serialize() const;
+    static std::optional<ColumnBloomFilter> deserialize(const std::string& data);
+
+private:
+    BloomFilter table_;
+    std::vector<BloomFilter> groups_;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_BLOOM_FILTER_H
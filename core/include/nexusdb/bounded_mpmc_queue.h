@@ -0,0 +1,257 @@
+#ifndef NEXUSDB_BOUNDED_MPMC_QUEUE_H
+#define NEXUSDB_BOUNDED_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace nexusdb {
+
+// Bounded multi-producer/multi-consumer ring buffer (Vyukov). Every cell
+// carries a sequence number that tells producers and consumers whose turn it
+// is, so a single CAS on the position counter claims a cell and no node is
+// ever allocated after construction.
+template<typename T>
+class BoundedMPMCQueue {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    explicit BoundedMPMCQueue(size_t capacity)
+        : capacity_(round_up_to_power_of_two(capacity)), mask_(capacity_ - 1),
+          cells_(new Cell[capacity_]), enqueue_pos_(0), dequeue_pos_(0) {
+        if (capacity == 0) {
+            delete[] cells_;
+            throw std::invalid_argument("BoundedMPMCQueue capacity must be positive");
+        }
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedMPMCQueue() {
+        while (try_dequeue()) {
+        }
+        delete[] cells_;
+    }
+
+    BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+    BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+    bool try_enqueue(const T& value) { return emplace_if_space(value); }
+    bool try_enqueue(T&& value) { return emplace_if_space(std::move(value)); }
+
+    std::optional<T> try_dequeue() {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;  // Empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::optional<T> result(std::move(*cell->value()));
+        cell->value()->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return result;
+    }
+
+    // Blocking variants spin briefly, then yield until space or data appears
+    void enqueue(T value) {
+        Backoff backoff;
+        while (!try_enqueue(std::move(value))) {
+            backoff.pause();
+        }
+    }
+
+    T dequeue() {
+        Backoff backoff;
+        while (true) {
+            auto value = try_dequeue();
+            if (value) {
+                return std::move(*value);
+            }
+            backoff.pause();
+        }
+    }
+
+    // Claims up to count consecutive cells with one CAS. Returns how many of
+    // the leading elements of [first, first + count) were moved in.
+    template<typename InputIt>
+    size_t try_enqueue_bulk(InputIt first, size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t claimed;
+        while (true) {
+            claimed = count_ready(pos, count, 0);
+            if (claimed == 0) {
+                size_t sequence = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) < 0) {
+                    return 0;  // Full
+                }
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < claimed; ++i, ++first) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            new (cell.storage) T(std::move(*first));
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    // Moves up to max_count elements to out. Returns how many were dequeued.
+    template<typename OutputIt>
+    size_t try_dequeue_bulk(OutputIt out, size_t max_count) {
+        if (max_count == 0) {
+            return 0;
+        }
+
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t claimed;
+        while (true) {
+            claimed = count_ready(pos, max_count, 1);
+            if (claimed == 0) {
+                size_t sequence = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+                    return 0;  // Empty
+                }
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < claimed; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            *out = std::move(*cell.value());
+            ++out;
+            cell.value()->~T();
+            cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    // Only a snapshot; concurrent operations may change it immediately
+    size_t size_approx() const {
+        size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t dequeued = dequeue_pos_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool is_empty() const { return size_approx() == 0; }
+
+private:
+    // One cell per cache line: neighbouring cells belong to different
+    // producers and consumers at the same moment, and sharing a line would
+    // bounce it between them on every sequence store
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    class Backoff {
+    public:
+        void pause() {
+            if (spins_ < SPIN_LIMIT) {
+                for (unsigned i = 0; i < (1u << spins_); ++i) {
+#if defined(__x86_64__) || defined(__i386__)
+                    __builtin_ia32_pause();
+#endif
+                }
+                ++spins_;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        static constexpr unsigned SPIN_LIMIT = 6;
+        unsigned spins_ = 0;
+    };
+
+    template<typename U>
+    bool emplace_if_space(U&& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Number of consecutive cells from pos whose sequence is pos + i + offset,
+    // i.e. ready for a producer (offset 0) or a consumer (offset 1).
+    size_t count_ready(size_t pos, size_t limit, size_t offset) const {
+        size_t ready = 0;
+        while (ready < limit && ready < capacity_) {
+            size_t sequence = cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire);
+            if (sequence != pos + ready + offset) {
+                break;
+            }
+            ++ready;
+        }
+        return ready;
+    }
+
+    static size_t round_up_to_power_of_two(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    Cell* const cells_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos_;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_BOUNDED_MPMC_QUEUE_H
@@ -5,9 +5,14 @@
 #include <memory>
 #include <algorithm>
 #include <optional>
+#include <functional>
+#include <cstddef>
 
 namespace nexusdb {
 
+// B+tree node. Internal nodes only hold separator keys and children; keys
+// and values live in the leaves, which are linked to their siblings so a
+// range can be scanned without going back through the parents.
 template<typename Key, typename Value>
 class BTreeNode {
 public:
@@ -15,29 +20,108 @@ public:
     std::vector<Key> keys;
     std::vector<Value> values;
     std::vector<std::unique_ptr<BTreeNode>> children;
+    BTreeNode* next;
+    BTreeNode* prev;
 
-    BTreeNode(bool leaf = true) : is_leaf(leaf) {}
+    BTreeNode(bool leaf = true) : is_leaf(leaf), next(nullptr), prev(nullptr) {}
 };
 
 template<typename Key, typename Value>
 class BTree {
 private:
-    std::unique_ptr<BTreeNode<Key, Value>> root;
+    using Node = BTreeNode<Key, Value>;
+
+    std::unique_ptr<Node> root;
     size_t degree;
+    size_t num_entries;
+    size_t num_nodes;
+    size_t num_levels;
 
-    void split_child(BTreeNode<Key, Value>* parent, int index, BTreeNode<Key, Value>* child);
-    void insert_non_full(BTreeNode<Key, Value>* node, const Key& key, const Value& value);
+    void split_child(Node* parent, int index, Node* child);
+    void insert_non_full(Node* node, const Key& key, const Value& value);
+    bool remove_from(Node* node, const Key& key);
+    // Refills parent->children[index] after it dropped below degree - 1 keys
+    void rebalance(Node* parent, size_t index);
+    void merge_children(Node* parent, size_t index);
+    const Node* find_leaf(const Key& key) const;
+    const Node* first_leaf() const;
+    const Node* last_leaf() const;
 
 public:
-    BTree(size_t degree) 
-        : root(std::make_unique<BTreeNode<Key, Value>>()), degree(degree) {}
+    // Bidirectional iterator over the leaf level. Decrementing end() yields
+    // the last entry. Any insert or remove invalidates all iterators.
+    class Iterator {
+    public:
+        Iterator() : tree_(nullptr), leaf_(nullptr), index_(0) {}
+
+        const Key& key() const { return leaf_->keys[index_]; }
+        const Value& value() const { return leaf_->values[index_]; }
+
+        Iterator& operator++() {
+            ++index_;
+            skip_forward();
+            return *this;
+        }
+
+        Iterator& operator--() {
+            if (leaf_ == nullptr) {
+                leaf_ = tree_->last_leaf();
+                index_ = leaf_ != nullptr ? leaf_->keys.size() : 0;
+            }
+            while (leaf_ != nullptr && index_ == 0) {
+                leaf_ = leaf_->prev;
+                index_ = leaf_ != nullptr ? leaf_->keys.size() : 0;
+            }
+            if (leaf_ != nullptr) {
+                --index_;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return leaf_ == other.leaf_ && index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BTree;
+
+        Iterator(const BTree* tree, const Node* leaf, size_t index) : tree_(tree), leaf_(leaf), index_(index) {
+            skip_forward();
+        }
 
+        // Moves past exhausted (or emptied) leaves; the end position is a null leaf
+        void skip_forward() {
+            while (leaf_ != nullptr && index_ >= leaf_->keys.size()) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+        }
+
+        const BTree* tree_;
+        const Node* leaf_;
+        size_t index_;
+    };
+
+    BTree(size_t degree)
+        : root(std::make_unique<Node>()), degree(std::max<size_t>(degree, 2)), num_entries(0), num_nodes(1), num_levels(1) {}
+
+    // Inserts the key, or replaces its value if it is already present
     void insert(const Key& key, const Value& value);
     std::optional<Value> search(const Key& key) const;
-};
+    bool remove(const Key& key);
 
-// Implementation details...
+    Iterator begin() const;
+    Iterator end() const;
+    // First entry with a key not less than / greater than the given key
+    Iterator lower_bound(const Key& key) const;
+    Iterator upper_bound(const Key& key) const;
+
+    void traverse(const std::function<void(const Key&, const Value&)>& visitor) const;
+
+    size_t size() const { return num_entries; }
+    size_t height() const { return num_levels; }
+    size_t node_count() const { return num_nodes; }
+};
 
 } // namespace nexusdb
 
-#endif // NEXUSDB_BTREE_H
\ No newline at end of file
+#endif // NEXUSDB_BTREE_H
@@ -1,13 +1,18 @@
 #ifndef NEXUSDB_BUFFER_MANAGER_H
 #define NEXUSDB_BUFFER_MANAGER_H
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 #include <cstddef>
 #include <optional>
 #include <mutex>
 #include <memory>
+#include <string>
+#include <functional>
 #include "nexusdb/page.h"
+#include "nexusdb/file_manager.h"
 
 namespace nexusdb {
 
@@ -15,6 +20,7 @@ struct BufferConfig {
     size_t initial_size = 0;  // 0 means auto-detect based on system memory
     float memory_usage_fraction = 0.25;  // Use 25% of available memory by default
     bool distributed_mode = false;
+    std::string data_directory;  // Pages are read from and written to files here; empty keeps pages in memory only
 };
 
 class BufferManager {
@@ -28,11 +34,33 @@ public:
     size_t get_buffer_size() const;
     std::optional<std::string> resize_buffer(size_t new_size);
 
-    // Page management methods
+    // Page management methods. Dirty pages are only written by the flush
+    // calls, never on eviction, so a file on disk only changes between
+    // operations. A flush first forces the log through the write-ahead
+    // callback, then writes the pages to a journal next to the file before
+    // writing them in place, so it reaches disk whole or not at all.
     std::shared_ptr<Page> get_page(const std::string& table_name, uint64_t page_id);
     void release_page(const std::string& table_name, uint64_t page_id);
     void flush_page(const std::string& table_name, uint64_t page_id);
     void flush_all_pages();
+    // Writes back the file's dirty pages and forces the file to stable storage
+    std::optional<std::string> flush_file(const std::string& table_name);
+    // Finishes a flush of the file that a crash interrupted. Call before
+    // reading any of its pages.
+    std::optional<std::string> recover_file(const std::string& table_name);
+    // Called before dirty pages are written, so that the log records
+    // describing their changes reach stable storage first
+    void set_write_ahead(std::function<std::optional<std::string>()> force_log);
+    // True while dirty pages, which cannot be evicted, hold the pool above its size
+    bool is_over_limit() const;
+
+    // Pages handed out by get_page must be marked dirty after being modified,
+    // otherwise changes are lost on eviction
+    void mark_dirty(const std::string& table_name, uint64_t page_id);
+    // Appends a zeroed page to the file and caches it
+    std::shared_ptr<Page> allocate_page(const std::string& table_name);
+    // Discards every cached page of a file without writing it back
+    void drop_file(const std::string& table_name);
 
     // New methods for distributed operations
     void invalidate_page(const std::string& table_name, uint64_t page_id);
@@ -45,15 +73,40 @@ private:
         size_t last_access_time;
     };
 
+    // The page table is split by (file, page id) so that a lookup of a
+    // cached page only locks its shard. mutex_ serializes misses, flushes and
+    // eviction, the only places entries are added or removed, and is always
+    // taken before a shard lock.
+    static constexpr size_t PAGE_TABLE_SHARDS = 16;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unordered_map<uint64_t, CacheEntry>> pages;
+    };
+
     BufferConfig config_;
-    std::unordered_map<std::string, std::unordered_map<uint64_t, CacheEntry>> buffer_;
+    mutable std::array<Shard, PAGE_TABLE_SHARDS> shards_;
     mutable std::mutex mutex_;
-    size_t current_size_;
-    size_t access_counter_;
+    std::atomic<size_t> current_size_;
+    std::atomic<size_t> access_counter_;
+    std::unique_ptr<FileManager> file_manager_;
+    std::function<std::optional<std::string>()> force_log_;
+
+    static constexpr uint32_t JOURNAL_MAGIC = 0x4E58464A;  // "NXFJ"
 
     size_t determine_buffer_size() const;
-    void evict_page();
-    void write_page_to_disk(const std::string& table_name, uint64_t page_id, const Page& page);
+    Shard& shard_for(const std::string& table_name, uint64_t page_id) const;
+    // Callers hold the shard's lock; nullptr if the page is not cached
+    static CacheEntry* find_entry(Shard& shard, const std::string& table_name, uint64_t page_id);
+    // Ids of the file's cached pages. Callers hold mutex_.
+    std::vector<uint64_t> cached_page_ids(const std::string& table_name) const;
+    // Evicts the least recently used clean page nobody holds; false if there is none
+    bool evict_page();
+    void flush_all_pages_locked();
+    // Writes the listed pages of the file that are dirty, through the journal.
+    // Callers hold mutex_.
+    std::optional<std::string> flush_pages_locked(const std::string& table_name, const std::vector<uint64_t>& page_ids);
+    std::string get_journal_path(const std::string& table_name) const;
+    bool write_page_to_disk(const std::string& table_name, uint64_t page_id, const Page& page);
     std::shared_ptr<Page> read_page_from_disk(const std::string& table_name, uint64_t page_id);
 };
 
@@ -0,0 +1,126 @@
+#ifndef NEXUSDB_CONCURRENT_BTREE_H
+#define NEXUSDB_CONCURRENT_BTREE_H
+
+#include "nexusdb/epoch_manager.h"
+#include "nexusdb/key_search.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace nexusdb {
+
+// Ordered set kept in a B+tree with optimistic lock coupling. Every node has
+// a version counter that writers bump while holding it locked; readers take
+// no locks and instead re-check the versions of the nodes they went through,
+// restarting if one changed. Writers lock only the nodes they modify.
+//
+// Node contents are copy-on-write: a writer publishes a new key array and
+// retires the old one through an EpochManager, so a reader racing a writer
+// never sees a half-updated node. A removal that leaves a node underfull
+// merges it with, or borrows from, a sibling; the emptied node is marked
+// obsolete so optimistic readers that reach it restart.
+//
+// Each node also stores a KeyPrefix per key in a flat array; searches
+// narrow the position with vectorized integer compares and only compare
+// full keys among equal prefixes.
+template<typename Key>
+class ConcurrentBTree {
+public:
+    static constexpr size_t DEFAULT_NODE_CAPACITY = 32;
+
+    // Return false to stop a scan
+    using Visitor = std::function<bool(const Key& key)>;
+
+    explicit ConcurrentBTree(size_t node_capacity = DEFAULT_NODE_CAPACITY);
+    ~ConcurrentBTree();
+
+    ConcurrentBTree(const ConcurrentBTree&) = delete;
+    ConcurrentBTree& operator=(const ConcurrentBTree&) = delete;
+
+    // Return false if the key was already present / missing
+    bool insert(const Key& key);
+    bool remove(const Key& key);
+    bool contains(const Key& key) const;
+
+    // Builds the tree bottom-up from sorted, unique keys, filling nodes to
+    // fill_factor of their capacity. Returns false unless the tree is empty.
+    // No other operation may run during the load.
+    bool bulk_load(const std::vector<Key>& keys, double fill_factor);
+
+    // Visits keys in order, starting at the first key not less than from
+    // (greater than, if exclusive) or at the smallest key if from is empty.
+    // Keys inserted or removed during the scan may or may not be seen.
+    void scan(const std::optional<Key>& from, bool exclusive, const Visitor& visitor) const;
+
+    size_t size() const { return num_entries_.load(std::memory_order_relaxed); }
+    size_t height() const { return height_.load(std::memory_order_relaxed); }
+    size_t node_count() const { return node_count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node;
+
+    // Internal nodes hold keys.size() + 1 children; leaves hold no children
+    struct Contents {
+        std::vector<Key> keys;
+        std::vector<Node*> children;
+        std::vector<uint64_t> prefixes;
+
+        // Fills prefixes from keys; called once, before publishing
+        void seal();
+        size_t lower_bound(const Key& key) const;
+        size_t upper_bound(const Key& key) const;
+    };
+
+    struct Node {
+        Node(bool leaf, Contents* initial) : is_leaf(leaf), version(0), contents(initial), next(nullptr) { initial->seal(); }
+
+        const bool is_leaf;
+        std::atomic<uint64_t> version;
+        std::atomic<const Contents*> contents;
+        std::atomic<Node*> next;  // Right sibling, leaves only
+    };
+
+    static constexpr uint64_t OBSOLETE_BIT = 1;
+    static constexpr uint64_t LOCKED_BIT = 2;
+
+    const size_t node_capacity_;
+    std::atomic<Node*> root_;
+    std::atomic<size_t> num_entries_;
+    std::atomic<size_t> height_;
+    std::atomic<size_t> node_count_;
+    mutable EpochManager epoch_;
+
+    static constexpr size_t MAX_REBALANCE_ATTEMPTS = 8;
+
+    static bool read_lock(const Node* node, uint64_t& version);
+    static bool validate(const Node* node, uint64_t version);
+    static bool upgrade_lock(Node* node, uint64_t version);
+    static void write_unlock(Node* node);
+    static void write_unlock_obsolete(Node* node);
+    static void backoff(size_t attempt);
+
+    // Descends to the leaf whose range holds key (the leftmost leaf if key is
+    // empty). Returns false if a concurrent change forces a restart.
+    bool find_leaf(const std::optional<Key>& key, const Node*& leaf, uint64_t& version) const;
+    // Callers hold the locks on node and parent (if any)
+    void split(Node* parent, Node* node);
+    // Fixes underfull nodes on the path to key. Gives up under contention;
+    // the next removal that underfills a node tries again.
+    void rebalance_path(const Key& key);
+    // Merges parent's children at index and index + 1, or evens them out if
+    // they would not fit one node. Callers hold all three locks; returns
+    // true if the right child was merged away.
+    bool merge_or_redistribute(Node* parent, size_t index);
+    void retire_node(Node* node);
+    size_t min_keys() const { return std::max<size_t>(node_capacity_ / 4, 1); }
+    void replace_contents(Node* node, Contents* contents);
+    void free_subtree(Node* node);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_CONCURRENT_BTREE_H
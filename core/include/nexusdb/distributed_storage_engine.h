@@ -9,7 +9,6 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
-#include <future>
 
 namespace nexusdb {
 
@@ -34,6 +33,10 @@ public:
     std::optional<std::string> delete_table(const std::string& table_name) override;
 
     // Record operations
+    using StorageEngine::insert_record;
+    using StorageEngine::read_record;
+    using StorageEngine::update_record;
+    using StorageEngine::delete_record;
     std::optional<std::string> insert_record(const std::string& table_name, const std::vector<std::string>& record) override;
     std::optional<std::string> read_record(const std::string& table_name, uint64_t record_id, std::vector<std::string>& record) const override;
     std::optional<std::string> update_record(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record) override;
@@ -72,7 +75,8 @@ private:
     // Helper methods
     std::vector<NodeInfo> select_nodes_for_operation(const std::string& table_name, const std::string& partition_key) const;
     std::optional<std::string> distribute_operation(const std::string& operation, const std::vector<NodeInfo>& target_nodes);
-    std::future<QueryResult> async_execute_query_on_node(const std::string& query, const NodeInfo& node);
+    // Runs on the scheduler, one task per node
+    QueryResult execute_query_on_node(const std::string& query, const NodeInfo& node);
     std::optional<std::string> resolve_conflicts(const std::vector<std::string>& conflicting_records);
     void update_partition_metadata(const std::string& table_name, const std::string& partition_key, const std::string& node_address);
     
@@ -0,0 +1,107 @@
+#ifndef NEXUSDB_EPOCH_MANAGER_H
+#define NEXUSDB_EPOCH_MANAGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nexusdb {
+
+// Epoch-based memory reclamation for lock-free structures.
+//
+// A thread pins the manager for the duration of every operation that may
+// dereference shared nodes. Nodes unlinked from a structure are retired rather
+// than freed, and are only handed back to their reclaim function once every
+// thread that could still hold a reference has unpinned.
+class EpochManager {
+public:
+    using ReclaimFunction = void (*)(void* ptr, void* context);
+
+    static constexpr uint64_t INACTIVE_EPOCH = UINT64_MAX;
+    static constexpr size_t COLLECT_THRESHOLD = 64;
+
+private:
+    struct ThreadRecord;
+
+public:
+    class Guard {
+    public:
+        Guard(Guard&& other) noexcept;
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+
+    private:
+        friend class EpochManager;
+        Guard(EpochManager* manager, ThreadRecord* record);
+
+        EpochManager* manager_;
+        ThreadRecord* record_;
+    };
+
+    EpochManager();
+    ~EpochManager();
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // Pins the calling thread to the current epoch. Guards nest.
+    Guard pin();
+
+    // Defers reclaim(ptr, context) until no pinned thread can reach ptr.
+    void retire(void* ptr, ReclaimFunction reclaim, void* context = nullptr);
+
+    template<typename T>
+    void retire(T* ptr) {
+        retire(ptr, +[](void* p, void*) { delete static_cast<T*>(p); });
+    }
+
+    // Advances the global epoch if every pinned thread has observed it.
+    bool try_advance();
+
+    // Reclaims whatever the calling thread has retired that is now safe.
+    void collect();
+
+    // Reclaims everything retired by every thread. Only safe when no other
+    // thread is using the manager (e.g. while tearing down the owner).
+    void reclaim_all();
+
+    uint64_t get_epoch() const;
+
+private:
+    struct RetiredPointer {
+        void* ptr;
+        ReclaimFunction reclaim;
+        void* context;
+        uint64_t epoch;
+    };
+
+    struct ThreadRecord {
+        alignas(64) std::atomic<uint64_t> local_epoch{INACTIVE_EPOCH};
+        std::atomic<bool> in_use{false};
+        std::atomic<bool> manager_alive{true};
+        uint32_t nesting = 0;
+        size_t retired_since_collect = 0;
+        std::vector<RetiredPointer> retired;
+        ThreadRecord* next = nullptr;
+    };
+
+    alignas(64) std::atomic<uint64_t> global_epoch_;
+    std::atomic<ThreadRecord*> records_;
+    std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<ThreadRecord>> registry_;
+    const uint64_t id_;
+
+    ThreadRecord* acquire_record();
+    void unpin(ThreadRecord* record);
+    void collect(ThreadRecord* record);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_EPOCH_MANAGER_H
@@ -20,6 +20,20 @@ public:
     std::unique_ptr<Page> read_page(const std::string& file_name, uint64_t page_id);
     bool write_page(const std::string& file_name, const Page& page);
     std::unique_ptr<Page> allocate_page(const std::string& file_name);
+    // Forces the file's written pages to stable storage
+    bool sync_file(const std::string& file_name);
+    // Closes and removes the file; true if it is gone
+    bool delete_file(const std::string& file_name);
+    // Forces source, renames it over target and forces the directory, so a
+    // crash leaves the old or the new target whole. Closes both files.
+    bool replace_file(const std::string& source, const std::string& target);
+
+    // Forces a file, or a directory's entries, to stable storage
+    static bool sync_path(const std::string& path);
+    // Writes contents to a temporary file, forces it and renames it over
+    // path, then forces the directory, so a crash leaves the old or the new
+    // contents whole
+    static bool write_file_durably(const std::string& path, const std::string& contents);
 
 private:
     std::string data_directory_;
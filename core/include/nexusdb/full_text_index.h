@@ -0,0 +1,203 @@
+#ifndef NEXUSDB_FULL_TEXT_INDEX_H
+#define NEXUSDB_FULL_TEXT_INDEX_H
+
+#include "nexusdb/index.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// Splits text into terms, numbering them by word position so phrase
+// queries can check adjacency. A tokenizer may skip positions, e.g. for
+// stop words, as long as it numbers a document and a query alike.
+class Tokenizer {
+public:
+    using Visitor = std::function<void(const std::string& term, uint32_t position)>;
+
+    virtual ~Tokenizer() = default;
+    virtual void tokenize(const std::string& text, const Visitor& visitor) const = 0;
+};
+
+// Lowercased runs of ASCII letters and digits. Bytes of multi-byte UTF-8
+// characters count as letters, so non-ASCII words stay whole; everything
+// else separates terms. Terms are cut at MAX_TERM_SIZE bytes.
+class SimpleTokenizer : public Tokenizer {
+public:
+    static constexpr size_t MAX_TERM_SIZE = 64;
+
+    void tokenize(const std::string& text, const Visitor& visitor) const override;
+};
+
+// Record ids of one term in ascending order, each with the term's
+// positions in that record. Ids are delta-coded as varints in blocks of
+// BLOCK_SIZE records; a skip entry per block keeps its last id and offset,
+// so a cursor seeking far ahead gallops over whole blocks without decoding
+// them.
+class TermPostings {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    // record_id must be above every id appended so far; positions are sorted
+    void append(uint64_t record_id, const std::vector<uint32_t>& positions);
+    size_t size() const { return size_; }
+    size_t memory_usage() const;
+
+    class Cursor {
+    public:
+        explicit Cursor(const TermPostings& postings);
+
+        bool valid() const { return valid_; }
+        uint64_t record_id() const { return record_id_; }
+        const std::vector<uint32_t>& positions() const { return positions_; }
+        void next();
+        // Moves to the first record id not below target
+        void seek(uint64_t target);
+
+    private:
+        const TermPostings* postings_;
+        size_t block_ = 0;
+        size_t offset_ = 0;
+        size_t block_end_ = 0;
+        bool valid_ = false;
+        uint64_t record_id_ = 0;
+        std::vector<uint32_t> positions_;
+
+        void enter_block(size_t block);
+        void decode();
+    };
+
+private:
+    struct Skip {
+        uint64_t base;  // Last id of the previous block, which the first id is coded against
+        uint64_t last;
+        size_t offset;
+    };
+
+    std::vector<uint8_t> data_;
+    std::vector<Skip> skips_;
+    size_t size_ = 0;
+};
+
+// A MATCH query: clauses separated by OR, each a list of words and
+// "quoted phrases" that must all appear in a record. Words and phrases go
+// through the index's tokenizer, so a word the tokenizer splits (e-mail)
+// is matched as a phrase.
+class FullTextQuery {
+public:
+    // A run of terms at fixed distances from the first one
+    struct Phrase {
+        std::vector<std::string> terms;
+        std::vector<uint32_t> offsets;
+    };
+    using Clause = std::vector<Phrase>;
+
+    static FullTextQuery parse(const std::string& query, const Tokenizer& tokenizer);
+
+    const std::vector<Clause>& clauses() const { return clauses_; }
+    bool empty() const { return clauses_.empty(); }
+    // Evaluates the query against one text, for rows without an index
+    bool matches(const std::string& text, const Tokenizer& tokenizer) const;
+
+private:
+    std::vector<Clause> clauses_;
+};
+
+// Inverted index over a text column: maps each term to the records that
+// contain it and where. Each record holds a single text; inserting another
+// text for a record replaces the old one.
+//
+// New records go to an in-memory buffer. Once it holds SEGMENT_RECORDS
+// records it is frozen into an immutable segment of compressed postings.
+// Removing a record from a segment only marks it deleted. Whenever
+// MERGE_FACTOR segments have been merged the same number of times, a
+// background task merges them into one, dropping deleted records. Queries
+// run against every segment and the buffer; AND intersects with galloping
+// cursor seeks, rarest term first. Heap-resident; contents are lost on
+// restart.
+//
+// Keys seen by search, postings and search_index are MATCH queries. scan
+// visits (term, record_id) pairs with the term between the bounds.
+class FullTextIndex : public Index {
+public:
+    static constexpr size_t SEGMENT_RECORDS = 4096;
+    static constexpr size_t MERGE_FACTOR = 4;
+
+    explicit FullTextIndex(std::shared_ptr<const Tokenizer> tokenizer = nullptr);
+    // Waits for a background merge in flight
+    ~FullTextIndex() override;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    // Number of records
+    size_t size() const override;
+    size_t height() const override { return 1; }
+    // Segments, counting a non-empty buffer
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::FULLTEXT; }
+
+    // Records matching a MATCH query, in ascending order
+    std::vector<uint64_t> match(const std::string& query) const;
+    const Tokenizer& tokenizer() const { return *tokenizer_; }
+    // Blocks until no merge is pending, for tests and shutdown
+    void wait_for_merges() const;
+
+private:
+    struct Segment {
+        std::map<std::string, TermPostings> terms;
+        std::vector<uint64_t> record_ids;  // Sorted
+        size_t merges = 0;  // Times its records have been merged, which sets its tier
+        std::unordered_set<uint64_t> deleted;  // Guarded by mutex_, unlike the rest
+
+        bool contains(uint64_t record_id) const;
+    };
+
+    std::shared_ptr<const Tokenizer> tokenizer_;
+    std::vector<std::shared_ptr<Segment>> segments_;
+    // Buffer: term -> record id -> positions, and each buffered record's terms
+    std::map<std::string, std::map<uint64_t, std::vector<uint32_t>>> buffer_terms_;
+    std::unordered_map<uint64_t, std::vector<std::string>> buffer_records_;
+    // Every record in the index, with a hash of its text
+    std::unordered_map<uint64_t, uint64_t> records_;
+    bool merging_ = false;
+    mutable std::shared_mutex mutex_;
+    mutable std::mutex merge_mutex_;
+    mutable std::condition_variable merge_done_;
+
+    // Callers hold mutex_ exclusively. Return true if a merge should be started.
+    bool insert_locked(const std::string& text, uint64_t record_id);
+    void remove_locked(uint64_t record_id);
+    bool freeze_buffer_locked();
+    // Segments of the lowest tier holding MERGE_FACTOR of them; empty if none
+    std::vector<std::shared_ptr<Segment>> pick_merge_locked() const;
+
+    void start_merge();
+    void run_merges();
+    static std::shared_ptr<Segment> merge_segments(const std::vector<std::shared_ptr<Segment>>& inputs,
+                                                   const std::vector<std::unordered_set<uint64_t>>& deleted);
+    // Records of one segment matching query; lookup returns nullptr for missing terms
+    static void evaluate(const FullTextQuery& query, const std::function<const TermPostings*(const std::string&)>& lookup,
+                         const std::unordered_set<uint64_t>* deleted, std::vector<uint64_t>& out);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_FULL_TEXT_INDEX_H
@@ -0,0 +1,70 @@
+#ifndef NEXUSDB_GEOMETRY_H
+#define NEXUSDB_GEOMETRY_H
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace nexusdb {
+
+// Geometry columns hold points as "POINT(x y)" and axis-aligned boxes as
+// "BOX(x1 y1,x2 y2)". Coordinates are planar and distances Euclidean, so
+// longitude/latitude data should be projected before it is stored.
+struct Point {
+    double x;
+    double y;
+};
+
+struct Rect {
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+
+    static Rect of(const Point& point) { return Rect{point.x, point.y, point.x, point.y}; }
+
+    double area() const { return (max_x - min_x) * (max_y - min_y); }
+    // Half the perimeter, which R*-tree splits minimize
+    double margin() const { return (max_x - min_x) + (max_y - min_y); }
+    Point center() const { return Point{(min_x + max_x) / 2, (min_y + max_y) / 2}; }
+
+    bool intersects(const Rect& other) const {
+        return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+    }
+    bool contains(const Rect& other) const {
+        return min_x <= other.min_x && other.max_x <= max_x && min_y <= other.min_y && other.max_y <= max_y;
+    }
+    Rect united(const Rect& other) const {
+        return Rect{std::min(min_x, other.min_x), std::min(min_y, other.min_y), std::max(max_x, other.max_x), std::max(max_y, other.max_y)};
+    }
+    // Area shared with other
+    double overlap(const Rect& other) const {
+        double width = std::min(max_x, other.max_x) - std::max(min_x, other.min_x);
+        double height = std::min(max_y, other.max_y) - std::max(min_y, other.min_y);
+        return width > 0 && height > 0 ? width * height : 0;
+    }
+    // Distance from point to the nearest point of the rectangle; 0 inside it
+    double distance_to(const Point& point) const {
+        double dx = std::max({min_x - point.x, 0.0, point.x - max_x});
+        double dy = std::max({min_y - point.y, 0.0, point.y - max_y});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    bool operator==(const Rect& other) const {
+        return min_x == other.min_x && min_y == other.min_y && max_x == other.max_x && max_y == other.max_y;
+    }
+};
+
+// Bounding rectangle of a POINT or BOX; nullopt for anything else
+std::optional<Rect> parse_geometry(const std::string& text);
+std::string encode_point(const Point& point);
+std::string encode_box(const Rect& box);
+
+// A DWITHIN operand: "POINT(x y) radius"
+std::optional<std::pair<Point, double>> parse_distance_query(const std::string& text);
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_GEOMETRY_H
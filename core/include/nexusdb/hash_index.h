@@ -0,0 +1,151 @@
+#ifndef NEXUSDB_HASH_INDEX_H
+#define NEXUSDB_HASH_INDEX_H
+
+#include "nexusdb/buffer_manager.h"
+#include "nexusdb/index.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// Bucket addressing for linear hashing. The table starts with
+// INITIAL_BUCKETS buckets and grows one bucket at a time: each split
+// rehashes only the bucket at next_split into itself and one new bucket,
+// so resizing never stalls an insert for longer than one bucket.
+struct LinearHashing {
+    static constexpr uint64_t INITIAL_BUCKETS = 16;
+
+    uint64_t level = 0;
+    uint64_t next_split = 0;
+
+    uint64_t bucket_count() const { return (INITIAL_BUCKETS << level) + next_split; }
+    uint64_t bucket_for(uint64_t hash) const;
+    // Advances past the bucket that was just split
+    void advance();
+
+    // Stable across processes and platforms, so buckets survive restarts
+    static uint64_t hash(const std::string& key);
+};
+
+// Heap-resident hash index; contents are lost on restart
+class HashIndex : public Index {
+public:
+    // Average entries per bucket before the next split
+    static constexpr size_t MAX_LOAD = 4;
+
+    HashIndex();
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override { return 1; }
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::HASH; }
+
+private:
+    using Bucket = std::vector<std::pair<std::string, uint64_t>>;
+
+    // A deque grows without moving existing buckets
+    std::deque<Bucket> buckets_;
+    LinearHashing addressing_;
+    size_t entry_count_;
+    mutable std::shared_mutex mutex_;
+
+    void split();
+};
+
+// Disk-resident linear hash table in an index file, accessed through a
+// BufferManager. Each bucket is a chain of pages; page 0 holds the
+// metadata and a chain of directory pages maps bucket numbers to the
+// first page of each bucket. Page id 0 doubles as the null link.
+class PagedHashIndex : public Index {
+public:
+    static constexpr uint32_t MAGIC = 0x49484E58;  // "NXHI"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t MAX_KEY_SIZE = 1024;
+    static constexpr uint64_t META_PAGE_ID = 0;
+    // A bucket is split once the average bucket is this full
+    static constexpr double MAX_FILL = 0.75;
+
+    PagedHashIndex(std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name);
+
+    // Loads the table from its file, creating an empty one if the file is new
+    std::optional<std::string> open();
+    // Writes the metadata and every dirty page back to disk
+    std::optional<std::string> flush() override;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    // Sizes the table for the entries up front; flushed before returning
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override { return 1; }
+    size_t node_count() const override;
+    bool is_persistent() const override { return true; }
+    IndexType type() const override { return IndexType::HASH; }
+
+private:
+    using Entry = std::pair<std::string, uint64_t>;
+
+    // Decoded copy of one page of a bucket chain
+    struct BucketPage {
+        uint64_t page_id = 0;
+        uint64_t overflow = 0;
+        std::vector<Entry> entries;
+    };
+
+    static constexpr size_t BUCKET_HEADER_SIZE = 16;
+    static constexpr size_t DIRECTORY_FANOUT = (Page::PAGE_SIZE - sizeof(uint64_t)) / sizeof(uint64_t);
+
+    std::shared_ptr<BufferManager> buffer_manager_;
+    std::string file_name_;
+    LinearHashing addressing_;
+    uint64_t entry_count_;
+    uint64_t entry_bytes_;
+    uint64_t page_count_;  // Pages in use besides the metadata page
+    uint64_t free_list_head_;
+    // In-memory copies of the directory chain and the bucket map it stores
+    std::vector<uint64_t> directory_pages_;
+    std::vector<uint64_t> bucket_pages_;
+    mutable std::shared_mutex mutex_;
+
+    BucketPage load_bucket_page(uint64_t page_id) const;
+    void store_bucket_page(const BucketPage& page);
+    std::vector<BucketPage> load_chain(uint64_t bucket) const;
+    // Packs entries into the bucket's chain, reusing its pages and
+    // freeing any left over
+    void write_chain(uint64_t bucket, const std::vector<Entry>& entries);
+    uint64_t allocate_page();
+    void free_page(uint64_t page_id);
+    void add_bucket();
+    void load_directory();
+    void store_meta();
+    void split();
+    bool needs_split() const;
+
+    static size_t encoded_size(const Entry& entry) { return sizeof(uint16_t) + entry.first.size() + sizeof(uint64_t); }
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_HASH_INDEX_H
@@ -0,0 +1,157 @@
+#ifndef NEXUSDB_HNSW_INDEX_H
+#define NEXUSDB_HNSW_INDEX_H
+
+#include "nexusdb/buffer_manager.h"
+#include "nexusdb/index.h"
+#include "nexusdb/vector_distance.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+struct HnswConfig {
+    size_t dimension = 0;  // 0 takes the dimension of the first vector inserted
+    DistanceMetric metric = DistanceMetric::L2;
+    size_t m = 16;  // Links per node on each layer; layer 0 keeps twice as many
+    size_t ef_construction = 200;  // Candidates considered when linking a new node
+    size_t ef_search = 64;  // Candidates considered by a query, at least k
+};
+
+// Hierarchical navigable small world graph over a vector column, answering
+// approximate k-nearest-neighbour queries. Keys are vectors in the
+// encode_vector text form. Each record holds a single vector; inserting
+// another vector for a record replaces the old one.
+//
+// Every node sits on layer 0 and, with exponentially falling odds, on the
+// layers above it. A query descends greedily from the top layer's entry
+// point and widens to ef candidates on layer 0. Inserts run concurrently:
+// the node is appended under a short exclusive lock, then linked under a
+// shared one, locking one node's neighbour lists at a time. Removed
+// records stay in the graph as tombstones that still route searches, until
+// flush finds they make up MAX_TOMBSTONE_FRACTION of it and rebuilds the
+// graph from the live vectors.
+//
+// With a BufferManager the graph is written to the index file by flush:
+// page 0 holds the metadata, the following pages the serialized nodes. If
+// the file was changed after its last flush, open starts from an empty
+// graph and needs_rebuild() holds until bulk_load refills it; flush writes
+// nothing meanwhile.
+class HnswIndex : public Index {
+public:
+    static constexpr uint32_t MAGIC = 0x5748584E;  // "NXHW"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint64_t META_PAGE_ID = 0;
+    static constexpr size_t MAX_LEVEL = 16;
+    static constexpr double MAX_TOMBSTONE_FRACTION = 0.25;
+
+    // Heap-resident graph; contents are lost on restart
+    explicit HnswIndex(HnswConfig config = {});
+    HnswIndex(HnswConfig config, std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name);
+
+    // Loads the graph and its configuration from the index file, creating
+    // an empty one with the constructor's configuration if the file is new
+    std::optional<std::string> open();
+    std::optional<std::string> flush() override;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    // Records whose vector equals key, found through the graph
+    std::vector<uint64_t> search(const std::string& key) const override;
+    // Scanned keys are re-encoded vectors, which need not match the text a
+    // record holds, so postings go through search
+    PostingList postings(const std::string& key) const override;
+    // Links the entries on every scheduler worker at once
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    // Visits every record's vector, in no particular order
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    // Number of records
+    size_t size() const override;
+    // Layers in the graph
+    size_t height() const override;
+    // Nodes, counting tombstones
+    size_t node_count() const override;
+    bool is_persistent() const override { return buffer_manager_ != nullptr; }
+    bool needs_rebuild() const override;
+    IndexType type() const override { return IndexType::HNSW; }
+
+    // The k records nearest to query with their distances, closest first.
+    // ef of 0 uses the configured ef_search; it is raised to at least k.
+    std::vector<std::pair<uint64_t, float>> knn(const std::vector<float>& query, size_t k, size_t ef = 0) const;
+    HnswConfig config() const;
+    void set_ef_search(size_t ef_search);
+
+private:
+    using NodeId = uint32_t;
+    // (distance, node) pairs
+    using Candidate = std::pair<float, NodeId>;
+
+    struct Node {
+        uint64_t record_id;
+        std::vector<float> vector;
+        float inverse_norm;  // Cached for COSINE
+        std::vector<std::vector<NodeId>> neighbors;  // One list per layer the node is on
+        mutable std::mutex mutex;  // Guards neighbors
+        std::atomic<bool> deleted{false};
+    };
+
+    HnswConfig config_;
+    std::shared_ptr<BufferManager> buffer_manager_;
+    std::string file_name_;
+    // nodes_ only grows; appending takes mutex_ exclusively, while searches
+    // and the linking of new nodes share it
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::unordered_map<uint64_t, NodeId> live_;  // Record id -> its node
+    NodeId entry_point_ = 0;
+    size_t max_level_ = 0;
+    std::mt19937_64 level_generator_;
+    // Set by the first change after a flush, which marks the file unclean
+    bool dirty_ = false;
+    // Set when open found the file unclean, until bulk_load refills the graph
+    bool stale_ = false;
+    mutable std::shared_mutex mutex_;
+
+    // Callers hold mutex_
+    float distance(const float* query, float query_inverse_norm, NodeId node) const;
+    float distance(NodeId a, NodeId b) const;
+    size_t max_links(size_t level) const { return level == 0 ? 2 * config_.m : config_.m; }
+    size_t random_level();
+    // Walks layers from_level down to to_level, moving to any closer neighbour
+    NodeId greedy_search(const float* query, float query_inverse_norm, NodeId entry, size_t from_level, size_t to_level) const;
+    // Up to ef nearest nodes on one layer, closest first. With skip_deleted,
+    // tombstones are walked through but not returned.
+    std::vector<Candidate> search_layer(const float* query, float query_inverse_norm, NodeId entry, size_t ef, size_t level,
+                                        bool skip_deleted) const;
+    // Picks up to count of candidates, sorted closest first, that are
+    // closer to the base than to any neighbour already picked
+    std::vector<NodeId> select_neighbors(const std::vector<Candidate>& candidates, size_t count) const;
+    // Connects a new node on its layers up to the entry point's
+    void link(NodeId node_id, NodeId entry, size_t top_level);
+    // Adds to to from's links on level, pruning them if they overflow
+    void add_link(NodeId from, NodeId to, size_t level);
+
+    // Callers hold mutex_ exclusively. store_meta describes a snapshot of
+    // data_size bytes and marks the file clean; mark_dirty_locked clears
+    // the clean flag on disk before the first change after a flush.
+    void store_meta(uint64_t node_count, uint64_t data_size);
+    void mark_dirty_locked();
+    // Replaces the graph with one built from the live vectors alone
+    std::optional<std::string> compact_locked();
+    std::vector<char> serialize() const;
+    std::optional<std::string> deserialize(const std::vector<char>& data, uint64_t node_count);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_HNSW_INDEX_H
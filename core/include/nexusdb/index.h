@@ -0,0 +1,109 @@
+#ifndef NEXUSDB_INDEX_H
+#define NEXUSDB_INDEX_H
+
+#include "nexusdb/concurrent_btree.h"
+#include "nexusdb/posting_list.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// B-trees keep keys ordered and answer range and prefix queries; hash
+// indexes only answer equality lookups, in O(1). Adaptive radix trees are
+// ordered too but live only in memory, for hot tables. Bitmap indexes,
+// also in memory, suit low-cardinality columns whose predicates are
+// combined. Full-text indexes map the words of a text column to the
+// records holding them and answer MATCH queries only. HNSW indexes link the
+// vectors of a vector column into a graph for nearest-neighbour searches.
+// R-trees bound the geometries of a geometry column with nested rectangles
+// and answer bounding-box, radius and nearest-neighbour queries.
+enum class IndexType {
+    BTREE,
+    HASH,
+    ART,
+    BITMAP,
+    FULLTEXT,
+    HNSW,
+    RTREE
+};
+
+const char* index_type_name(IndexType type);
+std::optional<IndexType> parse_index_type(const std::string& name);
+
+// Secondary index over one column, mapping column values to record ids.
+// Inserting an existing (key, record_id) pair or removing a missing one is a
+// no-op, so logged index operations can be replayed safely. Implementations
+// are safe to call from several threads at once.
+class Index {
+public:
+    // Return false from a scan visitor to stop the scan
+    using ScanVisitor = std::function<bool(const std::string& key, uint64_t record_id)>;
+
+    virtual ~Index() = default;
+
+    virtual std::optional<std::string> insert(const std::string& key, uint64_t record_id) = 0;
+    virtual std::optional<std::string> remove(const std::string& key, uint64_t record_id) = 0;
+    virtual std::vector<uint64_t> search(const std::string& key) const = 0;
+    // Record ids stored under key. Equal keys are scanned in record id
+    // order, so the list is built by tail appends only.
+    virtual PostingList postings(const std::string& key) const;
+    // postings for each of keys, which are sorted and unique, in the same
+    // order. Trees override this to descend once and walk the keys in order.
+    virtual std::vector<PostingList> postings_batch(const std::vector<std::string>& keys) const;
+    // Builds an empty index bottom-up from entries sorted by (key, record_id)
+    // without duplicates, filling nodes to fill_factor of their capacity
+    virtual std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) = 0;
+    // Visits entries between the bounds, in key order if the index is
+    // ordered; a missing bound is unbounded
+    virtual void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                      const std::optional<std::string>& upper, bool upper_inclusive,
+                      const ScanVisitor& visitor) const = 0;
+
+    virtual size_t size() const = 0;
+    virtual size_t height() const = 0;
+    virtual size_t node_count() const = 0;
+    virtual bool is_persistent() const = 0;
+    virtual IndexType type() const = 0;
+    bool is_ordered() const {
+        IndexType index_type = type();
+        return index_type == IndexType::BTREE || index_type == IndexType::ART || index_type == IndexType::BITMAP;
+    }
+    // Writes back whatever of a persistent index has not reached disk yet
+    virtual std::optional<std::string> flush() { return std::nullopt; }
+    // True if opening the index could not bring its entries back, so it
+    // must be reloaded from its table. Memory-resident indexes start empty.
+    virtual bool needs_rebuild() const { return !is_persistent(); }
+};
+
+// Heap-resident index on top of ConcurrentBTree; contents are lost on
+// restart. Lookups take no locks.
+class BTreeIndex : public Index {
+public:
+    BTreeIndex() = default;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override;
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::BTREE; }
+
+private:
+    ConcurrentBTree<std::pair<std::string, uint64_t>> tree_;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_INDEX_H
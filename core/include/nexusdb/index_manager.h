@@ -2,6 +2,15 @@
 #define NEXUSDB_INDEX_MANAGER_H
 
 #include "btree.h"
+#include "nexusdb/buffer_manager.h"
+#include "nexusdb/epoch_manager.h"
+#include "nexusdb/full_text_index.h"
+#include "nexusdb/hnsw_index.h"
+#include "nexusdb/index.h"
+#include "nexusdb/posting_list.h"
+#include "nexusdb/roaring_bitmap.h"
+#include "nexusdb/rtree_index.h"
+#include <atomic>
 #include <string>
 #include <optional>
 #include <mutex>
@@ -16,25 +25,163 @@ class StorageEngine;
 
 class IndexManager {
 public:
+    // One index of a table. A single-column index stores the column's raw
+    // values as keys. A composite index stores encode_composite_key over its
+    // key columns followed by its INCLUDE columns: the key columns order the
+    // entries, and the INCLUDE values ride along so scans can answer queries
+    // without reading the table.
+    struct IndexDefinition {
+        std::string name;
+        std::vector<std::string> key_columns;
+        std::vector<std::string> include_columns;
+        IndexType type = IndexType::BTREE;
+
+        bool is_composite() const { return key_columns.size() > 1 || !include_columns.empty(); }
+        // The index key for a record laid out by schema; nullopt if the
+        // record lacks one of the columns
+        std::optional<std::string> key_for(const std::vector<std::string>& schema, const std::vector<std::string>& record) const;
+        // Where the key and INCLUDE columns sit in schema, for key_at
+        std::vector<size_t> column_positions(const std::vector<std::string>& schema) const;
+        // key_for with the columns already looked up in the schema
+        std::optional<std::string> key_at(const std::vector<size_t>& positions, const std::vector<std::string>& record) const;
+    };
+
+    // Integer handle of an index, assigned when the index is created and
+    // never reused, so hot paths can hold on to it instead of naming the
+    // index by table and column on every call
+    using IndexId = uint32_t;
+
+    struct IndexHandle {
+        IndexId id;
+        IndexDefinition definition;
+    };
+
+    // A row decoded from a composite index: its key column values followed
+    // by its INCLUDE column values
+    struct IndexRow {
+        uint64_t record_id;
+        std::vector<std::string> values;
+    };
+
+    // column IN values, or NOT IN when negated
+    struct BitmapCondition {
+        std::string column;
+        std::vector<std::string> values;
+        bool negated = false;
+    };
+
+    // Name of a composite index, e.g. "tenant_id,created_at+email"
+    static std::string composite_index_name(const std::vector<std::string>& key_columns, const std::vector<std::string>& include_columns);
+
     explicit IndexManager(std::shared_ptr<StorageEngine> storage_engine);
     ~IndexManager();
 
     std::optional<std::string> initialize();
     void shutdown();
+    // Writes every index back and forces its file to stable storage
+    std::optional<std::string> flush_indexes();
+    // True once dirty index pages hold the buffer pool above its size
+    bool needs_flush() const;
+    // Indexes the catalog brought back empty, memory-resident ones and
+    // vector indexes with a stale snapshot; the storage engine refills
+    // these from their tables through reload_index. Logged changes are not
+    // replayed into them meanwhile.
+    std::vector<std::pair<std::string, IndexDefinition>> take_indexes_to_rebuild();
+    bool awaits_rebuild(const std::string& table_name, const std::string& column_name);
+    // Bulk loads an index taken from take_indexes_to_rebuild, before
+    // anything else uses it
+    std::optional<std::string> reload_index(const std::string& table_name, const std::string& column_name,
+                                            std::vector<std::pair<std::string, uint64_t>> data);
+    // Forces the log before index pages are written
+    void set_write_ahead(std::function<std::optional<std::string>()> force_log);
+    // Tokenizer for full-text indexes created from now on; SimpleTokenizer by default
+    void set_tokenizer(std::shared_ptr<const Tokenizer> tokenizer);
+    // Graph parameters and metric for vector indexes created from now on.
+    // An index reopened from disk keeps the ones it was built with.
+    void set_vector_index_config(const HnswConfig& config);
 
-    std::optional<std::string> create_index(const std::string& table_name, const std::string& column_name);
+    std::optional<std::string> create_index(const std::string& table_name, const std::string& column_name, IndexType type = IndexType::BTREE);
     std::optional<std::string> drop_index(const std::string& table_name, const std::string& column_name);
     std::optional<std::string> drop_all_indexes(const std::string& table_name);
+    bool has_index(const std::string& table_name, const std::string& column_name) const;
+    bool has_indexes(const std::string& table_name) const;
+    std::optional<IndexType> get_index_type(const std::string& table_name, const std::string& column_name) const;
+    std::optional<IndexDefinition> get_index_definition(const std::string& table_name, const std::string& index_name) const;
+    std::vector<IndexDefinition> get_table_indexes(const std::string& table_name) const;
+    // Handles of a table's indexes, along with the catalog version they
+    // were read at. The version changes whenever an index is created or
+    // dropped, so handles can be cached until catalog_version() moves on.
+    std::vector<IndexHandle> get_table_index_handles(const std::string& table_name, uint64_t& catalog_version) const;
+    uint64_t catalog_version() const;
     std::optional<std::vector<uint64_t>> search_index(const std::string& table_name, const std::string& column_name, const std::string& value);
+    // Record ids under value as a compressed posting list; nullopt if the column has no index
+    std::optional<PostingList> search_postings(const std::string& table_name, const std::string& column_name, const std::string& value);
+    // search_postings for many values at once, in the order given. The index
+    // is looked up once and probed in key order, so B-trees share the
+    // descent between neighbouring values. nullopt if the column has no index.
+    std::optional<std::vector<PostingList>> search_index_batch(const std::string& table_name, const std::string& column_name, const std::vector<std::string>& values);
+    // Record ids matching every (column, value) equality, intersecting the
+    // shortest posting lists first, or the bitmaps if every column has a
+    // bitmap index. Returns nullopt if a column has no index, or only a
+    // full-text one.
+    std::optional<std::vector<uint64_t>> search_index_all(const std::string& table_name, const std::vector<std::pair<std::string, std::string>>& conditions);
+    // Record ids matching every condition, worked out on the columns' bitmap
+    // indexes alone: the values of a condition are OR-ed, the smallest
+    // results AND-ed first and negated conditions subtracted last. Negated
+    // conditions on their own select from the records indexed under their
+    // column. Returns nullopt if a column has no bitmap index.
+    std::optional<RoaringBitmap> search_bitmaps(const std::string& table_name, const std::vector<BitmapCondition>& conditions);
+    // Record ids, ascending, whose column matches a full-text query (see
+    // FullTextQuery). Returns nullopt if the column has no full-text index.
+    std::optional<std::vector<uint64_t>> search_full_text(const std::string& table_name, const std::string& column_name, const std::string& query);
+    // The k records whose vectors are nearest to query, with their
+    // distances, closest first; approximate, see HnswIndex::knn. Returns
+    // nullopt if the column has no vector index.
+    std::optional<std::vector<std::pair<uint64_t, float>>> search_nearest(const std::string& table_name, const std::string& column_name,
+                                                                          const std::vector<float>& query, size_t k, size_t ef = 0);
+    // Record ids, ascending, whose geometry intersects box, or comes within
+    // radius of center. Return nullopt if the column has no spatial index.
+    std::optional<std::vector<uint64_t>> search_box(const std::string& table_name, const std::string& column_name, const Rect& box);
+    std::optional<std::vector<uint64_t>> search_radius(const std::string& table_name, const std::string& column_name, const Point& center, double radius);
+    // The k records whose geometries are nearest to point, with their
+    // distances, closest first. Returns nullopt if the column has no
+    // spatial index.
+    std::optional<std::vector<std::pair<uint64_t, double>>> search_nearest_geometries(const std::string& table_name, const std::string& column_name,
+                                                                                      const Point& point, size_t k);
+
+    // Record ids whose value lies between lower and upper; a missing bound is
+    // unbounded. Returns nullopt if the column has no ordered index.
+    std::optional<std::vector<uint64_t>> range_search(const std::string& table_name, const std::string& column_name,
+                                                      const std::optional<std::string>& lower, const std::optional<std::string>& upper,
+                                                      bool lower_inclusive = true, bool upper_inclusive = true);
+    std::optional<std::vector<uint64_t>> prefix_search(const std::string& table_name, const std::string& column_name, const std::string& prefix);
+    // Rows of a composite index whose leading key columns equal
+    // leading_values and whose next key column, if bounded, lies between
+    // lower and upper. Answered from the index alone; returns nullopt if
+    // there is no such composite index or it has too few key columns.
+    std::optional<std::vector<IndexRow>> scan_covering_index(const std::string& table_name, const std::string& index_name,
+                                                             const std::vector<std::string>& leading_values,
+                                                             const std::optional<std::string>& lower = std::nullopt,
+                                                             const std::optional<std::string>& upper = std::nullopt,
+                                                             bool lower_inclusive = true, bool upper_inclusive = true);
     std::optional<std::string> insert_into_index(const std::string& table_name, const std::string& column_name, const std::string& value, uint64_t record_id);
     std::optional<std::string> remove_from_index(const std::string& table_name, const std::string& column_name, const std::string& value, uint64_t record_id);
+    std::optional<std::string> insert_into_index(IndexId index_id, const std::string& value, uint64_t record_id);
+    std::optional<std::string> remove_from_index(IndexId index_id, const std::string& value, uint64_t record_id);
 
     // New methods for distributed operations
     std::optional<std::string> sync_index(const std::string& table_name, const std::string& column_name, const std::string& remote_node);
     std::optional<std::string> merge_index(const std::string& table_name, const std::string& column_name, const BTree<std::string, std::vector<uint64_t>>& remote_index);
 
-    // New method for bulk loading
-    std::optional<std::string> bulk_load_index(const std::string& table_name, const std::string& column_name, const std::vector<std::pair<std::string, uint64_t>>& data);
+    // Creates an index and builds it bottom-up from (value, record_id) pairs
+    // in any order, filling nodes to fill_factor of their capacity
+    static constexpr double DEFAULT_FILL_FACTOR = 0.9;
+    std::optional<std::string> bulk_load_index(const std::string& table_name, const std::string& column_name, std::vector<std::pair<std::string, uint64_t>> data,
+                                               IndexType type = IndexType::BTREE, double fill_factor = DEFAULT_FILL_FACTOR);
+    // Creates a composite B-tree index from keys built by IndexDefinition::key_for
+    std::optional<std::string> bulk_load_composite_index(const std::string& table_name, const std::vector<std::string>& key_columns,
+                                                         const std::vector<std::string>& include_columns,
+                                                         std::vector<std::pair<std::string, uint64_t>> data, double fill_factor = DEFAULT_FILL_FACTOR);
 
     // New method for index statistics
     struct IndexStats {
@@ -45,14 +192,64 @@ public:
     std::optional<IndexStats> get_index_stats(const std::string& table_name, const std::string& column_name);
 
 private:
+    // Indexes are persistent when the storage engine has a data directory
+    static constexpr size_t INDEX_BUFFER_POOL_SIZE = 64 * 1024 * 1024;
+    static constexpr const char* CATALOG_FILE_NAME = "indexes.catalog";
+
+    struct IndexEntry {
+        std::string table_name;
+        std::string column_name;
+        IndexType type;
+        std::unique_ptr<Index> index;
+        // Empty for single-column indexes
+        std::vector<std::string> key_columns;
+        std::vector<std::string> include_columns;
+        IndexId id = 0;  // 0 until the entry is first published
+
+        IndexDefinition definition() const;
+    };
+
+    struct Catalog {
+        std::unordered_map<std::string, const IndexEntry*> by_key;
+        std::unordered_map<std::string, std::vector<const IndexEntry*>> by_table;
+        std::vector<const IndexEntry*> by_id;  // null for dropped ids
+        uint64_t version = 0;
+    };
+
     std::shared_ptr<StorageEngine> storage_engine_;
-    mutable std::mutex mutex_;
-    std::unordered_map<std::string, std::unique_ptr<BTree<std::string, std::vector<uint64_t>>>> indexes_;
+    // Catalog changes are serialized by catalog_mutex_ and published as an
+    // immutable map. Index operations only pin epoch_ to read the map and
+    // never block each other; each index handles its own concurrency.
+    std::mutex catalog_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<IndexEntry>> indexes_;
+    std::atomic<const Catalog*> catalog_;
+    IndexId next_index_id_ = 1;
+    uint64_t catalog_version_ = 0;
+    mutable EpochManager epoch_;
+    std::string data_directory_;
+    std::shared_ptr<BufferManager> buffer_manager_;
+    std::shared_ptr<const Tokenizer> tokenizer_;
+    HnswConfig vector_index_config_;
+    // (table name, definition) of each index loaded empty
+    std::vector<std::pair<std::string, IndexDefinition>> indexes_to_rebuild_;
 
     std::string get_index_key(const std::string& table_name, const std::string& column_name) const;
-    
-    // New method for distributed conflict resolution
-    void resolve_conflicts(std::vector<uint64_t>& local_records, const std::vector<uint64_t>& remote_records);
+    std::string get_index_file_name(const std::string& table_name, const std::string& column_name) const;
+    // Callers have sorted data
+    std::optional<std::string> bulk_load_entry(std::unique_ptr<IndexEntry> entry, const std::vector<std::pair<std::string, uint64_t>>& data, double fill_factor);
+    std::optional<std::string> open_index(const std::string& table_name, const std::string& column_name, IndexType type, std::unique_ptr<Index>& index);
+    void destroy_index(const IndexEntry& entry);
+    // Callers pin epoch_, which keeps the returned entry alive
+    const IndexEntry* find_index(const std::string& table_name, const std::string& column_name) const;
+    const IndexEntry* find_index(IndexId index_id) const;
+
+    // Callers hold catalog_mutex_
+    std::optional<std::string> load_catalog();
+    std::optional<std::string> save_catalog() const;
+    // Gives new entries their ids, then swaps in a catalog of indexes_
+    void publish_catalog();
+    // Returns once no thread can still be using an entry removed from the catalog
+    void wait_for_readers();
 };
 
 } // namespace nexusdb
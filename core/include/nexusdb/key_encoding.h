@@ -0,0 +1,61 @@
+#ifndef NEXUSDB_KEY_ENCODING_H
+#define NEXUSDB_KEY_ENCODING_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nexusdb {
+
+// Tuple keys for composite indexes. Each component has its zero bytes
+// escaped as 00 FF and ends with 00 01, so keys compare component by
+// component and the encoding of the leading components is a prefix of the
+// whole key.
+inline void append_key_component(std::string& key, const std::string& value) {
+    for (char byte : value) {
+        key.push_back(byte);
+        if (byte == '\0') {
+            key.push_back('\xff');
+        }
+    }
+    key.push_back('\0');
+    key.push_back('\x01');
+}
+
+inline std::string encode_composite_key(const std::vector<std::string>& values) {
+    std::string key;
+    for (const auto& value : values) {
+        append_key_component(key, value);
+    }
+    return key;
+}
+
+inline std::optional<std::vector<std::string>> decode_composite_key(const std::string& key) {
+    std::vector<std::string> values;
+    std::string value;
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (key[i] != '\0') {
+            value.push_back(key[i]);
+            continue;
+        }
+        if (++i == key.size()) {
+            return std::nullopt;
+        }
+        if (key[i] == '\xff') {
+            value.push_back('\0');
+        } else if (key[i] == '\x01') {
+            values.push_back(std::move(value));
+            value.clear();
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (!value.empty()) {
+        return std::nullopt;  // Last component is unterminated
+    }
+    return values;
+}
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_KEY_ENCODING_H
@@ -0,0 +1,57 @@
+#ifndef NEXUSDB_KEY_SEARCH_H
+#define NEXUSDB_KEY_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace nexusdb {
+
+// Maps a key to a 64-bit integer that preserves order: a < b implies
+// prefix(a) <= prefix(b). Nodes keep these prefixes in a contiguous array
+// so a search compares integers and only looks at the keys themselves
+// when prefixes tie.
+template<typename Key>
+struct KeyPrefix;
+
+template<>
+struct KeyPrefix<uint64_t> {
+    static uint64_t get(uint64_t key) { return key; }
+};
+
+// The first eight bytes, big-endian, zero-padded
+template<>
+struct KeyPrefix<std::string> {
+    static uint64_t get(const std::string& key) {
+        uint64_t prefix = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+            prefix <<= 8;
+            if (i < key.size()) {
+                prefix |= static_cast<unsigned char>(key[i]);
+            }
+        }
+        return prefix;
+    }
+};
+
+template<typename Second>
+struct KeyPrefix<std::pair<std::string, Second>> {
+    static uint64_t get(const std::pair<std::string, Second>& key) { return KeyPrefix<std::string>::get(key.first); }
+};
+
+// Number of values in the sorted array that are less than target. Short
+// arrays are compared whole with SSE4.2 or AVX2, chosen at runtime from
+// what the CPU supports; longer ones are first narrowed by binary search.
+size_t count_less(const uint64_t* values, size_t count, uint64_t target);
+
+inline size_t count_less_equal(const uint64_t* values, size_t count, uint64_t target) {
+    return target == UINT64_MAX ? count : count_less(values, count, target + 1);
+}
+
+// Name of the instruction set count_less uses on this machine
+const char* key_search_isa();
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_KEY_SEARCH_H
@@ -4,25 +4,37 @@
 #include <atomic>
 #include <memory>
 #include <optional>
+#include "nexusdb/epoch_manager.h"
 
 namespace nexusdb {
 
+// Michael-Scott queue. Dequeued nodes are retired through an EpochManager and
+// recycled into a per-queue free list once no thread can still reach them.
 template<typename T>
 class LockFreeQueue {
 private:
     struct Node {
-        std::shared_ptr<T> data;
+        std::optional<T> data;
         std::atomic<Node*> next;
-        Node() : next(nullptr) {}
+        std::atomic<Node*> free_next;
+        Node() : next(nullptr), free_next(nullptr) {}
     };
 
-    std::atomic<Node*> head_;
-    std::atomic<Node*> tail_;
+    alignas(64) std::atomic<Node*> head_;
+    alignas(64) std::atomic<Node*> tail_;
+    alignas(64) std::atomic<Node*> free_list_;
+    mutable EpochManager epoch_manager_;
+
+    Node* acquire_node();
+    static void recycle_node(void* node, void* queue);
 
 public:
     LockFreeQueue();
     ~LockFreeQueue();
 
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
     void enqueue(T value);
     std::optional<T> dequeue();
     bool is_empty() const;
@@ -30,4 +42,4 @@ public:
 
 } // namespace nexusdb
 
-#endif // NEXUSDB_LOCK_FREE_QUEUE_H
\ No newline at end of file
+#endif // NEXUSDB_LOCK_FREE_QUEUE_H
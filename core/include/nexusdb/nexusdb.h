@@ -41,6 +41,17 @@ public:
     std::optional<std::string> update_record(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record);
     std::optional<std::string> delete_record(const std::string& table_name, uint64_t record_id);
 
+    // Explicit transactions; the record operations above each run in their own
+    std::shared_ptr<Transaction> begin_transaction();
+    // Sees a consistent snapshot and never blocks writers; writes through it fail
+    std::shared_ptr<Transaction> begin_read_only();
+    std::optional<std::string> commit_transaction(const std::shared_ptr<Transaction>& txn);
+    std::optional<std::string> abort_transaction(const std::shared_ptr<Transaction>& txn);
+    std::optional<std::vector<std::string>> read_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id);
+    std::optional<std::string> insert_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::vector<std::string>& record);
+    std::optional<std::string> update_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record);
+    std::optional<std::string> delete_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id);
+
     std::optional<std::vector<std::string>> get_user_tables();
     
     std::optional<QueryResult> execute_query(const std::string& query);
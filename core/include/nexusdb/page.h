@@ -2,6 +2,7 @@
 #define NEXUSDB_PAGE_H
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 #include "nexusdb/data_compression.h"
 
@@ -10,6 +11,8 @@ namespace nexusdb {
 class Page {
 public:
     static const size_t PAGE_SIZE = 4096; // 4KB page size
+    // Set in the size word of a deleted record
+    static constexpr size_t TOMBSTONE_BIT = size_t{1} << 63;
 
     Page(uint64_t page_id);
     Page(uint64_t page_id, const char* data);
@@ -22,7 +25,16 @@ public:
     int add_record(const std::vector<char>& record);
     std::vector<char> get_record(size_t offset) const;
     bool update_record(size_t offset, const std::vector<char>& new_record);
+    // Leaves a tombstone unless the record is the last on the page, so the
+    // records after it keep their offsets; compacting the table reclaims
+    // the space. get_record returns nothing for a tombstone.
     bool delete_record(size_t offset);
+    // Size of the deleted record whose tombstone is at offset; 0 if there is none
+    size_t tombstone_size(size_t offset) const;
+    // Writes record at offset, where add_record once put it, replacing any
+    // record there; false if it would run into the next record or off the
+    // page. Lets recovery restore a record under its old id.
+    bool put_record(size_t offset, const std::vector<char>& record);
 
     void compress();
     void decompress();
@@ -48,7 +60,6 @@ private:
     bool is_encrypted_;
     uint32_t checksum_;
     
-    void compact();
     void ensure_decompressed() const;
     void update_checksum();
 };
@@ -0,0 +1,231 @@
+#ifndef NEXUSDB_PAGED_BTREE_H
+#define NEXUSDB_PAGED_BTREE_H
+
+#include "nexusdb/buffer_manager.h"
+#include "nexusdb/index.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// Disk-resident B+tree whose nodes are NexusDB pages in an index file,
+// accessed through a BufferManager. Every (key, record_id) pair is its own
+// leaf entry, so duplicate keys never grow a single value beyond a page.
+//
+// Page 0 holds the tree metadata; page id 0 therefore doubles as the null
+// sibling/child link.
+//
+// Keys are front-coded: each entry stores how many leading bytes it shares
+// with the previous key in the node and only the rest. Leaf splits promote
+// the shortest separator that tells the two halves apart rather than a
+// whole key, so internal nodes stay small and fan out wider. Removals
+// merge or even out underfull nodes, and the pages they free are chained
+// into a free list that later splits reuse.
+//
+// Readers take no locks (optimistic lock coupling). Writers run one at a
+// time and bump a version per node around every page they write, and a
+// structure version around every split, merge or root change. A reader
+// copies each node page, retries the copy if the node's version moved, and
+// restarts its descent if the structure version moved since it began.
+class PagedBTree : public Index {
+public:
+    static constexpr uint32_t MAGIC = 0x5442584E;  // "NXBT"
+    static constexpr uint32_t FORMAT_VERSION = 2;
+    static constexpr size_t MAX_KEY_SIZE = 1024;
+    static constexpr uint64_t META_PAGE_ID = 0;
+
+    PagedBTree(std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name);
+
+    // Loads the tree from its file, creating an empty one if the file is new
+    std::optional<std::string> open();
+    // Writes the metadata and every dirty page of the tree back to disk
+    std::optional<std::string> flush() override;
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    // Keeps the path to the last leaf and climbs only as far as the next
+    // key's subtree, so neighbouring keys share their descent
+    std::vector<PostingList> postings_batch(const std::vector<std::string>& keys) const override;
+    // The load is not logged, so the finished tree is flushed before returning
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override;
+    size_t node_count() const override;
+    bool is_persistent() const override { return true; }
+    IndexType type() const override { return IndexType::BTREE; }
+
+    const std::string& get_file_name() const { return file_name_; }
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t record_id;
+
+        bool operator<(const Entry& other) const {
+            return key < other.key || (key == other.key && record_id < other.record_id);
+        }
+        bool operator==(const Entry& other) const { return key == other.key && record_id == other.record_id; }
+    };
+
+    using PageBuffer = std::array<char, Page::PAGE_SIZE>;
+
+    // Walks the entries of a node page in order without decoding the page.
+    // Each key is rebuilt in one buffer from the part it shares with the one
+    // before, and the order against a target key is carried from entry to
+    // entry: only the bytes past what the previous key already settled are
+    // compared. Every length is checked against the page.
+    class NodeCursor {
+    public:
+        // target may be null when the caller only walks the entries
+        NodeCursor(const char* data, const std::string* target);
+
+        bool is_leaf() const { return is_leaf_; }
+        uint64_t next_leaf() const { return next_leaf_; }
+        uint64_t prev_leaf() const { return prev_leaf_; }
+        uint16_t entry_count() const { return count_; }
+        // Internal nodes: the child left of the first entry
+        uint64_t first_child() const { return first_child_; }
+
+        // Moves to the next entry; false past the last one or on a malformed page
+        bool advance();
+        bool is_malformed() const { return malformed_; }
+
+        const std::string& key() const { return key_; }
+        uint64_t record_id() const { return record_id_; }
+        // Internal nodes: the child right of the current entry
+        uint64_t child() const { return child_; }
+        // Order of the current key against the target: <0, 0 or >0
+        int compare() const { return order_; }
+        // Order of the current entry against (target, record_id)
+        int compare(uint64_t record_id) const;
+
+    private:
+        const char* cursor_;
+        const char* end_;
+        const std::string* target_;
+        bool is_leaf_;
+        bool front_coded_;
+        uint16_t count_;
+        uint16_t remaining_;
+        uint64_t next_leaf_;
+        uint64_t prev_leaf_;
+        uint64_t first_child_;
+        std::string key_;
+        uint64_t record_id_;
+        uint64_t child_;
+        size_t matched_;  // Leading bytes the current key shares with the target
+        int order_;
+        bool malformed_;
+    };
+
+    // Decoded copy of a node page, which writers change and store back. Internal nodes hold entries.size() + 1
+    // children; an entry separates the child to its left from the one to
+    // its right.
+    struct Node {
+        uint64_t page_id = 0;
+        bool is_leaf = true;
+        std::vector<Entry> entries;
+        std::vector<uint64_t> children;
+        uint64_t next = 0;
+        uint64_t prev = 0;
+    };
+
+    struct SplitResult {
+        Entry separator;
+        uint64_t right_page_id;
+    };
+
+    static constexpr size_t NODE_HEADER_SIZE = 24;
+    // Node flag set on front-coded nodes; version 1 files store whole keys
+    static constexpr uint8_t NODE_FRONT_CODED = 1;
+    // Shared length, suffix length and record id of a leaf entry
+    static constexpr size_t ENTRY_OVERHEAD = 2 * sizeof(uint16_t) + sizeof(uint64_t);
+    // Non-root nodes smaller than this are rebalanced; siblings are merged
+    // only if the result leaves room for inserts
+    static constexpr size_t MIN_NODE_SIZE = Page::PAGE_SIZE / 4;
+    static constexpr size_t MAX_MERGED_SIZE = Page::PAGE_SIZE * 3 / 4;
+
+    // Node versions are striped by page id, like the table page seqlocks
+    static constexpr size_t NODE_VERSION_STRIPES = 64;
+
+    std::shared_ptr<BufferManager> buffer_manager_;
+    std::string file_name_;
+    std::atomic<uint64_t> root_page_id_;
+    std::atomic<uint64_t> entry_count_;
+    std::atomic<uint64_t> height_;
+    std::atomic<uint64_t> node_count_;
+    uint64_t free_list_head_;  // 0 if no page is free
+    // Serializes writers; readers never take it
+    std::mutex write_mutex_;
+    mutable std::array<std::atomic<uint64_t>, NODE_VERSION_STRIPES> node_versions_;
+    std::atomic<uint64_t> structure_version_;
+    bool restructuring_;  // Whether the running writer holds structure_version_ odd
+
+    // Closes the restructure a writer opened, if any, when the write ends
+    struct WriteScope {
+        explicit WriteScope(PagedBTree& tree);
+        ~WriteScope();
+        PagedBTree& tree;
+        std::lock_guard<std::mutex> lock;
+    };
+
+    // Writers only: decodes the page in place
+    Node load_node(uint64_t page_id) const;
+    // Readers: waits out a running restructure and returns the structure
+    // version to validate against
+    uint64_t begin_read() const;
+    // Readers: copies the node page; false if the structure changed since
+    // begin_read returned structure, in which case the copy is garbage
+    bool read_page(uint64_t page_id, uint64_t structure, PageBuffer& copy) const;
+    // The child of an internal node whose subtree holds target. Sets *bound
+    // to the separator above that child, if there is one and bound is given.
+    static uint64_t child_for(NodeCursor& cursor, const Entry& target, std::optional<Entry>* bound);
+    std::atomic<uint64_t>& node_version_for(uint64_t page_id) const;
+    // Marks the tree as restructuring until the current write ends
+    void begin_restructure();
+    void end_restructure();
+    void store_node(const Node& node);
+    uint64_t allocate_node_page();
+    void free_node_page(uint64_t page_id);
+    void store_meta();
+    static size_t encoded_size(const Node& node);
+    static size_t entry_size(const Node& node, size_t index);
+    static size_t shared_prefix(const std::string& a, const std::string& b);
+    // Shortest entry e with left < e <= right
+    static Entry separator_between(const Entry& left, const Entry& right);
+
+    // Splits items into consecutive node-sized groups of at most budget
+    // encoded bytes, each holding at least min_items. An item costs
+    // lead_sizes instead of item_sizes when it starts a group.
+    static std::vector<size_t> pack_groups(const std::vector<size_t>& item_sizes, const std::vector<size_t>& lead_sizes,
+                                           size_t base_size, size_t budget, size_t min_items);
+
+    std::optional<SplitResult> insert_into(uint64_t page_id, const Entry& entry, bool& inserted);
+    SplitResult split(Node& node);
+    // Entry index that halves the node by encoded size
+    static size_t split_point(const Node& node);
+    // Returns true if the node at page_id was left underfull
+    bool remove_from(uint64_t page_id, const Entry& entry, bool& removed);
+    // Merges parent's underfull child at index with a sibling, or evens the
+    // two out if they would not fit one page. Stores every node it changes.
+    void rebalance(Node& parent, size_t index);
+    // Readers: copy the leaf; false if the descent has to restart
+    bool find_leaf(const Entry& target, uint64_t structure, PageBuffer& leaf) const;
+    bool leftmost_leaf(uint64_t structure, PageBuffer& leaf) const;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_PAGED_BTREE_H
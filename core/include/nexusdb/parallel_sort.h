@@ -0,0 +1,71 @@
+#ifndef NEXUSDB_PARALLEL_SORT_H
+#define NEXUSDB_PARALLEL_SORT_H
+
+#include "nexusdb/task_scheduler.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nexusdb {
+
+// Inputs smaller than this are sorted on the calling thread
+constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 16;
+
+// Sorts [first, last) on the shared TaskScheduler: one chunk per worker is
+// sorted in parallel, then neighbouring runs are merged pairwise, each
+// round in parallel. Falls back to std::sort for small inputs or when the
+// scheduler is not running. Returns the first error raised by a task.
+template<typename RandomIt, typename Compare = std::less<>>
+std::optional<std::string> parallel_sort(RandomIt first, RandomIt last, Compare compare = Compare(),
+                                         TaskPriority priority = TaskPriority::BACKGROUND) {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    TaskScheduler& scheduler = TaskScheduler::get_instance();
+    size_t workers = scheduler.is_running() ? scheduler.get_worker_count() : 1;
+    if (count < PARALLEL_SORT_THRESHOLD || workers < 2) {
+        std::sort(first, last, compare);
+        return std::nullopt;
+    }
+
+    size_t chunks = 1;
+    while (chunks < workers) {
+        chunks *= 2;
+    }
+    std::vector<RandomIt> bounds;
+    bounds.reserve(chunks + 1);
+    for (size_t i = 0; i <= chunks; ++i) {
+        bounds.push_back(first + static_cast<std::ptrdiff_t>(count * i / chunks));
+    }
+
+    {
+        TaskGroup group(scheduler, priority);
+        for (size_t i = 0; i < chunks; ++i) {
+            group.run([&bounds, &compare, i]() { std::sort(bounds[i], bounds[i + 1], compare); });
+        }
+        auto error = group.wait();
+        if (error.has_value()) {
+            return error;
+        }
+    }
+
+    for (size_t width = 1; width < chunks; width *= 2) {
+        TaskGroup group(scheduler, priority);
+        for (size_t i = 0; i + width < chunks; i += 2 * width) {
+            group.run([&bounds, &compare, i, width, chunks]() {
+                std::inplace_merge(bounds[i], bounds[i + width], bounds[std::min(i + 2 * width, chunks)], compare);
+            });
+        }
+        auto error = group.wait();
+        if (error.has_value()) {
+            return error;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_PARALLEL_SORT_H
@@ -0,0 +1,91 @@
+#ifndef NEXUSDB_POSTING_LIST_H
+#define NEXUSDB_POSTING_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nexusdb {
+
+// Sorted set of record ids stored as compressed blocks. Each block keeps its
+// first and last id uncompressed and the gaps between consecutive ids as
+// varints, so dense lists of a low-cardinality key take a byte or two per
+// id. Appending an id larger than every other one touches only the tail
+// block; other changes re-encode a single block.
+//
+// The block bounds let intersections skip whole blocks that cannot
+// contribute to the result.
+class PostingList {
+public:
+    static constexpr size_t BLOCK_CAPACITY = 128;
+
+    using Visitor = std::function<void(uint64_t record_id)>;
+
+    PostingList() = default;
+    // ids need not be sorted or unique
+    explicit PostingList(std::vector<uint64_t> record_ids);
+
+    // Return false if the id was already present / missing
+    bool add(uint64_t record_id);
+    bool remove(uint64_t record_id);
+    bool contains(uint64_t record_id) const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // Bytes used by the encoded ids, for statistics
+    size_t encoded_size() const;
+
+    // Visits ids in ascending order
+    void for_each(const Visitor& visitor) const;
+    std::vector<uint64_t> to_vector() const;
+
+    static PostingList intersect(const PostingList& left, const PostingList& right);
+    static PostingList unite(const PostingList& left, const PostingList& right);
+
+private:
+    struct Block {
+        uint64_t first = 0;
+        uint64_t last = 0;
+        size_t count = 0;
+        std::vector<uint8_t> gaps;  // count - 1 varints
+    };
+
+    // Forward iterator that can skip ahead by whole blocks
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList& list);
+
+        bool valid() const { return block_ < list_.blocks_.size(); }
+        uint64_t value() const { return value_; }
+        void next();
+        // Moves to the first id not less than target
+        void seek(uint64_t target);
+
+    private:
+        const PostingList& list_;
+        size_t block_;
+        size_t position_;
+        size_t offset_;
+        uint64_t value_;
+
+        void enter_block();
+    };
+
+    std::vector<Block> blocks_;
+    size_t size_ = 0;
+
+    // Only valid for ids larger than every id in the list
+    void append(uint64_t record_id);
+    // Index of the last block whose first id is not greater than record_id, or 0
+    size_t find_block(uint64_t record_id) const;
+
+    static std::vector<uint64_t> decode(const Block& block);
+    static Block encode(const uint64_t* record_ids, size_t count);
+    static void put_varint(std::vector<uint8_t>& out, uint64_t value);
+    static uint64_t get_varint(const std::vector<uint8_t>& in, size_t& offset);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_POSTING_LIST_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
 #include "index_manager.h"
 
 namespace nexusdb {
@@ -13,17 +14,51 @@ public:
     virtual ~QueryNode() = default;
 };
 
+enum class PredicateOp {
+    EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    MATCH,  // value is a full-text query; see FullTextQuery
+    INTERSECTS,  // value is a geometry whose bounding box the column's must meet; see geometry.h
+    DWITHIN  // value is "POINT(x y) radius", which the column's geometry must come within
+};
+
+// column <op> value
+struct ColumnPredicate {
+    std::string column;
+    PredicateOp op;
+    std::string value;
+};
+
 class ScanNode : public QueryNode {
 public:
     std::string table_name;
     std::vector<std::string> columns;
+    std::vector<ColumnPredicate> predicates;  // All must hold
 };
 
 class IndexScanNode : public QueryNode {
 public:
     std::string table_name;
     std::string index_name;
+    // The index's name within its table, as IndexManager looks it up
+    std::string lookup_name;
     std::string condition;
+    IndexType index_type = IndexType::BTREE;
+    // Composite indexes are searched by leading key values through
+    // IndexManager::scan_covering_index even when they do not cover the scan
+    bool composite = false;
+    // The predicates the index answers, in key column order: equalities on
+    // leading key columns, then bounds on the next one. The others are
+    // checked per row.
+    std::vector<ColumnPredicate> index_predicates;
+    // Set when the index holds every column the scan needs, so rows come
+    // from IndexManager::scan_covering_index without reading the table
+    bool index_only = false;
+    // Columns of the values in each covering-scan row
+    std::vector<std::string> index_columns;
 };
 
 class JoinNode : public QueryNode {
@@ -43,6 +78,8 @@ public:
     QueryOptimizer(std::shared_ptr<IndexManager> index_manager);
 
     QueryPlan optimize(const std::string& query);
+    // Plans a single-table scan the caller has already parsed
+    QueryPlan optimize_scan(const ScanNode& scan_node);
 
 private:
     std::shared_ptr<IndexManager> index_manager_;
@@ -50,6 +87,12 @@ private:
     QueryPlan generate_initial_plan(const std::string& query);
     void optimize_joins(QueryPlan& plan);
     void apply_index_selection(QueryPlan& plan);
+    // Picks the index that answers the most predicates: the most leading
+    // key columns matched by equalities, then a range on the next key
+    // column, then an index that covers the scan, then a hash index, then
+    // an adaptive radix tree or bitmap index. Full-text indexes are only
+    // chosen for MATCH, which nothing else answers.
+    std::unique_ptr<IndexScanNode> choose_index(const ScanNode& scan_node);
 };
 
 } // namespace nexusdb
@@ -34,12 +34,21 @@ public:
 
 private:
     std::shared_ptr<StorageEngine> storage_engine_;
+    // Created by initialize, once the storage engine has its index manager
+    std::unique_ptr<QueryOptimizer> optimizer_;
     mutable std::mutex mutex_;
 
     std::optional<QueryResult> execute_select(const std::string& query);
     std::optional<QueryResult> execute_insert(const std::string& query);
     std::optional<QueryResult> execute_update(const std::string& query);
     std::optional<QueryResult> execute_delete(const std::string& query);
+    // SELECT columns FROM table WHERE column <op> value AND ..., answered
+    // by the access path the optimizer picks for it
+    std::optional<QueryResult> execute_planned_select(const std::string& table_name, const std::string& column_list, const std::string& where_clause);
+    // Rows found through the chosen index, holding the scan's columns in
+    // order; nullopt if the index could not be searched
+    std::optional<std::vector<std::vector<std::string>>> execute_index_scan(const IndexScanNode& index_scan, const ScanNode& scan_node,
+                                                                            const std::vector<std::string>& schema);
 
     std::optional<std::string> parse_query(const std::string& query);
 
@@ -7,6 +7,7 @@
 #include <memory>
 #include <vector>
 #include <fstream>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace nexusdb {
@@ -14,7 +15,9 @@ namespace nexusdb {
 class StorageEngine;
 
 enum class LogRecordType {
-    BEGIN, COMMIT, ABORT, UPDATE, INSERT, DELETE
+    BEGIN, COMMIT, ABORT, UPDATE, INSERT, DELETE,
+    // Index entry changes: before_image holds the column name, after_image the key
+    INDEX_INSERT, INDEX_DELETE
 };
 
 struct LogRecord {
@@ -38,16 +41,40 @@ public:
     std::optional<std::string> commit_transaction(uint64_t transaction_id);
     std::optional<std::string> abort_transaction(uint64_t transaction_id);
     std::optional<std::string> log_operation(const LogRecord& record);
+    // Forces every record appended so far to stable storage. A data page
+    // may only be written once the records describing its change are forced.
+    std::optional<std::string> force_log();
+    // Repeats the logged history, rolling each aborted transaction back
+    // where it aborted, then undoes the transactions that neither committed
+    // nor aborted. Stops at the first change that cannot be replayed.
     std::optional<std::string> recover();
+    // Empties the log, once recovery has run and the pages it restored are
+    // on stable storage, so the next start does not replay it again
+    std::optional<std::string> truncate_log();
+
+    // Largest transaction id in the log read by initialize; new transactions
+    // must be numbered above it, or recovery could mistake them for old ones
+    uint64_t get_max_logged_transaction_id() const;
+
+    // Data records logged so far by a still active transaction, oldest first
+    std::vector<LogRecord> get_transaction_records(uint64_t transaction_id) const;
 
 private:
     std::shared_ptr<StorageEngine> storage_engine_;
     mutable std::mutex mutex_;
+    std::string log_file_path_;
     std::ofstream log_file_;
+    int log_sync_fd_ = -1;  // Separate descriptor for fsync, which the stream hides
+    bool log_dirty_ = false;  // Records appended since the last force
+    uint64_t max_logged_transaction_id_ = 0;
     std::vector<LogRecord> in_memory_log_;
+    std::unordered_map<uint64_t, std::vector<size_t>> active_transactions_;  // Indexes into in_memory_log_
 
+    void append_log_record(const LogRecord& record);
     void write_log_to_disk(const LogRecord& record);
-    void apply_log_record(const LogRecord& record);
+    bool force_log_locked();
+    void read_log_from_disk(const std::string& log_file_path);
+    std::optional<std::string> apply_log_record(const LogRecord& record, bool undo);
     std::optional<std::string> redo();
     std::optional<std::string> undo();
 };
@@ -0,0 +1,124 @@
+#ifndef NEXUSDB_ROARING_BITMAP_H
+#define NEXUSDB_ROARING_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace nexusdb {
+
+// Set of 16-bit values in the cheapest of three layouts: a sorted array
+// while it holds at most ARRAY_MAX_SIZE values, a 65536-bit bitmap above
+// that, or a list of runs once run_optimize finds runs smaller. Set
+// operations between two bitmaps go through SIMD word loops.
+class RoaringContainer {
+public:
+    enum class Kind : uint8_t {
+        ARRAY,
+        BITMAP,
+        RUN
+    };
+
+    static constexpr size_t ARRAY_MAX_SIZE = 4096;
+    static constexpr size_t BITMAP_WORDS = 65536 / 64;
+
+    Kind kind() const { return kind_; }
+    uint32_t cardinality() const { return cardinality_; }
+    bool empty() const { return cardinality_ == 0; }
+
+    // Return false if the value was already present / missing
+    bool add(uint16_t value);
+    bool remove(uint16_t value);
+    bool contains(uint16_t value) const;
+
+    // Visits values in ascending order
+    void for_each(const std::function<void(uint16_t value)>& visitor) const;
+    // Appends base + value for every value, in ascending order
+    void append_to(std::vector<uint64_t>& out, uint64_t base) const;
+    // Switches to runs if they take less space, or back if they no longer do
+    void run_optimize();
+    size_t memory_usage() const;
+
+    static RoaringContainer intersect(const RoaringContainer& left, const RoaringContainer& right);
+    static RoaringContainer unite(const RoaringContainer& left, const RoaringContainer& right);
+    // Values of left that are not in right
+    static RoaringContainer subtract(const RoaringContainer& left, const RoaringContainer& right);
+    static uint32_t intersect_cardinality(const RoaringContainer& left, const RoaringContainer& right);
+
+private:
+    // length is the run's value count minus one, so a run can cover all 65536 values
+    struct Run {
+        uint16_t start;
+        uint16_t length;
+    };
+
+    Kind kind_ = Kind::ARRAY;
+    uint32_t cardinality_ = 0;
+    std::vector<uint16_t> values_;  // ARRAY, sorted
+    std::vector<uint64_t> words_;   // BITMAP
+    std::vector<Run> runs_;         // RUN, sorted and never adjacent
+
+    // The values as BITMAP_WORDS words, whatever the layout
+    std::vector<uint64_t> to_words() const;
+    // words_ for a bitmap, otherwise to_words() stored in scratch
+    const uint64_t* word_data(std::vector<uint64_t>& scratch) const;
+    // A container of the cardinality values set in words, as an array if it is small enough
+    static RoaringContainer from_words(std::vector<uint64_t> words, uint32_t cardinality);
+    static RoaringContainer from_values(std::vector<uint16_t> values);
+    // Index of the last run starting at or before value, or runs_.size()
+    size_t find_run(uint16_t value) const;
+    size_t count_runs() const;
+    void convert_to(Kind kind);
+};
+
+// Compressed set of 64-bit record ids in the Roaring layout: the high 48
+// bits of an id pick a container, which holds the low 16 bits. Dense
+// ranges of ids become bitmaps or runs and sparse ones stay arrays, so a
+// set takes at most about two bytes per id, and AND/OR/ANDNOT work one
+// container pair at a time, skipping keys only one side has.
+class RoaringBitmap {
+public:
+    using Visitor = std::function<void(uint64_t record_id)>;
+
+    RoaringBitmap() = default;
+    // ids need not be sorted or unique
+    explicit RoaringBitmap(const std::vector<uint64_t>& record_ids);
+
+    // Return false if the id was already present / missing
+    bool add(uint64_t record_id);
+    bool remove(uint64_t record_id);
+    bool contains(uint64_t record_id) const;
+
+    uint64_t cardinality() const;
+    bool empty() const { return containers_.empty(); }
+    size_t container_count() const { return containers_.size(); }
+    size_t memory_usage() const;
+
+    // Visits ids in ascending order
+    void for_each(const Visitor& visitor) const;
+    std::vector<uint64_t> to_vector() const;
+    // Re-encodes containers as runs wherever that is smaller
+    void run_optimize();
+
+    static RoaringBitmap intersect(const RoaringBitmap& left, const RoaringBitmap& right);
+    static RoaringBitmap unite(const RoaringBitmap& left, const RoaringBitmap& right);
+    // Ids of left that are not in right
+    static RoaringBitmap subtract(const RoaringBitmap& left, const RoaringBitmap& right);
+    static uint64_t intersect_cardinality(const RoaringBitmap& left, const RoaringBitmap& right);
+
+    // Instruction set the bitmap word loops were compiled for, picked at startup
+    static const char* simd_isa();
+
+private:
+    // Sorted high parts, each with the container of its low parts; no container is empty
+    std::vector<uint64_t> keys_;
+    std::vector<RoaringContainer> containers_;
+
+    // Index of the first key not less than key
+    size_t find_key(uint64_t key) const;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_ROARING_BITMAP_H
@@ -0,0 +1,117 @@
+#ifndef NEXUSDB_RTREE_INDEX_H
+#define NEXUSDB_RTREE_INDEX_H
+
+#include "nexusdb/geometry.h"
+#include "nexusdb/index.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// R*-tree over a geometry column (see geometry.h), answering bounding-box,
+// radius and k-nearest-neighbour queries. Each node bounds its entries with
+// a rectangle; leaves hold the records' geometries.
+//
+// Inserts descend to the child whose rectangle grows least, or above the
+// leaves, overlaps its siblings least. The first node to overflow on a
+// level during an insert sheds the REINSERT_ENTRIES entries farthest from
+// its center and inserts them again, which tightens the tree; later
+// overflows split along the axis with the smallest total margin, at the
+// point where the halves overlap least. Removals reinsert the entries of
+// nodes that fall below MIN_ENTRIES. bulk_load packs the tree bottom-up
+// with Sort-Tile-Recursive. Readers share a lock and run in parallel;
+// writers take it exclusively. Heap-resident; contents are lost on restart.
+//
+// Keys seen by search and scan are the column's text values, compared as
+// strings.
+class RTreeIndex : public Index {
+public:
+    static constexpr size_t MAX_ENTRIES = 32;
+    static constexpr size_t MIN_ENTRIES = MAX_ENTRIES * 2 / 5;
+    static constexpr size_t REINSERT_ENTRIES = MAX_ENTRIES * 3 / 10;
+
+    RTreeIndex();
+
+    std::optional<std::string> insert(const std::string& key, uint64_t record_id) override;
+    std::optional<std::string> remove(const std::string& key, uint64_t record_id) override;
+    std::vector<uint64_t> search(const std::string& key) const override;
+    PostingList postings(const std::string& key) const override;
+    std::optional<std::string> bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) override;
+    // Visits every entry with a key between the bounds, in no particular order
+    void scan(const std::optional<std::string>& lower, bool lower_inclusive,
+              const std::optional<std::string>& upper, bool upper_inclusive,
+              const ScanVisitor& visitor) const override;
+
+    size_t size() const override;
+    size_t height() const override;
+    size_t node_count() const override;
+    bool is_persistent() const override { return false; }
+    IndexType type() const override { return IndexType::RTREE; }
+
+    // Records, ascending, whose geometry intersects box
+    std::vector<uint64_t> search_box(const Rect& box) const;
+    // Records, ascending, whose geometry comes within radius of center
+    std::vector<uint64_t> search_radius(const Point& center, double radius) const;
+    // The k records whose geometries are nearest to point, with their
+    // distances, closest first
+    std::vector<std::pair<uint64_t, double>> nearest(const Point& point, size_t k) const;
+
+private:
+    struct Node;
+
+    // A child subtree in internal nodes, a record in leaves
+    struct Entry {
+        Rect rect;
+        std::unique_ptr<Node> child;
+        std::string key;
+        uint64_t record_id = 0;
+    };
+
+    struct Node {
+        size_t level = 0;  // 0 for leaves
+        std::vector<Entry> entries;
+
+        Rect bounds() const;
+    };
+
+    // An entry waiting to be placed in a node on level
+    struct PendingEntry {
+        Entry entry;
+        size_t level;
+    };
+
+    std::unique_ptr<Node> root_;
+    size_t entry_count_ = 0;
+    size_t node_count_ = 1;
+    mutable std::shared_mutex mutex_;
+
+    // Callers hold mutex_ exclusively
+    void insert_entry(Entry entry, size_t level);
+    // Places entry in the subtree of node on level. Returns the new sibling
+    // if node split; entries shed for reinsertion are added to pending.
+    std::unique_ptr<Node> insert_into(Node& node, Entry& entry, size_t level, std::vector<bool>& overflowed, std::vector<PendingEntry>& pending);
+    static size_t choose_subtree(const Node& node, const Rect& rect);
+    std::unique_ptr<Node> split(Node& node);
+    void shed_for_reinsert(Node& node, std::vector<PendingEntry>& pending);
+    // Removes the entry from node's subtree, collecting the entries of
+    // nodes left underfull in orphans. Returns false if it is not there.
+    bool remove_from(Node& node, const Rect& rect, const std::string& key, uint64_t record_id, std::vector<PendingEntry>& orphans);
+    // Packs the entries of one level into nodes with Sort-Tile-Recursive
+    std::vector<std::unique_ptr<Node>> pack(std::vector<Entry> entries, size_t level, size_t capacity);
+
+    // Callers hold mutex_
+    bool contains_entry(const Node& node, const Rect& rect, const std::string& key, uint64_t record_id) const;
+    // Calls visitor on every leaf entry whose rectangle, and every
+    // ancestor's, passes filter; a visitor returning false stops the walk
+    template<typename Filter, typename Visitor>
+    void visit_entries(const Filter& filter, const Visitor& visitor) const;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_RTREE_INDEX_H
@@ -21,6 +21,9 @@ public:
     SecureConnectionManager(const std::string& cert_file, const std::string& key_file);
     ~SecureConnectionManager();
 
+    // Accepts connections forever, running connection_handler for each on
+    // a thread of its own. Handlers may block on the socket, and should
+    // hand request processing to the TaskScheduler.
     void start_server(int port, std::function<void(std::unique_ptr<SecureSocket>)> connection_handler);
     std::unique_ptr<SecureSocket> connect_to_server(const std::string& host, int port);
 
@@ -4,11 +4,20 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
 #include <memory>
 #include <optional>
 #include <mutex>
+#include <array>
+#include <atomic>
+#include <functional>
+#include "nexusdb/bloom_filter.h"
 #include "nexusdb/index_manager.h"
 #include "nexusdb/recovery_manager.h"
+#include "nexusdb/transaction_manager.h"
+#include "nexusdb/version_store.h"
+#include "nexusdb/zone_map.h"
 #include "nexusdb/file_manager.h"
 #include "nexusdb/page.h"
 #include "nexusdb/encryptor.h"
@@ -22,6 +31,15 @@ struct StorageConfig {
     bool use_encryption = false;
 };
 
+// How create_index reads the table. An OFFLINE build holds the engine lock
+// throughout. An ONLINE build scans without it, captures the index changes
+// of concurrent writes in a side log, and holds the lock only to load the
+// index and merge the log into it.
+enum class IndexBuildMode {
+    OFFLINE,
+    ONLINE
+};
+
 enum class ConsistencyLevel {
     ONE,
     QUORUM,
@@ -33,10 +51,13 @@ public:
     explicit StorageEngine(const StorageConfig& config = StorageConfig());
     virtual ~StorageEngine();
 
+    // Reopens the tables listed in the table catalog. recover() must run
+    // before the first transaction, to replay what the log holds.
     virtual std::optional<std::string> initialize(const std::string& data_directory);
     virtual void shutdown();
 
-    // Table and record operations
+    // Table and record operations. Record changes without a transaction
+    // handle run in their own single-statement transaction.
     virtual std::optional<std::string> create_table(const std::string& table_name, const std::vector<std::string>& schema);
     virtual std::optional<std::string> delete_table(const std::string& table_name);
     virtual std::optional<std::string> insert_record(const std::string& table_name, const std::vector<std::string>& record);
@@ -44,20 +65,111 @@ public:
     virtual std::optional<std::string> update_record(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record);
     virtual std::optional<std::string> delete_record(const std::string& table_name, uint64_t record_id);
 
+    // Record operations inside an explicit transaction. Reads in a read-only
+    // transaction see its snapshot and take no locks; writes in one fail.
+    virtual std::optional<std::string> read_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, std::vector<std::string>& record) const;
+    virtual std::optional<std::string> insert_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::vector<std::string>& record);
+    virtual std::optional<std::string> update_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record);
+    virtual std::optional<std::string> delete_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id);
+
     // Schema and index operations
     virtual std::optional<std::vector<std::string>> get_table_schema(const std::string& table_name) const;
-    virtual std::optional<std::string> create_index(const std::string& table_name, const std::string& column_name);
+    // Index builds read the table's pages on every scheduler worker, then
+    // sort the entries in parallel and load the index bottom-up
+    virtual std::optional<std::string> create_index(const std::string& table_name, const std::string& column_name, IndexType type = IndexType::BTREE,
+                                                    IndexBuildMode mode = IndexBuildMode::OFFLINE);
+    // A B-tree over key_columns in order whose entries also carry the
+    // include_columns; dropped by its composite index name
+    virtual std::optional<std::string> create_composite_index(const std::string& table_name, const std::vector<std::string>& key_columns,
+                                                              const std::vector<std::string>& include_columns = {},
+                                                              IndexBuildMode mode = IndexBuildMode::OFFLINE);
     virtual std::optional<std::string> drop_index(const std::string& table_name, const std::string& column_name);
+    // Rewrites the table without the space of deleted records. Records get
+    // new ids, so the table's indexes, zone map and Bloom filters are
+    // rebuilt; fails while an unfinished transaction has changed the table.
+    virtual std::optional<std::string> compact_table(const std::string& table_name);
     virtual std::optional<std::vector<uint64_t>> search_index(const std::string& table_name, const std::string& column_name, const std::string& value) const;
+    // Record ids under each of values, in order; see IndexManager::search_index_batch
+    virtual std::optional<std::vector<PostingList>> search_index_batch(const std::string& table_name, const std::string& column_name,
+                                                                       const std::vector<std::string>& values) const;
+    // Index-only scan of a composite index; see IndexManager::scan_covering_index
+    virtual std::optional<std::vector<IndexManager::IndexRow>> scan_covering_index(const std::string& table_name, const std::string& index_name,
+                                                                                   const std::vector<std::string>& leading_values,
+                                                                                   const std::optional<std::string>& lower = std::nullopt,
+                                                                                   const std::optional<std::string>& upper = std::nullopt,
+                                                                                   bool lower_inclusive = true, bool upper_inclusive = true) const;
+
+    // Bloom filters over a column let lookups skip the table, or groups of
+    // its pages, that cannot hold a value. They are kept up to date on
+    // insert and update, rebuilt by compaction and saved next to the table.
+    virtual std::optional<std::string> create_bloom_filter(const std::string& table_name, const std::string& column_name);
+    virtual std::optional<std::string> drop_bloom_filter(const std::string& table_name, const std::string& column_name);
+    // False only if no record has value in the column; true without a filter
+    virtual bool might_contain(const std::string& table_name, const std::string& column_name, const std::string& value) const;
+    // Records whose column equals value, reading only the page groups whose filter admits it
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> find_records(const std::string& table_name, const std::string& column_name,
+                                                                                                   const std::string& value) const;
+
+    // Records matching every condition, combined on bitmap indexes before
+    // the table is read; each page holding a match is read once. Returns
+    // nullopt if a condition's column has no bitmap index.
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> select_records(const std::string& table_name,
+                                                                                                     const std::vector<IndexManager::BitmapCondition>& conditions) const;
+
+    // Records whose column matches a full-text query, found through the
+    // column's full-text index, or by scanning the table if it has none
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> match_records(const std::string& table_name, const std::string& column_name,
+                                                                                                    const std::string& query) const;
+    // The k records whose vectors in column are nearest to query, closest
+    // first, found through the column's vector index. Returns nullopt if
+    // the column has no vector index.
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> nearest_records(const std::string& table_name, const std::string& column_name,
+                                                                                                      const std::vector<float>& query, size_t k) const;
+    // Records satisfying an INTERSECTS or DWITHIN predicate, found through
+    // the column's spatial index, or by scanning the table if it has none
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> spatial_records(const std::string& table_name,
+                                                                                                      const ColumnPredicate& predicate) const;
+    // The k records whose geometries in column are nearest to point, closest
+    // first, found through the column's spatial index. Returns nullopt if
+    // the column has no spatial index.
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> nearest_geometries(const std::string& table_name, const std::string& column_name,
+                                                                                                         const Point& point, size_t k) const;
+
+    // Records satisfying every predicate. Pages whose zone map rules out a
+    // predicate are never read. Returns nullopt for an unknown table or column.
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> scan_table(const std::string& table_name,
+                                                                                                 const std::vector<ColumnPredicate>& predicates) const;
 
-    // Transaction operations
-    virtual std::optional<std::string> begin_transaction();
-    virtual std::optional<std::string> commit_transaction();
-    virtual std::optional<std::string> abort_transaction();
+    // The same reads inside an explicit transaction. A read-only transaction
+    // reads its snapshot without taking mutex_, from its private file view
+    // and the version store; such scans read every page, since zone maps and
+    // Bloom filters describe the current records, not the snapshot's.
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> scan_table(const std::shared_ptr<Transaction>& txn, const std::string& table_name,
+                                                                                                 const std::vector<ColumnPredicate>& predicates) const;
+    virtual std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> find_records(const std::shared_ptr<Transaction>& txn, const std::string& table_name,
+                                                                                                   const std::string& column_name, const std::string& value) const;
+    virtual std::optional<std::vector<uint64_t>> search_index(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::string& column_name,
+                                                              const std::string& value) const;
 
-    // Recovery operation
+    // Transaction operations. Pages a transaction changes stay in memory
+    // until it finishes, so no uncommitted change reaches a table file and
+    // only the COMMIT record has to be forced.
+    virtual std::optional<std::string> begin_transaction(std::shared_ptr<Transaction>& txn);
+    virtual std::optional<std::string> begin_read_only(std::shared_ptr<Transaction>& txn);
+    virtual std::optional<std::string> commit_transaction(const std::shared_ptr<Transaction>& txn);
+    virtual std::optional<std::string> abort_transaction(const std::shared_ptr<Transaction>& txn);
+
+    // Recovery operation. Replays the log, then truncates it once the
+    // restored pages are on stable storage. If any change fails to replay,
+    // the log is kept and the error returned.
     virtual std::optional<std::string> recover();
 
+    // Re-applies (or with undo, reverts) a logged change without logging it
+    // again. Records are put back under their logged ids, and a change the
+    // page already reflects is skipped, so replaying twice is harmless.
+    // Changes to a table or index dropped since then are skipped.
+    std::optional<std::string> replay_log_record(const LogRecord& record, bool undo);
+
     // Encryption operations
     virtual void enable_encryption(const EncryptionKey& key);
     virtual void disable_encryption();
@@ -68,6 +180,7 @@ public:
     virtual void set_consistency_level(ConsistencyLevel level);
 
     std::shared_ptr<IndexManager> get_index_manager() { return index_manager_; }
+    const std::string& get_data_directory() const { return data_directory_; }
     std::shared_ptr<RecoveryManager> get_recovery_manager() { return recovery_manager_; }
 
 protected:
@@ -76,17 +189,154 @@ protected:
     std::unique_ptr<FileManager> file_manager_;
     std::shared_ptr<IndexManager> index_manager_;
     std::shared_ptr<RecoveryManager> recovery_manager_;
+    std::unique_ptr<TransactionManager> transaction_manager_;
+    std::shared_ptr<VersionStore> version_store_;
     std::unordered_map<std::string, std::string> table_files_;
+    // Immutable copy of table_files_ for read-only transactions, replaced on every change
+    std::shared_ptr<const std::unordered_map<std::string, std::string>> table_snapshot_;
+    // Seqlocks that let snapshot readers detect a page write racing their read
+    static constexpr size_t PAGE_WRITE_STRIPES = 64;
+    mutable std::array<std::atomic<uint64_t>, PAGE_WRITE_STRIPES> page_write_seq_;
     mutable std::mutex mutex_;
+    // Pages changed by transactions, kept from the table file until every
+    // transaction that changed them has finished. Reads look here first.
+    struct DirtyPage {
+        std::vector<char> data;
+        std::unordered_set<transaction_id_t> writers;
+    };
+    // File name -> page id -> page
+    std::unordered_map<std::string, std::map<uint64_t, DirtyPage>> dirty_pages_;
+    // Transaction -> (table name, page id) of each page it changed
+    std::unordered_map<transaction_id_t, std::vector<std::pair<std::string, uint64_t>>> transaction_pages_;
+    // Guards the two maps above. Writers take it after mutex_; readers
+    // without mutex_ take it alone.
+    mutable std::mutex dirty_mutex_;
     std::unique_ptr<Encryptor> encryptor_;
     ConsistencyLevel consistency_level_;
 
+    // Names of the tables, one per line, so they are reopened on start
+    static constexpr const char* TABLE_CATALOG_FILE_NAME = "tables.catalog";
+    static constexpr const char* BLOOM_CATALOG_FILE_NAME = "bloom_filters.catalog";
+    // A filter's file is removed on its first change after being saved, so
+    // a file on disk is always current. filter is unset when a crash lost
+    // the file, until compaction or create_bloom_filter rebuilds it.
+    struct BloomFilterEntry {
+        std::optional<ColumnBloomFilter> filter;
+        bool saved = false;
+    };
+    // Table name -> column name -> filter
+    std::unordered_map<std::string, std::unordered_map<std::string, BloomFilterEntry>> bloom_filters_;
+    // Kept in memory for every table created this session and rebuilt by compaction
+    std::unordered_map<std::string, ZoneMap> zone_maps_;
+
+    // Pages each index build worker claims at a time
+    static constexpr uint64_t INDEX_BUILD_BATCH_PAGES = 64;
+    // Index changes made while an online build scans its table, merged into
+    // the index once it is loaded. Compacting or deleting the table cancels
+    // the build, since record ids no longer match what was scanned.
+    struct IndexBuildLog {
+        IndexManager::IndexDefinition definition;
+        struct Change {
+            bool insert;
+            std::string key;
+            uint64_t record_id;
+        };
+        std::vector<Change> changes;
+        bool cancelled = false;
+    };
+    // Table name -> online builds in progress
+    std::unordered_map<std::string, std::vector<std::shared_ptr<IndexBuildLog>>> index_builds_;
+
+    // A table's indexes with their columns looked up in its schema, so
+    // writes reach each index by id without reading the schema or naming
+    // the index. Rebuilt when the index catalog version moves on.
+    struct ResolvedIndex {
+        IndexManager::IndexId id;
+        IndexManager::IndexDefinition definition;
+        std::vector<size_t> positions;
+    };
+    struct TableIndexes {
+        uint64_t catalog_version = 0;
+        std::vector<ResolvedIndex> indexes;
+    };
+    std::unordered_map<std::string, TableIndexes> table_indexes_;
+
     std::string get_table_file_name(const std::string& table_name) const;
     std::unique_ptr<Page> allocate_page(const std::string& table_name);
-    std::optional<std::string> write_page(const std::string& table_name, const Page& page);
+    // A page changed by txn_id, or already held in memory, is kept in
+    // dirty_pages_; any other page is written through
+    std::optional<std::string> write_page(const std::string& table_name, const Page& page, std::optional<transaction_id_t> txn_id = std::nullopt);
+    std::optional<std::string> write_page_to_file(const std::string& table_name, const std::string& file_name, uint64_t page_id, const char* data);
     std::unique_ptr<Page> read_page(const std::string& table_name, uint64_t page_id) const;
-    void update_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id);
-    void remove_from_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id);
+    std::unique_ptr<Page> read_page_from(FileManager& file_manager, const std::string& file_name, uint64_t page_id) const;
+    std::atomic<uint64_t>& page_write_seq_for(const std::string& table_name) const;
+    void publish_table_snapshot();
+    std::optional<std::string> read_record_snapshot(const Transaction& txn, const std::string& table_name, uint64_t record_id, std::vector<std::string>& record) const;
+    std::optional<std::vector<std::string>> read_schema_snapshot(const Transaction& txn, const std::string& table_name, const std::string& file_name) const;
+    std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> scan_table_snapshot(const Transaction& txn, const std::string& table_name,
+                                                                                                  const std::vector<ColumnPredicate>& predicates) const;
+    std::optional<std::vector<std::string>> read_schema_locked(const std::string& table_name) const;
+    void for_each_record_locked(const std::string& table_name, const std::function<void(uint64_t, const std::vector<std::string>&)>& visitor) const;
+    void for_each_record_in_page(const Page& page, uint64_t page_id, const std::function<void(uint64_t, const std::vector<std::string>&)>& visitor) const;
+    // Records by ascending id, reading each page that holds one once; missing ids are skipped
+    std::vector<std::pair<uint64_t, std::vector<std::string>>> read_records_locked(const std::string& table_name, const std::vector<uint64_t>& record_ids) const;
+
+    // Callers hold mutex_
+    // Writes the pages txn_id changed that no unfinished transaction still
+    // holds. A page that fails to write stays in memory for the next try.
+    std::optional<std::string> release_transaction_pages(transaction_id_t txn_id);
+    std::optional<std::string> write_released_pages();
+    std::optional<std::string> load_table_catalog();
+    std::optional<std::string> save_table_catalog() const;
+    std::string get_bloom_file_path(const std::string& table_name, const std::string& column_name) const;
+    std::optional<std::string> load_bloom_filters();
+    std::optional<std::string> save_bloom_catalog() const;
+    std::optional<std::string> save_bloom_filter(const std::string& table_name, const std::string& column_name, BloomFilterEntry& entry);
+    void update_bloom_filters(const std::string& table_name, const std::vector<std::string>& record, uint64_t page_id);
+    void update_zone_map(const std::string& table_name, const std::vector<std::string>& record, uint64_t page_id);
+    // Zone maps live only in memory, so every table's is rebuilt from its
+    // pages once recovery has brought them up to date
+    void rebuild_zone_maps();
+    // Loads the index described by definition from the table's records
+    // through load, which publishes it. lock holds mutex_ on entry and exit.
+    std::optional<std::string> build_index(std::unique_lock<std::mutex>& lock, const std::string& table_name, const std::vector<std::string>& schema,
+                                           const IndexManager::IndexDefinition& definition, IndexBuildMode mode,
+                                           const std::function<std::optional<std::string>(std::vector<std::pair<std::string, uint64_t>>)>& load);
+    // (key, record_id) pairs for definition from every record, read in parallel
+    // through private file handles; needs no lock. Uncommitted changes are
+    // included; an abort takes them back out through reindex_record_locked.
+    std::optional<std::string> collect_index_entries(const std::string& table_name, const std::string& file_name, const std::vector<std::string>& schema,
+                                                     const IndexManager::IndexDefinition& definition,
+                                                     std::vector<std::pair<std::string, uint64_t>>& entries) const;
+    // Reads a page, again if a writer touched the table meanwhile; nullptr past the end
+    std::unique_ptr<Page> read_page_consistent(FileManager& file_manager, const std::string& table_name, const std::string& file_name, uint64_t page_id) const;
+    // Refills the indexes the index catalog brought back empty
+    std::optional<std::string> rebuild_indexes();
+    void log_index_build_change(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, bool insert);
+    void cancel_index_builds(const std::string& table_name);
+    // Callers hold mutex_; nullptr if the table has indexes but no schema
+    const std::vector<ResolvedIndex>* resolve_table_indexes(const std::string& table_name);
+    // Index changes are logged under txn_id like the record change that caused them
+    std::optional<std::string> update_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, std::optional<transaction_id_t> txn_id);
+    std::optional<std::string> remove_from_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, std::optional<transaction_id_t> txn_id);
+
+    // Callers hold mutex_. A change is logged under txn_id unless it is nullopt (replay).
+    std::optional<std::string> insert_record_locked(const std::string& table_name, const std::vector<std::string>& record, std::optional<transaction_id_t> txn_id);
+    std::optional<std::string> update_record_locked(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record, std::optional<transaction_id_t> txn_id);
+    std::optional<std::string> delete_record_locked(const std::string& table_name, uint64_t record_id, std::optional<transaction_id_t> txn_id);
+    // Callers hold mutex_. Sets the record at record_id to image (nullopt
+    // deletes it) if it still holds expected, without logging or touching
+    // indexes; does nothing if it already holds image.
+    std::optional<std::string> restore_record_locked(const std::string& table_name, uint64_t record_id,
+                                                     const std::optional<std::string>& expected, const std::optional<std::string>& image);
+    // Callers hold mutex_. Moves record_id's entries in every index and
+    // online index build from the keys of from to those of to. Undo needs it
+    // for indexes created after the change, which logged no INDEX_* record
+    // for them; the other indexes already match, and re-applying is a no-op.
+    std::optional<std::string> reindex_record_locked(const std::string& table_name, uint64_t record_id,
+                                                     const std::optional<std::string>& from, const std::optional<std::string>& to);
+    std::optional<std::string> check_transaction(const std::shared_ptr<Transaction>& txn, bool for_write = false) const;
+    std::optional<std::string> run_autocommit(const std::function<std::optional<std::string>(const std::shared_ptr<Transaction>&)>& operation);
 
     virtual std::vector<unsigned char> encrypt_page(const std::vector<unsigned char>& page_data) const;
     virtual std::vector<unsigned char> decrypt_page(const std::vector<unsigned char>& encrypted_data) const;
@@ -0,0 +1,146 @@
+#ifndef NEXUSDB_TASK_SCHEDULER_H
+#define NEXUSDB_TASK_SCHEDULER_H
+
+#include "nexusdb/bounded_mpmc_queue.h"
+#include "nexusdb/work_stealing_deque.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nexusdb {
+
+enum class TaskPriority {
+    FOREGROUND,  // Query execution and client requests
+    BACKGROUND   // Index builds, compaction, recovery and other maintenance
+};
+
+struct SchedulerConfig {
+    size_t num_workers = 0;  // 0 means one worker per hardware thread
+    size_t injection_queue_capacity = 4096;
+    std::vector<int> cpu_affinity;  // Worker i is pinned to cpu_affinity[i % size]; empty disables pinning
+};
+
+class TaskScheduler;
+
+// A set of tasks that can be waited on together. Waiting from a worker thread
+// runs other pending tasks instead of blocking the worker.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriority::FOREGROUND);
+    TaskGroup(TaskScheduler& scheduler, TaskPriority priority = TaskPriority::FOREGROUND);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+
+    // Returns the first error raised by a task in the group, if any
+    std::optional<std::string> wait();
+
+private:
+    TaskScheduler& scheduler_;
+    TaskPriority priority_;
+    std::atomic<size_t> pending_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::optional<std::string> error_;
+
+    void finish_task(const std::optional<std::string>& error);
+};
+
+// Shared work-stealing scheduler for the core. Each worker owns one Chase-Lev
+// deque per priority; tasks submitted from outside the pool go through
+// bounded injection queues. Foreground work is always preferred over
+// background work.
+class TaskScheduler {
+public:
+    static TaskScheduler& get_instance();
+
+    std::optional<std::string> initialize(const SchedulerConfig& config = SchedulerConfig());
+    void shutdown();
+    bool is_running() const;
+
+    // Runs the task inline when the scheduler is not running or is shutting
+    // down, so a submitted task always runs exactly once
+    void submit(std::function<void()> task, TaskPriority priority = TaskPriority::FOREGROUND);
+
+    template<typename F>
+    auto submit_async(F&& function, TaskPriority priority = TaskPriority::FOREGROUND)
+        -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        auto future = task->get_future();
+        submit([task]() { (*task)(); }, priority);
+        return future;
+    }
+
+    // Executes one queued task on the calling worker; false if none was found
+    // or the caller is not one of this scheduler's workers
+    bool run_pending_task();
+
+    bool in_worker_thread() const;
+    size_t get_worker_count() const;
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+private:
+    TaskScheduler();
+    ~TaskScheduler();
+
+    static constexpr size_t PRIORITY_LEVELS = 2;
+    static constexpr size_t SPIN_ROUNDS = 64;
+
+    struct Task {
+        std::function<void()> function;
+    };
+
+    struct Worker {
+        size_t index;
+        std::thread thread;
+        WorkStealingDeque<Task*> deques[PRIORITY_LEVELS];
+        uint64_t rng_state;
+    };
+
+    SchedulerConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::unique_ptr<BoundedMPMCQueue<Task*>>> injection_queues_;
+    std::deque<Task*> overflow_queues_[PRIORITY_LEVELS];
+    std::atomic<size_t> overflow_count_;
+    std::mutex overflow_mutex_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stopping_;
+    std::atomic<size_t> queued_tasks_;
+    std::atomic<size_t> sleeping_workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+    mutable std::mutex lifecycle_mutex_;
+
+    static thread_local Worker* current_worker_;
+    static thread_local TaskScheduler* current_scheduler_;
+
+    void worker_loop(Worker* worker);
+    Task* find_task(Worker* worker);
+    Task* take_injected(size_t level);
+    Task* steal_from_others(Worker* thief, size_t level);
+    void execute(Task* task);
+    void notify_workers();
+    void pin_to_cpu(Worker* worker);
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_TASK_SCHEDULER_H
@@ -2,8 +2,10 @@
 #define NEXUSDB_TRANSACTION_MANAGER_H
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -11,12 +13,55 @@ namespace nexusdb {
 
 typedef uint64_t transaction_id_t;
 
+class FileManager;
+
 enum class TransactionState {
     ACTIVE,
     COMMITTED,
     ABORTED
 };
 
+// Handle for an explicit transaction. Record operations that take a handle
+// tag their log records with its id; nothing is forced to the log until the
+// transaction commits.
+//
+// Read-only transactions are never logged and carry id 0. They read the
+// database as of their snapshot timestamp through a private read view, so a
+// read-only handle must not be shared between threads.
+class Transaction {
+public:
+    explicit Transaction(transaction_id_t id)
+        : id_(id), state_(TransactionState::ACTIVE), read_only_(false), snapshot_ts_(0) {}
+
+    Transaction(uint64_t snapshot_ts, std::shared_ptr<FileManager> read_view, std::shared_ptr<void> snapshot_registration)
+        : id_(0), state_(TransactionState::ACTIVE), read_only_(true), snapshot_ts_(snapshot_ts),
+          read_view_(std::move(read_view)), snapshot_registration_(std::move(snapshot_registration)) {}
+
+    transaction_id_t get_id() const { return id_; }
+    TransactionState get_state() const { return state_; }
+    bool is_active() const { return state_ == TransactionState::ACTIVE; }
+    bool is_read_only() const { return read_only_; }
+    uint64_t get_snapshot_timestamp() const { return snapshot_ts_; }
+    FileManager* get_read_view() const { return read_view_.get(); }
+
+    void set_state(TransactionState state) {
+        state_ = state;
+        if (state_ != TransactionState::ACTIVE) {
+            // Lets the version store reclaim what this snapshot was holding on to
+            snapshot_registration_.reset();
+            read_view_.reset();
+        }
+    }
+
+private:
+    transaction_id_t id_;
+    TransactionState state_;
+    bool read_only_;
+    uint64_t snapshot_ts_;
+    std::shared_ptr<FileManager> read_view_;
+    std::shared_ptr<void> snapshot_registration_;
+};
+
 struct TransactionLog {
     std::vector<std::string> operations;
 };
@@ -30,10 +75,13 @@ public:
     void shutdown();
 
     std::optional<transaction_id_t> begin_transaction();
+    // Numbers later transactions above last_used, an id from an earlier run
+    void reserve_transaction_ids(transaction_id_t last_used);
     std::optional<std::string> commit_transaction(transaction_id_t txn_id);
     std::optional<std::string> abort_transaction(transaction_id_t txn_id);
     
     std::optional<std::string> log_operation(transaction_id_t txn_id, const std::string& operation);
+    std::optional<TransactionState> get_state(transaction_id_t txn_id) const;
 
 private:
     mutable std::mutex mutex_;
@@ -0,0 +1,47 @@
+#ifndef NEXUSDB_VECTOR_DISTANCE_H
+#define NEXUSDB_VECTOR_DISTANCE_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nexusdb {
+
+// Float vectors are stored in columns as text, "[0.25,-1,3.5]", since
+// record fields may not hold arbitrary bytes. A column of type "vector(N)"
+// holds vectors of N dimensions.
+std::string encode_vector(const std::vector<float>& values);
+// nullopt unless text is a bracketed, comma-separated list of finite numbers
+std::optional<std::vector<float>> decode_vector(const std::string& text);
+// N for "vector(N)", nullopt for any other column type
+std::optional<size_t> parse_vector_type(const std::string& type);
+
+enum class DistanceMetric {
+    L2,      // Squared Euclidean distance
+    COSINE,  // 1 - cosine similarity
+    DOT      // Negated inner product, so smaller is closer for every metric
+};
+
+const char* distance_metric_name(DistanceMetric metric);
+std::optional<DistanceMetric> parse_distance_metric(const std::string& name);
+
+// Kernels over count floats, vectorized with AVX2 and FMA when the CPU has them
+float l2_squared(const float* a, const float* b, size_t count);
+float dot_product(const float* a, const float* b, size_t count);
+// Distance under metric. Callers comparing one vector against many can
+// cache norms and use the kernels directly instead.
+float vector_distance(DistanceMetric metric, const float* a, const float* b, size_t count);
+// 1 - a.b / (|a| |b|) from a dot product and the inverse norms of a and b,
+// where a zero vector has an inverse norm of 0
+inline float cosine_distance(float dot, float inverse_norm_a, float inverse_norm_b) {
+    return 1.0f - dot * inverse_norm_a * inverse_norm_b;
+}
+float inverse_norm(const float* values, size_t count);
+
+// Instruction set the kernels were compiled for, picked at startup
+const char* distance_simd_isa();
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_VECTOR_DISTANCE_H
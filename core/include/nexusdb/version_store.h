@@ -0,0 +1,86 @@
+#ifndef NEXUSDB_VERSION_STORE_H
+#define NEXUSDB_VERSION_STORE_H
+
+#include "nexusdb/epoch_manager.h"
+#include "nexusdb/transaction_manager.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nexusdb {
+
+// Before-images of records changed by writers, stamped with the commit
+// timestamp of the change. Read-only transactions use them to see a record
+// as it was at their snapshot without taking any locks: readers only pin an
+// epoch and walk immutable version chains, while writers serialize among
+// themselves on writer_mutex_.
+class VersionStore {
+public:
+    static constexpr uint64_t PENDING_TIMESTAMP = UINT64_MAX;
+    static constexpr size_t BUCKET_COUNT = 4096;
+    static constexpr size_t MAX_SNAPSHOTS = 1024;
+    static constexpr size_t GC_INTERVAL = 256;
+
+    VersionStore();
+    ~VersionStore();
+
+    VersionStore(const VersionStore&) = delete;
+    VersionStore& operator=(const VersionStore&) = delete;
+
+    // Writers. Must be called before the change reaches the page; a nullopt
+    // before_image means the record did not exist.
+    void record_before_image(transaction_id_t txn_id, const std::string& table_name, uint64_t record_id,
+                             const std::optional<std::string>& before_image);
+    // Stamps every version of the transaction with the next commit timestamp
+    // and makes it visible to new snapshots. Used for commit and for abort
+    // (after the transaction's changes have been rolled back).
+    void finish_transaction(transaction_id_t txn_id);
+
+    // Readers. A registered snapshot keeps the versions it needs alive.
+    std::optional<std::string> acquire_snapshot(uint64_t& snapshot_ts, size_t& slot);
+    void release_snapshot(size_t slot);
+
+    // True if the record changed after snapshot_ts; before_image is then the
+    // value the snapshot must see (nullopt if the record did not exist).
+    bool find_version(const std::string& table_name, uint64_t record_id, uint64_t snapshot_ts,
+                      std::optional<std::string>& before_image) const;
+    // find_version for every record of table_name that changed after
+    // snapshot_ts, by record id. Walks every bucket, so meant for scans.
+    std::map<uint64_t, std::optional<std::string>> changed_records(const std::string& table_name, uint64_t snapshot_ts) const;
+
+    uint64_t get_visible_timestamp() const { return visible_ts_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr uint64_t FREE_SLOT = UINT64_MAX;
+    static constexpr uint64_t CLAIMING_SLOT = UINT64_MAX - 1;
+
+    struct Version {
+        std::string table_name;
+        uint64_t record_id;
+        std::optional<std::string> before_image;
+        std::atomic<uint64_t> commit_ts;
+        std::atomic<Version*> next;
+    };
+
+    std::unique_ptr<std::atomic<Version*>[]> buckets_;
+    std::unique_ptr<std::atomic<uint64_t>[]> snapshot_slots_;
+    std::atomic<uint64_t> visible_ts_;
+    mutable EpochManager epoch_manager_;
+
+    std::mutex writer_mutex_;
+    std::unordered_map<transaction_id_t, std::vector<Version*>> pending_versions_;
+    size_t finished_since_gc_;
+
+    size_t bucket_for(const std::string& table_name, uint64_t record_id) const;
+    void collect_garbage();
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_VERSION_STORE_H
@@ -0,0 +1,59 @@
+#ifndef NEXUSDB_ZONE_MAP_H
+#define NEXUSDB_ZONE_MAP_H
+
+#include "nexusdb/query_optimizer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nexusdb {
+
+// Whether field <op> value holds. Values compare as byte strings, the same
+// order the indexes use. MATCH tokenizes field with SimpleTokenizer, and
+// spatial predicates parse it as a geometry.
+bool predicate_holds(const std::string& field, PredicateOp op, const std::string& value);
+
+// Synopsis of one column over one page. Empty fields count as nulls and are
+// kept out of min and max.
+struct ColumnZone {
+    std::string min;
+    std::string max;
+    uint64_t value_count = 0;
+    uint64_t null_count = 0;
+
+    void add(const std::string& value);
+    // False only if no value on the page can satisfy op value
+    bool may_match(PredicateOp op, const std::string& value) const;
+};
+
+// Per-page min/max synopses for every column of a table, so a scan can skip
+// pages that cannot satisfy a range predicate. Zones only widen: updates and
+// deletes leave stale bounds behind, which cost reads but never results,
+// until compaction rebuilds the map.
+class ZoneMap {
+public:
+    explicit ZoneMap(size_t column_count = 0);
+
+    void add(uint64_t page_id, const std::vector<std::string>& record);
+    // False only if no record on page_id can satisfy every predicate, each
+    // paired with its column's position in the schema. Pages without a
+    // synopsis may always match.
+    bool page_may_match(uint64_t page_id, const std::vector<std::pair<size_t, ColumnPredicate>>& predicates) const;
+    // nullptr if page_id has no synopsis
+    const ColumnZone* zone(uint64_t page_id, size_t column) const;
+
+    // Data pages 1 through page_count() have synopses
+    uint64_t page_count() const { return pages_.size(); }
+    size_t column_count() const { return column_count_; }
+
+private:
+    size_t column_count_;
+    // Indexed by page_id - 1, since page 0 holds the schema
+    std::vector<std::vector<ColumnZone>> pages_;
+};
+
+} // namespace nexusdb
+
+#endif // NEXUSDB_ZONE_MAP_H
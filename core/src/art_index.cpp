@@ -0,0 +1,746 @@
+#include "nexusdb/art_index.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace nexusdb {
+
+enum class ArtNodeType : uint8_t {
+    LEAF,
+    NODE4,
+    NODE16,
+    NODE48,
+    NODE256
+};
+
+struct ArtNode {
+    explicit ArtNode(ArtNodeType node_type) : type(node_type) {}
+    ArtNodeType type;
+};
+
+namespace {
+
+// A node moves to the next smaller type once it drains to this many
+// children; the gap to the smaller type's capacity keeps a node that
+// hovers around the boundary from converting back and forth
+constexpr size_t NODE16_SHRINK_COUNT = 3;
+constexpr size_t NODE48_SHRINK_COUNT = 12;
+constexpr size_t NODE256_SHRINK_COUNT = 40;
+
+// Node48 byte map entry for a byte without a child
+constexpr uint8_t EMPTY_SLOT = 0xFF;
+
+struct Leaf : ArtNode {
+    explicit Leaf(std::string leaf_key) : ArtNode(ArtNodeType::LEAF), key(std::move(leaf_key)) {}
+
+    std::string key;
+    std::vector<uint64_t> record_ids;  // Sorted
+};
+
+struct InnerNode : ArtNode {
+    using ArtNode::ArtNode;
+
+    // Bytes shared by every key below, after the edge byte leading here
+    std::string prefix;
+    // The key that ends right after prefix, if any
+    Leaf* terminal = nullptr;
+    uint16_t child_count = 0;
+};
+
+// Node4 and Node16 keep their edge bytes sorted next to the children
+template<size_t Capacity, ArtNodeType Type>
+struct SortedNode : InnerNode {
+    static constexpr size_t CAPACITY = Capacity;
+
+    SortedNode() : InnerNode(Type) {}
+
+    uint8_t keys[Capacity] = {};
+    ArtNode* children[Capacity] = {};
+};
+
+using Node4 = SortedNode<4, ArtNodeType::NODE4>;
+using Node16 = SortedNode<16, ArtNodeType::NODE16>;
+
+// Maps each byte to one of 48 densely packed child slots
+struct Node48 : InnerNode {
+    static constexpr size_t CAPACITY = 48;
+
+    Node48() : InnerNode(ArtNodeType::NODE48) { std::memset(slots, EMPTY_SLOT, sizeof(slots)); }
+
+    uint8_t slots[256];
+    ArtNode* children[CAPACITY] = {};
+};
+
+struct Node256 : InnerNode {
+    Node256() : InnerNode(ArtNodeType::NODE256) {}
+
+    ArtNode* children[256] = {};
+};
+
+uint8_t byte_at(const std::string& key, size_t depth) {
+    return static_cast<uint8_t>(key[depth]);
+}
+
+ArtNode** find_child(InnerNode* node, uint8_t byte) {
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            auto* node4 = static_cast<Node4*>(node);
+            for (size_t i = 0; i < node4->child_count; ++i) {
+                if (node4->keys[i] == byte) {
+                    return &node4->children[i];
+                }
+            }
+            return nullptr;
+        }
+        case ArtNodeType::NODE16: {
+            auto* node16 = static_cast<Node16*>(node);
+#if defined(__SSE2__)
+            // All 16 edge bytes are compared at once
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(node16->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << node16->child_count) - 1);
+            return mask != 0 ? &node16->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (size_t i = 0; i < node16->child_count; ++i) {
+                if (node16->keys[i] == byte) {
+                    return &node16->children[i];
+                }
+            }
+            return nullptr;
+#endif
+        }
+        case ArtNodeType::NODE48: {
+            auto* node48 = static_cast<Node48*>(node);
+            uint8_t slot = node48->slots[byte];
+            return slot != EMPTY_SLOT ? &node48->children[slot] : nullptr;
+        }
+        case ArtNodeType::NODE256: {
+            auto* node256 = static_cast<Node256*>(node);
+            return node256->children[byte] != nullptr ? &node256->children[byte] : nullptr;
+        }
+        case ArtNodeType::LEAF:
+            break;
+    }
+    return nullptr;
+}
+
+const ArtNode* find_child(const InnerNode* node, uint8_t byte) {
+    ArtNode** child = find_child(const_cast<InnerNode*>(node), byte);
+    return child != nullptr ? *child : nullptr;
+}
+
+// Visits children in byte order until visit returns false
+template<typename Visitor>
+bool for_each_child(const InnerNode* node, Visitor&& visit) {
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            auto* node4 = static_cast<const Node4*>(node);
+            for (size_t i = 0; i < node4->child_count; ++i) {
+                if (!visit(node4->keys[i], node4->children[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case ArtNodeType::NODE16: {
+            auto* node16 = static_cast<const Node16*>(node);
+            for (size_t i = 0; i < node16->child_count; ++i) {
+                if (!visit(node16->keys[i], node16->children[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case ArtNodeType::NODE48: {
+            auto* node48 = static_cast<const Node48*>(node);
+            for (size_t byte = 0; byte < 256; ++byte) {
+                uint8_t slot = node48->slots[byte];
+                if (slot != EMPTY_SLOT && !visit(static_cast<uint8_t>(byte), node48->children[slot])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case ArtNodeType::NODE256: {
+            auto* node256 = static_cast<const Node256*>(node);
+            for (size_t byte = 0; byte < 256; ++byte) {
+                if (node256->children[byte] != nullptr && !visit(static_cast<uint8_t>(byte), node256->children[byte])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case ArtNodeType::LEAF:
+            break;
+    }
+    return true;
+}
+
+// Nodes have no virtual destructor, so each is deleted as its own type
+void delete_node(ArtNode* node) {
+    switch (node->type) {
+        case ArtNodeType::LEAF:
+            delete static_cast<Leaf*>(node);
+            break;
+        case ArtNodeType::NODE4:
+            delete static_cast<Node4*>(node);
+            break;
+        case ArtNodeType::NODE16:
+            delete static_cast<Node16*>(node);
+            break;
+        case ArtNodeType::NODE48:
+            delete static_cast<Node48*>(node);
+            break;
+        case ArtNodeType::NODE256:
+            delete static_cast<Node256*>(node);
+            break;
+    }
+}
+
+void destroy(ArtNode* node) {
+    if (node == nullptr) {
+        return;
+    }
+    if (node->type != ArtNodeType::LEAF) {
+        auto* inner = static_cast<InnerNode*>(node);
+        destroy(inner->terminal);
+        for_each_child(inner, [](uint8_t, ArtNode* child) {
+            destroy(child);
+            return true;
+        });
+    }
+    delete_node(node);
+}
+
+// Moves the prefix, terminal and child count into a node of another size
+void move_header(InnerNode* from, InnerNode* to) {
+    to->prefix = std::move(from->prefix);
+    to->terminal = from->terminal;
+    to->child_count = from->child_count;
+}
+
+template<typename Node>
+void insert_sorted(Node* node, uint8_t byte, ArtNode* child) {
+    size_t position = 0;
+    while (position < node->child_count && node->keys[position] < byte) {
+        ++position;
+    }
+    std::copy_backward(node->keys + position, node->keys + node->child_count, node->keys + node->child_count + 1);
+    std::copy_backward(node->children + position, node->children + node->child_count, node->children + node->child_count + 1);
+    node->keys[position] = byte;
+    node->children[position] = child;
+    ++node->child_count;
+}
+
+template<typename Node>
+void erase_sorted(Node* node, uint8_t byte) {
+    size_t position = 0;
+    while (position < node->child_count && node->keys[position] != byte) {
+        ++position;
+    }
+    if (position == node->child_count) {
+        return;
+    }
+    std::copy(node->keys + position + 1, node->keys + node->child_count, node->keys + position);
+    std::copy(node->children + position + 1, node->children + node->child_count, node->children + position);
+    --node->child_count;
+    node->children[node->child_count] = nullptr;
+}
+
+// Adds a child to the inner node at *ref, replacing it with the next
+// larger node type if it is full
+void add_child(ArtNode** ref, uint8_t byte, ArtNode* child) {
+    switch ((*ref)->type) {
+        case ArtNodeType::NODE4: {
+            auto* node4 = static_cast<Node4*>(*ref);
+            if (node4->child_count < Node4::CAPACITY) {
+                insert_sorted(node4, byte, child);
+                return;
+            }
+            auto* node16 = new Node16();
+            move_header(node4, node16);
+            std::copy(node4->keys, node4->keys + Node4::CAPACITY, node16->keys);
+            std::copy(node4->children, node4->children + Node4::CAPACITY, node16->children);
+            delete node4;
+            *ref = node16;
+            insert_sorted(node16, byte, child);
+            return;
+        }
+        case ArtNodeType::NODE16: {
+            auto* node16 = static_cast<Node16*>(*ref);
+            if (node16->child_count < Node16::CAPACITY) {
+                insert_sorted(node16, byte, child);
+                return;
+            }
+            auto* node48 = new Node48();
+            move_header(node16, node48);
+            for (size_t i = 0; i < Node16::CAPACITY; ++i) {
+                node48->slots[node16->keys[i]] = static_cast<uint8_t>(i);
+                node48->children[i] = node16->children[i];
+            }
+            delete node16;
+            *ref = node48;
+            add_child(ref, byte, child);
+            return;
+        }
+        case ArtNodeType::NODE48: {
+            auto* node48 = static_cast<Node48*>(*ref);
+            if (node48->child_count < Node48::CAPACITY) {
+                node48->slots[byte] = static_cast<uint8_t>(node48->child_count);
+                node48->children[node48->child_count] = child;
+                ++node48->child_count;
+                return;
+            }
+            auto* node256 = new Node256();
+            move_header(node48, node256);
+            for (size_t i = 0; i < 256; ++i) {
+                if (node48->slots[i] != EMPTY_SLOT) {
+                    node256->children[i] = node48->children[node48->slots[i]];
+                }
+            }
+            delete node48;
+            *ref = node256;
+            add_child(ref, byte, child);
+            return;
+        }
+        case ArtNodeType::NODE256: {
+            auto* node256 = static_cast<Node256*>(*ref);
+            node256->children[byte] = child;
+            ++node256->child_count;
+            return;
+        }
+        case ArtNodeType::LEAF:
+            break;
+    }
+}
+
+// Drops the child slot for byte from the inner node at *ref, replacing it
+// with the next smaller node type once it has drained
+void remove_child(ArtNode** ref, uint8_t byte) {
+    switch ((*ref)->type) {
+        case ArtNodeType::NODE4:
+            erase_sorted(static_cast<Node4*>(*ref), byte);
+            return;
+        case ArtNodeType::NODE16: {
+            auto* node16 = static_cast<Node16*>(*ref);
+            erase_sorted(node16, byte);
+            if (node16->child_count > NODE16_SHRINK_COUNT) {
+                return;
+            }
+            auto* node4 = new Node4();
+            move_header(node16, node4);
+            std::copy(node16->keys, node16->keys + node4->child_count, node4->keys);
+            std::copy(node16->children, node16->children + node4->child_count, node4->children);
+            delete node16;
+            *ref = node4;
+            return;
+        }
+        case ArtNodeType::NODE48: {
+            auto* node48 = static_cast<Node48*>(*ref);
+            uint8_t slot = node48->slots[byte];
+            if (slot == EMPTY_SLOT) {
+                return;
+            }
+            // Keep the slots dense by moving the last child into the hole
+            node48->slots[byte] = EMPTY_SLOT;
+            uint8_t last = static_cast<uint8_t>(node48->child_count - 1);
+            if (slot != last) {
+                node48->children[slot] = node48->children[last];
+                *std::find(node48->slots, node48->slots + 256, last) = slot;
+            }
+            node48->children[last] = nullptr;
+            --node48->child_count;
+            if (node48->child_count > NODE48_SHRINK_COUNT) {
+                return;
+            }
+            auto* node16 = new Node16();
+            move_header(node48, node16);
+            size_t position = 0;
+            for (size_t i = 0; i < 256; ++i) {
+                if (node48->slots[i] != EMPTY_SLOT) {
+                    node16->keys[position] = static_cast<uint8_t>(i);
+                    node16->children[position] = node48->children[node48->slots[i]];
+                    ++position;
+                }
+            }
+            delete node48;
+            *ref = node16;
+            return;
+        }
+        case ArtNodeType::NODE256: {
+            // The slot may already be cleared by the removal below it
+            auto* node256 = static_cast<Node256*>(*ref);
+            node256->children[byte] = nullptr;
+            --node256->child_count;
+            if (node256->child_count > NODE256_SHRINK_COUNT) {
+                return;
+            }
+            auto* node48 = new Node48();
+            move_header(node256, node48);
+            uint8_t slot = 0;
+            for (size_t i = 0; i < 256; ++i) {
+                if (node256->children[i] != nullptr) {
+                    node48->slots[i] = slot;
+                    node48->children[slot] = node256->children[i];
+                    ++slot;
+                }
+            }
+            delete node256;
+            *ref = node48;
+            return;
+        }
+        case ArtNodeType::LEAF:
+            break;
+    }
+}
+
+// Undoes path compression around a Node4 left with a single path: a node
+// with only its terminal becomes that leaf, and a node with one child and
+// no terminal is merged into the child
+void collapse(ArtNode** ref, size_t& node_count) {
+    if ((*ref)->type != ArtNodeType::NODE4) {
+        return;
+    }
+    auto* node4 = static_cast<Node4*>(*ref);
+    if (node4->child_count == 0) {
+        *ref = node4->terminal;
+    } else if (node4->child_count == 1 && node4->terminal == nullptr) {
+        ArtNode* child = node4->children[0];
+        if (child->type != ArtNodeType::LEAF) {
+            auto* inner = static_cast<InnerNode*>(child);
+            inner->prefix = node4->prefix + static_cast<char>(node4->keys[0]) + inner->prefix;
+        }
+        *ref = child;
+    } else {
+        return;
+    }
+    delete node4;
+    --node_count;
+}
+
+// Hangs a leaf below the inner node at *ref, whose prefix ends at depth
+void attach(ArtNode** ref, Leaf* leaf, size_t depth) {
+    auto* inner = static_cast<InnerNode*>(*ref);
+    if (leaf->key.size() == depth) {
+        inner->terminal = leaf;
+    } else {
+        add_child(ref, byte_at(leaf->key, depth), leaf);
+    }
+}
+
+bool erase_record(Leaf* leaf, uint64_t record_id) {
+    auto it = std::lower_bound(leaf->record_ids.begin(), leaf->record_ids.end(), record_id);
+    if (it == leaf->record_ids.end() || *it != record_id) {
+        return false;
+    }
+    leaf->record_ids.erase(it);
+    return true;
+}
+
+// Removes record_id from key's leaf below *ref, deleting the leaf once it
+// is empty and shrinking nodes on the way back up
+bool remove_entry(ArtNode** ref, const std::string& key, size_t depth, uint64_t record_id, size_t& node_count) {
+    ArtNode* node = *ref;
+    if (node == nullptr) {
+        return false;
+    }
+    if (node->type == ArtNodeType::LEAF) {
+        auto* leaf = static_cast<Leaf*>(node);
+        if (leaf->key != key || !erase_record(leaf, record_id)) {
+            return false;
+        }
+        if (leaf->record_ids.empty()) {
+            delete leaf;
+            *ref = nullptr;
+            --node_count;
+        }
+        return true;
+    }
+
+    auto* inner = static_cast<InnerNode*>(node);
+    if (key.compare(depth, inner->prefix.size(), inner->prefix) != 0) {
+        return false;
+    }
+    depth += inner->prefix.size();
+    if (depth == key.size()) {
+        if (inner->terminal == nullptr || !erase_record(inner->terminal, record_id)) {
+            return false;
+        }
+        if (inner->terminal->record_ids.empty()) {
+            delete inner->terminal;
+            inner->terminal = nullptr;
+            --node_count;
+            collapse(ref, node_count);
+        }
+        return true;
+    }
+
+    uint8_t edge = byte_at(key, depth);
+    ArtNode** child = find_child(inner, edge);
+    if (child == nullptr || !remove_entry(child, key, depth + 1, record_id, node_count)) {
+        return false;
+    }
+    if (*child == nullptr) {
+        remove_child(ref, edge);
+        collapse(ref, node_count);
+    }
+    return true;
+}
+
+struct ScanBounds {
+    const std::optional<std::string>& lower;
+    bool lower_inclusive;
+    const std::optional<std::string>& upper;
+    bool upper_inclusive;
+};
+
+// Returns false once the visitor stops or keys pass the upper bound
+bool scan_leaf(const Leaf* leaf, const ScanBounds& bounds, const Index::ScanVisitor& visitor) {
+    if (bounds.upper.has_value() && (bounds.upper_inclusive ? leaf->key > *bounds.upper : leaf->key >= *bounds.upper)) {
+        return false;
+    }
+    if (bounds.lower.has_value() && (bounds.lower_inclusive ? leaf->key < *bounds.lower : leaf->key <= *bounds.lower)) {
+        return true;
+    }
+    for (uint64_t record_id : leaf->record_ids) {
+        if (!visitor(leaf->key, record_id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Visits the subtree in key order. While below_lower is set, the path so
+// far equals the lower bound's first depth bytes and subtrees that sort
+// entirely before it are skipped.
+bool scan_subtree(const ArtNode* node, size_t depth, bool below_lower, const ScanBounds& bounds, const Index::ScanVisitor& visitor) {
+    if (node->type == ArtNodeType::LEAF) {
+        return scan_leaf(static_cast<const Leaf*>(node), bounds, visitor);
+    }
+
+    auto* inner = static_cast<const InnerNode*>(node);
+    if (below_lower) {
+        const std::string& lower = *bounds.lower;
+        size_t remaining = lower.size() - depth;
+        size_t compared = std::min(inner->prefix.size(), remaining);
+        int order = inner->prefix.compare(0, compared, lower, depth, compared);
+        if (order < 0) {
+            return true;
+        }
+        // Every key below either sorts after the bound or, at the terminal, equals it
+        below_lower = order == 0 && remaining > inner->prefix.size();
+    }
+
+    size_t child_depth = depth + inner->prefix.size();
+    if (inner->terminal != nullptr && !below_lower && !scan_leaf(inner->terminal, bounds, visitor)) {
+        return false;
+    }
+    uint8_t lower_edge = below_lower ? byte_at(*bounds.lower, child_depth) : 0;
+    return for_each_child(inner, [&](uint8_t byte, const ArtNode* child) {
+        if (below_lower && byte < lower_edge) {
+            return true;
+        }
+        return scan_subtree(child, child_depth + 1, below_lower && byte == lower_edge, bounds, visitor);
+    });
+}
+
+size_t subtree_height(const ArtNode* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+    if (node->type == ArtNodeType::LEAF) {
+        return 1;
+    }
+    size_t height = 0;
+    for_each_child(static_cast<const InnerNode*>(node), [&](uint8_t, const ArtNode* child) {
+        height = std::max(height, subtree_height(child));
+        return true;
+    });
+    return height + 1;
+}
+
+} // namespace
+
+ArtIndex::ArtIndex() : root_(nullptr), entry_count_(0), node_count_(0) {}
+
+ArtIndex::~ArtIndex() {
+    destroy(root_);
+}
+
+std::optional<std::string> ArtIndex::insert(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::vector<uint64_t>& record_ids = find_or_insert(key);
+    auto it = std::lower_bound(record_ids.begin(), record_ids.end(), record_id);
+    if (it == record_ids.end() || *it != record_id) {
+        record_ids.insert(it, record_id);
+        ++entry_count_;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> ArtIndex::remove(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (remove_entry(&root_, key, 0, record_id, node_count_)) {
+        --entry_count_;
+    }
+    return std::nullopt;
+}
+
+std::vector<uint64_t> ArtIndex::search(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const std::vector<uint64_t>* record_ids = find(key);
+    return record_ids != nullptr ? *record_ids : std::vector<uint64_t>();
+}
+
+PostingList ArtIndex::postings(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const std::vector<uint64_t>* record_ids = find(key);
+    return record_ids != nullptr ? PostingList(*record_ids) : PostingList();
+}
+
+// Radix nodes are sized by their children, so there is no fill factor to apply
+std::optional<std::string> ArtIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (root_ != nullptr) {
+        return "Bulk load requires an empty index";
+    }
+
+    for (size_t i = 0; i < entries.size();) {
+        std::vector<uint64_t>& record_ids = find_or_insert(entries[i].first);
+        size_t end = i;
+        while (end < entries.size() && entries[end].first == entries[i].first) {
+            record_ids.push_back(entries[end].second);
+            ++end;
+        }
+        i = end;
+    }
+    entry_count_ = entries.size();
+    return std::nullopt;
+}
+
+void ArtIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                    const std::optional<std::string>& upper, bool upper_inclusive,
+                    const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (root_ == nullptr) {
+        return;
+    }
+    ScanBounds bounds{lower, lower_inclusive, upper, upper_inclusive};
+    scan_subtree(root_, 0, lower.has_value(), bounds, visitor);
+}
+
+size_t ArtIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entry_count_;
+}
+
+size_t ArtIndex::height() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return subtree_height(root_);
+}
+
+size_t ArtIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return node_count_;
+}
+
+const std::vector<uint64_t>* ArtIndex::find(const std::string& key) const {
+    const ArtNode* node = root_;
+    size_t depth = 0;
+    while (node != nullptr) {
+        if (node->type == ArtNodeType::LEAF) {
+            auto* leaf = static_cast<const Leaf*>(node);
+            return leaf->key == key ? &leaf->record_ids : nullptr;
+        }
+        auto* inner = static_cast<const InnerNode*>(node);
+        if (key.compare(depth, inner->prefix.size(), inner->prefix) != 0) {
+            return nullptr;
+        }
+        depth += inner->prefix.size();
+        if (depth == key.size()) {
+            return inner->terminal != nullptr ? &inner->terminal->record_ids : nullptr;
+        }
+        node = find_child(inner, byte_at(key, depth));
+        ++depth;
+    }
+    return nullptr;
+}
+
+std::vector<uint64_t>& ArtIndex::find_or_insert(const std::string& key) {
+    ArtNode** ref = &root_;
+    size_t depth = 0;
+    while (true) {
+        ArtNode* node = *ref;
+        if (node == nullptr) {
+            auto* leaf = new Leaf(key);
+            *ref = leaf;
+            ++node_count_;
+            return leaf->record_ids;
+        }
+
+        if (node->type == ArtNodeType::LEAF) {
+            auto* leaf = static_cast<Leaf*>(node);
+            if (leaf->key == key) {
+                return leaf->record_ids;
+            }
+            // The two keys only get inner nodes where they diverge
+            size_t common = 0;
+            while (depth + common < key.size() && depth + common < leaf->key.size() &&
+                   key[depth + common] == leaf->key[depth + common]) {
+                ++common;
+            }
+            auto* branch = new Node4();
+            branch->prefix = key.substr(depth, common);
+            auto* added = new Leaf(key);
+            node_count_ += 2;
+            *ref = branch;
+            attach(ref, leaf, depth + common);
+            attach(ref, added, depth + common);
+            return added->record_ids;
+        }
+
+        auto* inner = static_cast<InnerNode*>(node);
+        size_t matched = 0;
+        while (matched < inner->prefix.size() && depth + matched < key.size() &&
+               inner->prefix[matched] == key[depth + matched]) {
+            ++matched;
+        }
+        if (matched < inner->prefix.size()) {
+            // Split the compressed path where the key leaves it
+            auto* branch = new Node4();
+            branch->prefix = inner->prefix.substr(0, matched);
+            uint8_t edge = static_cast<uint8_t>(inner->prefix[matched]);
+            inner->prefix.erase(0, matched + 1);
+            *ref = branch;
+            add_child(ref, edge, inner);
+            auto* added = new Leaf(key);
+            node_count_ += 2;
+            attach(ref, added, depth + matched);
+            return added->record_ids;
+        }
+
+        depth += inner->prefix.size();
+        if (depth == key.size()) {
+            if (inner->terminal == nullptr) {
+                inner->terminal = new Leaf(key);
+                ++node_count_;
+            }
+            return inner->terminal->record_ids;
+        }
+        ArtNode** child = find_child(inner, byte_at(key, depth));
+        if (child == nullptr) {
+            auto* added = new Leaf(key);
+            ++node_count_;
+            add_child(ref, byte_at(key, depth), added);
+            return added->record_ids;
+        }
+        ref = child;
+        ++depth;
+    }
+}
+
+} // namespace nexusdb
@@ -0,0 +1,123 @@
+#include "nexusdb/bitmap_index.h"
+#include <mutex>
+
+namespace nexusdb {
+
+std::optional<std::string> BitmapIndex::insert(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (bitmaps_[key].add(record_id)) {
+        ++entry_count_;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> BitmapIndex::remove(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = bitmaps_.find(key);
+    if (it != bitmaps_.end() && it->second.remove(record_id)) {
+        --entry_count_;
+        if (it->second.empty()) {
+            bitmaps_.erase(it);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<uint64_t> BitmapIndex::search(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = bitmaps_.find(key);
+    return it != bitmaps_.end() ? it->second.to_vector() : std::vector<uint64_t>();
+}
+
+PostingList BitmapIndex::postings(const std::string& key) const {
+    return PostingList(search(key));
+}
+
+// Containers are sized by their values, so there is no fill factor to apply
+std::optional<std::string> BitmapIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!bitmaps_.empty()) {
+        return "Bulk load requires an empty index";
+    }
+
+    // Entries arrive sorted, so every bitmap is built by appends
+    auto hint = bitmaps_.end();
+    for (const auto& [key, record_id] : entries) {
+        if (hint == bitmaps_.end() || hint->first != key) {
+            hint = bitmaps_.emplace_hint(bitmaps_.end(), key, RoaringBitmap());
+        }
+        if (hint->second.add(record_id)) {
+            ++entry_count_;
+        }
+    }
+    for (auto& [key, bitmap] : bitmaps_) {
+        bitmap.run_optimize();
+    }
+    return std::nullopt;
+}
+
+void BitmapIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                       const std::optional<std::string>& upper, bool upper_inclusive,
+                       const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = !lower.has_value() ? bitmaps_.begin() : lower_inclusive ? bitmaps_.lower_bound(*lower) : bitmaps_.upper_bound(*lower);
+    for (; it != bitmaps_.end(); ++it) {
+        if (upper.has_value() && (upper_inclusive ? it->first > *upper : it->first >= *upper)) {
+            return;
+        }
+        for (uint64_t record_id : it->second.to_vector()) {
+            if (!visitor(it->first, record_id)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t BitmapIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entry_count_;
+}
+
+size_t BitmapIndex::height() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return bitmaps_.empty() ? 0 : 1;
+}
+
+// Containers, the unit a bitmap operation works on
+size_t BitmapIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t containers = 0;
+    for (const auto& [key, bitmap] : bitmaps_) {
+        containers += bitmap.container_count();
+    }
+    return containers;
+}
+
+RoaringBitmap BitmapIndex::bitmap(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = bitmaps_.find(key);
+    return it != bitmaps_.end() ? it->second : RoaringBitmap();
+}
+
+RoaringBitmap BitmapIndex::bitmap_of_any(const std::vector<std::string>& keys) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    RoaringBitmap result;
+    for (const auto& key : keys) {
+        auto it = bitmaps_.find(key);
+        if (it != bitmaps_.end()) {
+            result = RoaringBitmap::unite(result, it->second);
+        }
+    }
+    return result;
+}
+
+RoaringBitmap BitmapIndex::all_records() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    RoaringBitmap result;
+    for (const auto& [key, bitmap] : bitmaps_) {
+        result = RoaringBitmap::unite(result, bitmap);
+    }
+    return result;
+}
+
+} // namespace nexusdb
@@ -0,0 +1,194 @@
+#include "nexusdb/bloom_filter.h"
+#include "nexusdb/hash_index.h"
+#include <cstring>
+
+namespace nexusdb {
+
+namespace {
+
+constexpr size_t BITS_PER_BLOCK = 512;
+
+// Odd multipliers that spread the low hash bits over the eight words of a
+// block, one bit per word
+constexpr uint32_t BLOCK_SALTS[8] = {
+    0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+    0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U
+};
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template<typename T>
+bool get(const std::string& data, size_t& offset, T& value) {
+    if (offset > data.size() || data.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t initial_capacity) {
+    stages_.push_back(make_stage(initial_capacity > 0 ? initial_capacity : 1));
+}
+
+void BloomFilter::add_hash(uint64_t key_hash) {
+    if (stages_.back().count >= stages_.back().capacity) {
+        stages_.push_back(make_stage(stages_.back().capacity * 2));
+    }
+    set_bits(stages_.back(), key_hash);
+    ++stages_.back().count;
+}
+
+bool BloomFilter::might_contain_hash(uint64_t key_hash) const {
+    for (const auto& stage : stages_) {
+        if (test_bits(stage, key_hash)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BloomFilter::size() const {
+    size_t count = 0;
+    for (const auto& stage : stages_) {
+        count += stage.count;
+    }
+    return count;
+}
+
+size_t BloomFilter::memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& stage : stages_) {
+        bytes += stage.words.size() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+void BloomFilter::serialize(std::string& out) const {
+    put<uint64_t>(out, stages_.size());
+    for (const auto& stage : stages_) {
+        put<uint64_t>(out, stage.capacity);
+        put<uint64_t>(out, stage.count);
+        put<uint64_t>(out, stage.block_count());
+        for (uint64_t word : stage.words) {
+            put<uint64_t>(out, word);
+        }
+    }
+}
+
+std::optional<BloomFilter> BloomFilter::deserialize(const std::string& data, size_t& offset) {
+    uint64_t stage_count;
+    if (!get(data, offset, stage_count) || stage_count == 0) {
+        return std::nullopt;
+    }
+
+    BloomFilter filter;
+    filter.stages_.clear();
+    for (uint64_t i = 0; i < stage_count; ++i) {
+        Stage stage;
+        uint64_t block_count;
+        if (!get(data, offset, stage.capacity) || !get(data, offset, stage.count) || !get(data, offset, block_count) ||
+            stage.capacity == 0 || block_count == 0 || block_count > (data.size() - offset) / (WORDS_PER_BLOCK * sizeof(uint64_t))) {
+            return std::nullopt;
+        }
+        stage.words.resize(block_count * WORDS_PER_BLOCK);
+        for (uint64_t& word : stage.words) {
+            get(data, offset, word);
+        }
+        filter.stages_.push_back(std::move(stage));
+    }
+    return filter;
+}
+
+uint64_t BloomFilter::hash(const std::string& key) {
+    return LinearHashing::hash(key);
+}
+
+BloomFilter::Stage BloomFilter::make_stage(uint64_t capacity) {
+    Stage stage;
+    stage.capacity = capacity;
+    uint64_t block_count = (capacity * BITS_PER_KEY + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
+    stage.words.assign(block_count * WORDS_PER_BLOCK, 0);
+    return stage;
+}
+
+// The high half of the hash picks the block, the low half the bits in it
+void BloomFilter::set_bits(Stage& stage, uint64_t key_hash) {
+    uint64_t* block = stage.words.data() + ((key_hash >> 32) * stage.block_count() >> 32) * WORDS_PER_BLOCK;
+    uint32_t low = static_cast<uint32_t>(key_hash);
+    for (size_t i = 0; i < BITS_PER_BLOCK_KEY; ++i) {
+        block[i] |= uint64_t{1} << ((low * BLOCK_SALTS[i]) >> 26);
+    }
+}
+
+bool BloomFilter::test_bits(const Stage& stage, uint64_t key_hash) {
+    const uint64_t* block = stage.words.data() + ((key_hash >> 32) * stage.block_count() >> 32) * WORDS_PER_BLOCK;
+    uint32_t low = static_cast<uint32_t>(key_hash);
+    for (size_t i = 0; i < BITS_PER_BLOCK_KEY; ++i) {
+        if ((block[i] & (uint64_t{1} << ((low * BLOCK_SALTS[i]) >> 26))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ColumnBloomFilter::add(uint64_t page_id, const std::string& value) {
+    uint64_t value_hash = BloomFilter::hash(value);
+    table_.add_hash(value_hash);
+    uint64_t group = group_of(page_id);
+    while (groups_.size() <= group) {
+        groups_.emplace_back(GROUP_CAPACITY);
+    }
+    groups_[group].add_hash(value_hash);
+}
+
+bool ColumnBloomFilter::group_might_contain(uint64_t page_id, const std::string& value) const {
+    uint64_t group = group_of(page_id);
+    return group < groups_.size() && groups_[group].might_contain(value);
+}
+
+std::string ColumnBloomFilter::serialize() const {
+    std::string out;
+    put<uint32_t>(out, MAGIC);
+    put<uint32_t>(out, FORMAT_VERSION);
+    table_.serialize(out);
+    put<uint64_t>(out, groups_.size());
+    for (const auto& group : groups_) {
+        group.serialize(out);
+    }
+    return out;
+}
+
+std::optional<ColumnBloomFilter> ColumnBloomFilter::deserialize(const std::string& data) {
+    size_t offset = 0;
+    uint32_t magic;
+    uint32_t version;
+    if (!get(data, offset, magic) || magic != MAGIC || !get(data, offset, version) || version != FORMAT_VERSION) {
+        return std::nullopt;
+    }
+
+    ColumnBloomFilter filter;
+    auto table = BloomFilter::deserialize(data, offset);
+    uint64_t group_count;
+    if (!table.has_value() || !get(data, offset, group_count)) {
+        return std::nullopt;
+    }
+    filter.table_ = std::move(*table);
+    for (uint64_t i = 0; i < group_count; ++i) {
+        auto group = BloomFilter::deserialize(data, offset);
+        if (!group.has_value()) {
+            return std::nullopt;
+        }
+        filter.groups_.push_back(std::move(*group));
+    }
+    return filter;
+}
+
+} // namespace nexusdb
@@ -1,86 +1,259 @@
 #include "nexusdb/btree.h"
+#include <cstdint>
 #include <optional>
+#include <string>
 
 namespace nexusdb {
 
 template<typename Key, typename Value>
 void BTree<Key, Value>::insert(const Key& key, const Value& value) {
     if (root->keys.size() == 2 * degree - 1) {
-        auto new_root = std::make_unique<BTreeNode<Key, Value>>(false);
+        auto new_root = std::make_unique<Node>(false);
         new_root->children.push_back(std::move(root));
         root = std::move(new_root);
+        num_nodes++;
+        num_levels++;
         split_child(root.get(), 0, root->children[0].get());
     }
     insert_non_full(root.get(), key, value);
 }
 
 template<typename Key, typename Value>
-void BTree<Key, Value>::split_child(BTreeNode<Key, Value>* parent, int index, BTreeNode<Key, Value>* child) {
-    auto new_child = std::make_unique<BTreeNode<Key, Value>>(child->is_leaf);
-    
-    for (int j = 0; j < degree - 1; j++) {
-        new_child->keys.push_back(child->keys[j + degree]);
-        if (!child->is_leaf) {
-            new_child->children.push_back(std::move(child->children[j + degree]));
+void BTree<Key, Value>::split_child(Node* parent, int index, Node* child) {
+    auto new_child = std::make_unique<Node>(child->is_leaf);
+    Key separator;
+
+    if (child->is_leaf) {
+        // Leaves keep every key, so the separator is a copy of the first key
+        // of the new right sibling
+        new_child->keys.assign(child->keys.begin() + degree, child->keys.end());
+        new_child->values.assign(std::make_move_iterator(child->values.begin() + degree),
+                                 std::make_move_iterator(child->values.end()));
+        child->keys.resize(degree);
+        child->values.resize(degree);
+        separator = new_child->keys.front();
+
+        new_child->next = child->next;
+        new_child->prev = child;
+        if (child->next != nullptr) {
+            child->next->prev = new_child.get();
         }
+        child->next = new_child.get();
+    } else {
+        // Internal nodes move their median key up
+        separator = child->keys[degree - 1];
+        new_child->keys.assign(child->keys.begin() + degree, child->keys.end());
+        for (size_t j = degree; j < child->children.size(); j++) {
+            new_child->children.push_back(std::move(child->children[j]));
+        }
+        child->keys.resize(degree - 1);
+        child->children.resize(degree);
     }
-    
-    if (!child->is_leaf) {
-        new_child->children.push_back(std::move(child->children[2 * degree - 1]));
-    }
-    
-    child->keys.resize(degree - 1);
-    child->children.resize(degree);
-    
+
     parent->children.insert(parent->children.begin() + index + 1, std::move(new_child));
-    parent->keys.insert(parent->keys.begin() + index, child->keys[degree - 1]);
+    parent->keys.insert(parent->keys.begin() + index, separator);
+    num_nodes++;
 }
 
 template<typename Key, typename Value>
-void BTree<Key, Value>::insert_non_full(BTreeNode<Key, Value>* node, const Key& key, const Value& value) {
-    int i = node->keys.size() - 1;
-    
+void BTree<Key, Value>::insert_non_full(Node* node, const Key& key, const Value& value) {
     if (node->is_leaf) {
-        node->keys.push_back(key);
-        node->values.push_back(value);
-        
-        while (i >= 0 && key < node->keys[i]) {
-            node->keys[i + 1] = node->keys[i];
-            node->values[i + 1] = node->values[i];
-            i--;
-        }
-        node->keys[i + 1] = key;
-        node->values[i + 1] = value;
-    } else {
-        while (i >= 0 && key < node->keys[i]) {
-            i--;
+        auto it = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+        size_t pos = it - node->keys.begin();
+        if (it != node->keys.end() && !(key < *it)) {
+            node->values[pos] = value;
+            return;
         }
-        i++;
-        
-        if (node->children[i]->keys.size() == 2 * degree - 1) {
-            split_child(node, i, node->children[i].get());
-            if (key > node->keys[i]) {
-                i++;
-            }
+        node->keys.insert(it, key);
+        node->values.insert(node->values.begin() + pos, value);
+        num_entries++;
+        return;
+    }
+
+    size_t i = std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+    if (node->children[i]->keys.size() == 2 * degree - 1) {
+        split_child(node, i, node->children[i].get());
+        if (!(key < node->keys[i])) {
+            i++;
         }
-        insert_non_full(node->children[i].get(), key, value);
     }
+    insert_non_full(node->children[i].get(), key, value);
+}
+
+template<typename Key, typename Value>
+const BTreeNode<Key, Value>* BTree<Key, Value>::find_leaf(const Key& key) const {
+    const Node* current = root.get();
+    while (!current->is_leaf) {
+        size_t i = std::upper_bound(current->keys.begin(), current->keys.end(), key) - current->keys.begin();
+        current = current->children[i].get();
+    }
+    return current;
+}
+
+template<typename Key, typename Value>
+const BTreeNode<Key, Value>* BTree<Key, Value>::first_leaf() const {
+    const Node* current = root.get();
+    while (!current->is_leaf) {
+        current = current->children.front().get();
+    }
+    return current;
+}
+
+template<typename Key, typename Value>
+const BTreeNode<Key, Value>* BTree<Key, Value>::last_leaf() const {
+    const Node* current = root.get();
+    while (!current->is_leaf) {
+        current = current->children.back().get();
+    }
+    return current;
 }
 
 template<typename Key, typename Value>
 std::optional<Value> BTree<Key, Value>::search(const Key& key) const {
-    BTreeNode<Key, Value>* current = root.get();
-    while (current != nullptr) {
-        auto it = std::lower_bound(current->keys.begin(), current->keys.end(), key);
-        if (it != current->keys.end() && *it == key) {
-            return current->values[it - current->keys.begin()];
+    const Node* leaf = find_leaf(key);
+    auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
+    if (it != leaf->keys.end() && !(key < *it)) {
+        return leaf->values[it - leaf->keys.begin()];
+    }
+    return std::nullopt;
+}
+
+template<typename Key, typename Value>
+bool BTree<Key, Value>::remove(const Key& key) {
+    bool removed = remove_from(root.get(), key);
+    if (!root->is_leaf && root->keys.empty()) {
+        // The root's last two children were merged; the tree shrinks by a level
+        root = std::move(root->children.front());
+        num_nodes--;
+        num_levels--;
+    }
+    return removed;
+}
+
+template<typename Key, typename Value>
+bool BTree<Key, Value>::remove_from(Node* node, const Key& key) {
+    if (node->is_leaf) {
+        auto it = std::lower_bound(node->keys.begin(), node->keys.end(), key);
+        if (it == node->keys.end() || key < *it) {
+            return false;
+        }
+        node->values.erase(node->values.begin() + (it - node->keys.begin()));
+        node->keys.erase(it);
+        num_entries--;
+        return true;
+    }
+
+    // Separators left behind by removed keys are still valid bounds
+    size_t i = std::upper_bound(node->keys.begin(), node->keys.end(), key) - node->keys.begin();
+    bool removed = remove_from(node->children[i].get(), key);
+    if (removed && node->children[i]->keys.size() < degree - 1) {
+        rebalance(node, i);
+    }
+    return removed;
+}
+
+template<typename Key, typename Value>
+void BTree<Key, Value>::rebalance(Node* parent, size_t index) {
+    Node* child = parent->children[index].get();
+    Node* left = index > 0 ? parent->children[index - 1].get() : nullptr;
+    Node* right = index + 1 < parent->children.size() ? parent->children[index + 1].get() : nullptr;
+
+    if (left != nullptr && left->keys.size() > degree - 1) {
+        // Borrow the left sibling's last entry
+        if (child->is_leaf) {
+            child->keys.insert(child->keys.begin(), std::move(left->keys.back()));
+            child->values.insert(child->values.begin(), std::move(left->values.back()));
+            left->keys.pop_back();
+            left->values.pop_back();
+            parent->keys[index - 1] = child->keys.front();
+        } else {
+            child->keys.insert(child->keys.begin(), std::move(parent->keys[index - 1]));
+            parent->keys[index - 1] = std::move(left->keys.back());
+            left->keys.pop_back();
+            child->children.insert(child->children.begin(), std::move(left->children.back()));
+            left->children.pop_back();
         }
-        if (current->is_leaf) {
-            return std::nullopt;
+    } else if (right != nullptr && right->keys.size() > degree - 1) {
+        // Borrow the right sibling's first entry
+        if (child->is_leaf) {
+            child->keys.push_back(std::move(right->keys.front()));
+            child->values.push_back(std::move(right->values.front()));
+            right->keys.erase(right->keys.begin());
+            right->values.erase(right->values.begin());
+            parent->keys[index] = right->keys.front();
+        } else {
+            child->keys.push_back(std::move(parent->keys[index]));
+            parent->keys[index] = std::move(right->keys.front());
+            right->keys.erase(right->keys.begin());
+            child->children.push_back(std::move(right->children.front()));
+            right->children.erase(right->children.begin());
         }
-        current = current->children[it - current->keys.begin()].get();
+    } else if (left != nullptr) {
+        merge_children(parent, index - 1);
+    } else if (right != nullptr) {
+        merge_children(parent, index);
     }
-    return std::nullopt;
 }
 
-} // namespace nexusdb
\ No newline at end of file
+// Folds parent->children[index + 1] into parent->children[index]
+template<typename Key, typename Value>
+void BTree<Key, Value>::merge_children(Node* parent, size_t index) {
+    Node* left = parent->children[index].get();
+    Node* right = parent->children[index + 1].get();
+
+    if (left->is_leaf) {
+        left->next = right->next;
+        if (right->next != nullptr) {
+            right->next->prev = left;
+        }
+    } else {
+        left->keys.push_back(std::move(parent->keys[index]));
+        for (auto& child : right->children) {
+            left->children.push_back(std::move(child));
+        }
+    }
+    left->keys.insert(left->keys.end(), std::make_move_iterator(right->keys.begin()), std::make_move_iterator(right->keys.end()));
+    left->values.insert(left->values.end(), std::make_move_iterator(right->values.begin()), std::make_move_iterator(right->values.end()));
+
+    parent->keys.erase(parent->keys.begin() + index);
+    parent->children.erase(parent->children.begin() + index + 1);
+    num_nodes--;
+}
+
+template<typename Key, typename Value>
+typename BTree<Key, Value>::Iterator BTree<Key, Value>::begin() const {
+    return Iterator(this, first_leaf(), 0);
+}
+
+template<typename Key, typename Value>
+typename BTree<Key, Value>::Iterator BTree<Key, Value>::end() const {
+    return Iterator(this, nullptr, 0);
+}
+
+template<typename Key, typename Value>
+typename BTree<Key, Value>::Iterator BTree<Key, Value>::lower_bound(const Key& key) const {
+    const Node* leaf = find_leaf(key);
+    size_t index = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin();
+    return Iterator(this, leaf, index);
+}
+
+template<typename Key, typename Value>
+typename BTree<Key, Value>::Iterator BTree<Key, Value>::upper_bound(const Key& key) const {
+    const Node* leaf = find_leaf(key);
+    size_t index = std::upper_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin();
+    return Iterator(this, leaf, index);
+}
+
+template<typename Key, typename Value>
+void BTree<Key, Value>::traverse(const std::function<void(const Key&, const Value&)>& visitor) const {
+    for (const Node* leaf = first_leaf(); leaf != nullptr; leaf = leaf->next) {
+        for (size_t i = 0; i < leaf->keys.size(); i++) {
+            visitor(leaf->keys[i], leaf->values[i]);
+        }
+    }
+}
+
+// Explicit instantiation for the index type used by IndexManager
+template class BTree<std::string, std::vector<uint64_t>>;
+
+} // namespace nexusdb
@@ -3,6 +3,10 @@
 #include <stdexcept>
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <limits>
 
 #ifdef _WIN32
@@ -29,6 +33,9 @@ std::optional<std::string> BufferManager::initialize() {
         std::lock_guard<std::mutex> lock(mutex_);
         size_t buffer_size = determine_buffer_size();
         current_size_ = 0;  // Start with 0 and grow as needed
+        if (!config_.data_directory.empty()) {
+            file_manager_ = std::make_unique<FileManager>(config_.data_directory);
+        }
         LOG_INFO("Buffer Manager initialized successfully with max size: " + std::to_string(buffer_size) + " bytes");
         return std::nullopt;
     } catch (const std::exception& e) {
@@ -40,22 +47,23 @@ std::optional<std::string> BufferManager::initialize() {
 void BufferManager::shutdown() {
     LOG_INFO("Shutting down Buffer Manager...");
     std::lock_guard<std::mutex> lock(mutex_);
-    flush_all_pages();
-    buffer_.clear();
+    flush_all_pages_locked();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.pages.clear();
+    }
     current_size_ = 0;
     LOG_INFO("Buffer Manager shut down successfully");
 }
 
 size_t BufferManager::get_buffer_size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return current_size_;
+    return current_size_.load(std::memory_order_relaxed);
 }
 
 std::optional<std::string> BufferManager::resize_buffer(size_t new_size) {
     try {
         std::lock_guard<std::mutex> lock(mutex_);
-        while (current_size_ > new_size) {
-            evict_page();
+        while (current_size_ > new_size && evict_page()) {
         }
         LOG_INFO("Buffer resized to: " + std::to_string(new_size) + " bytes");
         return std::nullopt;
@@ -66,17 +74,26 @@ std::optional<std::string> BufferManager::resize_buffer(size_t new_size) {
 }
 
 std::shared_ptr<Page> BufferManager::get_page(const std::string& table_name, uint64_t page_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto& table_buffer = buffer_[table_name];
-    auto it = table_buffer.find(page_id);
-
-    if (it != table_buffer.end()) {
-        // Page is in buffer
-        it->second.last_access_time = ++access_counter_;
-        return it->second.page;
+    Shard& shard = shard_for(table_name, page_id);
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        if (CacheEntry* entry = find_entry(shard, table_name, page_id)) {
+            // Page is in buffer
+            entry->last_access_time = ++access_counter_;
+            return entry->page;
+        }
     }
 
-    // Page is not in buffer, need to load it
+    // Page is not in buffer, need to load it. Misses are serialized so that
+    // two threads never load the same page twice.
+    std::lock_guard<std::mutex> lock(mutex_);
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        if (CacheEntry* entry = find_entry(shard, table_name, page_id)) {
+            entry->last_access_time = ++access_counter_;
+            return entry->page;
+        }
+    }
     auto page = read_page_from_disk(table_name, page_id);
     if (!page) {
         LOG_ERROR("Failed to read page from disk: " + table_name + ", page_id: " + std::to_string(page_id));
@@ -89,58 +106,243 @@ std::shared_ptr<Page> BufferManager::get_page(const std::string& table_name, uin
     }
 
     // Add new page to buffer
-    table_buffer[page_id] = {page, false, ++access_counter_};
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.pages[table_name][page_id] = {page, false, ++access_counter_};
+    }
     current_size_ += Page::PAGE_SIZE;
 
     return page;
 }
 
 void BufferManager::release_page(const std::string& table_name, uint64_t page_id) {
+    flush_page(table_name, page_id);
+}
+
+void BufferManager::flush_page(const std::string& table_name, uint64_t page_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto flush_result = flush_pages_locked(table_name, {page_id});
+    if (flush_result.has_value()) {
+        LOG_ERROR(*flush_result);
+    }
+}
+
+void BufferManager::flush_all_pages() {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto& table_buffer = buffer_[table_name];
-    auto it = table_buffer.find(page_id);
+    flush_all_pages_locked();
+}
 
-    if (it != table_buffer.end()) {
-        if (it->second.is_dirty) {
-            write_page_to_disk(table_name, page_id, *(it->second.page));
-            it->second.is_dirty = false;
+void BufferManager::flush_all_pages_locked() {
+    std::unordered_map<std::string, std::vector<uint64_t>> tables;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        for (const auto& table_entry : shard.pages) {
+            auto& page_ids = tables[table_entry.first];
+            for (const auto& page_entry : table_entry.second) {
+                page_ids.push_back(page_entry.first);
+            }
+        }
+    }
+    for (const auto& table_entry : tables) {
+        auto flush_result = flush_pages_locked(table_entry.first, table_entry.second);
+        if (flush_result.has_value()) {
+            LOG_ERROR(*flush_result);
         }
     }
 }
 
-void BufferManager::flush_page(const std::string& table_name, uint64_t page_id) {
+std::optional<std::string> BufferManager::flush_file(const std::string& table_name) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto& table_buffer = buffer_[table_name];
-    auto it = table_buffer.find(page_id);
+    return flush_pages_locked(table_name, cached_page_ids(table_name));
+}
 
-    if (it != table_buffer.end() && it->second.is_dirty) {
-        write_page_to_disk(table_name, page_id, *(it->second.page));
-        it->second.is_dirty = false;
+std::optional<std::string> BufferManager::flush_pages_locked(const std::string& table_name, const std::vector<uint64_t>& page_ids) {
+    // Entries stay put while mutex_ is held. Dirty flags are cleared as the
+    // pages are picked, so a page marked dirty again during the write is
+    // written by the next flush; they are set again if this one fails.
+    std::vector<std::pair<uint64_t, CacheEntry*>> dirty;
+    for (uint64_t page_id : page_ids) {
+        Shard& shard = shard_for(table_name, page_id);
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        CacheEntry* entry = find_entry(shard, table_name, page_id);
+        if (entry != nullptr && entry->is_dirty) {
+            entry->is_dirty = false;
+            dirty.emplace_back(page_id, entry);
+        }
+    }
+    if (dirty.empty() || !file_manager_) {
+        return std::nullopt;  // Nothing to write, or a memory-only pool
+    }
+    auto keep_dirty = [&]() {
+        for (const auto& [page_id, entry] : dirty) {
+            std::lock_guard<std::mutex> shard_lock(shard_for(table_name, page_id).mutex);
+            entry->is_dirty = true;
+        }
+    };
+
+    if (force_log_) {
+        auto force_result = force_log_();
+        if (force_result.has_value()) {
+            keep_dirty();
+            return "Failed to force the log before writing " + table_name + ": " + *force_result;
+        }
+    }
+
+    // Journal layout: magic, page count, then each page id and its contents
+    std::string journal;
+    journal.reserve(sizeof(uint32_t) + sizeof(uint64_t) + dirty.size() * (sizeof(uint64_t) + Page::PAGE_SIZE));
+    uint64_t count = dirty.size();
+    journal.append(reinterpret_cast<const char*>(&JOURNAL_MAGIC), sizeof(JOURNAL_MAGIC));
+    journal.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const auto& [page_id, entry] : dirty) {
+        journal.append(reinterpret_cast<const char*>(&page_id), sizeof(page_id));
+        journal.append(entry->page->get_data(), Page::PAGE_SIZE);
+    }
+    std::string journal_path = get_journal_path(table_name);
+    if (!FileManager::write_file_durably(journal_path, journal)) {
+        keep_dirty();
+        return "Failed to write flush journal of " + table_name;
+    }
+
+    // Past this point a crash leaves the journal to finish the writes
+    for (const auto& [page_id, entry] : dirty) {
+        if (!write_page_to_disk(table_name, page_id, *entry->page)) {
+            keep_dirty();
+            return "Failed to write page " + std::to_string(page_id) + " of " + table_name;
+        }
     }
+    if (!file_manager_->sync_file(table_name)) {
+        keep_dirty();
+        return "Failed to sync " + table_name;
+    }
+    // Removing the journal need not be forced: until the next flush replaces
+    // it, replaying it only rewrites what the file already holds
+    std::remove(journal_path.c_str());
+    return std::nullopt;
 }
 
-void BufferManager::flush_all_pages() {
+std::optional<std::string> BufferManager::recover_file(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_manager_) {
+        return std::nullopt;
+    }
+    std::string journal_path = get_journal_path(table_name);
+    std::string journal;
+    {
+        std::ifstream journal_file(journal_path, std::ios::binary);
+        if (!journal_file.is_open()) {
+            return std::nullopt;  // The last flush finished
+        }
+        journal.assign(std::istreambuf_iterator<char>(journal_file), std::istreambuf_iterator<char>());
+    }
+
+    // The journal is renamed into place whole, so a bad one is corruption
+    // rather than a torn write
+    uint32_t magic = 0;
+    uint64_t count = 0;
+    const size_t header_size = sizeof(magic) + sizeof(count);
+    if (journal.size() >= header_size) {
+        std::memcpy(&magic, journal.data(), sizeof(magic));
+        std::memcpy(&count, journal.data() + sizeof(magic), sizeof(count));
+    }
+    if (magic != JOURNAL_MAGIC || journal.size() != header_size + count * (sizeof(uint64_t) + Page::PAGE_SIZE)) {
+        return "Corrupt flush journal: " + journal_path;
+    }
+
+    if (!file_manager_->open_file(table_name) && !file_manager_->create_file(table_name)) {
+        return "Failed to open " + table_name + " to replay its flush journal";
+    }
+    const char* cursor = journal.data() + header_size;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t page_id;
+        std::memcpy(&page_id, cursor, sizeof(page_id));
+        cursor += sizeof(page_id);
+        if (!write_page_to_disk(table_name, page_id, Page(page_id, cursor))) {
+            return "Failed to replay flush journal of " + table_name;
+        }
+        cursor += Page::PAGE_SIZE;
+    }
+    if (!file_manager_->sync_file(table_name)) {
+        return "Failed to sync " + table_name;
+    }
+    std::remove(journal_path.c_str());
+    LOG_INFO("Replayed " + std::to_string(count) + " pages from the flush journal of " + table_name);
+    return std::nullopt;
+}
+
+void BufferManager::set_write_ahead(std::function<std::optional<std::string>()> force_log) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    force_log_ = std::move(force_log);
+}
+
+bool BufferManager::is_over_limit() const {
+    return current_size_.load(std::memory_order_relaxed) > determine_buffer_size();
+}
+
+void BufferManager::mark_dirty(const std::string& table_name, uint64_t page_id) {
+    Shard& shard = shard_for(table_name, page_id);
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    if (CacheEntry* entry = find_entry(shard, table_name, page_id)) {
+        entry->is_dirty = true;
+    }
+}
+
+std::shared_ptr<Page> BufferManager::allocate_page(const std::string& table_name) {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& table_entry : buffer_) {
-        for (auto& page_entry : table_entry.second) {
-            if (page_entry.second.is_dirty) {
-                write_page_to_disk(table_entry.first, page_entry.first, *(page_entry.second.page));
-                page_entry.second.is_dirty = false;
+    std::shared_ptr<Page> page;
+    if (file_manager_) {
+        auto new_page = file_manager_->allocate_page(table_name);
+        if (!new_page) {
+            if (!file_manager_->create_file(table_name) || !(new_page = file_manager_->allocate_page(table_name))) {
+                LOG_ERROR("Failed to allocate page in: " + table_name);
+                return nullptr;
             }
         }
+        page = std::make_shared<Page>(new_page->get_page_id());
+    } else {
+        page = std::make_shared<Page>(cached_page_ids(table_name).size());
+    }
+
+    if (current_size_ >= determine_buffer_size()) {
+        evict_page();
+    }
+    {
+        Shard& shard = shard_for(table_name, page->get_page_id());
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        shard.pages[table_name][page->get_page_id()] = {page, true, ++access_counter_};
+    }
+    current_size_ += Page::PAGE_SIZE;
+    return page;
+}
+
+void BufferManager::drop_file(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        auto it = shard.pages.find(table_name);
+        if (it != shard.pages.end()) {
+            current_size_ -= it->second.size() * Page::PAGE_SIZE;
+            shard.pages.erase(it);
+        }
+    }
+    if (file_manager_) {
+        file_manager_->close_file(table_name);
+        std::remove(get_journal_path(table_name).c_str());
     }
 }
 
 void BufferManager::invalidate_page(const std::string& table_name, uint64_t page_id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto& table_buffer = buffer_[table_name];
-    auto it = table_buffer.find(page_id);
+    auto flush_result = flush_pages_locked(table_name, {page_id});
+    if (flush_result.has_value()) {
+        LOG_ERROR(*flush_result);
+        return;
+    }
 
-    if (it != table_buffer.end()) {
-        if (it->second.is_dirty) {
-            write_page_to_disk(table_name, page_id, *(it->second.page));
-        }
-        table_buffer.erase(it);
+    Shard& shard = shard_for(table_name, page_id);
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    auto table_it = shard.pages.find(table_name);
+    if (table_it != shard.pages.end() && table_it->second.erase(page_id) != 0) {
         current_size_ -= Page::PAGE_SIZE;
     }
 }
@@ -172,41 +374,104 @@ size_t BufferManager::determine_buffer_size() const {
     return static_cast<size_t>(total_memory * config_.memory_usage_fraction);
 }
 
-void BufferManager::evict_page() {
-    std::string table_to_evict;
-    uint64_t page_to_evict = 0;
-    size_t oldest_access_time = std::numeric_limits<size_t>::max();
+BufferManager::Shard& BufferManager::shard_for(const std::string& table_name, uint64_t page_id) const {
+    size_t hash = std::hash<std::string>()(table_name) ^ (page_id * 0x9E3779B97F4A7C15ULL);
+    return shards_[hash % PAGE_TABLE_SHARDS];
+}
 
-    for (const auto& table_entry : buffer_) {
-        for (const auto& page_entry : table_entry.second) {
-            if (page_entry.second.last_access_time < oldest_access_time) {
-                oldest_access_time = page_entry.second.last_access_time;
-                table_to_evict = table_entry.first;
-                page_to_evict = page_entry.first;
-            }
+BufferManager::CacheEntry* BufferManager::find_entry(Shard& shard, const std::string& table_name, uint64_t page_id) {
+    auto table_it = shard.pages.find(table_name);
+    if (table_it == shard.pages.end()) {
+        return nullptr;
+    }
+    auto it = table_it->second.find(page_id);
+    return it != table_it->second.end() ? &it->second : nullptr;
+}
+
+std::vector<uint64_t> BufferManager::cached_page_ids(const std::string& table_name) const {
+    std::vector<uint64_t> page_ids;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex);
+        auto table_it = shard.pages.find(table_name);
+        if (table_it == shard.pages.end()) {
+            continue;
+        }
+        for (const auto& page_entry : table_it->second) {
+            page_ids.push_back(page_entry.first);
         }
     }
+    return page_ids;
+}
 
-    if (!table_to_evict.empty()) {
-        auto& page_entry = buffer_[table_to_evict][page_to_evict];
-        if (page_entry.is_dirty) {
-            write_page_to_disk(table_to_evict, page_to_evict, *(page_entry.page));
+// A dirty page may belong to an operation still in progress, so writing it
+// here could put half of a split on disk; it stays until the next flush and
+// the pool grows past its size meanwhile
+bool BufferManager::evict_page() {
+    while (true) {
+        Shard* victim_shard = nullptr;
+        std::string table_to_evict;
+        uint64_t page_to_evict = 0;
+        size_t oldest_access_time = std::numeric_limits<size_t>::max();
+
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> shard_lock(shard.mutex);
+            for (const auto& table_entry : shard.pages) {
+                for (const auto& page_entry : table_entry.second) {
+                    // Pages still referenced outside the pool are in use and stay put
+                    if (page_entry.second.page.use_count() > 1 || page_entry.second.is_dirty) {
+                        continue;
+                    }
+                    if (page_entry.second.last_access_time < oldest_access_time) {
+                        oldest_access_time = page_entry.second.last_access_time;
+                        victim_shard = &shard;
+                        table_to_evict = table_entry.first;
+                        page_to_evict = page_entry.first;
+                    }
+                }
+            }
+        }
+
+        if (victim_shard == nullptr) {
+            return false;
         }
-        buffer_[table_to_evict].erase(page_to_evict);
+        // A hit may have handed the page out since its shard was scanned
+        std::lock_guard<std::mutex> shard_lock(victim_shard->mutex);
+        CacheEntry* entry = find_entry(*victim_shard, table_to_evict, page_to_evict);
+        if (entry == nullptr || entry->page.use_count() > 1 || entry->is_dirty) {
+            continue;
+        }
+        victim_shard->pages[table_to_evict].erase(page_to_evict);
         current_size_ -= Page::PAGE_SIZE;
+        return true;
+    }
+}
+
+bool BufferManager::write_page_to_disk(const std::string& table_name, uint64_t page_id, const Page& page) {
+    LOG_DEBUG("Writing page to disk: " + table_name + ", page_id: " + std::to_string(page_id));
+    if (!file_manager_) {
+        return true;  // Memory-only pool
+    }
+    if (!file_manager_->write_page(table_name, page)) {
+        LOG_ERROR("Failed to write page to disk: " + table_name + ", page_id: " + std::to_string(page_id));
+        return false;
     }
+    return true;
 }
 
-void BufferManager::write_page_to_disk(const std::string& table_name, uint64_t page_id, const Page& page) {
-    // This is a placeholder. In a real implementation, you would write the page to disk.
-    LOG_INFO(std::to_string(page.get_page_id()));
-    LOG_INFO("Writing page to disk: " + table_name + ", page_id: " + std::to_string(page_id));
+std::string BufferManager::get_journal_path(const std::string& table_name) const {
+    return config_.data_directory + "/" + table_name + ".journal";
 }
 
 std::shared_ptr<Page> BufferManager::read_page_from_disk(const std::string& table_name, uint64_t page_id) {
-    // This is a placeholder. In a real implementation, you would read the page from disk.
-    LOG_INFO("Reading page from disk: " + table_name + ", page_id: " + std::to_string(page_id));
-    return std::make_shared<Page>(page_id);
+    LOG_DEBUG("Reading page from disk: " + table_name + ", page_id: " + std::to_string(page_id));
+    if (!file_manager_) {
+        return std::make_shared<Page>(page_id);
+    }
+    auto page = file_manager_->read_page(table_name, page_id);
+    if (!page) {
+        return nullptr;
+    }
+    return std::shared_ptr<Page>(std::move(page));
 }
 
 } // namespace nexusdb
\ No newline at end of file
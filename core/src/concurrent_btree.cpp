@@ -0,0 +1,589 @@
+#include "nexusdb/concurrent_btree.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace nexusdb {
+
+namespace {
+
+// Sizes of the fewest groups of at most max_group_size items that hold
+// count items, spread as evenly as possible
+std::vector<size_t> even_groups(size_t count, size_t max_group_size) {
+    size_t groups = (count + max_group_size - 1) / max_group_size;
+    std::vector<size_t> sizes(groups, count / groups);
+    for (size_t i = 0; i < count % groups; ++i) {
+        sizes[i]++;
+    }
+    return sizes;
+}
+
+} // namespace
+
+template<typename Key>
+ConcurrentBTree<Key>::ConcurrentBTree(size_t node_capacity)
+    : node_capacity_(std::max<size_t>(node_capacity, 3)),
+      root_(new Node(true, new Contents())),
+      num_entries_(0), height_(1), node_count_(1) {}
+
+template<typename Key>
+ConcurrentBTree<Key>::~ConcurrentBTree() {
+    free_subtree(root_.load(std::memory_order_relaxed));
+    epoch_.reclaim_all();
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::insert(const Key& key) {
+    auto guard = epoch_.pin();
+    for (size_t attempt = 0;; ++attempt) {
+        backoff(attempt);
+
+        Node* node = root_.load(std::memory_order_acquire);
+        uint64_t version;
+        if (!read_lock(node, version) || node != root_.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        Node* parent = nullptr;
+        uint64_t parent_version = 0;
+        bool restart = false;
+        while (true) {
+            const Contents* contents = node->contents.load(std::memory_order_acquire);
+
+            // Split full nodes on the way down so a split never has to
+            // propagate past the parent
+            if (contents->keys.size() >= node_capacity_) {
+                if (parent != nullptr && !upgrade_lock(parent, parent_version)) {
+                    restart = true;
+                    break;
+                }
+                if (!upgrade_lock(node, version)) {
+                    if (parent != nullptr) {
+                        write_unlock(parent);
+                    }
+                    restart = true;
+                    break;
+                }
+                if (parent == nullptr && node != root_.load(std::memory_order_acquire)) {
+                    write_unlock(node);
+                    restart = true;
+                    break;
+                }
+                split(parent, node);
+                write_unlock(node);
+                if (parent != nullptr) {
+                    write_unlock(parent);
+                }
+                restart = true;
+                break;
+            }
+
+            if (node->is_leaf) {
+                break;
+            }
+
+            size_t child_index = contents->upper_bound(key);
+            Node* child = contents->children[child_index];
+            uint64_t child_version;
+            if (!read_lock(child, child_version) || !validate(node, version)) {
+                restart = true;
+                break;
+            }
+            parent = node;
+            parent_version = version;
+            node = child;
+            version = child_version;
+        }
+        if (restart || !upgrade_lock(node, version)) {
+            continue;
+        }
+
+        const Contents* contents = node->contents.load(std::memory_order_relaxed);
+        auto it = contents->keys.begin() + contents->lower_bound(key);
+        if (it != contents->keys.end() && !(key < *it)) {
+            write_unlock(node);
+            return false;
+        }
+
+        auto updated = new Contents();
+        updated->keys.reserve(contents->keys.size() + 1);
+        updated->keys.assign(contents->keys.begin(), it);
+        updated->keys.push_back(key);
+        updated->keys.insert(updated->keys.end(), it, contents->keys.end());
+        replace_contents(node, updated);
+        write_unlock(node);
+        num_entries_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::remove(const Key& key) {
+    auto guard = epoch_.pin();
+    for (size_t attempt = 0;; ++attempt) {
+        backoff(attempt);
+
+        const Node* leaf;
+        uint64_t version;
+        if (!find_leaf(key, leaf, version)) {
+            continue;
+        }
+        Node* node = const_cast<Node*>(leaf);
+        if (!upgrade_lock(node, version)) {
+            continue;
+        }
+
+        const Contents* contents = node->contents.load(std::memory_order_relaxed);
+        auto it = contents->keys.begin() + contents->lower_bound(key);
+        if (it == contents->keys.end() || key < *it) {
+            write_unlock(node);
+            return false;
+        }
+
+        auto updated = new Contents();
+        updated->keys.reserve(contents->keys.size() - 1);
+        updated->keys.assign(contents->keys.begin(), it);
+        updated->keys.insert(updated->keys.end(), it + 1, contents->keys.end());
+        bool underfull = updated->keys.size() < min_keys();
+        replace_contents(node, updated);
+        write_unlock(node);
+        num_entries_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (underfull) {
+            rebalance_path(key);
+        }
+        return true;
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::contains(const Key& key) const {
+    auto guard = epoch_.pin();
+    for (size_t attempt = 0;; ++attempt) {
+        backoff(attempt);
+
+        const Node* leaf;
+        uint64_t version;
+        if (!find_leaf(key, leaf, version)) {
+            continue;
+        }
+        const Contents* contents = leaf->contents.load(std::memory_order_acquire);
+        bool found = std::binary_search(contents->keys.begin(), contents->keys.end(), key);
+        if (validate(leaf, version)) {
+            return found;
+        }
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::bulk_load(const std::vector<Key>& keys, double fill_factor) {
+    if (num_entries_.load(std::memory_order_relaxed) != 0 || height_.load(std::memory_order_relaxed) != 1) {
+        return false;
+    }
+    if (keys.empty()) {
+        return true;
+    }
+
+    size_t per_node = std::clamp<size_t>(static_cast<size_t>(node_capacity_ * fill_factor), 1, node_capacity_ - 1);
+
+    // Each level is a list of nodes with the smallest key below each one
+    std::vector<Node*> level;
+    std::vector<Key> low_keys;
+    size_t offset = 0;
+    Node* previous = nullptr;
+    for (size_t group : even_groups(keys.size(), per_node)) {
+        auto contents = new Contents();
+        contents->keys.assign(keys.begin() + offset, keys.begin() + offset + group);
+        Node* leaf = new Node(true, contents);
+        if (previous != nullptr) {
+            previous->next.store(leaf, std::memory_order_relaxed);
+        }
+        previous = leaf;
+        level.push_back(leaf);
+        low_keys.push_back(keys[offset]);
+        offset += group;
+    }
+    size_t nodes = level.size();
+    size_t levels = 1;
+
+    while (level.size() > 1) {
+        std::vector<Node*> parents;
+        std::vector<Key> parent_low_keys;
+        offset = 0;
+        for (size_t group : even_groups(level.size(), per_node + 1)) {
+            auto contents = new Contents();
+            contents->children.assign(level.begin() + offset, level.begin() + offset + group);
+            contents->keys.assign(low_keys.begin() + offset + 1, low_keys.begin() + offset + group);
+            parents.push_back(new Node(false, contents));
+            parent_low_keys.push_back(low_keys[offset]);
+            offset += group;
+        }
+        nodes += parents.size();
+        levels++;
+        level = std::move(parents);
+        low_keys = std::move(parent_low_keys);
+    }
+
+    free_subtree(root_.load(std::memory_order_relaxed));
+    root_.store(level.front(), std::memory_order_release);
+    num_entries_.store(keys.size(), std::memory_order_relaxed);
+    height_.store(levels, std::memory_order_relaxed);
+    node_count_.store(nodes, std::memory_order_relaxed);
+    return true;
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::scan(const std::optional<Key>& from, bool exclusive, const Visitor& visitor) const {
+    auto guard = epoch_.pin();
+    // After a restart the scan resumes just past the last key it visited
+    std::optional<Key> position = from;
+    bool skip_position = exclusive;
+
+    for (size_t attempt = 0;; ++attempt) {
+        backoff(attempt);
+
+        const Node* leaf;
+        uint64_t version;
+        if (!find_leaf(position, leaf, version)) {
+            continue;
+        }
+
+        while (true) {
+            const Contents* contents = leaf->contents.load(std::memory_order_acquire);
+            const Node* next = leaf->next.load(std::memory_order_acquire);
+            if (!validate(leaf, version)) {
+                break;
+            }
+
+            auto it = contents->keys.begin();
+            if (position.has_value()) {
+                it += skip_position ? contents->upper_bound(*position) : contents->lower_bound(*position);
+            }
+            for (; it != contents->keys.end(); ++it) {
+                if (!visitor(*it)) {
+                    return;
+                }
+                position = *it;
+                skip_position = true;
+            }
+
+            if (next == nullptr) {
+                return;
+            }
+            // The leaf just left may have taken keys from next while they
+            // were visited; moving on would then skip them, so restart
+            const Node* previous = leaf;
+            uint64_t previous_version = version;
+            leaf = next;
+            if (!read_lock(leaf, version) || !validate(previous, previous_version)) {
+                break;
+            }
+        }
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::read_lock(const Node* node, uint64_t& version) {
+    version = node->version.load(std::memory_order_acquire);
+    return (version & (LOCKED_BIT | OBSOLETE_BIT)) == 0;
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::validate(const Node* node, uint64_t version) {
+    return node->version.load(std::memory_order_acquire) == version;
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::upgrade_lock(Node* node, uint64_t version) {
+    return node->version.compare_exchange_strong(version, version + LOCKED_BIT, std::memory_order_acquire);
+}
+
+// Clears the lock bit and moves the version past every value a reader saw
+template<typename Key>
+void ConcurrentBTree<Key>::write_unlock(Node* node) {
+    node->version.fetch_add(LOCKED_BIT, std::memory_order_release);
+}
+
+// Unlocks a node that has been unlinked from the tree for good
+template<typename Key>
+void ConcurrentBTree<Key>::write_unlock_obsolete(Node* node) {
+    node->version.fetch_add(LOCKED_BIT | OBSOLETE_BIT, std::memory_order_release);
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::backoff(size_t attempt) {
+    if (attempt > 3) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::find_leaf(const std::optional<Key>& key, const Node*& leaf, uint64_t& version) const {
+    const Node* node = root_.load(std::memory_order_acquire);
+    if (!read_lock(node, version) || node != root_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    while (!node->is_leaf) {
+        const Contents* contents = node->contents.load(std::memory_order_acquire);
+        size_t child_index = 0;
+        if (key.has_value()) {
+            child_index = contents->upper_bound(*key);
+        }
+        const Node* child = contents->children[child_index];
+        uint64_t child_version;
+        if (!read_lock(child, child_version) || !validate(node, version)) {
+            return false;
+        }
+        node = child;
+        version = child_version;
+    }
+
+    leaf = node;
+    return true;
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::split(Node* parent, Node* node) {
+    const Contents* contents = node->contents.load(std::memory_order_relaxed);
+    size_t mid = contents->keys.size() / 2;
+
+    auto left = new Contents();
+    auto right = new Contents();
+    Key separator;
+    if (node->is_leaf) {
+        // Leaves keep every key, so the separator is a copy of the first key
+        // of the new right sibling
+        left->keys.assign(contents->keys.begin(), contents->keys.begin() + mid);
+        right->keys.assign(contents->keys.begin() + mid, contents->keys.end());
+        separator = right->keys.front();
+    } else {
+        // Internal nodes move their median key up
+        separator = contents->keys[mid];
+        left->keys.assign(contents->keys.begin(), contents->keys.begin() + mid);
+        left->children.assign(contents->children.begin(), contents->children.begin() + mid + 1);
+        right->keys.assign(contents->keys.begin() + mid + 1, contents->keys.end());
+        right->children.assign(contents->children.begin() + mid + 1, contents->children.end());
+    }
+
+    Node* sibling = new Node(node->is_leaf, right);
+    if (node->is_leaf) {
+        sibling->next.store(node->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    replace_contents(node, left);
+    if (node->is_leaf) {
+        node->next.store(sibling, std::memory_order_release);
+    }
+    node_count_.fetch_add(1, std::memory_order_relaxed);
+
+    if (parent == nullptr) {
+        auto root_contents = new Contents();
+        root_contents->keys.push_back(separator);
+        root_contents->children = {node, sibling};
+        root_.store(new Node(false, root_contents), std::memory_order_release);
+        node_count_.fetch_add(1, std::memory_order_relaxed);
+        height_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const Contents* parent_contents = parent->contents.load(std::memory_order_relaxed);
+    size_t position = parent_contents->upper_bound(separator);
+    auto updated = new Contents(*parent_contents);
+    updated->keys.insert(updated->keys.begin() + position, separator);
+    updated->children.insert(updated->children.begin() + position + 1, sibling);
+    replace_contents(parent, updated);
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::rebalance_path(const Key& key) {
+    for (size_t attempt = 0; attempt < MAX_REBALANCE_ATTEMPTS; ++attempt) {
+        Node* node = root_.load(std::memory_order_acquire);
+        uint64_t version;
+        if (!read_lock(node, version) || node != root_.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        bool restart = false;
+        while (!node->is_leaf && !restart) {
+            const Contents* contents = node->contents.load(std::memory_order_acquire);
+            size_t index = contents->upper_bound(key);
+            Node* child = contents->children[index];
+            uint64_t child_version;
+            if (!read_lock(child, child_version) || !validate(node, version)) {
+                restart = true;
+                break;
+            }
+
+            if (child->contents.load(std::memory_order_acquire)->keys.size() >= min_keys() || contents->children.size() < 2) {
+                node = child;
+                version = child_version;
+                continue;
+            }
+
+            size_t left_index = index + 1 < contents->children.size() ? index : index - 1;
+            Node* left = contents->children[left_index];
+            Node* right = contents->children[left_index + 1];
+            Node* sibling = left == child ? right : left;
+            uint64_t sibling_version;
+            if (!read_lock(sibling, sibling_version) || !validate(node, version)) {
+                restart = true;
+                break;
+            }
+
+            uint64_t left_version = left == child ? child_version : sibling_version;
+            uint64_t right_version = right == child ? child_version : sibling_version;
+            if (!upgrade_lock(node, version)) {
+                restart = true;
+                break;
+            }
+            if (!upgrade_lock(left, left_version)) {
+                write_unlock(node);
+                restart = true;
+                break;
+            }
+            if (!upgrade_lock(right, right_version)) {
+                write_unlock(left);
+                write_unlock(node);
+                restart = true;
+                break;
+            }
+
+            bool merged = merge_or_redistribute(node, left_index);
+            bool collapse = merged && node == root_.load(std::memory_order_relaxed) &&
+                            node->contents.load(std::memory_order_relaxed)->keys.empty();
+            if (collapse) {
+                // The root's last two children were merged; the tree shrinks by a level
+                root_.store(left, std::memory_order_release);
+                height_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            write_unlock(left);
+            if (merged) {
+                write_unlock_obsolete(right);
+                retire_node(right);
+            } else {
+                write_unlock(right);
+            }
+            if (collapse) {
+                write_unlock_obsolete(node);
+                retire_node(node);
+            } else {
+                write_unlock(node);
+            }
+
+            // Start over: the parent may now be underfull itself
+            restart = true;
+        }
+        if (!restart) {
+            return;
+        }
+    }
+}
+
+template<typename Key>
+bool ConcurrentBTree<Key>::merge_or_redistribute(Node* parent, size_t index) {
+    const Contents* parent_contents = parent->contents.load(std::memory_order_relaxed);
+    Node* left = parent_contents->children[index];
+    Node* right = parent_contents->children[index + 1];
+    const Contents* left_contents = left->contents.load(std::memory_order_relaxed);
+    const Contents* right_contents = right->contents.load(std::memory_order_relaxed);
+
+    // Internal nodes pull the separator down between the two key ranges
+    std::vector<Key> keys = left_contents->keys;
+    if (!left->is_leaf) {
+        keys.push_back(parent_contents->keys[index]);
+    }
+    keys.insert(keys.end(), right_contents->keys.begin(), right_contents->keys.end());
+    std::vector<Node*> children = left_contents->children;
+    children.insert(children.end(), right_contents->children.begin(), right_contents->children.end());
+
+    auto updated_parent = new Contents(*parent_contents);
+    // Merge only when the result leaves room, so the next insert does not split it again
+    if (keys.size() <= node_capacity_ * 3 / 4) {
+        auto merged = new Contents();
+        merged->keys = std::move(keys);
+        merged->children = std::move(children);
+        replace_contents(left, merged);
+        if (left->is_leaf) {
+            left->next.store(right->next.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        updated_parent->keys.erase(updated_parent->keys.begin() + index);
+        updated_parent->children.erase(updated_parent->children.begin() + index + 1);
+        replace_contents(parent, updated_parent);
+        return true;
+    }
+
+    size_t mid = keys.size() / 2;
+    auto new_left = new Contents();
+    auto new_right = new Contents();
+    new_left->keys.assign(keys.begin(), keys.begin() + mid);
+    if (left->is_leaf) {
+        new_right->keys.assign(keys.begin() + mid, keys.end());
+        updated_parent->keys[index] = new_right->keys.front();
+    } else {
+        new_right->keys.assign(keys.begin() + mid + 1, keys.end());
+        new_left->children.assign(children.begin(), children.begin() + mid + 1);
+        new_right->children.assign(children.begin() + mid + 1, children.end());
+        updated_parent->keys[index] = keys[mid];
+    }
+    replace_contents(left, new_left);
+    replace_contents(right, new_right);
+    replace_contents(parent, updated_parent);
+    return false;
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::retire_node(Node* node) {
+    epoch_.retire(const_cast<Contents*>(node->contents.load(std::memory_order_relaxed)));
+    epoch_.retire(node);
+    node_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::replace_contents(Node* node, Contents* contents) {
+    contents->seal();
+    const Contents* old = node->contents.exchange(contents, std::memory_order_acq_rel);
+    epoch_.retire(const_cast<Contents*>(old));
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::Contents::seal() {
+    prefixes.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        prefixes[i] = KeyPrefix<Key>::get(keys[i]);
+    }
+}
+
+// Keys before the first equal prefix are smaller and keys after the last
+// one larger, so only the tied range needs full comparisons
+template<typename Key>
+size_t ConcurrentBTree<Key>::Contents::lower_bound(const Key& key) const {
+    uint64_t prefix = KeyPrefix<Key>::get(key);
+    size_t begin = count_less(prefixes.data(), prefixes.size(), prefix);
+    size_t end = begin + count_less_equal(prefixes.data() + begin, prefixes.size() - begin, prefix);
+    return std::lower_bound(keys.begin() + begin, keys.begin() + end, key) - keys.begin();
+}
+
+template<typename Key>
+size_t ConcurrentBTree<Key>::Contents::upper_bound(const Key& key) const {
+    uint64_t prefix = KeyPrefix<Key>::get(key);
+    size_t begin = count_less(prefixes.data(), prefixes.size(), prefix);
+    size_t end = begin + count_less_equal(prefixes.data() + begin, prefixes.size() - begin, prefix);
+    return std::upper_bound(keys.begin() + begin, keys.begin() + end, key) - keys.begin();
+}
+
+template<typename Key>
+void ConcurrentBTree<Key>::free_subtree(Node* node) {
+    const Contents* contents = node->contents.load(std::memory_order_relaxed);
+    for (Node* child : contents->children) {
+        free_subtree(child);
+    }
+    delete contents;
+    delete node;
+}
+
+// Explicit instantiation for the (key, record id) entries of BTreeIndex
+template class ConcurrentBTree<std::pair<std::string, uint64_t>>;
+
+} // namespace nexusdb
@@ -1,5 +1,7 @@
 // File: src/distributed_storage_engine.cpp
 #include "nexusdb/distributed_storage_engine.h"
+#include "nexusdb/task_scheduler.h"
+#include "nexusdb/utils/logger.h"
 #include <algorithm>
 #include <random>
 #include <chrono>
@@ -108,14 +110,29 @@ std::optional<std::string> DistributedStorageEngine::delete_record(const std::st
 
 std::optional<QueryResult> DistributedStorageEngine::execute_distributed_query(const std::string& query, ConsistencyLevel consistency_level) {
     // For simplicity, we'll execute the query on all nodes and aggregate results
-    std::vector<std::future<QueryResult>> futures;
-    for (const auto& node : nodes_) {
-        futures.push_back(async_execute_query_on_node(query, node));
+    std::vector<NodeInfo> nodes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nodes = nodes_;
+    }
+
+    // Waiting on the group from a worker runs other tasks instead of
+    // blocking it, which waiting on futures would
+    std::vector<QueryResult> results(nodes.size());
+    TaskGroup group;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        group.run([this, &query, &nodes, &results, i]() {
+            results[i] = execute_query_on_node(query, nodes[i]);
+        });
+    }
+    auto error = group.wait();
+    if (error.has_value()) {
+        LOG_ERROR("Distributed query failed: " + *error);
+        return std::nullopt;
     }
 
     QueryResult aggregated_result;
-    for (auto& future : futures) {
-        auto result = future.get();
+    for (const auto& result : results) {
         // Aggregate results (this is a simplified version and may need more sophisticated logic)
         aggregated_result.rows.insert(aggregated_result.rows.end(), result.rows.begin(), result.rows.end());
     }
@@ -168,15 +185,13 @@ std::optional<std::string> DistributedStorageEngine::distribute_operation(const
     return std::nullopt;
 }
 
-std::future<QueryResult> DistributedStorageEngine::async_execute_query_on_node(const std::string& query, const NodeInfo& node) {
-    // In a real implementation, this would send the query to the node and return a future
+QueryResult DistributedStorageEngine::execute_query_on_node(const std::string& query, const NodeInfo& node) {
+    // In a real implementation, this would send the query to the node and wait for its rows
     // For now, we'll just simulate the execution
-    return std::async(std::launch::async, [this, query]() {
-        // Simulate query execution time
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        // For simplicity, we'll just return an empty QueryResult
-        return QueryResult{};
-    });
+    // Simulate query execution time
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // For simplicity, we'll just return an empty QueryResult
+    return QueryResult{};
 }
 
 } // namespace nexusdb
\ No newline at end of file
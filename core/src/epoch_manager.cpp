@@ -0,0 +1,162 @@
+#include "nexusdb/epoch_manager.h"
+#include <algorithm>
+
+namespace nexusdb {
+
+namespace {
+
+std::atomic<uint64_t> next_manager_id{1};
+
+} // namespace
+
+EpochManager::Guard::Guard(EpochManager* manager, ThreadRecord* record)
+    : manager_(manager), record_(record) {}
+
+EpochManager::Guard::Guard(Guard&& other) noexcept
+    : manager_(other.manager_), record_(other.record_) {
+    other.manager_ = nullptr;
+    other.record_ = nullptr;
+}
+
+EpochManager::Guard::~Guard() {
+    if (manager_ != nullptr) {
+        manager_->unpin(record_);
+    }
+}
+
+EpochManager::EpochManager()
+    : global_epoch_(0), records_(nullptr), id_(next_manager_id.fetch_add(1)) {}
+
+EpochManager::~EpochManager() {
+    reclaim_all();
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (auto& record : registry_) {
+        record->manager_alive.store(false, std::memory_order_release);
+    }
+}
+
+EpochManager::Guard EpochManager::pin() {
+    ThreadRecord* record = acquire_record();
+    if (record->nesting++ == 0) {
+        record->local_epoch.store(global_epoch_.load(std::memory_order_relaxed), std::memory_order_release);
+        // Publish the pin before any shared node is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    return Guard(this, record);
+}
+
+void EpochManager::unpin(ThreadRecord* record) {
+    if (--record->nesting == 0) {
+        record->local_epoch.store(INACTIVE_EPOCH, std::memory_order_release);
+    }
+}
+
+void EpochManager::retire(void* ptr, ReclaimFunction reclaim, void* context) {
+    ThreadRecord* record = acquire_record();
+    record->retired.push_back({ptr, reclaim, context, global_epoch_.load(std::memory_order_acquire)});
+
+    if (++record->retired_since_collect >= COLLECT_THRESHOLD) {
+        record->retired_since_collect = 0;
+        try_advance();
+        collect(record);
+    }
+}
+
+bool EpochManager::try_advance() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        uint64_t local = record->local_epoch.load(std::memory_order_acquire);
+        if (local != INACTIVE_EPOCH && local != epoch) {
+            return false;  // A pinned thread has not yet observed the current epoch
+        }
+    }
+
+    return global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+void EpochManager::collect() {
+    ThreadRecord* record = acquire_record();
+    try_advance();
+    collect(record);
+}
+
+void EpochManager::collect(ThreadRecord* record) {
+    // Anything retired two epochs ago can no longer be referenced by a pinned thread
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    auto safe_end = std::partition(record->retired.begin(), record->retired.end(),
+        [epoch](const RetiredPointer& retired) { return retired.epoch + 2 <= epoch; });
+
+    // Reclaim functions may retire more memory, so detach the batch first
+    std::vector<RetiredPointer> reclaimable(record->retired.begin(), safe_end);
+    record->retired.erase(record->retired.begin(), safe_end);
+
+    for (const auto& retired : reclaimable) {
+        retired.reclaim(retired.ptr, retired.context);
+    }
+}
+
+void EpochManager::reclaim_all() {
+    std::vector<RetiredPointer> reclaimable;
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        reclaimable.insert(reclaimable.end(), record->retired.begin(), record->retired.end());
+        record->retired.clear();
+        record->retired_since_collect = 0;
+    }
+
+    for (const auto& retired : reclaimable) {
+        retired.reclaim(retired.ptr, retired.context);
+    }
+}
+
+uint64_t EpochManager::get_epoch() const {
+    return global_epoch_.load(std::memory_order_acquire);
+}
+
+EpochManager::ThreadRecord* EpochManager::acquire_record() {
+    // Each thread keeps one record per manager; the shared_ptr keeps it valid
+    // for the thread even if the manager is destroyed first.
+    struct ThreadCache {
+        std::vector<std::pair<uint64_t, std::shared_ptr<ThreadRecord>>> entries;
+
+        ~ThreadCache() {
+            for (auto& entry : entries) {
+                entry.second->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local ThreadCache cache;
+
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+        if (it->first == id_) {
+            return it->second.get();
+        }
+        if (!it->second->manager_alive.load(std::memory_order_acquire)) {
+            it = cache.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+
+    // Reuse a record abandoned by an exited thread, including its pending retirements
+    for (auto& record : registry_) {
+        bool expected = false;
+        if (record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            cache.entries.emplace_back(id_, record);
+            return record.get();
+        }
+    }
+
+    auto record = std::make_shared<ThreadRecord>();
+    record->in_use.store(true, std::memory_order_relaxed);
+    record->next = records_.load(std::memory_order_relaxed);
+    records_.store(record.get(), std::memory_order_release);
+    registry_.push_back(record);
+    cache.entries.emplace_back(id_, record);
+    return record.get();
+}
+
+} // namespace nexusdb
@@ -2,6 +2,7 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cerrno>
+#include <fcntl.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -76,6 +77,7 @@ std::unique_ptr<Page> FileManager::read_page(const std::string& file_name, uint6
     file.read(page->get_data(), Page::PAGE_SIZE);
 
     if (file.gcount() != Page::PAGE_SIZE) {
+        file.clear();  // Keep the stream usable after reading past the end
         return nullptr; // Failed to read full page
     }
 
@@ -113,6 +115,70 @@ std::unique_ptr<Page> FileManager::allocate_page(const std::string& file_name) {
     return new_page;
 }
 
+bool FileManager::sync_file(const std::string& file_name) {
+    auto it = open_files_.find(file_name);
+    if (it != open_files_.end()) {
+        it->second.flush();
+    }
+
+    // The stream hides its descriptor, so sync through one of our own
+    return sync_path(get_file_path(file_name));
+}
+
+bool FileManager::delete_file(const std::string& file_name) {
+    close_file(file_name);
+    std::string full_path = get_file_path(file_name);
+    return std::remove(full_path.c_str()) == 0 || !file_exists(full_path);
+}
+
+bool FileManager::replace_file(const std::string& source, const std::string& target) {
+    if (!sync_file(source)) {
+        return false;
+    }
+    close_file(source);
+    close_file(target);
+    if (std::rename(get_file_path(source).c_str(), get_file_path(target).c_str()) != 0) {
+        return false;
+    }
+    return sync_path(data_directory_);
+}
+
+bool FileManager::sync_path(const std::string& path) {
+#ifdef _WIN32
+    // Directory entries cannot be forced on Windows; renames are journaled
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) {
+        return _access(path.c_str(), F_OK) == 0;
+    }
+    bool synced = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+#endif
+    return synced;
+}
+
+bool FileManager::write_file_durably(const std::string& path, const std::string& contents) {
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    if (!sync_path(temp_path) || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    size_t separator = path.find_last_of('/');
+    return sync_path(separator == std::string::npos ? std::string(".") : path.substr(0, separator));
+}
+
 std::string FileManager::get_file_path(const std::string& file_name) const {
     return data_directory_ + "/" + file_name;
 }
@@ -0,0 +1,644 @@
+#include "nexusdb/full_text_index.h"
+#include "nexusdb/task_scheduler.h"
+#include <algorithm>
+#include <cctype>
+
+namespace nexusdb {
+
+namespace {
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t get_varint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; offset < in.size(); shift += 7) {
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return value;
+}
+
+bool is_term_byte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+// Whether the phrase starts at some position, given each term's sorted positions
+bool phrase_holds(const FullTextQuery::Phrase& phrase, const std::function<const std::vector<uint32_t>&(size_t term)>& positions_of) {
+    if (phrase.terms.size() == 1) {
+        return true;
+    }
+    for (uint32_t start : positions_of(0)) {
+        bool found = true;
+        for (size_t i = 1; i < phrase.terms.size() && found; ++i) {
+            const auto& positions = positions_of(i);
+            found = std::binary_search(positions.begin(), positions.end(), start + phrase.offsets[i]);
+        }
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void SimpleTokenizer::tokenize(const std::string& text, const Visitor& visitor) const {
+    std::string term;
+    uint32_t position = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (is_term_byte(c)) {
+            if (term.size() < MAX_TERM_SIZE) {
+                term.push_back(static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+            }
+        } else if (!term.empty()) {
+            visitor(term, position++);
+            term.clear();
+        }
+    }
+}
+
+void TermPostings::append(uint64_t record_id, const std::vector<uint32_t>& positions) {
+    if (size_ % BLOCK_SIZE == 0) {
+        uint64_t base = skips_.empty() ? 0 : skips_.back().last;
+        skips_.push_back(Skip{base, base, data_.size()});
+    }
+    put_varint(data_, record_id - skips_.back().last);
+    put_varint(data_, positions.size());
+    uint32_t previous = 0;
+    for (uint32_t position : positions) {
+        put_varint(data_, position - previous);
+        previous = position;
+    }
+    skips_.back().last = record_id;
+    ++size_;
+}
+
+size_t TermPostings::memory_usage() const {
+    return data_.capacity() + skips_.capacity() * sizeof(Skip);
+}
+
+TermPostings::Cursor::Cursor(const TermPostings& postings) : postings_(&postings) {
+    enter_block(0);
+}
+
+void TermPostings::Cursor::next() {
+    decode();
+}
+
+void TermPostings::Cursor::seek(uint64_t target) {
+    if (!valid_ || record_id_ >= target) {
+        return;
+    }
+
+    const auto& skips = postings_->skips_;
+    if (skips[block_].last < target) {
+        // Gallop to a block that reaches target, then binary search the
+        // blocks jumped over
+        size_t low = block_ + 1;
+        size_t high = low;
+        size_t step = 1;
+        while (high < skips.size() && skips[high].last < target) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        high = std::min(high, skips.size());
+        auto first = std::partition_point(skips.begin() + low, skips.begin() + high, [&](const Skip& skip) { return skip.last < target; });
+        enter_block(first - skips.begin());
+    }
+    while (valid_ && record_id_ < target) {
+        decode();
+    }
+}
+
+void TermPostings::Cursor::enter_block(size_t block) {
+    const auto& skips = postings_->skips_;
+    block_ = block;
+    if (block_ >= skips.size()) {
+        valid_ = false;
+        return;
+    }
+    offset_ = skips[block_].offset;
+    block_end_ = block_ + 1 < skips.size() ? skips[block_ + 1].offset : postings_->data_.size();
+    record_id_ = skips[block_].base;
+    valid_ = true;
+    decode();
+}
+
+void TermPostings::Cursor::decode() {
+    if (offset_ >= block_end_) {
+        enter_block(block_ + 1);
+        return;
+    }
+    const auto& data = postings_->data_;
+    record_id_ += get_varint(data, offset_);
+    positions_.resize(get_varint(data, offset_));
+    uint32_t position = 0;
+    for (auto& value : positions_) {
+        position += static_cast<uint32_t>(get_varint(data, offset_));
+        value = position;
+    }
+}
+
+FullTextQuery FullTextQuery::parse(const std::string& query, const Tokenizer& tokenizer) {
+    FullTextQuery parsed;
+    Clause clause;
+    auto add_phrase = [&](const std::string& text) {
+        Phrase phrase;
+        uint32_t first = 0;
+        tokenizer.tokenize(text, [&](const std::string& term, uint32_t position) {
+            if (phrase.terms.empty()) {
+                first = position;
+            }
+            phrase.terms.push_back(term);
+            phrase.offsets.push_back(position - first);
+        });
+        if (!phrase.terms.empty()) {
+            clause.push_back(std::move(phrase));
+        }
+    };
+    auto end_clause = [&]() {
+        if (!clause.empty()) {
+            parsed.clauses_.push_back(std::move(clause));
+            clause.clear();
+        }
+    };
+
+    size_t i = 0;
+    while (i < query.size()) {
+        if (std::isspace(static_cast<unsigned char>(query[i]))) {
+            ++i;
+        } else if (query[i] == '"') {
+            size_t close = query.find('"', i + 1);
+            size_t end = close == std::string::npos ? query.size() : close;
+            add_phrase(query.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else {
+            size_t end = i;
+            while (end < query.size() && query[end] != '"' && !std::isspace(static_cast<unsigned char>(query[end]))) {
+                ++end;
+            }
+            std::string word = query.substr(i, end - i);
+            if (word == "OR") {
+                end_clause();
+            } else {
+                add_phrase(word);
+            }
+            i = end;
+        }
+    }
+    end_clause();
+    return parsed;
+}
+
+bool FullTextQuery::matches(const std::string& text, const Tokenizer& tokenizer) const {
+    std::unordered_map<std::string, std::vector<uint32_t>> positions;
+    tokenizer.tokenize(text, [&](const std::string& term, uint32_t position) {
+        positions[term].push_back(position);
+    });
+
+    for (const auto& clause : clauses_) {
+        bool holds = true;
+        for (const auto& phrase : clause) {
+            std::vector<const std::vector<uint32_t>*> term_positions;
+            for (const auto& term : phrase.terms) {
+                auto it = positions.find(term);
+                if (it == positions.end()) {
+                    break;
+                }
+                term_positions.push_back(&it->second);
+            }
+            if (term_positions.size() < phrase.terms.size() ||
+                !phrase_holds(phrase, [&](size_t term) -> const std::vector<uint32_t>& { return *term_positions[term]; })) {
+                holds = false;
+                break;
+            }
+        }
+        if (holds) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FullTextIndex::Segment::contains(uint64_t record_id) const {
+    return std::binary_search(record_ids.begin(), record_ids.end(), record_id);
+}
+
+FullTextIndex::FullTextIndex(std::shared_ptr<const Tokenizer> tokenizer)
+    : tokenizer_(tokenizer ? std::move(tokenizer) : std::make_shared<SimpleTokenizer>()) {}
+
+FullTextIndex::~FullTextIndex() {
+    wait_for_merges();
+}
+
+std::optional<std::string> FullTextIndex::insert(const std::string& key, uint64_t record_id) {
+    bool merge;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        merge = insert_locked(key, record_id);
+    }
+    if (merge) {
+        start_merge();
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> FullTextIndex::remove(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = records_.find(record_id);
+    if (it != records_.end() && it->second == std::hash<std::string>()(key)) {
+        remove_locked(record_id);
+    }
+    return std::nullopt;
+}
+
+std::vector<uint64_t> FullTextIndex::search(const std::string& key) const {
+    return match(key);
+}
+
+PostingList FullTextIndex::postings(const std::string& key) const {
+    return PostingList(match(key));
+}
+
+// Segments are sized by record count, so there is no fill factor to apply
+std::optional<std::string> FullTextIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double) {
+    bool merge = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!records_.empty()) {
+            return "Bulk load requires an empty index";
+        }
+        for (const auto& [text, record_id] : entries) {
+            merge = insert_locked(text, record_id) || merge;
+        }
+    }
+    if (merge) {
+        start_merge();
+    }
+    return std::nullopt;
+}
+
+void FullTextIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                         const std::optional<std::string>& upper, bool upper_inclusive,
+                         const ScanVisitor& visitor) const {
+    // Terms are visited from lower_bound(lower), so only an exclusive lower
+    // bound can still turn one away
+    auto past_upper = [&](const std::string& term) {
+        return upper.has_value() && (upper_inclusive ? *upper < term : !(term < *upper));
+    };
+    auto skipped = [&](const std::string& term) { return lower.has_value() && !lower_inclusive && term == *lower; };
+
+    // Terms are spread over the segments, so gather each term's records first
+    std::map<std::string, std::vector<uint64_t>> matches;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& segment : segments_) {
+            auto it = lower.has_value() ? segment->terms.lower_bound(*lower) : segment->terms.begin();
+            for (; it != segment->terms.end() && !past_upper(it->first); ++it) {
+                if (skipped(it->first)) {
+                    continue;
+                }
+                auto& record_ids = matches[it->first];
+                for (TermPostings::Cursor cursor(it->second); cursor.valid(); cursor.next()) {
+                    if (segment->deleted.count(cursor.record_id()) == 0) {
+                        record_ids.push_back(cursor.record_id());
+                    }
+                }
+            }
+        }
+        auto it = lower.has_value() ? buffer_terms_.lower_bound(*lower) : buffer_terms_.begin();
+        for (; it != buffer_terms_.end() && !past_upper(it->first); ++it) {
+            if (skipped(it->first)) {
+                continue;
+            }
+            auto& record_ids = matches[it->first];
+            for (const auto& [record_id, positions] : it->second) {
+                record_ids.push_back(record_id);
+            }
+        }
+    }
+
+    for (auto& [term, record_ids] : matches) {
+        std::sort(record_ids.begin(), record_ids.end());
+        for (uint64_t record_id : record_ids) {
+            if (!visitor(term, record_id)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t FullTextIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return records_.size();
+}
+
+size_t FullTextIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return segments_.size() + (buffer_records_.empty() ? 0 : 1);
+}
+
+std::vector<uint64_t> FullTextIndex::match(const std::string& query) const {
+    FullTextQuery parsed = FullTextQuery::parse(query, *tokenizer_);
+    std::vector<uint64_t> record_ids;
+    if (parsed.empty()) {
+        return record_ids;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& segment : segments_) {
+        evaluate(parsed, [&](const std::string& term) -> const TermPostings* {
+            auto it = segment->terms.find(term);
+            return it != segment->terms.end() ? &it->second : nullptr;
+        }, &segment->deleted, record_ids);
+    }
+    if (!buffer_records_.empty()) {
+        // Encode the query's terms from the buffer so it is searched like a segment
+        std::map<std::string, TermPostings> encoded;
+        evaluate(parsed, [&](const std::string& term) -> const TermPostings* {
+            auto cached = encoded.find(term);
+            if (cached != encoded.end()) {
+                return &cached->second;
+            }
+            auto it = buffer_terms_.find(term);
+            if (it == buffer_terms_.end()) {
+                return nullptr;
+            }
+            TermPostings& postings = encoded[term];
+            for (const auto& [record_id, positions] : it->second) {
+                postings.append(record_id, positions);
+            }
+            return &postings;
+        }, nullptr, record_ids);
+    }
+
+    std::sort(record_ids.begin(), record_ids.end());
+    record_ids.erase(std::unique(record_ids.begin(), record_ids.end()), record_ids.end());
+    return record_ids;
+}
+
+void FullTextIndex::wait_for_merges() const {
+    std::unique_lock<std::mutex> lock(merge_mutex_);
+    merge_done_.wait(lock, [&]() { return !merging_; });
+}
+
+bool FullTextIndex::insert_locked(const std::string& text, uint64_t record_id) {
+    uint64_t text_hash = std::hash<std::string>()(text);
+    auto existing = records_.find(record_id);
+    if (existing != records_.end()) {
+        if (existing->second == text_hash) {
+            return false;
+        }
+        remove_locked(record_id);
+    }
+
+    std::map<std::string, std::vector<uint32_t>> term_positions;
+    tokenizer_->tokenize(text, [&](const std::string& term, uint32_t position) {
+        term_positions[term].push_back(position);
+    });
+    auto& terms = buffer_records_[record_id];
+    for (auto& [term, positions] : term_positions) {
+        std::sort(positions.begin(), positions.end());
+        buffer_terms_[term][record_id] = std::move(positions);
+        terms.push_back(term);
+    }
+    records_[record_id] = text_hash;
+
+    return buffer_records_.size() >= SEGMENT_RECORDS && freeze_buffer_locked();
+}
+
+void FullTextIndex::remove_locked(uint64_t record_id) {
+    auto buffered = buffer_records_.find(record_id);
+    if (buffered != buffer_records_.end()) {
+        for (const auto& term : buffered->second) {
+            auto it = buffer_terms_.find(term);
+            it->second.erase(record_id);
+            if (it->second.empty()) {
+                buffer_terms_.erase(it);
+            }
+        }
+        buffer_records_.erase(buffered);
+    } else {
+        for (const auto& segment : segments_) {
+            if (segment->contains(record_id)) {
+                segment->deleted.insert(record_id);
+            }
+        }
+    }
+    records_.erase(record_id);
+}
+
+bool FullTextIndex::freeze_buffer_locked() {
+    auto segment = std::make_shared<Segment>();
+    for (const auto& [term, records] : buffer_terms_) {
+        TermPostings& postings = segment->terms[term];
+        for (const auto& [record_id, positions] : records) {
+            postings.append(record_id, positions);
+        }
+    }
+    segment->record_ids.reserve(buffer_records_.size());
+    for (const auto& [record_id, terms] : buffer_records_) {
+        segment->record_ids.push_back(record_id);
+    }
+    std::sort(segment->record_ids.begin(), segment->record_ids.end());
+    segments_.push_back(std::move(segment));
+    buffer_terms_.clear();
+    buffer_records_.clear();
+    return !pick_merge_locked().empty();
+}
+
+std::vector<std::shared_ptr<FullTextIndex::Segment>> FullTextIndex::pick_merge_locked() const {
+    std::map<size_t, std::vector<std::shared_ptr<Segment>>> tiers;
+    for (const auto& segment : segments_) {
+        tiers[segment->merges].push_back(segment);
+    }
+    for (auto& [merges, segments] : tiers) {
+        if (segments.size() >= MERGE_FACTOR) {
+            segments.resize(MERGE_FACTOR);
+            return segments;
+        }
+    }
+    return {};
+}
+
+void FullTextIndex::start_merge() {
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        if (merging_) {
+            return;  // The running merge picks up new segments before it stops
+        }
+        merging_ = true;
+    }
+    TaskScheduler::get_instance().submit([this]() { run_merges(); }, TaskPriority::BACKGROUND);
+}
+
+// Merges tiers until none is full. Inputs are merged without the lock;
+// records deleted from them meanwhile are marked deleted in the result.
+void FullTextIndex::run_merges() {
+    while (true) {
+        std::vector<std::shared_ptr<Segment>> inputs;
+        std::vector<std::unordered_set<uint64_t>> deleted;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            inputs = pick_merge_locked();
+            if (inputs.empty()) {
+                std::lock_guard<std::mutex> merge_lock(merge_mutex_);
+                merging_ = false;
+                merge_done_.notify_all();
+                return;
+            }
+            for (const auto& input : inputs) {
+                deleted.push_back(input->deleted);
+            }
+        }
+
+        auto merged = merge_segments(inputs, deleted);
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            for (uint64_t record_id : inputs[i]->deleted) {
+                if (deleted[i].count(record_id) == 0) {
+                    merged->deleted.insert(record_id);
+                }
+            }
+            segments_.erase(std::find(segments_.begin(), segments_.end(), inputs[i]));
+        }
+        segments_.push_back(std::move(merged));
+    }
+}
+
+std::shared_ptr<FullTextIndex::Segment> FullTextIndex::merge_segments(const std::vector<std::shared_ptr<Segment>>& inputs,
+                                                                      const std::vector<std::unordered_set<uint64_t>>& deleted) {
+    auto merged = std::make_shared<Segment>();
+    merged->merges = inputs.front()->merges + 1;
+
+    // A live record is in one input only, so each term's records are a
+    // k-way merge of the inputs' cursors
+    std::map<std::string, std::vector<std::pair<size_t, const TermPostings*>>> terms;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        for (const auto& [term, postings] : inputs[i]->terms) {
+            terms[term].emplace_back(i, &postings);
+        }
+        for (uint64_t record_id : inputs[i]->record_ids) {
+            if (deleted[i].count(record_id) == 0) {
+                merged->record_ids.push_back(record_id);
+            }
+        }
+    }
+    std::sort(merged->record_ids.begin(), merged->record_ids.end());
+
+    for (const auto& [term, sources] : terms) {
+        std::vector<std::pair<size_t, TermPostings::Cursor>> cursors;
+        for (const auto& [input, postings] : sources) {
+            cursors.emplace_back(input, TermPostings::Cursor(*postings));
+        }
+        TermPostings postings;
+        while (true) {
+            size_t lowest = cursors.size();
+            for (size_t i = 0; i < cursors.size(); ++i) {
+                if (cursors[i].second.valid() &&
+                    (lowest == cursors.size() || cursors[i].second.record_id() < cursors[lowest].second.record_id())) {
+                    lowest = i;
+                }
+            }
+            if (lowest == cursors.size()) {
+                break;
+            }
+            auto& [input, cursor] = cursors[lowest];
+            if (deleted[input].count(cursor.record_id()) == 0) {
+                postings.append(cursor.record_id(), cursor.positions());
+            }
+            cursor.next();
+        }
+        if (postings.size() > 0) {
+            merged->terms.emplace(term, std::move(postings));
+        }
+    }
+    return merged;
+}
+
+void FullTextIndex::evaluate(const FullTextQuery& query, const std::function<const TermPostings*(const std::string&)>& lookup,
+                             const std::unordered_set<uint64_t>* deleted, std::vector<uint64_t>& out) {
+    for (const auto& clause : query.clauses()) {
+        // One cursor per distinct term of the clause
+        std::vector<std::string> terms;
+        std::vector<std::vector<size_t>> phrase_terms;
+        for (const auto& phrase : clause) {
+            std::vector<size_t> indexes;
+            for (const auto& term : phrase.terms) {
+                auto it = std::find(terms.begin(), terms.end(), term);
+                indexes.push_back(it - terms.begin());
+                if (it == terms.end()) {
+                    terms.push_back(term);
+                }
+            }
+            phrase_terms.push_back(std::move(indexes));
+        }
+        std::vector<const TermPostings*> lists;
+        for (const auto& term : terms) {
+            lists.push_back(lookup(term));
+        }
+        if (std::find(lists.begin(), lists.end(), nullptr) != lists.end()) {
+            continue;
+        }
+        std::vector<TermPostings::Cursor> cursors;
+        for (const auto* list : lists) {
+            cursors.emplace_back(*list);
+        }
+
+        // Leapfrog: the rarest term proposes a record and the others seek
+        // to it; any that overshoots moves the rarest one on instead
+        std::vector<size_t> order(cursors.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return lists[a]->size() < lists[b]->size(); });
+        TermPostings::Cursor& lead = cursors[order.front()];
+        bool exhausted = false;
+        while (lead.valid() && !exhausted) {
+            uint64_t candidate = lead.record_id();
+            bool aligned = true;
+            for (size_t k = 1; k < order.size(); ++k) {
+                auto& cursor = cursors[order[k]];
+                cursor.seek(candidate);
+                if (!cursor.valid()) {
+                    exhausted = true;
+                    aligned = false;
+                    break;
+                }
+                if (cursor.record_id() != candidate) {
+                    lead.seek(cursor.record_id());
+                    aligned = false;
+                    break;
+                }
+            }
+            if (!aligned) {
+                continue;
+            }
+
+            bool holds = deleted == nullptr || deleted->count(candidate) == 0;
+            for (size_t p = 0; p < clause.size() && holds; ++p) {
+                holds = phrase_holds(clause[p], [&](size_t term) -> const std::vector<uint32_t>& {
+                    return cursors[phrase_terms[p][term]].positions();
+                });
+            }
+            if (holds) {
+                out.push_back(candidate);
+            }
+            lead.next();
+        }
+    }
+}
+
+} // namespace nexusdb
@@ -0,0 +1,106 @@
+#include "nexusdb/geometry.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+
+namespace nexusdb {
+
+namespace {
+
+void skip_spaces(const char*& cursor, const char* end) {
+    while (cursor < end && std::isspace(static_cast<unsigned char>(*cursor))) {
+        ++cursor;
+    }
+}
+
+// Case-insensitive keyword or punctuation, after optional spaces
+bool read_literal(const char*& cursor, const char* end, const std::string& literal) {
+    skip_spaces(cursor, end);
+    if (static_cast<size_t>(end - cursor) < literal.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < literal.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(cursor[i])) != literal[i]) {
+            return false;
+        }
+    }
+    cursor += literal.size();
+    return true;
+}
+
+bool read_number(const char*& cursor, const char* end, double& value) {
+    skip_spaces(cursor, end);
+    char* number_end = nullptr;
+    errno = 0;
+    value = std::strtod(cursor, &number_end);
+    if (number_end == cursor || number_end > end || errno == ERANGE || !std::isfinite(value)) {
+        return false;
+    }
+    cursor = number_end;
+    return true;
+}
+
+std::optional<Rect> read_geometry(const char*& cursor, const char* end) {
+    if (read_literal(cursor, end, "POINT")) {
+        Point point;
+        if (!read_literal(cursor, end, "(") || !read_number(cursor, end, point.x) || !read_number(cursor, end, point.y) ||
+            !read_literal(cursor, end, ")")) {
+            return std::nullopt;
+        }
+        return Rect::of(point);
+    }
+    if (read_literal(cursor, end, "BOX")) {
+        Point first;
+        Point second;
+        if (!read_literal(cursor, end, "(") || !read_number(cursor, end, first.x) || !read_number(cursor, end, first.y) ||
+            !read_literal(cursor, end, ",") || !read_number(cursor, end, second.x) || !read_number(cursor, end, second.y) ||
+            !read_literal(cursor, end, ")")) {
+            return std::nullopt;
+        }
+        return Rect::of(first).united(Rect::of(second));
+    }
+    return std::nullopt;
+}
+
+std::string format(double value) {
+    std::ostringstream out;
+    out.precision(17);  // Enough digits to read every double back exactly
+    out << value;
+    return out.str();
+}
+
+} // namespace
+
+std::optional<Rect> parse_geometry(const std::string& text) {
+    const char* cursor = text.c_str();
+    const char* end = cursor + text.size();
+    auto rect = read_geometry(cursor, end);
+    skip_spaces(cursor, end);
+    return cursor == end ? rect : std::nullopt;
+}
+
+std::string encode_point(const Point& point) {
+    return "POINT(" + format(point.x) + " " + format(point.y) + ")";
+}
+
+std::string encode_box(const Rect& box) {
+    return "BOX(" + format(box.min_x) + " " + format(box.min_y) + "," + format(box.max_x) + " " + format(box.max_y) + ")";
+}
+
+std::optional<std::pair<Point, double>> parse_distance_query(const std::string& text) {
+    const char* cursor = text.c_str();
+    const char* end = cursor + text.size();
+    auto rect = read_geometry(cursor, end);
+    double radius;
+    if (!rect.has_value() || rect->area() != 0 || rect->margin() != 0 || !read_number(cursor, end, radius) || radius < 0) {
+        return std::nullopt;
+    }
+    skip_spaces(cursor, end);
+    if (cursor != end) {
+        return std::nullopt;
+    }
+    return std::make_pair(rect->center(), radius);
+}
+
+} // namespace nexusdb
@@ -0,0 +1,641 @@
+#include "nexusdb/hash_index.h"
+#include "nexusdb/utils/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace nexusdb {
+
+namespace {
+
+template<typename T>
+void put(char*& cursor, T value) {
+    std::memcpy(cursor, &value, sizeof(T));
+    cursor += sizeof(T);
+}
+
+template<typename T>
+T get(const char*& cursor) {
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+bool in_bounds(const std::string& key,
+               const std::optional<std::string>& lower, bool lower_inclusive,
+               const std::optional<std::string>& upper, bool upper_inclusive) {
+    if (lower.has_value() && (lower_inclusive ? key < *lower : !(*lower < key))) {
+        return false;
+    }
+    if (upper.has_value() && (upper_inclusive ? *upper < key : !(key < *upper))) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t LinearHashing::bucket_for(uint64_t hash) const {
+    uint64_t bucket = hash & ((INITIAL_BUCKETS << level) - 1);
+    if (bucket < next_split) {
+        bucket = hash & ((INITIAL_BUCKETS << (level + 1)) - 1);
+    }
+    return bucket;
+}
+
+void LinearHashing::advance() {
+    if (++next_split == (INITIAL_BUCKETS << level)) {
+        level++;
+        next_split = 0;
+    }
+}
+
+// FNV-1a, then a murmur-style finalizer so the low bits that pick the
+// bucket depend on every byte
+uint64_t LinearHashing::hash(const std::string& key) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (char byte : key) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001B3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+HashIndex::HashIndex() : buckets_(LinearHashing::INITIAL_BUCKETS), entry_count_(0) {}
+
+std::optional<std::string> HashIndex::insert(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Bucket& bucket = buckets_[addressing_.bucket_for(LinearHashing::hash(key))];
+    auto entry = std::make_pair(key, record_id);
+    if (std::find(bucket.begin(), bucket.end(), entry) != bucket.end()) {
+        return std::nullopt;
+    }
+    bucket.push_back(std::move(entry));
+    entry_count_++;
+    if (entry_count_ > MAX_LOAD * buckets_.size()) {
+        split();
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> HashIndex::remove(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Bucket& bucket = buckets_[addressing_.bucket_for(LinearHashing::hash(key))];
+    auto it = std::find(bucket.begin(), bucket.end(), std::make_pair(key, record_id));
+    if (it != bucket.end()) {
+        *it = std::move(bucket.back());
+        bucket.pop_back();
+        entry_count_--;
+    }
+    return std::nullopt;
+}
+
+std::vector<uint64_t> HashIndex::search(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<uint64_t> record_ids;
+    for (const auto& [entry_key, record_id] : buckets_[addressing_.bucket_for(LinearHashing::hash(key))]) {
+        if (entry_key == key) {
+            record_ids.push_back(record_id);
+        }
+    }
+    return record_ids;
+}
+
+PostingList HashIndex::postings(const std::string& key) const {
+    return PostingList(search(key));
+}
+
+std::optional<std::string> HashIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (entry_count_ != 0) {
+        return "Bulk load requires an empty index";
+    }
+
+    // Presize so the load itself never splits
+    double per_bucket = MAX_LOAD * std::clamp(fill_factor, 0.5, 1.0);
+    while (static_cast<double>(buckets_.size()) * per_bucket < static_cast<double>(entries.size())) {
+        split();
+    }
+    for (const auto& entry : entries) {
+        buckets_[addressing_.bucket_for(LinearHashing::hash(entry.first))].push_back(entry);
+    }
+    entry_count_ = entries.size();
+    return std::nullopt;
+}
+
+void HashIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                     const std::optional<std::string>& upper, bool upper_inclusive,
+                     const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& bucket : buckets_) {
+        for (const auto& [key, record_id] : bucket) {
+            if (in_bounds(key, lower, lower_inclusive, upper, upper_inclusive) && !visitor(key, record_id)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t HashIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entry_count_;
+}
+
+size_t HashIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return buckets_.size();
+}
+
+void HashIndex::split() {
+    uint64_t source = addressing_.next_split;
+    buckets_.emplace_back();
+    addressing_.advance();
+
+    Bucket& bucket = buckets_[source];
+    Bucket& target = buckets_.back();
+    auto moved = std::stable_partition(bucket.begin(), bucket.end(), [&](const auto& entry) {
+        return addressing_.bucket_for(LinearHashing::hash(entry.first)) == source;
+    });
+    target.assign(std::make_move_iterator(moved), std::make_move_iterator(bucket.end()));
+    bucket.erase(moved, bucket.end());
+}
+
+PagedHashIndex::PagedHashIndex(std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name)
+    : buffer_manager_(std::move(buffer_manager)), file_name_(file_name),
+      entry_count_(0), entry_bytes_(0), page_count_(0), free_list_head_(0) {}
+
+std::optional<std::string> PagedHashIndex::open() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto recover_result = buffer_manager_->recover_file(file_name_);
+    if (recover_result.has_value()) {
+        return "Failed to open index " + file_name_ + ": " + *recover_result;
+    }
+    try {
+        auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+        if (meta) {
+            const char* cursor = meta->get_data();
+            uint32_t magic = get<uint32_t>(cursor);
+            uint32_t version = get<uint32_t>(cursor);
+            if (magic == MAGIC) {
+                if (version != FORMAT_VERSION) {
+                    return "Unsupported hash index format version in " + file_name_;
+                }
+                addressing_.level = get<uint64_t>(cursor);
+                addressing_.next_split = get<uint64_t>(cursor);
+                entry_count_ = get<uint64_t>(cursor);
+                entry_bytes_ = get<uint64_t>(cursor);
+                page_count_ = get<uint64_t>(cursor);
+                free_list_head_ = get<uint64_t>(cursor);
+                uint64_t directory_head = get<uint64_t>(cursor);
+                directory_pages_.clear();
+                bucket_pages_.clear();
+                if (directory_head != 0) {
+                    directory_pages_.push_back(directory_head);
+                }
+                load_directory();
+                LOG_DEBUG("Opened hash index file " + file_name_ + " with " + std::to_string(entry_count_) + " entries");
+                return std::nullopt;
+            }
+            if (magic != 0) {
+                return "Not a hash index file: " + file_name_;
+            }
+        } else {
+            meta = buffer_manager_->allocate_page(file_name_);
+            if (!meta || meta->get_page_id() != META_PAGE_ID) {
+                return "Failed to create index file: " + file_name_;
+            }
+        }
+
+        addressing_ = LinearHashing();
+        for (uint64_t i = 0; i < LinearHashing::INITIAL_BUCKETS; ++i) {
+            add_bucket();
+        }
+        store_meta();
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        return "Failed to open index " + file_name_ + ": " + e.what();
+    }
+}
+
+std::optional<std::string> PagedHashIndex::flush() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    try {
+        store_meta();
+    } catch (const std::exception& e) {
+        return "Failed to flush index " + file_name_ + ": " + e.what();
+    }
+    return buffer_manager_->flush_file(file_name_);
+}
+
+std::optional<std::string> PagedHashIndex::insert(const std::string& key, uint64_t record_id) {
+    if (key.size() > MAX_KEY_SIZE) {
+        return "Index key exceeds " + std::to_string(MAX_KEY_SIZE) + " bytes";
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    try {
+        Entry entry{key, record_id};
+        size_t size = encoded_size(entry);
+
+        // Walk the whole chain to rule out a duplicate, remembering the
+        // first page with room
+        std::optional<BucketPage> target;
+        BucketPage last;
+        uint64_t page_id = bucket_pages_[addressing_.bucket_for(LinearHashing::hash(key))];
+        while (page_id != 0) {
+            BucketPage page = load_bucket_page(page_id);
+            size_t used = BUCKET_HEADER_SIZE;
+            for (const auto& existing : page.entries) {
+                if (existing == entry) {
+                    return std::nullopt;
+                }
+                used += encoded_size(existing);
+            }
+            if (!target.has_value() && used + size <= Page::PAGE_SIZE) {
+                target = page;
+            }
+            page_id = page.overflow;
+            last = std::move(page);
+        }
+
+        if (!target.has_value()) {
+            target = BucketPage();
+            target->page_id = allocate_page();
+            last.overflow = target->page_id;
+            store_bucket_page(last);
+        }
+        target->entries.push_back(std::move(entry));
+        store_bucket_page(*target);
+        entry_count_++;
+        entry_bytes_ += size;
+
+        if (needs_split()) {
+            split();
+        }
+        store_meta();
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index insert failed in " + file_name_ + ": " + e.what());
+        return "Index insert failed: " + std::string(e.what());
+    }
+}
+
+std::optional<std::string> PagedHashIndex::remove(const std::string& key, uint64_t record_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    try {
+        Entry entry{key, record_id};
+        std::optional<BucketPage> previous;
+        uint64_t page_id = bucket_pages_[addressing_.bucket_for(LinearHashing::hash(key))];
+        while (page_id != 0) {
+            BucketPage page = load_bucket_page(page_id);
+            auto it = std::find(page.entries.begin(), page.entries.end(), entry);
+            if (it == page.entries.end()) {
+                page_id = page.overflow;
+                previous = std::move(page);
+                continue;
+            }
+
+            page.entries.erase(it);
+            if (page.entries.empty() && previous.has_value()) {
+                // Unlink an emptied overflow page; the head page always stays
+                previous->overflow = page.overflow;
+                store_bucket_page(*previous);
+                free_page(page.page_id);
+            } else {
+                store_bucket_page(page);
+            }
+            entry_count_--;
+            entry_bytes_ -= encoded_size(entry);
+            store_meta();
+            return std::nullopt;
+        }
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index remove failed in " + file_name_ + ": " + e.what());
+        return "Index remove failed: " + std::string(e.what());
+    }
+}
+
+std::vector<uint64_t> PagedHashIndex::search(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<uint64_t> record_ids;
+    try {
+        uint64_t page_id = bucket_pages_[addressing_.bucket_for(LinearHashing::hash(key))];
+        while (page_id != 0) {
+            BucketPage page = load_bucket_page(page_id);
+            for (const auto& [entry_key, record_id] : page.entries) {
+                if (entry_key == key) {
+                    record_ids.push_back(record_id);
+                }
+            }
+            page_id = page.overflow;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index search failed in " + file_name_ + ": " + e.what());
+    }
+    return record_ids;
+}
+
+PostingList PagedHashIndex::postings(const std::string& key) const {
+    return PostingList(search(key));
+}
+
+std::optional<std::string> PagedHashIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (entry_count_ != 0) {
+        return "Bulk load requires an empty index";
+    }
+
+    try {
+        uint64_t total_bytes = 0;
+        for (const auto& entry : entries) {
+            if (entry.first.size() > MAX_KEY_SIZE) {
+                return "Index key exceeds " + std::to_string(MAX_KEY_SIZE) + " bytes";
+            }
+            total_bytes += encoded_size(entry);
+        }
+
+        // Splitting empty buckets is cheap, so grow the table first and
+        // then write every chain once
+        double per_bucket = (Page::PAGE_SIZE - BUCKET_HEADER_SIZE) * std::min(fill_factor, MAX_FILL);
+        while (static_cast<double>(addressing_.bucket_count()) * per_bucket < static_cast<double>(total_bytes)) {
+            split();
+        }
+
+        std::vector<std::vector<Entry>> buckets(addressing_.bucket_count());
+        for (const auto& entry : entries) {
+            buckets[addressing_.bucket_for(LinearHashing::hash(entry.first))].push_back(entry);
+        }
+        for (uint64_t bucket = 0; bucket < buckets.size(); ++bucket) {
+            if (!buckets[bucket].empty()) {
+                write_chain(bucket, buckets[bucket]);
+            }
+        }
+        entry_count_ = entries.size();
+        entry_bytes_ = total_bytes;
+        store_meta();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index bulk load failed in " + file_name_ + ": " + e.what());
+        return "Index bulk load failed: " + std::string(e.what());
+    }
+    return buffer_manager_->flush_file(file_name_);
+}
+
+void PagedHashIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                          const std::optional<std::string>& upper, bool upper_inclusive,
+                          const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    try {
+        for (uint64_t head : bucket_pages_) {
+            for (uint64_t page_id = head; page_id != 0;) {
+                BucketPage page = load_bucket_page(page_id);
+                for (const auto& [key, record_id] : page.entries) {
+                    if (in_bounds(key, lower, lower_inclusive, upper, upper_inclusive) && !visitor(key, record_id)) {
+                        return;
+                    }
+                }
+                page_id = page.overflow;
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index scan failed in " + file_name_ + ": " + e.what());
+    }
+}
+
+size_t PagedHashIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entry_count_;
+}
+
+size_t PagedHashIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return page_count_;
+}
+
+PagedHashIndex::BucketPage PagedHashIndex::load_bucket_page(uint64_t page_id) const {
+    auto page = buffer_manager_->get_page(file_name_, page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(page_id));
+    }
+
+    BucketPage bucket_page;
+    bucket_page.page_id = page_id;
+    const char* cursor = page->get_data();
+    uint16_t count = get<uint16_t>(cursor);
+    get<uint16_t>(cursor);
+    get<uint32_t>(cursor);
+    bucket_page.overflow = get<uint64_t>(cursor);
+    bucket_page.entries.resize(count);
+    for (auto& [key, record_id] : bucket_page.entries) {
+        uint16_t key_size = get<uint16_t>(cursor);
+        key.assign(cursor, key_size);
+        cursor += key_size;
+        record_id = get<uint64_t>(cursor);
+    }
+    return bucket_page;
+}
+
+void PagedHashIndex::store_bucket_page(const BucketPage& bucket_page) {
+    auto page = buffer_manager_->get_page(file_name_, bucket_page.page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(bucket_page.page_id));
+    }
+
+    char* cursor = page->get_data();
+    put<uint16_t>(cursor, static_cast<uint16_t>(bucket_page.entries.size()));
+    put<uint16_t>(cursor, 0);
+    put<uint32_t>(cursor, 0);
+    put<uint64_t>(cursor, bucket_page.overflow);
+    for (const auto& [key, record_id] : bucket_page.entries) {
+        put<uint16_t>(cursor, static_cast<uint16_t>(key.size()));
+        std::memcpy(cursor, key.data(), key.size());
+        cursor += key.size();
+        put<uint64_t>(cursor, record_id);
+    }
+    buffer_manager_->mark_dirty(file_name_, bucket_page.page_id);
+}
+
+std::vector<PagedHashIndex::BucketPage> PagedHashIndex::load_chain(uint64_t bucket) const {
+    std::vector<BucketPage> chain;
+    for (uint64_t page_id = bucket_pages_[bucket]; page_id != 0;) {
+        chain.push_back(load_bucket_page(page_id));
+        page_id = chain.back().overflow;
+    }
+    return chain;
+}
+
+void PagedHashIndex::write_chain(uint64_t bucket, const std::vector<Entry>& entries) {
+    std::vector<uint64_t> old_pages;
+    for (uint64_t page_id = bucket_pages_[bucket]; page_id != 0;) {
+        old_pages.push_back(page_id);
+        page_id = load_bucket_page(page_id).overflow;
+    }
+
+    std::vector<BucketPage> pages(1);
+    size_t used = BUCKET_HEADER_SIZE;
+    for (const auto& entry : entries) {
+        if (used + encoded_size(entry) > Page::PAGE_SIZE) {
+            pages.emplace_back();
+            used = BUCKET_HEADER_SIZE;
+        }
+        pages.back().entries.push_back(entry);
+        used += encoded_size(entry);
+    }
+
+    for (size_t i = 0; i < pages.size(); ++i) {
+        pages[i].page_id = i < old_pages.size() ? old_pages[i] : allocate_page();
+    }
+    for (size_t i = 0; i < pages.size(); ++i) {
+        pages[i].overflow = i + 1 < pages.size() ? pages[i + 1].page_id : 0;
+        store_bucket_page(pages[i]);
+    }
+    for (size_t i = pages.size(); i < old_pages.size(); ++i) {
+        free_page(old_pages[i]);
+    }
+}
+
+uint64_t PagedHashIndex::allocate_page() {
+    if (free_list_head_ != 0) {
+        uint64_t page_id = free_list_head_;
+        auto page = buffer_manager_->get_page(file_name_, page_id);
+        if (!page) {
+            throw std::runtime_error("failed to read free page " + std::to_string(page_id));
+        }
+        const char* cursor = page->get_data();
+        free_list_head_ = get<uint64_t>(cursor);
+        page_count_++;
+        return page_id;
+    }
+
+    auto page = buffer_manager_->allocate_page(file_name_);
+    if (!page) {
+        throw std::runtime_error("failed to allocate index page");
+    }
+    page_count_++;
+    return page->get_page_id();
+}
+
+// A free page holds only the id of the next free page
+void PagedHashIndex::free_page(uint64_t page_id) {
+    auto page = buffer_manager_->get_page(file_name_, page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(page_id));
+    }
+    char* cursor = page->get_data();
+    put<uint64_t>(cursor, free_list_head_);
+    buffer_manager_->mark_dirty(file_name_, page_id);
+    free_list_head_ = page_id;
+    page_count_--;
+}
+
+// Directory page layout: next directory page, then DIRECTORY_FANOUT bucket head pages
+void PagedHashIndex::add_bucket() {
+    uint64_t bucket = bucket_pages_.size();
+    BucketPage head;
+    head.page_id = allocate_page();
+    store_bucket_page(head);
+
+    if (bucket % DIRECTORY_FANOUT == 0) {
+        uint64_t directory_id = allocate_page();
+        auto directory = buffer_manager_->get_page(file_name_, directory_id);
+        if (!directory) {
+            throw std::runtime_error("failed to read page " + std::to_string(directory_id));
+        }
+        std::memset(directory->get_data(), 0, Page::PAGE_SIZE);
+        buffer_manager_->mark_dirty(file_name_, directory_id);
+
+        if (!directory_pages_.empty()) {
+            auto previous = buffer_manager_->get_page(file_name_, directory_pages_.back());
+            if (!previous) {
+                throw std::runtime_error("failed to read directory page");
+            }
+            char* cursor = previous->get_data();
+            put<uint64_t>(cursor, directory_id);
+            buffer_manager_->mark_dirty(file_name_, directory_pages_.back());
+        }
+        directory_pages_.push_back(directory_id);
+    }
+
+    uint64_t directory_id = directory_pages_[bucket / DIRECTORY_FANOUT];
+    auto directory = buffer_manager_->get_page(file_name_, directory_id);
+    if (!directory) {
+        throw std::runtime_error("failed to read directory page");
+    }
+    char* cursor = directory->get_data() + sizeof(uint64_t) * (1 + bucket % DIRECTORY_FANOUT);
+    put<uint64_t>(cursor, head.page_id);
+    buffer_manager_->mark_dirty(file_name_, directory_id);
+    bucket_pages_.push_back(head.page_id);
+}
+
+// Callers seed directory_pages_ with the head of the chain
+void PagedHashIndex::load_directory() {
+    uint64_t bucket_count = addressing_.bucket_count();
+    while (bucket_pages_.size() < bucket_count) {
+        size_t index = bucket_pages_.size() / DIRECTORY_FANOUT;
+        if (index >= directory_pages_.size()) {
+            throw std::runtime_error("hash index directory is truncated");
+        }
+        auto directory = buffer_manager_->get_page(file_name_, directory_pages_[index]);
+        if (!directory) {
+            throw std::runtime_error("failed to read directory page");
+        }
+        const char* cursor = directory->get_data();
+        uint64_t next = get<uint64_t>(cursor);
+        for (size_t i = 0; i < DIRECTORY_FANOUT && bucket_pages_.size() < bucket_count; ++i) {
+            bucket_pages_.push_back(get<uint64_t>(cursor));
+        }
+        if (next != 0) {
+            directory_pages_.push_back(next);
+        }
+    }
+}
+
+void PagedHashIndex::store_meta() {
+    auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+    if (!meta) {
+        throw std::runtime_error("failed to read index metadata");
+    }
+    char* cursor = meta->get_data();
+    put<uint32_t>(cursor, MAGIC);
+    put<uint32_t>(cursor, FORMAT_VERSION);
+    put<uint64_t>(cursor, addressing_.level);
+    put<uint64_t>(cursor, addressing_.next_split);
+    put<uint64_t>(cursor, entry_count_);
+    put<uint64_t>(cursor, entry_bytes_);
+    put<uint64_t>(cursor, page_count_);
+    put<uint64_t>(cursor, free_list_head_);
+    put<uint64_t>(cursor, directory_pages_.empty() ? 0 : directory_pages_.front());
+    buffer_manager_->mark_dirty(file_name_, META_PAGE_ID);
+}
+
+void PagedHashIndex::split() {
+    uint64_t source = addressing_.next_split;
+    uint64_t target = addressing_.bucket_count();
+    add_bucket();
+    addressing_.advance();
+
+    std::vector<Entry> kept;
+    std::vector<Entry> moved;
+    for (auto& page : load_chain(source)) {
+        for (auto& entry : page.entries) {
+            (addressing_.bucket_for(LinearHashing::hash(entry.first)) == source ? kept : moved).push_back(std::move(entry));
+        }
+    }
+    if (!moved.empty()) {
+        write_chain(source, kept);
+        write_chain(target, moved);
+    }
+}
+
+bool PagedHashIndex::needs_split() const {
+    return static_cast<double>(entry_bytes_) > MAX_FILL * static_cast<double>(addressing_.bucket_count() * (Page::PAGE_SIZE - BUCKET_HEADER_SIZE));
+}
+
+} // namespace nexusdb
@@ -0,0 +1,756 @@
+#include "nexusdb/hnsw_index.h"
+#include "nexusdb/task_scheduler.h"
+#include "nexusdb/utils/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace nexusdb {
+
+namespace {
+
+template<typename T>
+void put(char*& cursor, T value) {
+    std::memcpy(cursor, &value, sizeof(T));
+    cursor += sizeof(T);
+}
+
+template<typename T>
+T get(const char*& cursor) {
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+template<typename T>
+void append(std::vector<char>& data, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+// Bounds-checked reads from a serialized graph
+class Reader {
+public:
+    explicit Reader(const std::vector<char>& data) : cursor_(data.data()), end_(data.data() + data.size()) {}
+
+    template<typename T>
+    bool read(T& value) {
+        if (static_cast<size_t>(end_ - cursor_) < sizeof(T)) {
+            return false;
+        }
+        value = get<T>(cursor_);
+        return true;
+    }
+
+    bool read_floats(std::vector<float>& values, size_t count) {
+        if (static_cast<size_t>(end_ - cursor_) / sizeof(float) < count) {
+            return false;
+        }
+        values.resize(count);
+        std::memcpy(values.data(), cursor_, count * sizeof(float));
+        cursor_ += count * sizeof(float);
+        return true;
+    }
+
+private:
+    const char* cursor_;
+    const char* end_;
+};
+
+// Nodes seen by one search. Marks are tagged with the search that set
+// them, so the array is cleared only when the tag wraps around.
+class VisitedSet {
+public:
+    void reset(size_t capacity) {
+        if (marks_.size() < capacity) {
+            marks_.resize(capacity, 0);
+        }
+        if (++tag_ == 0) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            tag_ = 1;
+        }
+    }
+
+    // Returns false if id was already visited
+    bool insert(uint32_t id) {
+        if (marks_[id] == tag_) {
+            return false;
+        }
+        marks_[id] = tag_;
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> marks_;
+    uint32_t tag_ = 0;
+};
+
+thread_local VisitedSet visited_nodes;
+
+// Layout of the metadata page
+constexpr size_t CLEAN_FLAG_OFFSET = 2 * sizeof(uint32_t);
+
+// Fewer than two links or candidates would leave the graph disconnected
+HnswConfig checked(HnswConfig config) {
+    config.m = std::max<size_t>(config.m, 2);
+    config.ef_construction = std::max(config.ef_construction, config.m);
+    config.ef_search = std::max<size_t>(config.ef_search, 1);
+    return config;
+}
+
+} // namespace
+
+HnswIndex::HnswIndex(HnswConfig config)
+    : config_(checked(config)) {}
+
+HnswIndex::HnswIndex(HnswConfig config, std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name)
+    : config_(checked(config)), buffer_manager_(std::move(buffer_manager)), file_name_(file_name) {}
+
+std::optional<std::string> HnswIndex::open() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto recover_result = buffer_manager_->recover_file(file_name_);
+    if (recover_result.has_value()) {
+        return "Failed to open index " + file_name_ + ": " + *recover_result;
+    }
+    try {
+        auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+        if (meta) {
+            const char* cursor = meta->get_data();
+            uint32_t magic = get<uint32_t>(cursor);
+            uint32_t version = get<uint32_t>(cursor);
+            if (magic == MAGIC) {
+                if (version != FORMAT_VERSION) {
+                    return "Unsupported index format version in " + file_name_;
+                }
+                bool clean = get<uint32_t>(cursor) != 0;
+                config_.dimension = get<uint32_t>(cursor);
+                uint32_t metric = get<uint32_t>(cursor);
+                if (metric > static_cast<uint32_t>(DistanceMetric::DOT)) {
+                    return "Unknown distance metric in " + file_name_;
+                }
+                config_.metric = static_cast<DistanceMetric>(metric);
+                config_.m = get<uint32_t>(cursor);
+                config_.ef_construction = get<uint32_t>(cursor);
+                config_.ef_search = get<uint32_t>(cursor);
+                config_ = checked(config_);
+                if (!clean) {
+                    // The snapshot misses changes made since; serving it would
+                    // answer from a stale graph
+                    stale_ = true;
+                    dirty_ = true;
+                    LOG_WARNING("Vector index " + file_name_ + " was changed after it was last flushed; "
+                                "it is rebuilt from its table");
+                    return std::nullopt;
+                }
+                uint64_t node_count = get<uint64_t>(cursor);
+                uint32_t entry_point = get<uint32_t>(cursor);
+                uint32_t max_level = get<uint32_t>(cursor);
+                uint64_t data_size = get<uint64_t>(cursor);
+
+                std::vector<char> data(data_size);
+                for (uint64_t offset = 0, page_id = META_PAGE_ID + 1; offset < data_size; offset += Page::PAGE_SIZE, ++page_id) {
+                    auto page = buffer_manager_->get_page(file_name_, page_id);
+                    if (!page) {
+                        return "Index file is truncated: " + file_name_;
+                    }
+                    std::memcpy(data.data() + offset, page->get_data(), std::min(static_cast<uint64_t>(Page::PAGE_SIZE), data_size - offset));
+                }
+                auto load_result = deserialize(data, node_count);
+                if (load_result.has_value()) {
+                    return "Corrupt index file " + file_name_ + ": " + *load_result;
+                }
+                if (node_count > 0 && (entry_point >= node_count || max_level + 1 > nodes_[entry_point]->neighbors.size())) {
+                    return "Corrupt index file " + file_name_ + ": bad entry point";
+                }
+                entry_point_ = entry_point;
+                max_level_ = max_level;
+
+                LOG_DEBUG("Opened index file " + file_name_ + " with " + std::to_string(live_.size()) + " vectors");
+                return std::nullopt;
+            }
+            if (magic != 0) {
+                return "Not an index file: " + file_name_;
+            }
+        } else {
+            meta = buffer_manager_->allocate_page(file_name_);
+            if (!meta || meta->get_page_id() != META_PAGE_ID) {
+                return "Failed to create index file: " + file_name_;
+            }
+        }
+
+        store_meta(0, 0);
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        return "Failed to open index " + file_name_ + ": " + e.what();
+    }
+}
+
+// The graph is rewritten whole; pages past its end are left for the next
+// snapshot to reuse
+std::optional<std::string> HnswIndex::flush() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (nodes_.size() - live_.size() > nodes_.size() * MAX_TOMBSTONE_FRACTION) {
+        auto compact_result = compact_locked();
+        if (compact_result.has_value()) {
+            return "Failed to compact index " + file_name_ + ": " + *compact_result;
+        }
+    }
+    // A stale graph is not worth saving; the unclean file keeps it rebuilt
+    if (!buffer_manager_ || !dirty_ || stale_) {
+        return std::nullopt;
+    }
+    try {
+        std::vector<char> data = serialize();
+        for (uint64_t offset = 0, page_id = META_PAGE_ID + 1; offset < data.size(); offset += Page::PAGE_SIZE, ++page_id) {
+            auto page = buffer_manager_->get_page(file_name_, page_id);
+            if (!page) {
+                page = buffer_manager_->allocate_page(file_name_);
+                if (!page || page->get_page_id() != page_id) {
+                    throw std::runtime_error("failed to allocate index page");
+                }
+            }
+            std::memcpy(page->get_data(), data.data() + offset, std::min(static_cast<uint64_t>(Page::PAGE_SIZE), data.size() - offset));
+            buffer_manager_->mark_dirty(file_name_, page_id);
+        }
+        // The snapshot reaches stable storage before the metadata that declares it clean
+        auto flush_result = buffer_manager_->flush_file(file_name_);
+        if (!flush_result.has_value()) {
+            store_meta(nodes_.size(), data.size());
+            flush_result = buffer_manager_->flush_file(file_name_);
+        }
+        if (flush_result.has_value()) {
+            return "Failed to flush index " + file_name_ + ": " + *flush_result;
+        }
+    } catch (const std::exception& e) {
+        return "Failed to flush index " + file_name_ + ": " + e.what();
+    }
+    dirty_ = false;
+    return std::nullopt;
+}
+
+std::optional<std::string> HnswIndex::insert(const std::string& key, uint64_t record_id) {
+    auto vector = decode_vector(key);
+    if (!vector.has_value() || vector->empty()) {
+        return "Not a vector: " + key.substr(0, 64);
+    }
+    float vector_inverse_norm = inverse_norm(vector->data(), vector->size());
+
+    NodeId node_id;
+    size_t level;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (config_.dimension == 0) {
+            config_.dimension = vector->size();
+        }
+        if (vector->size() != config_.dimension) {
+            return "Vector has " + std::to_string(vector->size()) + " dimensions; the index holds " + std::to_string(config_.dimension);
+        }
+        auto live_it = live_.find(record_id);
+        if (live_it != live_.end()) {
+            Node& current = *nodes_[live_it->second];
+            if (current.vector == *vector) {
+                return std::nullopt;
+            }
+            current.deleted.store(true, std::memory_order_relaxed);
+            live_.erase(live_it);
+        }
+        if (nodes_.size() >= std::numeric_limits<NodeId>::max()) {
+            return "Vector index is full";
+        }
+
+        node_id = static_cast<NodeId>(nodes_.size());
+        level = random_level();
+        auto node = std::make_unique<Node>();
+        node->record_id = record_id;
+        node->vector = std::move(*vector);
+        node->inverse_norm = vector_inverse_norm;
+        node->neighbors.resize(level + 1);
+        nodes_.push_back(std::move(node));
+        live_[record_id] = node_id;
+        mark_dirty_locked();
+        if (node_id == 0) {
+            entry_point_ = 0;
+            max_level_ = level;
+            return std::nullopt;
+        }
+    }
+
+    size_t top_level;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        top_level = max_level_;
+        link(node_id, entry_point_, top_level);
+    }
+
+    // A node above every other becomes the entry point. A concurrent insert
+    // may have raised the top meanwhile, in which case it stays put.
+    if (level > top_level) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (level > max_level_) {
+            max_level_ = level;
+            entry_point_ = node_id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> HnswIndex::remove(const std::string& key, uint64_t record_id) {
+    auto vector = decode_vector(key);
+    if (!vector.has_value()) {
+        return std::nullopt;  // Never inserted
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto live_it = live_.find(record_id);
+    if (live_it == live_.end() || nodes_[live_it->second]->vector != *vector) {
+        return std::nullopt;
+    }
+    nodes_[live_it->second]->deleted.store(true, std::memory_order_relaxed);
+    live_.erase(live_it);
+    mark_dirty_locked();
+    return std::nullopt;
+}
+
+std::vector<uint64_t> HnswIndex::search(const std::string& key) const {
+    std::vector<uint64_t> record_ids;
+    auto vector = decode_vector(key);
+    if (!vector.has_value()) {
+        return record_ids;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (nodes_.empty() || vector->size() != config_.dimension) {
+        return record_ids;
+    }
+    float vector_inverse_norm = inverse_norm(vector->data(), vector->size());
+    NodeId entry = greedy_search(vector->data(), vector_inverse_norm, entry_point_, max_level_, 1);
+    for (const auto& [distance, node_id] : search_layer(vector->data(), vector_inverse_norm, entry, config_.ef_search, 0, true)) {
+        if (nodes_[node_id]->vector == *vector) {
+            record_ids.push_back(nodes_[node_id]->record_id);
+        }
+    }
+    std::sort(record_ids.begin(), record_ids.end());
+    return record_ids;
+}
+
+PostingList HnswIndex::postings(const std::string& key) const {
+    PostingList record_ids;
+    for (uint64_t record_id : search(key)) {
+        record_ids.add(record_id);
+    }
+    return record_ids;
+}
+
+std::optional<std::string> HnswIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (!nodes_.empty()) {
+            return "Bulk load requires an empty index";
+        }
+    }
+    if (entries.empty()) {
+        return std::nullopt;
+    }
+
+    // The first node is inserted alone so the others have an entry point
+    auto first_result = insert(entries.front().first, entries.front().second);
+    if (first_result.has_value()) {
+        return first_result;
+    }
+
+    TaskScheduler& scheduler = TaskScheduler::get_instance();
+    size_t workers = scheduler.is_running() ? scheduler.get_worker_count() : 1;
+    std::atomic<size_t> next_entry{1};
+    std::optional<std::string> load_result;
+    {
+        TaskGroup group(scheduler, TaskPriority::BACKGROUND);
+        for (size_t worker = 0; worker < workers; ++worker) {
+            group.run([&]() {
+                for (size_t i = next_entry.fetch_add(1, std::memory_order_relaxed); i < entries.size();
+                     i = next_entry.fetch_add(1, std::memory_order_relaxed)) {
+                    auto insert_result = insert(entries[i].first, entries[i].second);
+                    if (insert_result.has_value()) {
+                        next_entry.store(entries.size(), std::memory_order_relaxed);
+                        throw std::runtime_error(*insert_result);
+                    }
+                }
+            });
+        }
+        load_result = group.wait();
+    }
+    if (load_result.has_value()) {
+        return load_result;
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        stale_ = false;
+    }
+    // The load is not logged, so the finished graph is flushed before returning
+    return flush();
+}
+
+void HnswIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                     const std::optional<std::string>& upper, bool upper_inclusive,
+                     const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [record_id, node_id] : live_) {
+        std::string key = encode_vector(nodes_[node_id]->vector);
+        if (lower.has_value() && (key < *lower || (!lower_inclusive && key == *lower))) {
+            continue;
+        }
+        if (upper.has_value() && (*upper < key || (!upper_inclusive && key == *upper))) {
+            continue;
+        }
+        if (!visitor(key, record_id)) {
+            return;
+        }
+    }
+}
+
+size_t HnswIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return live_.size();
+}
+
+size_t HnswIndex::height() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return nodes_.empty() ? 0 : max_level_ + 1;
+}
+
+size_t HnswIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return nodes_.size();
+}
+
+std::vector<std::pair<uint64_t, float>> HnswIndex::knn(const std::vector<float>& query, size_t k, size_t ef) const {
+    std::vector<std::pair<uint64_t, float>> nearest;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (k == 0 || nodes_.empty() || query.size() != config_.dimension) {
+        return nearest;
+    }
+
+    float query_inverse_norm = inverse_norm(query.data(), query.size());
+    NodeId entry = greedy_search(query.data(), query_inverse_norm, entry_point_, max_level_, 1);
+    auto found = search_layer(query.data(), query_inverse_norm, entry, std::max(ef == 0 ? config_.ef_search : ef, k), 0, true);
+    found.resize(std::min(found.size(), k));
+    nearest.reserve(found.size());
+    for (const auto& [distance, node_id] : found) {
+        nearest.emplace_back(nodes_[node_id]->record_id, distance);
+    }
+    return nearest;
+}
+
+HnswConfig HnswIndex::config() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return config_;
+}
+
+void HnswIndex::set_ef_search(size_t ef_search) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    config_.ef_search = std::max<size_t>(ef_search, 1);
+}
+
+float HnswIndex::distance(const float* query, float query_inverse_norm, NodeId node_id) const {
+    const Node& node = *nodes_[node_id];
+    switch (config_.metric) {
+        case DistanceMetric::L2:
+            return l2_squared(query, node.vector.data(), config_.dimension);
+        case DistanceMetric::COSINE:
+            return cosine_distance(dot_product(query, node.vector.data(), config_.dimension), query_inverse_norm, node.inverse_norm);
+        case DistanceMetric::DOT:
+            return -dot_product(query, node.vector.data(), config_.dimension);
+    }
+    return 0;
+}
+
+float HnswIndex::distance(NodeId a, NodeId b) const {
+    return distance(nodes_[a]->vector.data(), nodes_[a]->inverse_norm, b);
+}
+
+size_t HnswIndex::random_level() {
+    // Level l is reached with odds m^-l, which keeps each layer m times
+    // sparser than the one below
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double scale = 1.0 / std::log(static_cast<double>(std::max<size_t>(config_.m, 2)));
+    double level = -std::log(1.0 - uniform(level_generator_)) * scale;
+    return std::min(static_cast<size_t>(level), MAX_LEVEL);
+}
+
+HnswIndex::NodeId HnswIndex::greedy_search(const float* query, float query_inverse_norm, NodeId entry, size_t from_level, size_t to_level) const {
+    float entry_distance = distance(query, query_inverse_norm, entry);
+    std::vector<NodeId> neighbors;
+    for (size_t level = from_level + 1; level-- > to_level;) {
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            {
+                std::lock_guard<std::mutex> node_lock(nodes_[entry]->mutex);
+                neighbors = nodes_[entry]->neighbors[level];
+            }
+            for (NodeId neighbor : neighbors) {
+                float neighbor_distance = distance(query, query_inverse_norm, neighbor);
+                if (neighbor_distance < entry_distance) {
+                    entry = neighbor;
+                    entry_distance = neighbor_distance;
+                    moved = true;
+                }
+            }
+        }
+    }
+    return entry;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::search_layer(const float* query, float query_inverse_norm, NodeId entry, size_t ef, size_t level,
+                                                          bool skip_deleted) const {
+    VisitedSet& visited = visited_nodes;
+    visited.reset(nodes_.size());
+    // Closest candidate on top of one heap, farthest result on top of the other
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::priority_queue<Candidate> results;
+
+    float entry_distance = distance(query, query_inverse_norm, entry);
+    visited.insert(entry);
+    candidates.emplace(entry_distance, entry);
+    if (!skip_deleted || !nodes_[entry]->deleted.load(std::memory_order_relaxed)) {
+        results.emplace(entry_distance, entry);
+    }
+
+    std::vector<NodeId> neighbors;
+    while (!candidates.empty()) {
+        auto [current_distance, current] = candidates.top();
+        if (results.size() >= ef && current_distance > results.top().first) {
+            break;
+        }
+        candidates.pop();
+        {
+            std::lock_guard<std::mutex> node_lock(nodes_[current]->mutex);
+            neighbors = nodes_[current]->neighbors[level];
+        }
+        for (NodeId neighbor : neighbors) {
+            if (!visited.insert(neighbor)) {
+                continue;
+            }
+            float neighbor_distance = distance(query, query_inverse_norm, neighbor);
+            if (results.size() < ef || neighbor_distance < results.top().first) {
+                candidates.emplace(neighbor_distance, neighbor);
+                if (!skip_deleted || !nodes_[neighbor]->deleted.load(std::memory_order_relaxed)) {
+                    results.emplace(neighbor_distance, neighbor);
+                    if (results.size() > ef) {
+                        results.pop();
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> nearest(results.size());
+    for (size_t i = nearest.size(); i-- > 0;) {
+        nearest[i] = results.top();
+        results.pop();
+    }
+    return nearest;
+}
+
+std::vector<HnswIndex::NodeId> HnswIndex::select_neighbors(const std::vector<Candidate>& candidates, size_t count) const {
+    std::vector<NodeId> selected;
+    for (const auto& [candidate_distance, candidate] : candidates) {
+        if (selected.size() == count) {
+            break;
+        }
+        bool diverse = std::none_of(selected.begin(), selected.end(), [&](NodeId neighbor) {
+            return distance(candidate, neighbor) < candidate_distance;
+        });
+        if (diverse) {
+            selected.push_back(candidate);
+        }
+    }
+    return selected;
+}
+
+void HnswIndex::link(NodeId node_id, NodeId entry, size_t top_level) {
+    const Node& node = *nodes_[node_id];
+    size_t level = node.neighbors.size() - 1;
+    if (level < top_level) {
+        entry = greedy_search(node.vector.data(), node.inverse_norm, entry, top_level, level + 1);
+    }
+    for (size_t current = std::min(level, top_level) + 1; current-- > 0;) {
+        auto candidates = search_layer(node.vector.data(), node.inverse_norm, entry, config_.ef_construction, current, false);
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const Candidate& candidate) { return candidate.second == node_id; }),
+                         candidates.end());
+        if (candidates.empty()) {
+            continue;
+        }
+        for (NodeId neighbor : select_neighbors(candidates, config_.m)) {
+            add_link(node_id, neighbor, current);
+            add_link(neighbor, node_id, current);
+        }
+        entry = candidates.front().second;
+    }
+}
+
+void HnswIndex::add_link(NodeId from, NodeId to, size_t level) {
+    Node& node = *nodes_[from];
+    std::lock_guard<std::mutex> node_lock(node.mutex);
+    auto& links = node.neighbors[level];
+    if (std::find(links.begin(), links.end(), to) != links.end()) {
+        return;
+    }
+    links.push_back(to);
+    if (links.size() <= max_links(level)) {
+        return;
+    }
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(links.size());
+    for (NodeId link : links) {
+        candidates.emplace_back(distance(from, link), link);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    links = select_neighbors(candidates, max_links(level));
+}
+
+void HnswIndex::store_meta(uint64_t node_count, uint64_t data_size) {
+    auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+    if (!meta) {
+        throw std::runtime_error("failed to read index metadata");
+    }
+    char* cursor = meta->get_data();
+    put<uint32_t>(cursor, MAGIC);
+    put<uint32_t>(cursor, FORMAT_VERSION);
+    put<uint32_t>(cursor, 1);  // Clean
+    put<uint32_t>(cursor, static_cast<uint32_t>(config_.dimension));
+    put<uint32_t>(cursor, static_cast<uint32_t>(config_.metric));
+    put<uint32_t>(cursor, static_cast<uint32_t>(config_.m));
+    put<uint32_t>(cursor, static_cast<uint32_t>(config_.ef_construction));
+    put<uint32_t>(cursor, static_cast<uint32_t>(config_.ef_search));
+    put<uint64_t>(cursor, node_count);
+    put<uint32_t>(cursor, entry_point_);
+    put<uint32_t>(cursor, static_cast<uint32_t>(max_level_));
+    put<uint64_t>(cursor, data_size);
+    buffer_manager_->mark_dirty(file_name_, META_PAGE_ID);
+}
+
+void HnswIndex::mark_dirty_locked() {
+    if (dirty_ || !buffer_manager_) {
+        dirty_ = true;
+        return;
+    }
+    dirty_ = true;
+    try {
+        auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+        if (!meta) {
+            throw std::runtime_error("failed to read index metadata");
+        }
+        char* cursor = meta->get_data() + CLEAN_FLAG_OFFSET;
+        put<uint32_t>(cursor, 0);
+        buffer_manager_->mark_dirty(file_name_, META_PAGE_ID);
+        buffer_manager_->flush_page(file_name_, META_PAGE_ID);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to mark index " + file_name_ + " as changed: " + e.what());
+    }
+}
+
+std::optional<std::string> HnswIndex::compact_locked() {
+    std::vector<std::pair<std::string, uint64_t>> entries;
+    entries.reserve(live_.size());
+    for (const auto& [record_id, node_id] : live_) {
+        entries.emplace_back(encode_vector(nodes_[node_id]->vector), record_id);
+    }
+
+    HnswIndex rebuilt(config_);
+    auto load_result = rebuilt.bulk_load(entries, 1.0);
+    if (load_result.has_value()) {
+        return load_result;
+    }
+    LOG_DEBUG("Compacted vector index " + file_name_ + " from " + std::to_string(nodes_.size()) + " to " +
+              std::to_string(rebuilt.nodes_.size()) + " nodes");
+    nodes_ = std::move(rebuilt.nodes_);
+    live_ = std::move(rebuilt.live_);
+    entry_point_ = rebuilt.entry_point_;
+    max_level_ = rebuilt.max_level_;
+    mark_dirty_locked();
+    return std::nullopt;
+}
+
+bool HnswIndex::needs_rebuild() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return !buffer_manager_ || stale_;
+}
+
+// Per node: record id, deleted flag, layer count, the vector, then for each
+// layer the number of links and the linked node ids
+std::vector<char> HnswIndex::serialize() const {
+    std::vector<char> data;
+    for (const auto& node : nodes_) {
+        append<uint64_t>(data, node->record_id);
+        append<uint8_t>(data, node->deleted.load(std::memory_order_relaxed) ? 1 : 0);
+        append<uint8_t>(data, static_cast<uint8_t>(node->neighbors.size()));
+        const char* vector_bytes = reinterpret_cast<const char*>(node->vector.data());
+        data.insert(data.end(), vector_bytes, vector_bytes + node->vector.size() * sizeof(float));
+        for (const auto& links : node->neighbors) {
+            append<uint32_t>(data, static_cast<uint32_t>(links.size()));
+            for (NodeId link : links) {
+                append<uint32_t>(data, link);
+            }
+        }
+    }
+    return data;
+}
+
+std::optional<std::string> HnswIndex::deserialize(const std::vector<char>& data, uint64_t node_count) {
+    if (node_count > std::numeric_limits<NodeId>::max()) {
+        return "too many nodes";
+    }
+    Reader reader(data);
+    nodes_.clear();
+    live_.clear();
+    nodes_.reserve(node_count);
+    for (uint64_t i = 0; i < node_count; ++i) {
+        auto node = std::make_unique<Node>();
+        uint8_t deleted;
+        uint8_t levels;
+        if (!reader.read(node->record_id) || !reader.read(deleted) || !reader.read(levels) ||
+            !reader.read_floats(node->vector, config_.dimension)) {
+            return "node " + std::to_string(i) + " is cut short";
+        }
+        if (levels == 0 || levels > MAX_LEVEL + 1) {
+            return "node " + std::to_string(i) + " has " + std::to_string(levels) + " layers";
+        }
+        node->inverse_norm = inverse_norm(node->vector.data(), node->vector.size());
+        node->deleted.store(deleted != 0, std::memory_order_relaxed);
+        node->neighbors.resize(levels);
+        for (auto& links : node->neighbors) {
+            uint32_t count;
+            if (!reader.read(count) || count > node_count) {
+                return "node " + std::to_string(i) + " has a bad link count";
+            }
+            links.resize(count);
+            for (NodeId& link : links) {
+                if (!reader.read(link) || link >= node_count) {
+                    return "node " + std::to_string(i) + " has a bad link";
+                }
+            }
+        }
+        if (deleted == 0) {
+            live_[node->record_id] = static_cast<NodeId>(i);
+        }
+        nodes_.push_back(std::move(node));
+    }
+    // A link on a layer must lead to a node on that layer
+    for (const auto& node : nodes_) {
+        for (size_t level = 0; level < node->neighbors.size(); ++level) {
+            for (NodeId link : node->neighbors[level]) {
+                if (nodes_[link]->neighbors.size() <= level) {
+                    return "a link leads below its layer";
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace nexusdb
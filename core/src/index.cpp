@@ -0,0 +1,128 @@
+#include "nexusdb/index.h"
+
+namespace nexusdb {
+
+const char* index_type_name(IndexType type) {
+    switch (type) {
+        case IndexType::BTREE:
+            return "btree";
+        case IndexType::HASH:
+            return "hash";
+        case IndexType::ART:
+            return "art";
+        case IndexType::BITMAP:
+            return "bitmap";
+        case IndexType::FULLTEXT:
+            return "fulltext";
+        case IndexType::HNSW:
+            return "hnsw";
+        case IndexType::RTREE:
+            return "rtree";
+    }
+    return "btree";
+}
+
+std::optional<IndexType> parse_index_type(const std::string& name) {
+    if (name == "btree") {
+        return IndexType::BTREE;
+    }
+    if (name == "hash") {
+        return IndexType::HASH;
+    }
+    if (name == "art") {
+        return IndexType::ART;
+    }
+    if (name == "bitmap") {
+        return IndexType::BITMAP;
+    }
+    if (name == "fulltext") {
+        return IndexType::FULLTEXT;
+    }
+    if (name == "hnsw") {
+        return IndexType::HNSW;
+    }
+    if (name == "rtree") {
+        return IndexType::RTREE;
+    }
+    return std::nullopt;
+}
+
+PostingList Index::postings(const std::string& key) const {
+    PostingList record_ids;
+    scan(key, true, key, true, [&](const std::string&, uint64_t record_id) {
+        record_ids.add(record_id);
+        return true;
+    });
+    return record_ids;
+}
+
+std::vector<PostingList> Index::postings_batch(const std::vector<std::string>& keys) const {
+    std::vector<PostingList> lists;
+    lists.reserve(keys.size());
+    for (const auto& key : keys) {
+        lists.push_back(postings(key));
+    }
+    return lists;
+}
+
+std::optional<std::string> BTreeIndex::insert(const std::string& key, uint64_t record_id) {
+    tree_.insert({key, record_id});
+    return std::nullopt;
+}
+
+std::optional<std::string> BTreeIndex::remove(const std::string& key, uint64_t record_id) {
+    tree_.remove({key, record_id});
+    return std::nullopt;
+}
+
+std::vector<uint64_t> BTreeIndex::search(const std::string& key) const {
+    std::vector<uint64_t> record_ids;
+    tree_.scan(std::make_pair(key, uint64_t{0}), false, [&](const std::pair<std::string, uint64_t>& entry) {
+        if (entry.first != key) {
+            return false;
+        }
+        record_ids.push_back(entry.second);
+        return true;
+    });
+    return record_ids;
+}
+
+std::optional<std::string> BTreeIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) {
+    if (!tree_.bulk_load(entries, fill_factor)) {
+        return "Bulk load requires an empty index";
+    }
+    return std::nullopt;
+}
+
+void BTreeIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                      const std::optional<std::string>& upper, bool upper_inclusive,
+                      const ScanVisitor& visitor) const {
+    std::optional<std::pair<std::string, uint64_t>> from;
+    if (lower.has_value()) {
+        from = std::make_pair(*lower, lower_inclusive ? uint64_t{0} : UINT64_MAX);
+    }
+
+    tree_.scan(from, !lower_inclusive, [&](const std::pair<std::string, uint64_t>& entry) {
+        if (lower.has_value() && !lower_inclusive && entry.first == *lower) {
+            return true;
+        }
+        if (upper.has_value() && (upper_inclusive ? *upper < entry.first : !(entry.first < *upper))) {
+            return false;
+        }
+        return visitor(entry.first, entry.second);
+    });
+}
+
+size_t BTreeIndex::size() const {
+    return tree_.size();
+}
+
+size_t BTreeIndex::height() const {
+    return tree_.height();
+}
+
+size_t BTreeIndex::node_count() const {
+    return tree_.node_count();
+}
+
+} // namespace nexusdb
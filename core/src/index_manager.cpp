@@ -1,151 +1,673 @@
 #include "nexusdb/index_manager.h"
+#include "nexusdb/art_index.h"
+#include "nexusdb/bitmap_index.h"
+#include "nexusdb/hash_index.h"
+#include "nexusdb/key_encoding.h"
+#include "nexusdb/paged_btree.h"
+#include "nexusdb/parallel_sort.h"
 #include "nexusdb/storage_engine.h"
 #include "nexusdb/utils/logger.h"
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <thread>
 
 namespace nexusdb {
 
+namespace {
+
+// Separators in composite index names and catalog lines
+constexpr char KEY_COLUMN_SEPARATOR = ',';
+constexpr char INCLUDE_SEPARATOR = '+';
+
+std::string join(const std::vector<std::string>& parts, char separator) {
+    std::string joined;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (i > 0) {
+            joined.push_back(separator);
+        }
+        joined += parts[i];
+    }
+    return joined;
+}
+
+std::vector<std::string> split(const std::string& joined, char separator) {
+    std::vector<std::string> parts;
+    if (joined.empty()) {
+        return parts;
+    }
+    size_t start = 0;
+    while (true) {
+        size_t end = joined.find(separator, start);
+        parts.push_back(joined.substr(start, end - start));
+        if (end == std::string::npos) {
+            return parts;
+        }
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+std::string IndexManager::composite_index_name(const std::vector<std::string>& key_columns, const std::vector<std::string>& include_columns) {
+    std::string name = join(key_columns, KEY_COLUMN_SEPARATOR);
+    if (!include_columns.empty()) {
+        name.push_back(INCLUDE_SEPARATOR);
+        name += join(include_columns, KEY_COLUMN_SEPARATOR);
+    }
+    return name;
+}
+
+std::optional<std::string> IndexManager::IndexDefinition::key_for(const std::vector<std::string>& schema, const std::vector<std::string>& record) const {
+    return key_at(column_positions(schema), record);
+}
+
+std::vector<size_t> IndexManager::IndexDefinition::column_positions(const std::vector<std::string>& schema) const {
+    std::vector<size_t> positions;
+    positions.reserve(key_columns.size() + include_columns.size());
+    for (const auto* columns : {&key_columns, &include_columns}) {
+        for (const auto& column : *columns) {
+            positions.push_back(std::distance(schema.begin(), std::find(schema.begin(), schema.end(), column)));
+        }
+    }
+    return positions;
+}
+
+std::optional<std::string> IndexManager::IndexDefinition::key_at(const std::vector<size_t>& positions, const std::vector<std::string>& record) const {
+    for (size_t position : positions) {
+        if (position >= record.size()) {
+            return std::nullopt;
+        }
+    }
+    if (!is_composite()) {
+        return record[positions.front()];
+    }
+    std::vector<std::string> values;
+    values.reserve(positions.size());
+    for (size_t position : positions) {
+        values.push_back(record[position]);
+    }
+    return encode_composite_key(values);
+}
+
+IndexManager::IndexDefinition IndexManager::IndexEntry::definition() const {
+    if (key_columns.empty()) {
+        return IndexDefinition{column_name, {column_name}, {}, type};
+    }
+    return IndexDefinition{column_name, key_columns, include_columns, type};
+}
+
 IndexManager::IndexManager(std::shared_ptr<StorageEngine> storage_engine)
-    : storage_engine_(storage_engine) {
+    : storage_engine_(storage_engine), catalog_(new Catalog()) {
     LOG_DEBUG("IndexManager constructor called");
 }
 
 IndexManager::~IndexManager() {
     LOG_DEBUG("IndexManager destructor called");
     shutdown();
+    delete catalog_.load();
 }
 
 std::optional<std::string> IndexManager::initialize() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     LOG_INFO("Initializing Index Manager...");
-    // Add any necessary initialization logic here
-    LOG_INFO("Index Manager initialized successfully");
+    data_directory_ = storage_engine_->get_data_directory();
+    if (!data_directory_.empty()) {
+        BufferConfig buffer_config;
+        buffer_config.initial_size = INDEX_BUFFER_POOL_SIZE;
+        buffer_config.data_directory = data_directory_;
+        buffer_manager_ = std::make_shared<BufferManager>(buffer_config);
+        auto buffer_result = buffer_manager_->initialize();
+        if (buffer_result.has_value()) {
+            return buffer_result;
+        }
+
+        auto catalog_result = load_catalog();
+        if (catalog_result.has_value()) {
+            return catalog_result;
+        }
+        publish_catalog();
+    }
+    LOG_INFO("Index Manager initialized successfully with " + std::to_string(indexes_.size()) + " indexes");
     return std::nullopt;
 }
 
+void IndexManager::set_tokenizer(std::shared_ptr<const Tokenizer> tokenizer) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    tokenizer_ = std::move(tokenizer);
+}
+
+void IndexManager::set_vector_index_config(const HnswConfig& config) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    vector_index_config_ = config;
+}
+
 void IndexManager::shutdown() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     LOG_INFO("Shutting down Index Manager...");
+    auto closing = std::move(indexes_);
     indexes_.clear();
+    publish_catalog();
+    wait_for_readers();
+    for (const auto& [index_key, entry] : closing) {
+        auto flush_result = entry->index->flush();
+        if (flush_result.has_value()) {
+            LOG_ERROR(*flush_result);
+        }
+    }
+    closing.clear();
+    if (buffer_manager_) {
+        buffer_manager_->shutdown();
+        buffer_manager_.reset();
+    }
     LOG_INFO("Index Manager shut down successfully");
 }
 
-std::optional<std::string> IndexManager::create_index(const std::string& table_name, const std::string& column_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::optional<std::string> IndexManager::flush_indexes() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    for (const auto& [index_key, entry] : indexes_) {
+        auto flush_result = entry->index->flush();
+        if (flush_result.has_value()) {
+            return flush_result;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<std::string, IndexManager::IndexDefinition>> IndexManager::take_indexes_to_rebuild() {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return std::move(indexes_to_rebuild_);
+}
+
+bool IndexManager::awaits_rebuild(const std::string& table_name, const std::string& column_name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    return std::any_of(indexes_to_rebuild_.begin(), indexes_to_rebuild_.end(), [&](const auto& pending) {
+        return pending.first == table_name && pending.second.name == column_name;
+    });
+}
+
+std::optional<std::string> IndexManager::reload_index(const std::string& table_name, const std::string& column_name,
+                                                      std::vector<std::pair<std::string, uint64_t>> data) {
+    auto sort_result = parallel_sort(data.begin(), data.end());
+    if (sort_result.has_value()) {
+        return "Failed to sort index entries: " + *sort_result;
+    }
+    data.erase(std::unique(data.begin(), data.end()), data.end());
+
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    auto it = indexes_.find(get_index_key(table_name, column_name));
+    if (it == indexes_.end()) {
+        return "Index not found";
+    }
+    auto load_result = it->second->index->bulk_load(data, DEFAULT_FILL_FACTOR);
+    if (load_result.has_value()) {
+        return load_result;
+    }
+    LOG_INFO("Reloaded index for " + table_name + "." + column_name + " with " + std::to_string(data.size()) + " entries");
+    return std::nullopt;
+}
+
+bool IndexManager::needs_flush() const {
+    return buffer_manager_ && buffer_manager_->is_over_limit();
+}
+
+void IndexManager::set_write_ahead(std::function<std::optional<std::string>()> force_log) {
+    if (buffer_manager_) {
+        buffer_manager_->set_write_ahead(std::move(force_log));
+    }
+}
+
+// Only registers the index; StorageEngine populates it from the table
+std::optional<std::string> IndexManager::create_index(const std::string& table_name, const std::string& column_name, IndexType type) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     std::string index_key = get_index_key(table_name, column_name);
     
     if (indexes_.find(index_key) != indexes_.end()) {
         return "Index already exists for this table and column";
     }
 
-    indexes_[index_key] = std::make_unique<BTree<std::string, std::vector<uint64_t>>>(10); // Degree of 10 as an example
+    std::unique_ptr<Index> index;
+    auto open_result = open_index(table_name, column_name, type, index);
+    if (open_result.has_value()) {
+        return open_result;
+    }
+    indexes_[index_key] = std::make_unique<IndexEntry>(IndexEntry{table_name, column_name, type, std::move(index), {}, {}});
 
-    // Populate the index with existing data
-    auto table_scan = storage_engine_->full_table_scan(table_name);
-    if (table_scan.has_value()) {
-        for (const auto& [record_id, record] : *table_scan) {
-            if (column_name < record.size()) {
-                insert_into_index(table_name, column_name, record[std::stoi(column_name)], record_id);
-            }
-        }
+    auto catalog_result = save_catalog();
+    if (catalog_result.has_value()) {
+        destroy_index(*indexes_[index_key]);
+        indexes_.erase(index_key);
+        return catalog_result;
     }
+    publish_catalog();
     
-    LOG_INFO("Created index for " + table_name + "." + column_name);
+    LOG_INFO("Created " + std::string(index_type_name(type)) + " index for " + table_name + "." + column_name);
     return std::nullopt;
 }
 
 std::optional<std::string> IndexManager::drop_index(const std::string& table_name, const std::string& column_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     std::string index_key = get_index_key(table_name, column_name);
     
-    if (indexes_.find(index_key) == indexes_.end()) {
+    auto it = indexes_.find(index_key);
+    if (it == indexes_.end()) {
         return "Index does not exist for this table and column";
     }
 
-    indexes_.erase(index_key);
+    auto dropped = std::move(it->second);
+    indexes_.erase(it);
+    publish_catalog();
+    wait_for_readers();
+    destroy_index(*dropped);
+    auto catalog_result = save_catalog();
+    if (catalog_result.has_value()) {
+        return catalog_result;
+    }
     
     LOG_INFO("Dropped index for " + table_name + "." + column_name);
     return std::nullopt;
 }
 
 std::optional<std::vector<uint64_t>> IndexManager::search_index(const std::string& table_name, const std::string& column_name, const std::string& value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
-    
-    auto it = indexes_.find(index_key);
-    if (it == indexes_.end()) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
         return std::nullopt; // Index doesn't exist
     }
 
-    auto search_result = it->second->search(value);
-    if (search_result) {
-        return *search_result;
+    return entry->index->search(value);
+}
+
+std::optional<PostingList> IndexManager::search_postings(const std::string& table_name, const std::string& column_name, const std::string& value) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return std::nullopt; // Index doesn't exist
     }
 
-    return std::vector<uint64_t>{}; // No matches found
+    return entry->index->postings(value);
 }
 
-std::optional<std::string> IndexManager::insert_into_index(const std::string& table_name, const std::string& column_name, const std::string& value, uint64_t record_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
-    
-    auto it = indexes_.find(index_key);
-    if (it == indexes_.end()) {
-        return "Index does not exist for this table and column";
+std::optional<std::vector<PostingList>> IndexManager::search_index_batch(const std::string& table_name, const std::string& column_name, const std::vector<std::string>& values) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return std::nullopt; // Index doesn't exist
     }
 
-    auto search_result = it->second->search(value);
-    if (search_result) {
-        search_result->push_back(record_id);
-        it->second->insert(value, *search_result);
-    } else {
-        it->second->insert(value, {record_id});
+    // Probe each distinct value once, in order, and remember which of them
+    // answers each position of values
+    std::vector<size_t> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+    std::vector<std::string> keys;
+    std::vector<size_t> key_of(values.size());
+    for (size_t position : order) {
+        if (keys.empty() || keys.back() != values[position]) {
+            keys.push_back(values[position]);
+        }
+        key_of[position] = keys.size() - 1;
     }
 
-    return std::nullopt;
+    std::vector<PostingList> lists = entry->index->postings_batch(keys);
+    std::vector<PostingList> results;
+    results.reserve(values.size());
+    for (size_t position = 0; position < values.size(); ++position) {
+        results.push_back(lists[key_of[position]]);
+    }
+    return results;
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::search_index_all(const std::string& table_name, const std::vector<std::pair<std::string, std::string>>& conditions) {
+    if (conditions.empty()) {
+        return std::nullopt;
+    }
+    for (const auto& [column_name, value] : conditions) {
+        auto type = get_index_type(table_name, column_name);
+        if (type == IndexType::FULLTEXT || type == IndexType::HNSW) {
+            return std::nullopt;  // Its keys are queries, or vectors only found approximately
+        }
+    }
+
+    std::vector<BitmapCondition> bitmap_conditions;
+    for (const auto& [column_name, value] : conditions) {
+        bitmap_conditions.push_back(BitmapCondition{column_name, {value}, false});
+    }
+    auto bitmap = search_bitmaps(table_name, bitmap_conditions);
+    if (bitmap.has_value()) {
+        return bitmap->to_vector();
+    }
+
+    std::vector<PostingList> lists;
+    lists.reserve(conditions.size());
+    for (const auto& [column_name, value] : conditions) {
+        auto list = search_postings(table_name, column_name, value);
+        if (!list.has_value()) {
+            return std::nullopt;
+        }
+        lists.push_back(std::move(*list));
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const PostingList& a, const PostingList& b) { return a.size() < b.size(); });
+    PostingList result = std::move(lists.front());
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        result = PostingList::intersect(result, lists[i]);
+    }
+    return result.to_vector();
+}
+
+std::optional<RoaringBitmap> IndexManager::search_bitmaps(const std::string& table_name, const std::vector<BitmapCondition>& conditions) {
+    if (conditions.empty()) {
+        return std::nullopt;
+    }
+
+    auto guard = epoch_.pin();
+    std::vector<const BitmapIndex*> indexes;
+    for (const auto& condition : conditions) {
+        const IndexEntry* entry = find_index(table_name, condition.column);
+        if (entry == nullptr || entry->type != IndexType::BITMAP) {
+            return std::nullopt;
+        }
+        indexes.push_back(static_cast<const BitmapIndex*>(entry->index.get()));
+    }
+
+    std::vector<RoaringBitmap> included;
+    std::vector<RoaringBitmap> excluded;
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        (conditions[i].negated ? excluded : included).push_back(indexes[i]->bitmap_of_any(conditions[i].values));
+    }
+    if (included.empty()) {
+        auto negated = std::find_if(conditions.begin(), conditions.end(), [](const BitmapCondition& condition) { return condition.negated; });
+        included.push_back(indexes[negated - conditions.begin()]->all_records());
+    }
+
+    std::sort(included.begin(), included.end(), [](const RoaringBitmap& a, const RoaringBitmap& b) { return a.cardinality() < b.cardinality(); });
+    RoaringBitmap result = std::move(included.front());
+    for (size_t i = 1; i < included.size() && !result.empty(); ++i) {
+        result = RoaringBitmap::intersect(result, included[i]);
+    }
+    for (size_t i = 0; i < excluded.size() && !result.empty(); ++i) {
+        result = RoaringBitmap::subtract(result, excluded[i]);
+    }
+    return result;
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::search_full_text(const std::string& table_name, const std::string& column_name, const std::string& query) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr || entry->type != IndexType::FULLTEXT) {
+        return std::nullopt;
+    }
+    return static_cast<const FullTextIndex*>(entry->index.get())->match(query);
+}
+
+std::optional<std::vector<std::pair<uint64_t, float>>> IndexManager::search_nearest(const std::string& table_name, const std::string& column_name,
+                                                                                    const std::vector<float>& query, size_t k, size_t ef) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr || entry->type != IndexType::HNSW) {
+        return std::nullopt;
+    }
+    return static_cast<const HnswIndex*>(entry->index.get())->knn(query, k, ef);
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::search_box(const std::string& table_name, const std::string& column_name, const Rect& box) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr || entry->type != IndexType::RTREE) {
+        return std::nullopt;
+    }
+    return static_cast<const RTreeIndex*>(entry->index.get())->search_box(box);
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::search_radius(const std::string& table_name, const std::string& column_name, const Point& center, double radius) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr || entry->type != IndexType::RTREE) {
+        return std::nullopt;
+    }
+    return static_cast<const RTreeIndex*>(entry->index.get())->search_radius(center, radius);
+}
+
+std::optional<std::vector<std::pair<uint64_t, double>>> IndexManager::search_nearest_geometries(const std::string& table_name, const std::string& column_name,
+                                                                                                const Point& point, size_t k) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr || entry->type != IndexType::RTREE) {
+        return std::nullopt;
+    }
+    return static_cast<const RTreeIndex*>(entry->index.get())->nearest(point, k);
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::range_search(const std::string& table_name, const std::string& column_name,
+                                                                const std::optional<std::string>& lower, const std::optional<std::string>& upper,
+                                                                bool lower_inclusive, bool upper_inclusive) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return std::nullopt; // Index doesn't exist
+    }
+
+    if (!entry->index->is_ordered()) {
+        return std::nullopt; // Hash indexes only answer equality lookups
+    }
+
+    std::vector<uint64_t> record_ids;
+    entry->index->scan(lower, lower_inclusive, upper, upper_inclusive, [&](const std::string&, uint64_t record_id) {
+        record_ids.push_back(record_id);
+        return true;
+    });
+    return record_ids;
+}
+
+std::optional<std::vector<uint64_t>> IndexManager::prefix_search(const std::string& table_name, const std::string& column_name, const std::string& prefix) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return std::nullopt; // Index doesn't exist
+    }
+
+    if (!entry->index->is_ordered()) {
+        return std::nullopt; // Hash indexes only answer equality lookups
+    }
+
+    std::vector<uint64_t> record_ids;
+    entry->index->scan(prefix, true, std::nullopt, false, [&](const std::string& key, uint64_t record_id) {
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        record_ids.push_back(record_id);
+        return true;
+    });
+    return record_ids;
+}
+
+std::optional<std::vector<IndexManager::IndexRow>> IndexManager::scan_covering_index(const std::string& table_name, const std::string& index_name,
+                                                                                 const std::vector<std::string>& leading_values,
+                                                                                 const std::optional<std::string>& lower,
+                                                                                 const std::optional<std::string>& upper,
+                                                                                 bool lower_inclusive, bool upper_inclusive) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, index_name);
+    if (entry == nullptr || entry->key_columns.empty()) {
+        return std::nullopt; // No composite index by that name
+    }
+
+    bool bounded = lower.has_value() || upper.has_value();
+    size_t range_column = leading_values.size();
+    if (range_column + (bounded ? 1 : 0) > entry->key_columns.size()) {
+        return std::nullopt;
+    }
+
+    // Keys whose range column is below lower already sort before this start
+    std::string prefix = encode_composite_key(leading_values);
+    std::string start = prefix;
+    if (lower.has_value()) {
+        append_key_component(start, *lower);
+    }
+
+    std::vector<IndexRow> rows;
+    std::optional<std::string> error;
+    entry->index->scan(start, true, std::nullopt, false, [&](const std::string& key, uint64_t record_id) {
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        auto values = decode_composite_key(key);
+        if (!values.has_value() || values->size() != entry->key_columns.size() + entry->include_columns.size()) {
+            error = "Malformed key in composite index " + table_name + "." + index_name;
+            return false;
+        }
+        if (bounded) {
+            const std::string& value = (*values)[range_column];
+            if (upper.has_value() && (upper_inclusive ? value > *upper : value >= *upper)) {
+                return false;
+            }
+            if (lower.has_value() && !lower_inclusive && value == *lower) {
+                return true;
+            }
+        }
+        rows.push_back(IndexRow{record_id, std::move(*values)});
+        return true;
+    });
+    if (error.has_value()) {
+        LOG_ERROR(*error);
+        return std::nullopt;
+    }
+    return rows;
+}
+
+std::optional<std::string> IndexManager::insert_into_index(const std::string& table_name, const std::string& column_name, const std::string& value, uint64_t record_id) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return "Index does not exist for this table and column";
+    }
+
+    return entry->index->insert(value, record_id);
 }
 
 std::optional<std::string> IndexManager::remove_from_index(const std::string& table_name, const std::string& column_name, const std::string& value, uint64_t record_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
-    
-    auto it = indexes_.find(index_key);
-    if (it == indexes_.end()) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
         return "Index does not exist for this table and column";
     }
 
-    auto search_result = it->second->search(value);
-    if (search_result) {
-        auto& records = *search_result;
-        records.erase(std::remove(records.begin(), records.end(), record_id), records.end());
-        if (records.empty()) {
-            it->second->remove(value);
-        } else {
-            it->second->insert(value, records);
-        }
+    return entry->index->remove(value, record_id);
+}
+
+std::optional<std::string> IndexManager::insert_into_index(IndexId index_id, const std::string& value, uint64_t record_id) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(index_id);
+    if (entry == nullptr) {
+        return "Index does not exist";
     }
 
-    return std::nullopt;
+    return entry->index->insert(value, record_id);
+}
+
+std::optional<std::string> IndexManager::remove_from_index(IndexId index_id, const std::string& value, uint64_t record_id) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(index_id);
+    if (entry == nullptr) {
+        return "Index does not exist";
+    }
+
+    return entry->index->remove(value, record_id);
 }
 
 std::optional<std::string> IndexManager::drop_all_indexes(const std::string& table_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
     LOG_INFO("Dropping all indexes for table: " + table_name);
 
-    std::string prefix = table_name + ".";
+    std::vector<std::unique_ptr<IndexEntry>> dropped;
     auto it = indexes_.begin();
     while (it != indexes_.end()) {
-        if (it->first.compare(0, prefix.length(), prefix) == 0) {
+        if (it->second->table_name == table_name) {
+            dropped.push_back(std::move(it->second));
             it = indexes_.erase(it);
         } else {
             ++it;
         }
     }
+    publish_catalog();
+    wait_for_readers();
+    for (const auto& entry : dropped) {
+        destroy_index(*entry);
+    }
+
+    auto catalog_result = save_catalog();
+    if (catalog_result.has_value()) {
+        return catalog_result;
+    }
 
     LOG_INFO("All indexes dropped for table: " + table_name);
     return std::nullopt;
 }
 
+bool IndexManager::has_index(const std::string& table_name, const std::string& column_name) const {
+    auto guard = epoch_.pin();
+    return find_index(table_name, column_name) != nullptr;
+}
+
+bool IndexManager::has_indexes(const std::string& table_name) const {
+    auto guard = epoch_.pin();
+    const Catalog* catalog = catalog_.load(std::memory_order_acquire);
+    return catalog->by_table.find(table_name) != catalog->by_table.end();
+}
+
+std::optional<IndexType> IndexManager::get_index_type(const std::string& table_name, const std::string& column_name) const {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->type;
+}
+
+std::optional<IndexManager::IndexDefinition> IndexManager::get_index_definition(const std::string& table_name, const std::string& index_name) const {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, index_name);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->definition();
+}
+
+std::vector<IndexManager::IndexDefinition> IndexManager::get_table_indexes(const std::string& table_name) const {
+    auto guard = epoch_.pin();
+    std::vector<IndexDefinition> definitions;
+    const Catalog* catalog = catalog_.load(std::memory_order_acquire);
+    auto it = catalog->by_table.find(table_name);
+    if (it != catalog->by_table.end()) {
+        for (const IndexEntry* entry : it->second) {
+            definitions.push_back(entry->definition());
+        }
+    }
+    return definitions;
+}
+
+std::vector<IndexManager::IndexHandle> IndexManager::get_table_index_handles(const std::string& table_name, uint64_t& catalog_version) const {
+    auto guard = epoch_.pin();
+    std::vector<IndexHandle> handles;
+    const Catalog* catalog = catalog_.load(std::memory_order_acquire);
+    catalog_version = catalog->version;
+    auto it = catalog->by_table.find(table_name);
+    if (it != catalog->by_table.end()) {
+        for (const IndexEntry* entry : it->second) {
+            handles.push_back(IndexHandle{entry->id, entry->definition()});
+        }
+    }
+    return handles;
+}
+
+uint64_t IndexManager::catalog_version() const {
+    auto guard = epoch_.pin();
+    return catalog_.load(std::memory_order_acquire)->version;
+}
+
 std::optional<std::string> IndexManager::sync_index(const std::string& table_name, const std::string& column_name, const std::string& remote_node) {
     // This is a placeholder implementation. In a real system, you'd need to implement
     // network communication and data transfer with the remote node.
@@ -154,74 +676,111 @@ std::optional<std::string> IndexManager::sync_index(const std::string& table_nam
 }
 
 std::optional<std::string> IndexManager::merge_index(const std::string& table_name, const std::string& column_name, const BTree<std::string, std::vector<uint64_t>>& remote_index) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
-    
-    auto it = indexes_.find(index_key);
-    if (it == indexes_.end()) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
         return "Index does not exist for this table and column";
     }
 
-    // Merge the remote index into the local index
+    // Inserting an existing entry is a no-op, so this takes the union of
+    // local and remote records
+    std::optional<std::string> merge_result;
     remote_index.traverse([&](const std::string& key, const std::vector<uint64_t>& remote_records) {
-        auto local_result = it->second->search(key);
-        if (local_result) {
-            std::vector<uint64_t> merged_records = *local_result;
-            resolve_conflicts(merged_records, remote_records);
-            it->second->insert(key, merged_records);
-        } else {
-            it->second->insert(key, remote_records);
+        for (uint64_t record_id : remote_records) {
+            auto insert_result = entry->index->insert(key, record_id);
+            if (insert_result.has_value() && !merge_result.has_value()) {
+                merge_result = insert_result;
+            }
         }
     });
+    if (merge_result.has_value()) {
+        return merge_result;
+    }
 
     LOG_INFO("Merged index for " + table_name + "." + column_name);
     return std::nullopt;
 }
 
-std::optional<std::string> IndexManager::bulk_load_index(const std::string& table_name, const std::string& column_name, const std::vector<std::pair<std::string, uint64_t>>& data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
+std::optional<std::string> IndexManager::bulk_load_index(const std::string& table_name, const std::string& column_name, std::vector<std::pair<std::string, uint64_t>> data,
+                                                        IndexType type, double fill_factor) {
+    // Sort before taking the catalog lock; large inputs are sorted on all workers
+    auto sort_result = parallel_sort(data.begin(), data.end());
+    if (sort_result.has_value()) {
+        return "Failed to sort index entries: " + *sort_result;
+    }
+    data.erase(std::unique(data.begin(), data.end()), data.end());
+
+    return bulk_load_entry(std::make_unique<IndexEntry>(IndexEntry{table_name, column_name, type, nullptr, {}, {}}), data, fill_factor);
+}
+
+std::optional<std::string> IndexManager::bulk_load_composite_index(const std::string& table_name, const std::vector<std::string>& key_columns,
+                                                                  const std::vector<std::string>& include_columns,
+                                                                  std::vector<std::pair<std::string, uint64_t>> data, double fill_factor) {
+    if (key_columns.empty() || (key_columns.size() == 1 && include_columns.empty())) {
+        return "A composite index needs several key columns or INCLUDE columns";
+    }
+    for (const auto* columns : {&key_columns, &include_columns}) {
+        for (const auto& column : *columns) {
+            if (column.empty() || column.find_first_of(std::string{KEY_COLUMN_SEPARATOR, INCLUDE_SEPARATOR, '\t'}) != std::string::npos) {
+                return "Invalid column name for a composite index: " + column;
+            }
+        }
+    }
+
+    auto sort_result = parallel_sort(data.begin(), data.end());
+    if (sort_result.has_value()) {
+        return "Failed to sort index entries: " + *sort_result;
+    }
+    data.erase(std::unique(data.begin(), data.end()), data.end());
+
+    // Composite keys are only useful in order, so they always go in a B-tree
+    std::string index_name = composite_index_name(key_columns, include_columns);
+    return bulk_load_entry(std::make_unique<IndexEntry>(IndexEntry{table_name, index_name, IndexType::BTREE, nullptr, key_columns, include_columns}),
+                           data, fill_factor);
+}
+
+std::optional<std::string> IndexManager::bulk_load_entry(std::unique_ptr<IndexEntry> entry, const std::vector<std::pair<std::string, uint64_t>>& data, double fill_factor) {
+    std::lock_guard<std::mutex> lock(catalog_mutex_);
+    std::string index_key = get_index_key(entry->table_name, entry->column_name);
     
     if (indexes_.find(index_key) != indexes_.end()) {
         return "Index already exists for this table and column";
     }
 
-    auto new_index = std::make_unique<BTree<std::string, std::vector<uint64_t>>>(10);
-    
-    // Sort the data for efficient bulk loading
-    std::vector<std::pair<std::string, uint64_t>> sorted_data = data;
-    std::sort(sorted_data.begin(), sorted_data.end());
-
-    // Bulk load the index
-    for (const auto& [value, record_id] : sorted_data) {
-        auto search_result = new_index->search(value);
-        if (search_result) {
-            search_result->push_back(record_id);
-            new_index->insert(value, *search_result);
-        } else {
-            new_index->insert(value, {record_id});
-        }
+    auto open_result = open_index(entry->table_name, entry->column_name, entry->type, entry->index);
+    if (open_result.has_value()) {
+        return open_result;
+    }
+
+    auto load_result = entry->index->bulk_load(data, fill_factor);
+    if (load_result.has_value()) {
+        destroy_index(*entry);
+        return load_result;
     }
 
-    indexes_[index_key] = std::move(new_index);
+    std::string description = std::string(index_type_name(entry->type)) + " index for " + entry->table_name + "." + entry->column_name;
+    indexes_[index_key] = std::move(entry);
+    publish_catalog();
+    auto catalog_result = save_catalog();
+    if (catalog_result.has_value()) {
+        return catalog_result;
+    }
     
-    LOG_INFO("Bulk loaded index for " + table_name + "." + column_name);
+    LOG_INFO("Bulk loaded " + description + " with " + std::to_string(data.size()) + " entries");
     return std::nullopt;
 }
 
 std::optional<IndexManager::IndexStats> IndexManager::get_index_stats(const std::string& table_name, const std::string& column_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string index_key = get_index_key(table_name, column_name);
-    
-    auto it = indexes_.find(index_key);
-    if (it == indexes_.end()) {
+    auto guard = epoch_.pin();
+    const IndexEntry* entry = find_index(table_name, column_name);
+    if (entry == nullptr) {
         return std::nullopt;
     }
 
     IndexStats stats;
-    stats.num_entries = it->second->size();
-    stats.height = it->second->height();
-    stats.num_nodes = it->second->node_count();
+    stats.num_entries = entry->index->size();
+    stats.height = entry->index->height();
+    stats.num_nodes = entry->index->node_count();
 
     return stats;
 }
@@ -230,13 +789,186 @@ std::string IndexManager::get_index_key(const std::string& table_name, const std
     return table_name + "." + column_name;
 }
 
-void IndexManager::resolve_conflicts(std::vector<uint64_t>& local_records, const std::vector<uint64_t>& remote_records) {
-    // This is a simple conflict resolution strategy that takes the union of local and remote records
-    std::vector<uint64_t> merged_records;
-    std::set_union(local_records.begin(), local_records.end(),
-                   remote_records.begin(), remote_records.end(),
-                   std::back_inserter(merged_records));
-    local_records = merged_records;
+std::string IndexManager::get_index_file_name(const std::string& table_name, const std::string& column_name) const {
+    return table_name + "." + column_name + ".idx";
+}
+
+std::optional<std::string> IndexManager::open_index(const std::string& table_name, const std::string& column_name, IndexType type, std::unique_ptr<Index>& index) {
+    if (type == IndexType::ART) {
+        index = std::make_unique<ArtIndex>();
+        return std::nullopt;
+    }
+    if (type == IndexType::BITMAP) {
+        index = std::make_unique<BitmapIndex>();
+        return std::nullopt;
+    }
+    if (type == IndexType::FULLTEXT) {
+        index = std::make_unique<FullTextIndex>(tokenizer_);
+        return std::nullopt;
+    }
+    if (type == IndexType::RTREE) {
+        index = std::make_unique<RTreeIndex>();
+        return std::nullopt;
+    }
+    if (type == IndexType::HNSW) {
+        if (!buffer_manager_) {
+            index = std::make_unique<HnswIndex>(vector_index_config_);
+            return std::nullopt;
+        }
+        auto vector_index = std::make_unique<HnswIndex>(vector_index_config_, buffer_manager_, get_index_file_name(table_name, column_name));
+        auto open_result = vector_index->open();
+        if (open_result.has_value()) {
+            return open_result;
+        }
+        index = std::move(vector_index);
+        return std::nullopt;
+    }
+
+    if (!buffer_manager_) {
+        if (type == IndexType::HASH) {
+            index = std::make_unique<HashIndex>();
+        } else {
+            index = std::make_unique<BTreeIndex>();
+        }
+        return std::nullopt;
+    }
+
+    std::string file_name = get_index_file_name(table_name, column_name);
+    if (type == IndexType::HASH) {
+        auto hash_index = std::make_unique<PagedHashIndex>(buffer_manager_, file_name);
+        auto open_result = hash_index->open();
+        if (open_result.has_value()) {
+            return open_result;
+        }
+        index = std::move(hash_index);
+        return std::nullopt;
+    }
+
+    auto paged_index = std::make_unique<PagedBTree>(buffer_manager_, file_name);
+    auto open_result = paged_index->open();
+    if (open_result.has_value()) {
+        return open_result;
+    }
+    index = std::move(paged_index);
+    return std::nullopt;
+}
+
+void IndexManager::destroy_index(const IndexEntry& entry) {
+    if (!buffer_manager_) {
+        return;
+    }
+    std::string file_name = get_index_file_name(entry.table_name, entry.column_name);
+    buffer_manager_->drop_file(file_name);
+    std::remove((data_directory_ + "/" + file_name).c_str());
+}
+
+std::optional<std::string> IndexManager::load_catalog() {
+    std::ifstream catalog(data_directory_ + "/" + CATALOG_FILE_NAME);
+    if (!catalog.is_open()) {
+        return std::nullopt;  // No indexes yet
+    }
+
+    // Lines are table, index name, type, then for composite indexes the key
+    // and INCLUDE columns. Catalogs written before index types existed only
+    // list single-column B-trees.
+    std::string line;
+    while (std::getline(catalog, line)) {
+        auto fields = split(line, '\t');
+        if (fields.size() < 2) {
+            continue;
+        }
+        const std::string& table_name = fields[0];
+        const std::string& column_name = fields[1];
+
+        IndexType type = IndexType::BTREE;
+        if (fields.size() > 2) {
+            auto parsed = parse_index_type(fields[2]);
+            if (!parsed.has_value()) {
+                return "Unknown index type in catalog: " + line;
+            }
+            type = *parsed;
+        }
+        std::vector<std::string> key_columns;
+        std::vector<std::string> include_columns;
+        if (fields.size() > 3) {
+            key_columns = split(fields[3], KEY_COLUMN_SEPARATOR);
+            include_columns = split(fields.size() > 4 ? fields[4] : std::string(), KEY_COLUMN_SEPARATOR);
+        }
+
+        std::unique_ptr<Index> index;
+        auto open_result = open_index(table_name, column_name, type, index);
+        if (open_result.has_value()) {
+            return "Failed to load index " + table_name + "." + column_name + ": " + *open_result;
+        }
+        auto entry = std::make_unique<IndexEntry>(
+            IndexEntry{table_name, column_name, type, std::move(index), std::move(key_columns), std::move(include_columns)});
+        if (entry->index->needs_rebuild()) {
+            indexes_to_rebuild_.emplace_back(table_name, entry->definition());
+        }
+        indexes_[get_index_key(table_name, column_name)] = std::move(entry);
+    }
+    return std::nullopt;
+}
+
+const IndexManager::IndexEntry* IndexManager::find_index(const std::string& table_name, const std::string& column_name) const {
+    const Catalog* catalog = catalog_.load(std::memory_order_acquire);
+    auto it = catalog->by_key.find(get_index_key(table_name, column_name));
+    return it != catalog->by_key.end() ? it->second : nullptr;
+}
+
+const IndexManager::IndexEntry* IndexManager::find_index(IndexId index_id) const {
+    const Catalog* catalog = catalog_.load(std::memory_order_acquire);
+    return index_id < catalog->by_id.size() ? catalog->by_id[index_id] : nullptr;
+}
+
+// The catalog is rewritten whole and renamed into place so a crash leaves
+// either the old or the new version
+std::optional<std::string> IndexManager::save_catalog() const {
+    if (!buffer_manager_) {
+        return std::nullopt;
+    }
+
+    std::ostringstream catalog;
+    // Memory-resident indexes are listed too; they come back empty and
+    // the storage engine refills them from their tables
+    for (const auto& [index_key, entry] : indexes_) {
+        catalog << entry->table_name << '\t' << entry->column_name << '\t' << index_type_name(entry->type);
+        if (!entry->key_columns.empty()) {
+            catalog << '\t' << join(entry->key_columns, KEY_COLUMN_SEPARATOR) << '\t' << join(entry->include_columns, KEY_COLUMN_SEPARATOR);
+        }
+        catalog << '\n';
+    }
+    if (!FileManager::write_file_durably(data_directory_ + "/" + CATALOG_FILE_NAME, catalog.str())) {
+        return "Failed to write index catalog";
+    }
+    return std::nullopt;
+}
+
+void IndexManager::publish_catalog() {
+    auto catalog = new Catalog();
+    catalog->version = ++catalog_version_;
+    catalog->by_id.resize(next_index_id_);
+    for (const auto& [index_key, entry] : indexes_) {
+        if (entry->id == 0) {
+            entry->id = next_index_id_++;
+            catalog->by_id.resize(next_index_id_);
+        }
+        catalog->by_key[index_key] = entry.get();
+        catalog->by_table[entry->table_name].push_back(entry.get());
+        catalog->by_id[entry->id] = entry.get();
+    }
+    const Catalog* old = catalog_.exchange(catalog, std::memory_order_acq_rel);
+    epoch_.retire(const_cast<Catalog*>(old));
+}
+
+void IndexManager::wait_for_readers() {
+    // Two epoch advances guarantee every thread pinned before this call has unpinned
+    uint64_t target = epoch_.get_epoch() + 2;
+    while (epoch_.get_epoch() < target) {
+        if (!epoch_.try_advance()) {
+            std::this_thread::yield();
+        }
+    }
 }
 
 } // namespace nexusdb
\ No newline at end of file
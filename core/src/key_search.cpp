@@ -0,0 +1,102 @@
+#include "nexusdb/key_search.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NEXUSDB_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace nexusdb {
+
+namespace {
+
+// Arrays up to this length are compared in full rather than bisected
+constexpr size_t LINEAR_SEARCH_THRESHOLD = 32;
+
+using CountFunction = size_t (*)(const uint64_t* values, size_t count, uint64_t target);
+
+size_t count_less_scalar(const uint64_t* values, size_t count, uint64_t target) {
+    size_t less = 0;
+    for (size_t i = 0; i < count; ++i) {
+        less += values[i] < target ? 1 : 0;
+    }
+    return less;
+}
+
+#ifdef NEXUSDB_X86_DISPATCH
+
+// The 64-bit compares are signed, so both sides are biased by flipping the sign bit
+
+__attribute__((target("sse4.2")))
+size_t count_less_sse42(const uint64_t* values, size_t count, uint64_t target) {
+    const __m128i bias = _mm_set1_epi64x(INT64_MIN);
+    const __m128i biased_target = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(target)), bias);
+    size_t less = 0;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(biased_target, block)));
+        less += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(values + i, count - i, target);
+}
+
+__attribute__((target("avx2")))
+size_t count_less_avx2(const uint64_t* values, size_t count, uint64_t target) {
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i biased_target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(target)), bias);
+    size_t less = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), bias);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(biased_target, block)));
+        less += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return less + count_less_scalar(values + i, count - i, target);
+}
+
+#endif
+
+struct Implementation {
+    CountFunction function;
+    const char* isa;
+};
+
+Implementation select_implementation() {
+#ifdef NEXUSDB_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {count_less_avx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return {count_less_sse42, "sse4.2"};
+    }
+#endif
+    return {count_less_scalar, "scalar"};
+}
+
+const Implementation& implementation() {
+    static const Implementation selected = select_implementation();
+    return selected;
+}
+
+} // namespace
+
+size_t count_less(const uint64_t* values, size_t count, uint64_t target) {
+    size_t base = 0;
+    while (count > LINEAR_SEARCH_THRESHOLD) {
+        size_t half = count / 2;
+        if (values[base + half] < target) {
+            base += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return base + implementation().function(values + base, count, target);
+}
+
+const char* key_search_isa() {
+    return implementation().isa;
+}
+
+} // namespace nexusdb
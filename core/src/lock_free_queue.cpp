@@ -1,10 +1,11 @@
 // File: src/lock_free_queue.cpp
 #include "nexusdb/lock_free_queue.h"
+#include <string>
 
 namespace nexusdb {
 
 template<typename T>
-LockFreeQueue<T>::LockFreeQueue() {
+LockFreeQueue<T>::LockFreeQueue() : free_list_(nullptr) {
     Node* dummy = new Node();
     head_.store(dummy);
     tail_.store(dummy);
@@ -16,24 +17,61 @@ LockFreeQueue<T>::~LockFreeQueue() {
         head_.store(old_head->next);
         delete old_head;
     }
+
+    // Retired nodes land on the free list, which is then released wholesale
+    epoch_manager_.reclaim_all();
+    while (Node* node = free_list_.load()) {
+        free_list_.store(node->free_next.load());
+        delete node;
+    }
+}
+
+template<typename T>
+typename LockFreeQueue<T>::Node* LockFreeQueue<T>::acquire_node() {
+    // The caller is pinned, and nodes only return to the free list after a
+    // grace period, so a node cannot be popped and pushed back underneath us.
+    Node* node = free_list_.load(std::memory_order_acquire);
+    while (node != nullptr) {
+        Node* next = node->free_next.load(std::memory_order_relaxed);
+        if (free_list_.compare_exchange_weak(node, next, std::memory_order_acquire, std::memory_order_acquire)) {
+            node->free_next.store(nullptr, std::memory_order_relaxed);
+            return node;
+        }
+    }
+    return new Node();
+}
+
+template<typename T>
+void LockFreeQueue<T>::recycle_node(void* ptr, void* queue_ptr) {
+    auto* node = static_cast<Node*>(ptr);
+    auto* queue = static_cast<LockFreeQueue<T>*>(queue_ptr);
+
+    node->data.reset();
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    Node* head = queue->free_list_.load(std::memory_order_relaxed);
+    do {
+        node->free_next.store(head, std::memory_order_relaxed);
+    } while (!queue->free_list_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
 }
 
 template<typename T>
 void LockFreeQueue<T>::enqueue(T value) {
-    Node* new_node = new Node();
-    new_node->data = std::make_shared<T>(std::move(value));
+    auto guard = epoch_manager_.pin();
+    Node* new_node = acquire_node();
+    new_node->data.emplace(std::move(value));
 
     while (true) {
-        Node* tail = tail_.load();
-        Node* next = tail->next.load();
-        if (tail == tail_.load()) {
+        Node* tail = tail_.load(std::memory_order_acquire);
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == tail_.load(std::memory_order_acquire)) {
             if (next == nullptr) {
-                if (tail->next.compare_exchange_weak(next, new_node)) {
-                    tail_.compare_exchange_strong(tail, new_node);
+                if (tail->next.compare_exchange_weak(next, new_node, std::memory_order_release, std::memory_order_relaxed)) {
+                    tail_.compare_exchange_strong(tail, new_node, std::memory_order_release, std::memory_order_relaxed);
                     return;
                 }
             } else {
-                tail_.compare_exchange_strong(tail, next);
+                tail_.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
             }
         }
     }
@@ -41,23 +79,24 @@ void LockFreeQueue<T>::enqueue(T value) {
 
 template<typename T>
 std::optional<T> LockFreeQueue<T>::dequeue() {
+    auto guard = epoch_manager_.pin();
     while (true) {
-        Node* head = head_.load();
-        Node* tail = tail_.load();
-        Node* next = head->next.load();
+        Node* head = head_.load(std::memory_order_acquire);
+        Node* tail = tail_.load(std::memory_order_acquire);
+        Node* next = head->next.load(std::memory_order_acquire);
 
-        if (head == head_.load()) {
+        if (head == head_.load(std::memory_order_acquire)) {
             if (head == tail) {
                 if (next == nullptr) {
                     return std::nullopt;
                 }
-                tail_.compare_exchange_strong(tail, next);
-            } else {
-                T result = std::move(*next->data);
-                if (head_.compare_exchange_weak(head, next)) {
-                    delete head;
-                    return result;
-                }
+                tail_.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+            } else if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                // Only the winner of the CAS touches the payload; next is now the dummy
+                std::optional<T> result(std::move(next->data));
+                next->data.reset();
+                epoch_manager_.retire(head, &LockFreeQueue<T>::recycle_node, this);
+                return result;
             }
         }
     }
@@ -65,7 +104,8 @@ std::optional<T> LockFreeQueue<T>::dequeue() {
 
 template<typename T>
 bool LockFreeQueue<T>::is_empty() const {
-    return head_.load() == tail_.load();
+    auto guard = epoch_manager_.pin();
+    return head_.load(std::memory_order_acquire)->next.load(std::memory_order_acquire) == nullptr;
 }
 
 // Explicit instantiation for common types
@@ -73,4 +113,4 @@ template class LockFreeQueue<int>;
 template class LockFreeQueue<double>;
 template class LockFreeQueue<std::string>;
 
-} // namespace nexusdb
\ No newline at end of file
+} // namespace nexusdb
@@ -1,4 +1,5 @@
 #include "nexusdb/nexusdb.h"
+#include "nexusdb/task_scheduler.h"
 #include "nexusdb/utils/logger.h"
 #include <algorithm>
 
@@ -22,7 +23,13 @@ NexusDB::~NexusDB() {
 std::optional<std::string> NexusDB::initialize(const std::string& data_directory, bool distributed) {
     LOG_INFO("Initializing NexusDB...");
     is_distributed_ = distributed;
-    
+
+    auto scheduler_result = TaskScheduler::get_instance().initialize();
+    if (scheduler_result.has_value()) {
+        LOG_ERROR("Failed to initialize TaskScheduler: " + scheduler_result.value());
+        return scheduler_result;
+    }
+
     if (is_distributed_) {
         storage_engine_ = std::make_shared<DistributedStorageEngine>(StorageConfig());
     } else {
@@ -35,6 +42,13 @@ std::optional<std::string> NexusDB::initialize(const std::string& data_directory
         return storage_result;
     }
 
+    // Changes logged before a crash are replayed before anything else runs
+    auto recover_result = storage_engine_->recover();
+    if (recover_result.has_value()) {
+        LOG_ERROR("Failed to recover StorageEngine: " + recover_result.value());
+        return recover_result;
+    }
+
     auto buffer_result = buffer_manager_->initialize();
     if (buffer_result.has_value()) {
         LOG_ERROR("Failed to initialize BufferManager: " + buffer_result.value());
@@ -99,6 +113,7 @@ void NexusDB::shutdown() {
     query_processor_->shutdown();
     buffer_manager_->shutdown();
     storage_engine_->shutdown();
+    TaskScheduler::get_instance().shutdown();
     LOG_INFO("NexusDB shut down successfully");
 }
 
@@ -203,6 +218,92 @@ std::optional<std::string> NexusDB::delete_record(const std::string& table_name,
     return storage_engine_->delete_record(table_name, record_id);
 }
 
+std::shared_ptr<Transaction> NexusDB::begin_transaction() {
+    if (!check_authentication()) {
+        return nullptr;
+    }
+    std::shared_ptr<Transaction> txn;
+    auto begin_result = storage_engine_->begin_transaction(txn);
+    if (begin_result.has_value()) {
+        LOG_ERROR("Failed to begin transaction: " + begin_result.value());
+        return nullptr;
+    }
+    LOG_INFO("Transaction " + std::to_string(txn->get_id()) + " started");
+    return txn;
+}
+
+std::shared_ptr<Transaction> NexusDB::begin_read_only() {
+    if (!check_authentication()) {
+        return nullptr;
+    }
+    std::shared_ptr<Transaction> txn;
+    auto begin_result = storage_engine_->begin_read_only(txn);
+    if (begin_result.has_value()) {
+        LOG_ERROR("Failed to begin read-only transaction: " + begin_result.value());
+        return nullptr;
+    }
+    return txn;
+}
+
+std::optional<std::string> NexusDB::commit_transaction(const std::shared_ptr<Transaction>& txn) {
+    if (!check_authentication()) {
+        return "Not authenticated. Please login first.";
+    }
+    return storage_engine_->commit_transaction(txn);
+}
+
+std::optional<std::string> NexusDB::abort_transaction(const std::shared_ptr<Transaction>& txn) {
+    if (!check_authentication()) {
+        return "Not authenticated. Please login first.";
+    }
+    return storage_engine_->abort_transaction(txn);
+}
+
+std::optional<std::vector<std::string>> NexusDB::read_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id) {
+    if (!check_authentication()) {
+        return std::vector<std::string>{"Not authenticated. Please login first."};
+    }
+    if (!check_table_ownership(table_name)) {
+        return std::vector<std::string>{"User does not have permission to access this table"};
+    }
+    std::vector<std::string> record;
+    auto read_result = storage_engine_->read_record(txn, table_name, record_id, record);
+    if (read_result.has_value()) {
+        return std::vector<std::string>{read_result.value()};
+    }
+    return record;
+}
+
+std::optional<std::string> NexusDB::insert_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::vector<std::string>& record) {
+    if (!check_authentication()) {
+        return "Not authenticated. Please login first.";
+    }
+    if (!check_table_ownership(table_name)) {
+        return "User does not have permission to access this table";
+    }
+    return storage_engine_->insert_record(txn, table_name, record);
+}
+
+std::optional<std::string> NexusDB::update_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record) {
+    if (!check_authentication()) {
+        return "Not authenticated. Please login first.";
+    }
+    if (!check_table_ownership(table_name)) {
+        return "User does not have permission to access this table";
+    }
+    return storage_engine_->update_record(txn, table_name, record_id, new_record);
+}
+
+std::optional<std::string> NexusDB::delete_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id) {
+    if (!check_authentication()) {
+        return "Not authenticated. Please login first.";
+    }
+    if (!check_table_ownership(table_name)) {
+        return "User does not have permission to access this table";
+    }
+    return storage_engine_->delete_record(txn, table_name, record_id);
+}
+
 std::optional<std::vector<std::string>> NexusDB::get_user_tables() {
     if (!check_authentication()) {
         return std::vector<std::string>{"Not authenticated. Please login first."};
@@ -287,9 +388,12 @@ std::optional<std::string> NexusDB::start_secure_server(int port, const std::str
             auto data = socket->receive();
             std::string command(data.begin(), data.end());
             LOG_INFO("Received command: " + command);
-            // Process the command and send a response
+            // Process the command on the scheduler, keeping this connection's
+            // thread for socket I/O, and send a response
             // This is just a placeholder - you'd implement actual command processing here
-            std::string response = "Command processed: " + command;
+            std::string response = TaskScheduler::get_instance().submit_async([command]() {
+                return "Command processed: " + command;
+            }).get();
             socket->send(std::vector<unsigned char>(response.begin(), response.end()));
         });
         LOG_INFO("Secure server started on port " + std::to_string(port));
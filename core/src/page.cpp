@@ -69,6 +69,9 @@ std::vector<char> Page::get_record(size_t offset) const {
     size_t record_size;
     std::memcpy(&record_size, data_.data() + offset, sizeof(size_t));
 
+    if (record_size & TOMBSTONE_BIT) {
+        return {}; // Deleted record
+    }
     if (offset + sizeof(size_t) + record_size > PAGE_SIZE) {
         return {}; // Corrupted record
     }
@@ -86,6 +89,9 @@ bool Page::update_record(size_t offset, const std::vector<char>& new_record) {
     size_t old_record_size;
     std::memcpy(&old_record_size, data_.data() + offset, sizeof(size_t));
 
+    if (old_record_size & TOMBSTONE_BIT) {
+        return false; // Deleted record
+    }
     if (offset + sizeof(size_t) + old_record_size > PAGE_SIZE) {
         return false; // Corrupted record
     }
@@ -116,15 +122,77 @@ bool Page::delete_record(size_t offset) {
     size_t record_size;
     std::memcpy(&record_size, data_.data() + offset, sizeof(size_t));
 
-    if (offset + sizeof(size_t) + record_size > PAGE_SIZE) {
-        return false; // Corrupted record
+    if (record_size == 0 || offset + sizeof(size_t) + record_size > PAGE_SIZE) {
+        return false; // Corrupted or already deleted record
     }
 
-    // Mark the space as free
-    std::memset(data_.data() + offset, 0, sizeof(size_t) + record_size);
-    free_space_ += sizeof(size_t) + record_size;
+    if (offset + sizeof(size_t) + record_size == PAGE_SIZE - free_space_) {
+        // Nothing follows the last record, so its space is simply freed
+        std::memset(data_.data() + offset, 0, sizeof(size_t) + record_size);
+        free_space_ += sizeof(size_t) + record_size;
+    } else {
+        // Records after it keep their offsets, and with them their ids
+        record_size |= TOMBSTONE_BIT;
+        std::memcpy(data_.data() + offset, &record_size, sizeof(size_t));
+    }
 
-    compact();
+    update_checksum();
+    return true;
+}
+
+size_t Page::tombstone_size(size_t offset) const {
+    ensure_decompressed();
+    if (offset + sizeof(size_t) > PAGE_SIZE) {
+        return 0;
+    }
+    size_t record_size;
+    std::memcpy(&record_size, data_.data() + offset, sizeof(size_t));
+    return (record_size & TOMBSTONE_BIT) ? record_size & ~TOMBSTONE_BIT : 0;
+}
+
+bool Page::put_record(size_t offset, const std::vector<char>& record) {
+    ensure_decompressed();
+    if (offset + sizeof(size_t) > PAGE_SIZE) {
+        return false;
+    }
+
+    size_t used_end = PAGE_SIZE - free_space_;
+    size_t limit = offset;
+    if (offset < used_end) {
+        size_t old_record_size;
+        std::memcpy(&old_record_size, data_.data() + offset, sizeof(size_t));
+        old_record_size &= ~TOMBSTONE_BIT;  // A deleted record's space can be reused
+        if (offset + sizeof(size_t) + old_record_size > PAGE_SIZE) {
+            return false; // Corrupted record
+        }
+        if (old_record_size != 0) {
+            limit = offset + sizeof(size_t) + old_record_size;
+        }
+    }
+    // Zeroed size words after it are free space
+    size_t old_end = limit;
+    while (limit + sizeof(size_t) <= PAGE_SIZE) {
+        size_t word;
+        std::memcpy(&word, data_.data() + limit, sizeof(size_t));
+        if (word != 0) {
+            break;
+        }
+        limit += sizeof(size_t);
+    }
+
+    size_t record_end = offset + sizeof(size_t) + record.size();
+    if (record_end > limit) {
+        return false;
+    }
+    if (old_end > record_end) {
+        std::memset(data_.data() + record_end, 0, old_end - record_end);
+    }
+    size_t record_size = record.size();
+    std::memcpy(data_.data() + offset, &record_size, sizeof(size_t));
+    std::memcpy(data_.data() + offset + sizeof(size_t), record.data(), record_size);
+    if (record_end > used_end) {
+        free_space_ = PAGE_SIZE - record_end;
+    }
     update_checksum();
     return true;
 }
@@ -305,35 +373,6 @@ bool Page::verify_checksum() const {
     return calculate_checksum() == checksum_;
 }
 
-void Page::compact() {
-    ensure_decompressed();
-    std::vector<char> temp_data(PAGE_SIZE, 0);
-    size_t write_offset = 0;
-    size_t read_offset = 0;
-
-    while (read_offset < PAGE_SIZE - free_space_) {
-        size_t record_size;
-        std::memcpy(&record_size, data_.data() + read_offset, sizeof(size_t));
-
-        if (record_size == 0) {
-            // Skip free space
-            read_offset += sizeof(size_t);
-        } else {
-            // Copy record to temp buffer
-            std::memcpy(temp_data.data() + write_offset, 
-                        data_.data() + read_offset, 
-                        sizeof(size_t) + record_size);
-            write_offset += sizeof(size_t) + record_size;
-            read_offset += sizeof(size_t) + record_size;
-        }
-    }
-
-    // Update data and free space
-    data_ = std::move(temp_data);
-    free_space_ = PAGE_SIZE - write_offset;
-    update_checksum();
-}
-
 void Page::ensure_decompressed() const {
     if (is_compressed_) {
         const_cast<Page*>(this)->decompress();
@@ -0,0 +1,986 @@
+#include "nexusdb/paged_btree.h"
+#include "nexusdb/utils/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace nexusdb {
+
+namespace {
+
+template<typename T>
+void put(char*& cursor, T value) {
+    std::memcpy(cursor, &value, sizeof(T));
+    cursor += sizeof(T);
+}
+
+template<typename T>
+T get(const char*& cursor) {
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+} // namespace
+
+PagedBTree::PagedBTree(std::shared_ptr<BufferManager> buffer_manager, const std::string& file_name)
+    : buffer_manager_(std::move(buffer_manager)), file_name_(file_name),
+      root_page_id_(0), entry_count_(0), height_(0), node_count_(0), free_list_head_(0),
+      structure_version_(0), restructuring_(false) {
+    for (auto& version : node_versions_) {
+        version.store(0, std::memory_order_relaxed);
+    }
+}
+
+PagedBTree::WriteScope::WriteScope(PagedBTree& tree) : tree(tree), lock(tree.write_mutex_) {}
+
+PagedBTree::WriteScope::~WriteScope() {
+    tree.end_restructure();
+}
+
+std::optional<std::string> PagedBTree::open() {
+    WriteScope scope(*this);
+    auto recover_result = buffer_manager_->recover_file(file_name_);
+    if (recover_result.has_value()) {
+        return "Failed to open index " + file_name_ + ": " + *recover_result;
+    }
+    try {
+        auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+        if (meta) {
+            const char* cursor = meta->get_data();
+            uint32_t magic = get<uint32_t>(cursor);
+            uint32_t version = get<uint32_t>(cursor);
+            if (magic == MAGIC) {
+                // Version 1 nodes are decoded as they are and written back front-coded
+                if (version == 0 || version > FORMAT_VERSION) {
+                    return "Unsupported index format version in " + file_name_;
+                }
+                root_page_id_ = get<uint64_t>(cursor);
+                entry_count_ = get<uint64_t>(cursor);
+                height_ = get<uint64_t>(cursor);
+                node_count_ = get<uint64_t>(cursor);
+                // Files written before the free list existed have zeroes here
+                free_list_head_ = get<uint64_t>(cursor);
+                LOG_DEBUG("Opened index file " + file_name_ + " with " + std::to_string(entry_count_) + " entries");
+                return std::nullopt;
+            }
+            if (magic != 0) {
+                return "Not an index file: " + file_name_;
+            }
+        } else {
+            meta = buffer_manager_->allocate_page(file_name_);
+            if (!meta || meta->get_page_id() != META_PAGE_ID) {
+                return "Failed to create index file: " + file_name_;
+            }
+        }
+
+        begin_restructure();
+        Node root;
+        root.page_id = allocate_node_page();
+        store_node(root);
+        root_page_id_ = root.page_id;
+        entry_count_ = 0;
+        height_ = 1;
+        node_count_ = 1;
+        free_list_head_ = 0;
+        store_meta();
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        return "Failed to open index " + file_name_ + ": " + e.what();
+    }
+}
+
+std::optional<std::string> PagedBTree::flush() {
+    WriteScope scope(*this);
+    try {
+        store_meta();
+    } catch (const std::exception& e) {
+        return "Failed to flush index " + file_name_ + ": " + e.what();
+    }
+    return buffer_manager_->flush_file(file_name_);
+}
+
+std::optional<std::string> PagedBTree::insert(const std::string& key, uint64_t record_id) {
+    if (key.size() > MAX_KEY_SIZE) {
+        return "Index key exceeds " + std::to_string(MAX_KEY_SIZE) + " bytes";
+    }
+
+    WriteScope scope(*this);
+    try {
+        bool inserted = false;
+        auto split_result = insert_into(root_page_id_, Entry{key, record_id}, inserted);
+        if (split_result) {
+            Node new_root;
+            new_root.page_id = allocate_node_page();
+            new_root.is_leaf = false;
+            new_root.entries.push_back(split_result->separator);
+            new_root.children = {root_page_id_, split_result->right_page_id};
+            store_node(new_root);
+            root_page_id_ = new_root.page_id;
+            height_++;
+        }
+        if (inserted) {
+            entry_count_++;
+        }
+        if (inserted || split_result) {
+            store_meta();
+        }
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index insert failed in " + file_name_ + ": " + e.what());
+        return "Index insert failed: " + std::string(e.what());
+    }
+}
+
+// Leaves may underflow or become empty; separators stay valid bounds
+std::optional<std::string> PagedBTree::remove(const std::string& key, uint64_t record_id) {
+    WriteScope scope(*this);
+    try {
+        bool removed = false;
+        remove_from(root_page_id_, Entry{key, record_id}, removed);
+        if (!removed) {
+            return std::nullopt;
+        }
+        entry_count_--;
+
+        Node root = load_node(root_page_id_);
+        if (!root.is_leaf && root.entries.empty()) {
+            begin_restructure();
+            root_page_id_ = root.children.front();
+            free_node_page(root.page_id);
+            height_--;
+        }
+        store_meta();
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index remove failed in " + file_name_ + ": " + e.what());
+        return "Index remove failed: " + std::string(e.what());
+    }
+}
+
+std::vector<uint64_t> PagedBTree::search(const std::string& key) const {
+    std::vector<uint64_t> record_ids;
+    scan(key, true, key, true, [&](const std::string&, uint64_t record_id) {
+        record_ids.push_back(record_id);
+        return true;
+    });
+    return record_ids;
+}
+
+std::vector<PostingList> PagedBTree::postings_batch(const std::vector<std::string>& keys) const {
+    std::vector<PostingList> lists(keys.size());
+    try {
+        // Copies of the pages from the root to the last leaf, each with the
+        // separator bounding it from above. Keys only grow, so a node still
+        // holds the next key's subtree while the key is below its bound, as
+        // long as no restructure ran since the path was read.
+        std::vector<PageBuffer> path;
+        std::vector<std::optional<Entry>> bounds;
+        uint64_t structure = begin_read();
+        for (size_t i = 0; i < keys.size(); ++i) {
+            Entry target{keys[i], 0};
+            auto lookup = [&]() {
+                while (!path.empty() && bounds.back().has_value() && !(target < *bounds.back())) {
+                    path.pop_back();
+                    bounds.pop_back();
+                }
+                if (path.empty()) {
+                    path.emplace_back();
+                    bounds.emplace_back();
+                    if (!read_page(root_page_id_.load(std::memory_order_acquire), structure, path.back())) {
+                        return false;
+                    }
+                }
+                while (true) {
+                    NodeCursor cursor(path.back().data(), &target.key);
+                    if (cursor.is_leaf()) {
+                        break;
+                    }
+                    std::optional<Entry> bound = bounds.back();
+                    uint64_t child = child_for(cursor, target, &bound);
+                    path.emplace_back();
+                    bounds.push_back(std::move(bound));
+                    if (!read_page(child, structure, path.back())) {
+                        return false;
+                    }
+                }
+
+                const char* leaf = path.back().data();
+                PageBuffer overflow;
+                bool left_path = false;
+                while (true) {
+                    NodeCursor cursor(leaf, &keys[i]);
+                    bool passed = false;
+                    while (cursor.advance()) {
+                        if (cursor.compare() > 0) {
+                            passed = true;
+                            break;
+                        }
+                        if (cursor.compare() == 0) {
+                            lists[i].add(cursor.record_id());
+                        }
+                    }
+                    if (cursor.is_malformed()) {
+                        throw std::runtime_error("corrupt leaf page");
+                    }
+                    if (passed || cursor.next_leaf() == 0) {
+                        break;
+                    }
+                    // The key's entries may go on in the next leaf, off the path
+                    if (!read_page(cursor.next_leaf(), structure, overflow)) {
+                        return false;
+                    }
+                    leaf = overflow.data();
+                    left_path = true;
+                }
+                if (left_path) {
+                    path.clear();
+                    bounds.clear();
+                }
+                return true;
+            };
+
+            if (structure_version_.load(std::memory_order_acquire) != structure) {
+                path.clear();
+                bounds.clear();
+                structure = begin_read();
+            }
+            while (!lookup()) {
+                lists[i] = PostingList();
+                path.clear();
+                bounds.clear();
+                structure = begin_read();
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index batch search failed in " + file_name_ + ": " + e.what());
+    }
+    return lists;
+}
+
+std::optional<std::string> PagedBTree::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) {
+    WriteScope scope(*this);
+    if (entry_count_ != 0 || height_ != 1) {
+        return "Bulk load requires an empty index";
+    }
+    if (entries.empty()) {
+        return std::nullopt;
+    }
+    begin_restructure();
+
+    size_t budget = std::clamp<size_t>(static_cast<size_t>(Page::PAGE_SIZE * fill_factor), size_t{Page::PAGE_SIZE / 2}, size_t{Page::PAGE_SIZE});
+    try {
+        // Each entry costs its suffix after the previous key, or the whole
+        // key when it starts a node
+        std::vector<size_t> entry_sizes;
+        std::vector<size_t> lead_sizes;
+        entry_sizes.reserve(entries.size());
+        lead_sizes.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const std::string& key = entries[i].first;
+            if (key.size() > MAX_KEY_SIZE) {
+                return "Index key exceeds " + std::to_string(MAX_KEY_SIZE) + " bytes";
+            }
+            size_t shared = i > 0 ? shared_prefix(entries[i - 1].first, key) : 0;
+            entry_sizes.push_back(ENTRY_OVERHEAD + key.size() - shared);
+            lead_sizes.push_back(ENTRY_OVERHEAD + key.size());
+        }
+
+        // Leaves, left to right; the empty root leaf becomes the first one
+        std::vector<size_t> leaf_groups = pack_groups(entry_sizes, lead_sizes, NODE_HEADER_SIZE, budget, 1);
+        std::vector<uint64_t> level{root_page_id_.load()};
+        for (size_t i = 1; i < leaf_groups.size(); ++i) {
+            level.push_back(allocate_node_page());
+        }
+
+        std::vector<Entry> low_entries;
+        size_t offset = 0;
+        for (size_t i = 0; i < level.size(); ++i) {
+            Node leaf;
+            leaf.page_id = level[i];
+            leaf.prev = i > 0 ? level[i - 1] : 0;
+            leaf.next = i + 1 < level.size() ? level[i + 1] : 0;
+            leaf.entries.reserve(leaf_groups[i]);
+            for (size_t j = offset; j < offset + leaf_groups[i]; ++j) {
+                leaf.entries.push_back(Entry{entries[j].first, entries[j].second});
+            }
+            // The separator in front of a leaf only has to sort after the last
+            // entry of the previous leaf
+            low_entries.push_back(offset > 0 ? separator_between(Entry{entries[offset - 1].first, entries[offset - 1].second}, leaf.entries.front())
+                                             : leaf.entries.front());
+            store_node(leaf);
+            offset += leaf_groups[i];
+        }
+        uint64_t levels = 1;
+
+        // Parent levels from the smallest entry below each child. Every child
+        // is costed as if it came with a separator, which slightly underfills
+        // the nodes but keeps them within the budget.
+        while (level.size() > 1) {
+            std::vector<size_t> child_sizes;
+            std::vector<size_t> child_lead_sizes;
+            child_sizes.reserve(level.size());
+            child_lead_sizes.reserve(level.size());
+            for (size_t i = 0; i < low_entries.size(); ++i) {
+                const std::string& key = low_entries[i].key;
+                size_t shared = i > 0 ? shared_prefix(low_entries[i - 1].key, key) : 0;
+                child_sizes.push_back(ENTRY_OVERHEAD + key.size() - shared + sizeof(uint64_t));
+                child_lead_sizes.push_back(ENTRY_OVERHEAD + key.size() + sizeof(uint64_t));
+            }
+
+            std::vector<uint64_t> parents;
+            std::vector<Entry> parent_low_entries;
+            offset = 0;
+            for (size_t group : pack_groups(child_sizes, child_lead_sizes, NODE_HEADER_SIZE, budget, 2)) {
+                Node parent;
+                parent.page_id = allocate_node_page();
+                parent.is_leaf = false;
+                parent.children.assign(level.begin() + offset, level.begin() + offset + group);
+                parent.entries.assign(low_entries.begin() + offset + 1, low_entries.begin() + offset + group);
+                store_node(parent);
+                parents.push_back(parent.page_id);
+                parent_low_entries.push_back(low_entries[offset]);
+                offset += group;
+            }
+            level = std::move(parents);
+            low_entries = std::move(parent_low_entries);
+            levels++;
+        }
+
+        root_page_id_ = level.front();
+        height_ = levels;
+        entry_count_ = entries.size();
+        store_meta();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index bulk load failed in " + file_name_ + ": " + e.what());
+        return "Index bulk load failed: " + std::string(e.what());
+    }
+    return buffer_manager_->flush_file(file_name_);
+}
+
+void PagedBTree::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                      const std::optional<std::string>& upper, bool upper_inclusive,
+                      const ScanVisitor& visitor) const {
+    try {
+        // Where a restarted scan picks up: the entries from start on, or
+        // after it once start itself was visited
+        std::optional<Entry> start;
+        bool start_visited = false;
+        if (lower.has_value()) {
+            start = Entry{*lower, lower_inclusive ? 0 : UINT64_MAX};
+        }
+
+        PageBuffer pages[2];
+        while (true) {
+            uint64_t structure = begin_read();
+            size_t current = 0;
+            if (start.has_value() ? !find_leaf(*start, structure, pages[current]) : !leftmost_leaf(structure, pages[current])) {
+                continue;
+            }
+
+            // Only the first leaf holds entries before start
+            bool positioned = !start.has_value();
+            while (true) {
+                NodeCursor cursor(pages[current].data(), positioned ? nullptr : &start->key);
+                while (cursor.advance()) {
+                    if (!positioned) {
+                        int order = cursor.compare(start->record_id);
+                        if (order < 0 || (order == 0 && start_visited)) {
+                            continue;
+                        }
+                        positioned = true;
+                    }
+                    const std::string& key = cursor.key();
+                    if (lower.has_value() && !lower_inclusive && key == *lower) {
+                        continue;
+                    }
+                    if (upper.has_value() && (upper_inclusive ? *upper < key : !(key < *upper))) {
+                        return;
+                    }
+                    if (!visitor(key, cursor.record_id())) {
+                        return;
+                    }
+                }
+                if (cursor.is_malformed()) {
+                    throw std::runtime_error("corrupt leaf page");
+                }
+                if (cursor.next_leaf() == 0) {
+                    return;
+                }
+                if (read_page(cursor.next_leaf(), structure, pages[1 - current])) {
+                    current = 1 - current;
+                    positioned = true;
+                    continue;
+                }
+                // Every entry of this leaf was visited or skipped
+                Entry last{cursor.key(), cursor.record_id()};
+                if (cursor.entry_count() > 0 && (!start.has_value() || !(last < *start))) {
+                    start = std::move(last);
+                    start_visited = true;
+                }
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Index scan failed in " + file_name_ + ": " + e.what());
+    }
+}
+
+size_t PagedBTree::size() const {
+    return entry_count_.load(std::memory_order_relaxed);
+}
+
+size_t PagedBTree::height() const {
+    return height_.load(std::memory_order_relaxed);
+}
+
+size_t PagedBTree::node_count() const {
+    return node_count_.load(std::memory_order_relaxed);
+}
+
+PagedBTree::Node PagedBTree::load_node(uint64_t page_id) const {
+    auto page = buffer_manager_->get_page(file_name_, page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(page_id));
+    }
+
+    NodeCursor cursor(page->get_data(), nullptr);
+    Node node;
+    node.page_id = page_id;
+    node.is_leaf = cursor.is_leaf();
+    node.next = cursor.next_leaf();
+    node.prev = cursor.prev_leaf();
+    node.entries.reserve(cursor.entry_count());
+    if (!node.is_leaf) {
+        node.children.reserve(cursor.entry_count() + 1);
+        node.children.push_back(cursor.first_child());
+    }
+    while (cursor.advance()) {
+        node.entries.push_back(Entry{cursor.key(), cursor.record_id()});
+        if (!node.is_leaf) {
+            node.children.push_back(cursor.child());
+        }
+    }
+    if (cursor.is_malformed()) {
+        throw std::runtime_error("corrupt node page " + std::to_string(page_id));
+    }
+    return node;
+}
+
+uint64_t PagedBTree::begin_read() const {
+    while (true) {
+        uint64_t structure = structure_version_.load(std::memory_order_acquire);
+        if ((structure & 1) == 0) {
+            return structure;
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool PagedBTree::read_page(uint64_t page_id, uint64_t structure, PageBuffer& copy) const {
+    auto page = buffer_manager_->get_page(file_name_, page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(page_id));
+    }
+
+    // Optimistic read: retry if the writer touched the node while it was copied
+    std::atomic<uint64_t>& version = node_version_for(page_id);
+    while (true) {
+        uint64_t seq = version.load(std::memory_order_acquire);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::memcpy(copy.data(), page->get_data(), Page::PAGE_SIZE);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == seq) {
+            break;
+        }
+    }
+
+    // The copy is whole, but it is only where the descent expects it if no
+    // split or merge started meanwhile; a freed page may hold anything
+    return structure_version_.load(std::memory_order_acquire) == structure;
+}
+
+PagedBTree::NodeCursor::NodeCursor(const char* data, const std::string* target)
+    : cursor_(data), end_(data + Page::PAGE_SIZE), target_(target), record_id_(0), child_(0),
+      matched_(0), order_(0), malformed_(false) {
+    is_leaf_ = get<uint8_t>(cursor_) != 0;
+    front_coded_ = (get<uint8_t>(cursor_) & NODE_FRONT_CODED) != 0;
+    count_ = get<uint16_t>(cursor_);
+    get<uint32_t>(cursor_);
+    next_leaf_ = get<uint64_t>(cursor_);
+    prev_leaf_ = get<uint64_t>(cursor_);
+    first_child_ = is_leaf_ ? 0 : get<uint64_t>(cursor_);
+    remaining_ = count_;
+    if (count_ > (Page::PAGE_SIZE - NODE_HEADER_SIZE) / (sizeof(uint16_t) + sizeof(uint64_t))) {
+        malformed_ = true;
+        remaining_ = 0;
+    }
+}
+
+bool PagedBTree::NodeCursor::advance() {
+    if (remaining_ == 0) {
+        return false;
+    }
+    remaining_--;
+
+    size_t shared = 0;
+    size_t suffix_size = 0;
+    if (front_coded_) {
+        if (static_cast<size_t>(end_ - cursor_) < 2 * sizeof(uint16_t)) {
+            malformed_ = true;
+        } else {
+            shared = get<uint16_t>(cursor_);
+            suffix_size = get<uint16_t>(cursor_);
+        }
+    } else if (static_cast<size_t>(end_ - cursor_) < sizeof(uint16_t)) {
+        malformed_ = true;
+    } else {
+        // Nodes written before front coding store whole keys
+        suffix_size = get<uint16_t>(cursor_);
+    }
+    size_t tail_size = is_leaf_ ? sizeof(uint64_t) : 2 * sizeof(uint64_t);
+    if (malformed_ || shared > key_.size() || static_cast<size_t>(end_ - cursor_) < suffix_size + tail_size) {
+        malformed_ = true;
+        remaining_ = 0;
+        return false;
+    }
+
+    bool first = remaining_ + 1 == count_;
+    key_.resize(shared);
+    key_.append(cursor_, suffix_size);
+    cursor_ += suffix_size;
+    record_id_ = get<uint64_t>(cursor_);
+    if (!is_leaf_) {
+        child_ = get<uint64_t>(cursor_);
+    }
+
+    if (target_ != nullptr) {
+        if (first || !front_coded_) {
+            matched_ = 0;
+            shared = 0;
+        }
+        if (shared < matched_) {
+            // Keys are sorted, so this one is above the previous key at the
+            // byte where that key still matched the target
+            matched_ = shared;
+            order_ = 1;
+        } else if (shared == matched_) {
+            const std::string& target = *target_;
+            size_t limit = std::min(key_.size(), target.size());
+            while (matched_ < limit && key_[matched_] == target[matched_]) {
+                matched_++;
+            }
+            if (matched_ < limit) {
+                order_ = static_cast<unsigned char>(key_[matched_]) < static_cast<unsigned char>(target[matched_]) ? -1 : 1;
+            } else {
+                order_ = key_.size() < target.size() ? -1 : (key_.size() > target.size() ? 1 : 0);
+            }
+        }
+        // A key sharing more with the previous one than that one did with
+        // the target compares the same way
+    }
+    return true;
+}
+
+int PagedBTree::NodeCursor::compare(uint64_t record_id) const {
+    if (order_ != 0) {
+        return order_;
+    }
+    return record_id_ < record_id ? -1 : (record_id_ > record_id ? 1 : 0);
+}
+
+uint64_t PagedBTree::child_for(NodeCursor& cursor, const Entry& target, std::optional<Entry>* bound) {
+    uint64_t child = cursor.first_child();
+    while (cursor.advance()) {
+        if (cursor.compare(target.record_id) > 0) {
+            if (bound != nullptr) {
+                *bound = Entry{cursor.key(), cursor.record_id()};
+            }
+            return child;
+        }
+        child = cursor.child();
+    }
+    if (cursor.is_malformed()) {
+        throw std::runtime_error("corrupt internal page");
+    }
+    return child;
+}
+
+std::atomic<uint64_t>& PagedBTree::node_version_for(uint64_t page_id) const {
+    return node_versions_[page_id % NODE_VERSION_STRIPES];
+}
+
+void PagedBTree::begin_restructure() {
+    if (!restructuring_) {
+        structure_version_.fetch_add(1, std::memory_order_acq_rel);
+        restructuring_ = true;
+    }
+}
+
+void PagedBTree::end_restructure() {
+    if (restructuring_) {
+        structure_version_.fetch_add(1, std::memory_order_release);
+        restructuring_ = false;
+    }
+}
+
+void PagedBTree::store_node(const Node& node) {
+    auto page = buffer_manager_->get_page(file_name_, node.page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(node.page_id));
+    }
+
+    std::atomic<uint64_t>& version = node_version_for(node.page_id);
+    version.fetch_add(1, std::memory_order_acq_rel);
+    char* cursor = page->get_data();
+    put<uint8_t>(cursor, node.is_leaf ? 1 : 0);
+    put<uint8_t>(cursor, NODE_FRONT_CODED);
+    put<uint16_t>(cursor, static_cast<uint16_t>(node.entries.size()));
+    put<uint32_t>(cursor, 0);
+    put<uint64_t>(cursor, node.next);
+    put<uint64_t>(cursor, node.prev);
+
+    if (!node.is_leaf) {
+        put<uint64_t>(cursor, node.children[0]);
+    }
+    for (size_t i = 0; i < node.entries.size(); ++i) {
+        const Entry& entry = node.entries[i];
+        size_t shared = i > 0 ? shared_prefix(node.entries[i - 1].key, entry.key) : 0;
+        put<uint16_t>(cursor, static_cast<uint16_t>(shared));
+        put<uint16_t>(cursor, static_cast<uint16_t>(entry.key.size() - shared));
+        std::memcpy(cursor, entry.key.data() + shared, entry.key.size() - shared);
+        cursor += entry.key.size() - shared;
+        put<uint64_t>(cursor, entry.record_id);
+        if (!node.is_leaf) {
+            put<uint64_t>(cursor, node.children[i + 1]);
+        }
+    }
+    version.fetch_add(1, std::memory_order_release);
+    buffer_manager_->mark_dirty(file_name_, node.page_id);
+}
+
+uint64_t PagedBTree::allocate_node_page() {
+    if (free_list_head_ != 0) {
+        uint64_t page_id = free_list_head_;
+        auto page = buffer_manager_->get_page(file_name_, page_id);
+        if (!page) {
+            throw std::runtime_error("failed to read free page " + std::to_string(page_id));
+        }
+        const char* cursor = page->get_data();
+        free_list_head_ = get<uint64_t>(cursor);
+        node_count_++;
+        return page_id;
+    }
+
+    auto page = buffer_manager_->allocate_page(file_name_);
+    if (!page) {
+        throw std::runtime_error("failed to allocate index page");
+    }
+    node_count_++;
+    return page->get_page_id();
+}
+
+// A free page holds only the id of the next free page
+void PagedBTree::free_node_page(uint64_t page_id) {
+    auto page = buffer_manager_->get_page(file_name_, page_id);
+    if (!page) {
+        throw std::runtime_error("failed to read page " + std::to_string(page_id));
+    }
+    std::atomic<uint64_t>& version = node_version_for(page_id);
+    version.fetch_add(1, std::memory_order_acq_rel);
+    char* cursor = page->get_data();
+    put<uint64_t>(cursor, free_list_head_);
+    version.fetch_add(1, std::memory_order_release);
+    buffer_manager_->mark_dirty(file_name_, page_id);
+    free_list_head_ = page_id;
+    node_count_--;
+}
+
+void PagedBTree::store_meta() {
+    auto meta = buffer_manager_->get_page(file_name_, META_PAGE_ID);
+    if (!meta) {
+        throw std::runtime_error("failed to read index metadata");
+    }
+    char* cursor = meta->get_data();
+    put<uint32_t>(cursor, MAGIC);
+    put<uint32_t>(cursor, FORMAT_VERSION);
+    put<uint64_t>(cursor, root_page_id_);
+    put<uint64_t>(cursor, entry_count_);
+    put<uint64_t>(cursor, height_);
+    put<uint64_t>(cursor, node_count_);
+    put<uint64_t>(cursor, free_list_head_);
+    buffer_manager_->mark_dirty(file_name_, META_PAGE_ID);
+}
+
+size_t PagedBTree::encoded_size(const Node& node) {
+    size_t size = NODE_HEADER_SIZE + (node.is_leaf ? 0 : sizeof(uint64_t));
+    for (size_t i = 0; i < node.entries.size(); ++i) {
+        size += entry_size(node, i);
+    }
+    return size;
+}
+
+size_t PagedBTree::entry_size(const Node& node, size_t index) {
+    const std::string& key = node.entries[index].key;
+    size_t shared = index > 0 ? shared_prefix(node.entries[index - 1].key, key) : 0;
+    return ENTRY_OVERHEAD + key.size() - shared + (node.is_leaf ? 0 : sizeof(uint64_t));
+}
+
+size_t PagedBTree::shared_prefix(const std::string& a, const std::string& b) {
+    size_t limit = std::min(a.size(), b.size());
+    size_t shared = 0;
+    while (shared < limit && a[shared] == b[shared]) {
+        shared++;
+    }
+    return shared;
+}
+
+PagedBTree::Entry PagedBTree::separator_between(const Entry& left, const Entry& right) {
+    if (!(left.key < right.key)) {
+        return right;
+    }
+    // The shortest prefix of right's key that still sorts after left's key
+    return Entry{right.key.substr(0, shared_prefix(left.key, right.key) + 1), 0};
+}
+
+std::vector<size_t> PagedBTree::pack_groups(const std::vector<size_t>& item_sizes, const std::vector<size_t>& lead_sizes,
+                                            size_t base_size, size_t budget, size_t min_items) {
+    std::vector<size_t> groups;
+    std::vector<size_t> group_bytes;
+    size_t count = 0;
+    size_t bytes = base_size;
+    for (size_t i = 0; i < item_sizes.size(); ++i) {
+        if (count >= min_items && bytes + item_sizes[i] > budget) {
+            groups.push_back(count);
+            group_bytes.push_back(bytes);
+            count = 0;
+            bytes = base_size;
+        }
+        bytes += count == 0 ? lead_sizes[i] : item_sizes[i];
+        count++;
+    }
+    groups.push_back(count);
+    group_bytes.push_back(bytes);
+
+    // Top up a short last group from its neighbour so no node ends up nearly
+    // empty. The moved item becomes the lead of the last group.
+    size_t last = groups.size() - 1;
+    size_t boundary = item_sizes.size() - groups[last];
+    while (last > 0 && groups[last - 1] > min_items && (groups[last] < min_items || group_bytes[last] < budget / 2)) {
+        size_t moved = boundary - 1;
+        size_t last_bytes = group_bytes[last] + lead_sizes[moved] - lead_sizes[boundary] + item_sizes[boundary];
+        size_t previous_bytes = group_bytes[last - 1] - item_sizes[moved];
+        if (groups[last] >= min_items && last_bytes >= previous_bytes) {
+            break;
+        }
+        groups[last - 1]--;
+        group_bytes[last - 1] = previous_bytes;
+        groups[last]++;
+        group_bytes[last] = last_bytes;
+        boundary--;
+    }
+    if (last > 0 && groups[last] < min_items) {
+        // The neighbour is down to min_items as well, so the two fit in one node
+        groups[last - 1] += groups[last];
+        groups.pop_back();
+    }
+    return groups;
+}
+
+std::optional<PagedBTree::SplitResult> PagedBTree::insert_into(uint64_t page_id, const Entry& entry, bool& inserted) {
+    Node node = load_node(page_id);
+
+    if (node.is_leaf) {
+        auto it = std::lower_bound(node.entries.begin(), node.entries.end(), entry);
+        if (it != node.entries.end() && *it == entry) {
+            inserted = false;
+            return std::nullopt;
+        }
+        node.entries.insert(it, entry);
+        inserted = true;
+    } else {
+        size_t child = std::upper_bound(node.entries.begin(), node.entries.end(), entry) - node.entries.begin();
+        auto child_split = insert_into(node.children[child], entry, inserted);
+        if (!child_split) {
+            return std::nullopt;
+        }
+        node.entries.insert(node.entries.begin() + child, child_split->separator);
+        node.children.insert(node.children.begin() + child + 1, child_split->right_page_id);
+    }
+
+    if (encoded_size(node) > Page::PAGE_SIZE) {
+        return split(node);
+    }
+    store_node(node);
+    return std::nullopt;
+}
+
+size_t PagedBTree::split_point(const Node& node) {
+    size_t total = encoded_size(node);
+    size_t running = NODE_HEADER_SIZE;
+    size_t mid = 0;
+    while (mid < node.entries.size() - 1 && running < total / 2) {
+        running += entry_size(node, mid);
+        mid++;
+    }
+    return std::max<size_t>(mid, 1);
+}
+
+// Splits an overfull node roughly in half by encoded size and stores both halves
+PagedBTree::SplitResult PagedBTree::split(Node& node) {
+    begin_restructure();
+    size_t mid = split_point(node);
+
+    Node right;
+    right.page_id = allocate_node_page();
+    right.is_leaf = node.is_leaf;
+    SplitResult result;
+    result.right_page_id = right.page_id;
+
+    if (node.is_leaf) {
+        right.entries.assign(node.entries.begin() + mid, node.entries.end());
+        node.entries.resize(mid);
+        result.separator = separator_between(node.entries.back(), right.entries.front());
+
+        right.next = node.next;
+        right.prev = node.page_id;
+        if (node.next != 0) {
+            Node next = load_node(node.next);
+            next.prev = right.page_id;
+            store_node(next);
+        }
+        node.next = right.page_id;
+    } else {
+        result.separator = node.entries[mid];
+        right.entries.assign(node.entries.begin() + mid + 1, node.entries.end());
+        right.children.assign(node.children.begin() + mid + 1, node.children.end());
+        node.entries.resize(mid);
+        node.children.resize(mid + 1);
+    }
+
+    store_node(node);
+    store_node(right);
+    return result;
+}
+
+bool PagedBTree::remove_from(uint64_t page_id, const Entry& entry, bool& removed) {
+    Node node = load_node(page_id);
+
+    if (node.is_leaf) {
+        auto it = std::lower_bound(node.entries.begin(), node.entries.end(), entry);
+        if (it == node.entries.end() || !(*it == entry)) {
+            removed = false;
+            return false;
+        }
+        node.entries.erase(it);
+        removed = true;
+        store_node(node);
+    } else {
+        size_t child = std::upper_bound(node.entries.begin(), node.entries.end(), entry) - node.entries.begin();
+        if (!remove_from(node.children[child], entry, removed)) {
+            return false;
+        }
+        rebalance(node, child);
+    }
+    return encoded_size(node) < MIN_NODE_SIZE;
+}
+
+void PagedBTree::rebalance(Node& parent, size_t index) {
+    if (parent.children.size() < 2) {
+        return;  // The parent is underfull itself and gets fixed one level up
+    }
+    begin_restructure();
+    // Work on the pair (left, right) around separator parent.entries[sep]
+    size_t sep = index + 1 < parent.children.size() ? index : index - 1;
+    Node left = load_node(parent.children[sep]);
+    Node right = load_node(parent.children[sep + 1]);
+
+    Node combined;
+    combined.page_id = left.page_id;
+    combined.is_leaf = left.is_leaf;
+    combined.prev = left.prev;
+    combined.next = left.is_leaf ? right.next : 0;
+    combined.entries = std::move(left.entries);
+    if (!combined.is_leaf) {
+        combined.entries.push_back(parent.entries[sep]);
+        combined.children = std::move(left.children);
+        combined.children.insert(combined.children.end(), right.children.begin(), right.children.end());
+    }
+    combined.entries.insert(combined.entries.end(), right.entries.begin(), right.entries.end());
+
+    if (encoded_size(combined) <= MAX_MERGED_SIZE) {
+        if (combined.is_leaf && combined.next != 0) {
+            Node next = load_node(combined.next);
+            next.prev = combined.page_id;
+            store_node(next);
+        }
+        store_node(combined);
+        free_node_page(right.page_id);
+        parent.entries.erase(parent.entries.begin() + sep);
+        parent.children.erase(parent.children.begin() + sep + 1);
+        store_node(parent);
+        return;
+    }
+
+    // A longer separator could overflow the parent; the child then simply
+    // stays underfull
+    size_t mid = split_point(combined);
+    Entry separator = combined.is_leaf ? separator_between(combined.entries[mid - 1], combined.entries[mid]) : combined.entries[mid];
+    Entry replaced = std::move(parent.entries[sep]);
+    parent.entries[sep] = std::move(separator);
+    if (encoded_size(parent) > Page::PAGE_SIZE) {
+        parent.entries[sep] = std::move(replaced);
+        return;
+    }
+    right.entries.clear();
+    if (combined.is_leaf) {
+        right.entries.assign(combined.entries.begin() + mid, combined.entries.end());
+    } else {
+        right.entries.assign(combined.entries.begin() + mid + 1, combined.entries.end());
+        right.children.assign(combined.children.begin() + mid + 1, combined.children.end());
+        combined.children.resize(mid + 1);
+    }
+    combined.entries.resize(mid);
+    combined.next = left.next;
+    store_node(combined);
+    store_node(right);
+    store_node(parent);
+}
+
+bool PagedBTree::find_leaf(const Entry& target, uint64_t structure, PageBuffer& leaf) const {
+    uint64_t page_id = root_page_id_.load(std::memory_order_acquire);
+    while (true) {
+        if (!read_page(page_id, structure, leaf)) {
+            return false;
+        }
+        NodeCursor cursor(leaf.data(), &target.key);
+        if (cursor.is_leaf()) {
+            return true;
+        }
+        page_id = child_for(cursor, target, nullptr);
+    }
+}
+
+bool PagedBTree::leftmost_leaf(uint64_t structure, PageBuffer& leaf) const {
+    uint64_t page_id = root_page_id_.load(std::memory_order_acquire);
+    while (true) {
+        if (!read_page(page_id, structure, leaf)) {
+            return false;
+        }
+        NodeCursor cursor(leaf.data(), nullptr);
+        if (cursor.is_leaf()) {
+            return true;
+        }
+        page_id = cursor.first_child();
+    }
+}
+
+} // namespace nexusdb
@@ -0,0 +1,247 @@
+#include "nexusdb/posting_list.h"
+#include <algorithm>
+
+namespace nexusdb {
+
+PostingList::PostingList(std::vector<uint64_t> record_ids) {
+    std::sort(record_ids.begin(), record_ids.end());
+    record_ids.erase(std::unique(record_ids.begin(), record_ids.end()), record_ids.end());
+    for (uint64_t record_id : record_ids) {
+        append(record_id);
+    }
+}
+
+bool PostingList::add(uint64_t record_id) {
+    if (blocks_.empty() || record_id > blocks_.back().last) {
+        append(record_id);
+        return true;
+    }
+
+    size_t index = find_block(record_id);
+    std::vector<uint64_t> ids = decode(blocks_[index]);
+    auto it = std::lower_bound(ids.begin(), ids.end(), record_id);
+    if (it != ids.end() && *it == record_id) {
+        return false;
+    }
+    ids.insert(it, record_id);
+    size_++;
+
+    if (ids.size() > BLOCK_CAPACITY) {
+        size_t half = ids.size() / 2;
+        blocks_[index] = encode(ids.data(), half);
+        blocks_.insert(blocks_.begin() + index + 1, encode(ids.data() + half, ids.size() - half));
+    } else {
+        blocks_[index] = encode(ids.data(), ids.size());
+    }
+    return true;
+}
+
+bool PostingList::remove(uint64_t record_id) {
+    if (blocks_.empty()) {
+        return false;
+    }
+    size_t index = find_block(record_id);
+    const Block& block = blocks_[index];
+    if (record_id < block.first || record_id > block.last) {
+        return false;
+    }
+
+    std::vector<uint64_t> ids = decode(block);
+    auto it = std::lower_bound(ids.begin(), ids.end(), record_id);
+    if (it == ids.end() || *it != record_id) {
+        return false;
+    }
+    ids.erase(it);
+    size_--;
+
+    if (ids.empty()) {
+        blocks_.erase(blocks_.begin() + index);
+    } else {
+        blocks_[index] = encode(ids.data(), ids.size());
+    }
+    return true;
+}
+
+bool PostingList::contains(uint64_t record_id) const {
+    if (blocks_.empty()) {
+        return false;
+    }
+    const Block& block = blocks_[find_block(record_id)];
+    if (record_id < block.first || record_id > block.last) {
+        return false;
+    }
+
+    uint64_t value = block.first;
+    size_t offset = 0;
+    for (size_t i = 1; i < block.count && value < record_id; ++i) {
+        value += get_varint(block.gaps, offset);
+    }
+    return value == record_id;
+}
+
+size_t PostingList::encoded_size() const {
+    size_t bytes = 0;
+    for (const auto& block : blocks_) {
+        bytes += 2 * sizeof(uint64_t) + sizeof(uint32_t) + block.gaps.size();
+    }
+    return bytes;
+}
+
+void PostingList::for_each(const Visitor& visitor) const {
+    for (Cursor cursor(*this); cursor.valid(); cursor.next()) {
+        visitor(cursor.value());
+    }
+}
+
+std::vector<uint64_t> PostingList::to_vector() const {
+    std::vector<uint64_t> record_ids;
+    record_ids.reserve(size_);
+    for (Cursor cursor(*this); cursor.valid(); cursor.next()) {
+        record_ids.push_back(cursor.value());
+    }
+    return record_ids;
+}
+
+PostingList PostingList::intersect(const PostingList& left, const PostingList& right) {
+    PostingList result;
+    Cursor a(left);
+    Cursor b(right);
+    while (a.valid() && b.valid()) {
+        if (a.value() == b.value()) {
+            result.append(a.value());
+            a.next();
+            b.next();
+        } else if (a.value() < b.value()) {
+            a.seek(b.value());
+        } else {
+            b.seek(a.value());
+        }
+    }
+    return result;
+}
+
+PostingList PostingList::unite(const PostingList& left, const PostingList& right) {
+    PostingList result;
+    Cursor a(left);
+    Cursor b(right);
+    while (a.valid() || b.valid()) {
+        if (!b.valid() || (a.valid() && a.value() < b.value())) {
+            result.append(a.value());
+            a.next();
+        } else if (!a.valid() || b.value() < a.value()) {
+            result.append(b.value());
+            b.next();
+        } else {
+            result.append(a.value());
+            a.next();
+            b.next();
+        }
+    }
+    return result;
+}
+
+PostingList::Cursor::Cursor(const PostingList& list)
+    : list_(list), block_(0), position_(0), offset_(0), value_(0) {
+    enter_block();
+}
+
+void PostingList::Cursor::next() {
+    const Block& block = list_.blocks_[block_];
+    if (position_ + 1 < block.count) {
+        value_ += get_varint(block.gaps, offset_);
+        position_++;
+        return;
+    }
+    block_++;
+    enter_block();
+}
+
+void PostingList::Cursor::seek(uint64_t target) {
+    if (!valid() || value_ >= target) {
+        return;
+    }
+    if (list_.blocks_[block_].last < target) {
+        do {
+            block_++;
+        } while (valid() && list_.blocks_[block_].last < target);
+        enter_block();
+    }
+    while (valid() && value_ < target) {
+        next();
+    }
+}
+
+void PostingList::Cursor::enter_block() {
+    position_ = 0;
+    offset_ = 0;
+    if (valid()) {
+        value_ = list_.blocks_[block_].first;
+    }
+}
+
+void PostingList::append(uint64_t record_id) {
+    if (blocks_.empty() || blocks_.back().count == BLOCK_CAPACITY) {
+        Block block;
+        block.first = record_id;
+        block.last = record_id;
+        block.count = 1;
+        blocks_.push_back(std::move(block));
+    } else {
+        Block& tail = blocks_.back();
+        put_varint(tail.gaps, record_id - tail.last);
+        tail.last = record_id;
+        tail.count++;
+    }
+    size_++;
+}
+
+size_t PostingList::find_block(uint64_t record_id) const {
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), record_id,
+                               [](uint64_t id, const Block& block) { return id < block.first; });
+    return it == blocks_.begin() ? 0 : static_cast<size_t>(it - blocks_.begin()) - 1;
+}
+
+std::vector<uint64_t> PostingList::decode(const Block& block) {
+    std::vector<uint64_t> record_ids;
+    record_ids.reserve(block.count + 1);
+    uint64_t value = block.first;
+    size_t offset = 0;
+    record_ids.push_back(value);
+    for (size_t i = 1; i < block.count; ++i) {
+        value += get_varint(block.gaps, offset);
+        record_ids.push_back(value);
+    }
+    return record_ids;
+}
+
+PostingList::Block PostingList::encode(const uint64_t* record_ids, size_t count) {
+    Block block;
+    block.first = record_ids[0];
+    block.last = record_ids[count - 1];
+    block.count = count;
+    for (size_t i = 1; i < count; ++i) {
+        put_varint(block.gaps, record_ids[i] - record_ids[i - 1]);
+    }
+    return block;
+}
+
+void PostingList::put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t PostingList::get_varint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (in[offset] & 0x80) {
+        value |= static_cast<uint64_t>(in[offset++] & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint64_t>(in[offset++]) << shift;
+    return value;
+}
+
+} // namespace nexusdb
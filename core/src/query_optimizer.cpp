@@ -2,9 +2,86 @@
 #include "nexusdb/index_manager.h"
 #include "nexusdb/utils/logger.h"
 #include "nexusdb/schema_manager.h"
+#include <algorithm>
+#include <tuple>
 
 namespace nexusdb {
 
+namespace {
+
+const char* predicate_op_symbol(PredicateOp op) {
+    switch (op) {
+        case PredicateOp::EQUAL:
+            return "=";
+        case PredicateOp::LESS:
+            return "<";
+        case PredicateOp::LESS_EQUAL:
+            return "<=";
+        case PredicateOp::GREATER:
+            return ">";
+        case PredicateOp::GREATER_EQUAL:
+            return ">=";
+        case PredicateOp::MATCH:
+            return "MATCH";
+        case PredicateOp::INTERSECTS:
+            return "&&";
+        case PredicateOp::DWITHIN:
+            return "DWITHIN";
+    }
+    return "=";
+}
+
+// Whether every column the scan reads or filters on is stored in the index
+bool covers(const IndexManager::IndexDefinition& definition, const ScanNode& scan_node) {
+    if (!definition.is_composite()) {
+        return false;  // Single-column indexes keep no row values
+    }
+    auto stored = [&](const std::string& column) {
+        return std::find(definition.key_columns.begin(), definition.key_columns.end(), column) != definition.key_columns.end() ||
+               std::find(definition.include_columns.begin(), definition.include_columns.end(), column) != definition.include_columns.end();
+    };
+    return std::all_of(scan_node.columns.begin(), scan_node.columns.end(), stored) &&
+           std::all_of(scan_node.predicates.begin(), scan_node.predicates.end(),
+                       [&](const ColumnPredicate& predicate) { return stored(predicate.column); });
+}
+
+// Among indexes answering the same predicates: hash lookups are O(1), and
+// adaptive radix trees and bitmaps stay in memory
+int lookup_preference(IndexType type) {
+    switch (type) {
+        case IndexType::HASH:
+            return 2;
+        case IndexType::ART:
+        case IndexType::BITMAP:
+            return 1;
+        case IndexType::BTREE:
+        case IndexType::FULLTEXT:
+        case IndexType::HNSW:
+        case IndexType::RTREE:
+            return 0;
+    }
+    return 0;
+}
+
+// Comparisons an ordered index answers with a key range
+bool is_range_op(PredicateOp op) {
+    switch (op) {
+        case PredicateOp::LESS:
+        case PredicateOp::LESS_EQUAL:
+        case PredicateOp::GREATER:
+        case PredicateOp::GREATER_EQUAL:
+            return true;
+        case PredicateOp::EQUAL:
+        case PredicateOp::MATCH:
+        case PredicateOp::INTERSECTS:
+        case PredicateOp::DWITHIN:
+            return false;
+    }
+    return false;
+}
+
+} // namespace
+
 QueryOptimizer::QueryOptimizer(std::shared_ptr<IndexManager> index_manager)
     : index_manager_(index_manager) {}
 
@@ -15,6 +92,14 @@ QueryPlan QueryOptimizer::optimize(const std::string& query) {
     return initial_plan;
 }
 
+QueryPlan QueryOptimizer::optimize_scan(const ScanNode& scan_node) {
+    QueryPlan plan;
+    plan.root = std::make_unique<ScanNode>(scan_node);
+    optimize_joins(plan);
+    apply_index_selection(plan);
+    return plan;
+}
+
 QueryPlan QueryOptimizer::generate_initial_plan(const std::string& query) {
     // This would involve parsing the query and creating a basic execution plan
     // For simplicity, we'll just create a dummy plan here
@@ -30,16 +115,119 @@ void QueryOptimizer::optimize_joins(QueryPlan& plan) {
 }
 
 void QueryOptimizer::apply_index_selection(QueryPlan& plan) {
-    // This would involve checking for applicable indexes and modifying the plan to use them
     // For simplicity, we'll just check if we can replace a ScanNode with an IndexScanNode
     if (auto* scan_node = dynamic_cast<ScanNode*>(plan.root.get())) {
-        if (index_manager_->search_index(scan_node->table_name, scan_node->columns[0], "").has_value()) {
-            auto index_scan = std::make_unique<IndexScanNode>();
-            index_scan->table_name = scan_node->table_name;
-            index_scan->index_name = scan_node->table_name + "." + scan_node->columns[0];
+        auto index_scan = choose_index(*scan_node);
+        if (index_scan) {
             plan.root = std::move(index_scan);
         }
     }
 }
 
+std::unique_ptr<IndexScanNode> QueryOptimizer::choose_index(const ScanNode& scan_node) {
+    struct Candidate {
+        IndexManager::IndexDefinition definition;
+        std::vector<ColumnPredicate> predicates;
+        size_t equalities = 0;
+        bool range = false;
+        bool covering = false;
+
+        auto rank() const { return std::make_tuple(equalities, range, covering, lookup_preference(definition.type)); }
+    };
+
+    std::optional<Candidate> best;
+    std::optional<Candidate> ordered_fallback;
+    // A full-text or spatial index answering a MATCH or spatial predicate
+    std::optional<Candidate> dedicated;
+    for (auto& definition : index_manager_->get_table_indexes(scan_node.table_name)) {
+        Candidate candidate;
+        if (definition.type == IndexType::FULLTEXT || definition.type == IndexType::RTREE) {
+            auto usable = std::find_if(scan_node.predicates.begin(), scan_node.predicates.end(), [&](const ColumnPredicate& predicate) {
+                if (predicate.column != definition.key_columns.front()) {
+                    return false;
+                }
+                if (definition.type == IndexType::FULLTEXT) {
+                    return predicate.op == PredicateOp::MATCH;
+                }
+                return predicate.op == PredicateOp::INTERSECTS || predicate.op == PredicateOp::DWITHIN;
+            });
+            if (usable != scan_node.predicates.end() && !dedicated.has_value()) {
+                candidate.predicates.push_back(*usable);
+                candidate.definition = std::move(definition);
+                dedicated = std::move(candidate);
+            }
+            continue;
+        }
+        // Vector indexes only answer nearest-neighbour searches, which are
+        // not predicates
+        if (definition.type == IndexType::HNSW) {
+            continue;
+        }
+        candidate.covering = covers(definition, scan_node);
+        for (const auto& column : definition.key_columns) {
+            auto equality = std::find_if(scan_node.predicates.begin(), scan_node.predicates.end(), [&](const ColumnPredicate& predicate) {
+                return predicate.column == column && predicate.op == PredicateOp::EQUAL;
+            });
+            if (equality == scan_node.predicates.end()) {
+                break;
+            }
+            candidate.predicates.push_back(*equality);
+            ++candidate.equalities;
+        }
+        // Hash indexes only answer equalities
+        if (definition.type != IndexType::HASH && candidate.equalities < definition.key_columns.size()) {
+            for (const auto& predicate : scan_node.predicates) {
+                if (predicate.column == definition.key_columns[candidate.equalities] && is_range_op(predicate.op)) {
+                    candidate.predicates.push_back(predicate);
+                    candidate.range = true;
+                }
+            }
+        }
+        candidate.definition = std::move(definition);
+
+        if (!candidate.predicates.empty()) {
+            if (!best.has_value() || candidate.rank() > best->rank()) {
+                best = std::move(candidate);
+            }
+        } else if (candidate.definition.type != IndexType::HASH && !scan_node.columns.empty() &&
+                   candidate.definition.key_columns.front() == scan_node.columns[0] &&
+                   (!ordered_fallback.has_value() || candidate.rank() > ordered_fallback->rank())) {
+            // Without a usable predicate, an ordered index still returns rows in column order
+            ordered_fallback = std::move(candidate);
+        }
+    }
+
+    // A MATCH or spatial predicate otherwise means parsing every row, so
+    // its index beats a range, though not an equality
+    if (dedicated.has_value() && (!best.has_value() || best->equalities == 0)) {
+        best = std::move(dedicated);
+    }
+    if (!best.has_value()) {
+        best = std::move(ordered_fallback);
+    }
+    if (!best.has_value()) {
+        return nullptr;
+    }
+
+    auto index_scan = std::make_unique<IndexScanNode>();
+    index_scan->table_name = scan_node.table_name;
+    index_scan->index_name = scan_node.table_name + "." + best->definition.name;
+    index_scan->lookup_name = best->definition.name;
+    index_scan->index_type = best->definition.type;
+    index_scan->composite = best->definition.is_composite();
+    for (const auto& predicate : best->predicates) {
+        if (!index_scan->condition.empty()) {
+            index_scan->condition += " AND ";
+        }
+        index_scan->condition += predicate.column + " " + predicate_op_symbol(predicate.op) + " " + predicate.value;
+    }
+    index_scan->index_predicates = std::move(best->predicates);
+    index_scan->index_only = best->covering;
+    if (best->covering) {
+        index_scan->index_columns = best->definition.key_columns;
+        index_scan->index_columns.insert(index_scan->index_columns.end(), best->definition.include_columns.begin(), best->definition.include_columns.end());
+    }
+    return index_scan;
+}
+
 } // namespace nexusdb
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "nexusdb/query_processor.h"
+#include "nexusdb/geometry.h"
 #include "nexusdb/utils/logger.h"
+#include "nexusdb/vector_distance.h"
 #include <algorithm>
 #include <cctype>
 #include <sstream>
@@ -7,6 +9,96 @@
 
 namespace nexusdb {
 
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+std::optional<PredicateOp> parse_predicate_op(const std::string& symbol) {
+    if (symbol == "=") {
+        return PredicateOp::EQUAL;
+    } else if (symbol == "<") {
+        return PredicateOp::LESS;
+    } else if (symbol == "<=") {
+        return PredicateOp::LESS_EQUAL;
+    } else if (symbol == ">") {
+        return PredicateOp::GREATER;
+    } else if (symbol == ">=") {
+        return PredicateOp::GREATER_EQUAL;
+    }
+    return std::nullopt;
+}
+
+// column <op> value [AND column <op> value ...]; values may be quoted.
+// Returns nullopt for anything else.
+std::optional<std::vector<ColumnPredicate>> parse_predicates(const std::string& where_clause) {
+    std::vector<ColumnPredicate> predicates;
+    if (trim(where_clause).empty()) {
+        return predicates;
+    }
+
+    std::regex predicate_regex(R"(\s*(\w+)\s*(<=|>=|<|>|=)\s*(?:'([^']*)'|([^\s';]+))\s*(?:(AND)\s+|;?\s*$))", std::regex_constants::icase);
+    std::smatch parts;
+    auto begin = where_clause.cbegin();
+    bool more = true;
+    while (more) {
+        if (!std::regex_search(begin, where_clause.cend(), parts, predicate_regex, std::regex_constants::match_continuous)) {
+            return std::nullopt;
+        }
+        predicates.push_back(ColumnPredicate{parts[1], *parse_predicate_op(parts[2]), parts[3].matched ? parts[3].str() : parts[4].str()});
+        more = parts[5].matched;
+        begin = parts[0].second;
+    }
+    return predicates;
+}
+
+// Equalities on the leading key columns, then the first lower and upper
+// bound on the next one; the rest is left to the per-row check
+struct IndexBounds {
+    std::vector<std::string> leading_values;
+    std::optional<std::string> lower;
+    std::optional<std::string> upper;
+    bool lower_inclusive = true;
+    bool upper_inclusive = true;
+};
+
+IndexBounds index_bounds(const std::vector<ColumnPredicate>& index_predicates) {
+    IndexBounds bounds;
+    for (const auto& predicate : index_predicates) {
+        switch (predicate.op) {
+            case PredicateOp::EQUAL:
+                bounds.leading_values.push_back(predicate.value);
+                break;
+            case PredicateOp::GREATER:
+            case PredicateOp::GREATER_EQUAL:
+                if (!bounds.lower.has_value()) {
+                    bounds.lower = predicate.value;
+                    bounds.lower_inclusive = predicate.op == PredicateOp::GREATER_EQUAL;
+                }
+                break;
+            case PredicateOp::LESS:
+            case PredicateOp::LESS_EQUAL:
+                if (!bounds.upper.has_value()) {
+                    bounds.upper = predicate.value;
+                    bounds.upper_inclusive = predicate.op == PredicateOp::LESS_EQUAL;
+                }
+                break;
+            case PredicateOp::MATCH:
+            case PredicateOp::INTERSECTS:
+            case PredicateOp::DWITHIN:
+                break;
+        }
+    }
+    return bounds;
+}
+
+} // namespace
+
 QueryProcessor::QueryProcessor(std::shared_ptr<StorageEngine> storage_engine)
     : storage_engine_(storage_engine) {
     LOG_DEBUG("QueryProcessor constructor called");
@@ -20,7 +112,11 @@ QueryProcessor::~QueryProcessor() {
 std::optional<std::string> QueryProcessor::initialize() {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Initializing Query Processor...");
-    // Add any necessary initialization logic here
+    if (storage_engine_ && storage_engine_->get_index_manager()) {
+        optimizer_ = std::make_unique<QueryOptimizer>(storage_engine_->get_index_manager());
+    } else {
+        LOG_WARNING("Storage engine has no index manager; SELECT will scan tables");
+    }
     LOG_INFO("Query Processor initialized successfully");
     return std::nullopt;
 }
@@ -101,29 +197,238 @@ std::optional<QueryResult> QueryProcessor::execute_select(const std::string& que
         std::string table_name = matches[2];
         std::string where_clause = matches[3];
 
-        // For simplicity, we'll just return all records and filter client-side
-        std::vector<std::string> record;
-        QueryResult result;
-        uint64_t record_id = 0;
+        // ORDER BY column <-> '[vector]' LIMIT k is answered by the column's
+        // vector index, and ORDER BY column <-> 'POINT(x y)' LIMIT k by its
+        // spatial index
+        std::regex nearest_regex(R"(ORDER\s+BY\s+(\w+)\s*<->\s*'([^']*)'\s+LIMIT\s+(\d{1,9})\s*$)", std::regex_constants::icase);
+        std::smatch nearest_parts;
+        if (std::regex_search(query, nearest_parts, nearest_regex)) {
+            auto point = parse_geometry(nearest_parts[2]);
+            if (point.has_value() && point->area() == 0 && point->margin() == 0) {
+                auto records = storage_engine_->nearest_geometries(table_name, nearest_parts[1], point->center(), std::stoul(nearest_parts[3]));
+                if (!records.has_value()) {
+                    return QueryResult{.error = "No spatial index on " + table_name + "." + nearest_parts[1].str()};
+                }
+                QueryResult result;
+                for (auto& [record_id, record] : *records) {
+                    result.rows.push_back(std::move(record));
+                }
+                result.column_names = {"column1", "column2", "column3"};  // Placeholder, as below
+                return result;
+            }
+            auto vector = decode_vector(nearest_parts[2]);
+            if (!vector.has_value()) {
+                return QueryResult{.error = "Invalid vector in ORDER BY: " + nearest_parts[2].str()};
+            }
+            auto records = storage_engine_->nearest_records(table_name, nearest_parts[1], *vector, std::stoul(nearest_parts[3]));
+            if (!records.has_value()) {
+                return QueryResult{.error = "No vector index on " + table_name + "." + nearest_parts[1].str()};
+            }
+            QueryResult result;
+            for (auto& [record_id, record] : *records) {
+                result.rows.push_back(std::move(record));
+            }
+            result.column_names = {"column1", "column2", "column3"};  // Placeholder, as below
+            return result;
+        }
 
-        while (true) {
-            auto read_result = storage_engine_->read_record(table_name, record_id, record);
-            if (read_result.has_value()) {
-                break;  // No more records or error occurred
+        // column MATCH 'query' is answered by the column's full-text index
+        std::regex match_regex(R"(\s*(\w+)\s+MATCH\s+'([^']*)'\s*)", std::regex_constants::icase);
+        std::smatch match_parts;
+        if (std::regex_match(where_clause, match_parts, match_regex)) {
+            auto records = storage_engine_->match_records(table_name, match_parts[1], match_parts[2]);
+            if (!records.has_value()) {
+                return QueryResult{.error = "Unknown table or column in MATCH: " + table_name + "." + match_parts[1].str()};
+            }
+            QueryResult result;
+            for (auto& [record_id, record] : *records) {
+                result.rows.push_back(std::move(record));
             }
-            result.rows.push_back(record);
-            record_id++;
+            result.column_names = {"column1", "column2", "column3"};  // Placeholder, as below
+            return result;
         }
 
-        // Set column names (in a real implementation, you'd get this from table metadata)
-        result.column_names = {"column1", "column2", "column3"};  // Placeholder
+        // column INTERSECTS 'geometry' and column DWITHIN 'POINT(x y) radius'
+        // are answered by the column's spatial index
+        std::regex spatial_regex(R"(\s*(\w+)\s+(INTERSECTS|DWITHIN)\s+'([^']*)'\s*)", std::regex_constants::icase);
+        std::smatch spatial_parts;
+        if (std::regex_match(where_clause, spatial_parts, spatial_regex)) {
+            bool intersects = std::toupper(static_cast<unsigned char>(spatial_parts[2].str()[0])) == 'I';
+            bool valid = intersects ? parse_geometry(spatial_parts[3]).has_value() : parse_distance_query(spatial_parts[3]).has_value();
+            if (!valid) {
+                return QueryResult{.error = "Invalid geometry in " + spatial_parts[2].str() + ": " + spatial_parts[3].str()};
+            }
+            ColumnPredicate predicate{spatial_parts[1], intersects ? PredicateOp::INTERSECTS : PredicateOp::DWITHIN, spatial_parts[3]};
+            auto records = storage_engine_->spatial_records(table_name, predicate);
+            if (!records.has_value()) {
+                return QueryResult{.error = "Unknown table or column in " + spatial_parts[2].str() + ": " + table_name + "." + spatial_parts[1].str()};
+            }
+            QueryResult result;
+            for (auto& [record_id, record] : *records) {
+                result.rows.push_back(std::move(record));
+            }
+            result.column_names = {"column1", "column2", "column3"};  // Placeholder, as below
+            return result;
+        }
 
-        return result;
+        return execute_planned_select(table_name, columns, where_clause);
     }
 
     return QueryResult{.error = "Invalid SELECT query"};
 }
 
+std::optional<QueryResult> QueryProcessor::execute_planned_select(const std::string& table_name, const std::string& column_list, const std::string& where_clause) {
+    auto schema = storage_engine_->get_table_schema(table_name);
+    if (!schema.has_value()) {
+        return QueryResult{.error = "Table doesn't exist: " + table_name};
+    }
+    auto predicates = parse_predicates(where_clause);
+    if (!predicates.has_value()) {
+        return QueryResult{.error = "Unsupported WHERE clause: " + where_clause};
+    }
+
+    ScanNode scan_node;
+    scan_node.table_name = table_name;
+    scan_node.predicates = std::move(*predicates);
+    if (trim(column_list) == "*") {
+        scan_node.columns = *schema;
+    } else {
+        std::istringstream column_stream(column_list);
+        std::string column;
+        while (std::getline(column_stream, column, ',')) {
+            scan_node.columns.push_back(trim(column));
+        }
+    }
+    auto known = [&](const std::string& column) { return std::find(schema->begin(), schema->end(), column) != schema->end(); };
+    for (const auto& column : scan_node.columns) {
+        if (!known(column)) {
+            return QueryResult{.error = "Unknown column: " + table_name + "." + column};
+        }
+    }
+    for (const auto& predicate : scan_node.predicates) {
+        if (!known(predicate.column)) {
+            return QueryResult{.error = "Unknown column: " + table_name + "." + predicate.column};
+        }
+    }
+
+    QueryResult result;
+    result.column_names = scan_node.columns;
+    QueryPlan plan;
+    if (optimizer_) {
+        plan = optimizer_->optimize_scan(scan_node);
+    }
+    if (auto* index_scan = dynamic_cast<IndexScanNode*>(plan.root.get())) {
+        LOG_DEBUG("Scanning " + index_scan->index_name + (index_scan->index_only ? " alone" : "") + " for " + index_scan->condition);
+        auto rows = execute_index_scan(*index_scan, scan_node, *schema);
+        if (!rows.has_value()) {
+            return QueryResult{.error = "Failed to search index " + index_scan->index_name};
+        }
+        result.rows = std::move(*rows);
+        return result;
+    }
+
+    // No index helps; the zone maps still skip pages
+    auto records = storage_engine_->scan_table(table_name, scan_node.predicates);
+    if (!records.has_value()) {
+        return QueryResult{.error = "Failed to scan table " + table_name};
+    }
+    std::vector<size_t> positions;
+    for (const auto& column : scan_node.columns) {
+        positions.push_back(std::find(schema->begin(), schema->end(), column) - schema->begin());
+    }
+    for (const auto& [record_id, record] : *records) {
+        std::vector<std::string> row;
+        row.reserve(positions.size());
+        for (size_t position : positions) {
+            row.push_back(position < record.size() ? record[position] : "");
+        }
+        result.rows.push_back(std::move(row));
+    }
+    return result;
+}
+
+std::optional<std::vector<std::vector<std::string>>> QueryProcessor::execute_index_scan(const IndexScanNode& index_scan, const ScanNode& scan_node,
+                                                                                         const std::vector<std::string>& schema) {
+    const std::string& table_name = scan_node.table_name;
+    std::vector<std::vector<std::string>> rows;
+    // Every predicate is checked on every row; the index only narrows the rows read
+    auto keep = [&](const std::vector<std::string>& values, const std::vector<std::string>& layout) {
+        std::vector<std::string> row;
+        row.reserve(scan_node.columns.size());
+        auto value_of = [&](const std::string& column) -> const std::string& {
+            static const std::string empty;
+            size_t position = std::find(layout.begin(), layout.end(), column) - layout.begin();
+            return position < values.size() ? values[position] : empty;
+        };
+        for (const auto& predicate : scan_node.predicates) {
+            if (!predicate_holds(value_of(predicate.column), predicate.op, predicate.value)) {
+                return;
+            }
+        }
+        for (const auto& column : scan_node.columns) {
+            row.push_back(value_of(column));
+        }
+        rows.push_back(std::move(row));
+    };
+
+    IndexBounds bounds = index_bounds(index_scan.index_predicates);
+    std::optional<std::vector<IndexManager::IndexRow>> index_rows;
+    if (index_scan.composite) {
+        index_rows = storage_engine_->scan_covering_index(table_name, index_scan.lookup_name, bounds.leading_values, bounds.lower, bounds.upper,
+                                                          bounds.lower_inclusive, bounds.upper_inclusive);
+        if (!index_rows.has_value()) {
+            return std::nullopt;
+        }
+        if (index_scan.index_only) {
+            for (const auto& index_row : *index_rows) {
+                keep(index_row.values, index_scan.index_columns);
+            }
+            return rows;
+        }
+    }
+
+    std::vector<uint64_t> record_ids;
+    if (index_rows.has_value()) {
+        for (const auto& index_row : *index_rows) {
+            record_ids.push_back(index_row.record_id);
+        }
+    } else if (index_scan.index_type == IndexType::FULLTEXT || index_scan.index_type == IndexType::RTREE) {
+        const ColumnPredicate& predicate = index_scan.index_predicates.front();
+        auto records = index_scan.index_type == IndexType::FULLTEXT ? storage_engine_->match_records(table_name, predicate.column, predicate.value)
+                                                                    : storage_engine_->spatial_records(table_name, predicate);
+        if (!records.has_value()) {
+            return std::nullopt;
+        }
+        for (const auto& [record_id, record] : *records) {
+            keep(record, schema);
+        }
+        return rows;
+    } else if (!bounds.leading_values.empty()) {
+        auto found = storage_engine_->search_index(table_name, index_scan.lookup_name, bounds.leading_values.front());
+        if (!found.has_value()) {
+            return std::nullopt;
+        }
+        record_ids = std::move(*found);
+    } else {
+        // A range, or no predicate at all when the index only supplies order
+        auto found = storage_engine_->get_index_manager()->range_search(table_name, index_scan.lookup_name, bounds.lower, bounds.upper,
+                                                                         bounds.lower_inclusive, bounds.upper_inclusive);
+        if (!found.has_value()) {
+            return std::nullopt;
+        }
+        record_ids = std::move(*found);
+    }
+
+    std::vector<std::string> record;
+    for (uint64_t record_id : record_ids) {
+        if (storage_engine_->read_record(table_name, record_id, record).has_value()) {
+            continue;  // Deleted since the index was read
+        }
+        keep(record, schema);
+    }
+    return rows;
+}
+
 std::optional<QueryResult> QueryProcessor::execute_insert(const std::string& query) {
     // Simplified INSERT query execution
     std::regex insert_regex(R"(INSERT\s+INTO\s+(\w+)\s+VALUES\s+\((.*?)\))", std::regex_constants::icase);
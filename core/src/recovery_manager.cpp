@@ -2,10 +2,39 @@
 #include "nexusdb/storage_engine.h"
 #include "nexusdb/utils/logger.h"
 #include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
 #include <unordered_set>
 
 namespace nexusdb {
 
+namespace {
+
+void write_u64(std::ostream& out, uint64_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_string(std::ostream& out, const std::string& value) {
+    write_u64(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+bool read_u64(std::istream& in, uint64_t& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool read_string(std::istream& in, std::string& value) {
+    uint64_t size;
+    if (!read_u64(in, size)) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&value[0], size));
+}
+
+} // namespace
+
 RecoveryManager::RecoveryManager(std::shared_ptr<StorageEngine> storage_engine)
     : storage_engine_(storage_engine) {
     LOG_DEBUG("RecoveryManager constructor called");
@@ -19,10 +48,19 @@ RecoveryManager::~RecoveryManager() {
 std::optional<std::string> RecoveryManager::initialize(const std::string& log_file_path) {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Initializing Recovery Manager...");
+    log_file_path_ = log_file_path;
+    read_log_from_disk(log_file_path);
+    for (const auto& record : in_memory_log_) {
+        max_logged_transaction_id_ = std::max(max_logged_transaction_id_, record.transaction_id);
+    }
     log_file_.open(log_file_path, std::ios::app | std::ios::binary);
     if (!log_file_.is_open()) {
         return "Failed to open log file: " + log_file_path;
     }
+    log_sync_fd_ = ::open(log_file_path.c_str(), O_WRONLY);
+    if (log_sync_fd_ < 0) {
+        return "Failed to open log file for syncing: " + log_file_path;
+    }
     LOG_INFO("Recovery Manager initialized successfully");
     return std::nullopt;
 }
@@ -31,35 +69,93 @@ void RecoveryManager::shutdown() {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Shutting down Recovery Manager...");
     if (log_file_.is_open()) {
+        force_log_locked();
         log_file_.close();
     }
+    if (log_sync_fd_ >= 0) {
+        ::close(log_sync_fd_);
+        log_sync_fd_ = -1;
+    }
     in_memory_log_.clear();
+    active_transactions_.clear();
     LOG_INFO("Recovery Manager shut down successfully");
 }
 
 std::optional<std::string> RecoveryManager::begin_transaction(uint64_t transaction_id) {
-    LogRecord record{LogRecordType::BEGIN, transaction_id, "", 0, "", ""};
-    return log_operation(record);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active_transactions_.find(transaction_id) != active_transactions_.end()) {
+        return "Transaction " + std::to_string(transaction_id) + " already started";
+    }
+    active_transactions_[transaction_id] = {};
+    append_log_record(LogRecord{LogRecordType::BEGIN, transaction_id, "", 0, "", ""});
+    return std::nullopt;
 }
 
 std::optional<std::string> RecoveryManager::commit_transaction(uint64_t transaction_id) {
-    LogRecord record{LogRecordType::COMMIT, transaction_id, "", 0, "", ""};
-    return log_operation(record);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = active_transactions_.find(transaction_id);
+    if (it == active_transactions_.end()) {
+        return "Transaction " + std::to_string(transaction_id) + " is not active";
+    }
+    append_log_record(LogRecord{LogRecordType::COMMIT, transaction_id, "", 0, "", ""});
+    bool forced = force_log_locked();
+    active_transactions_.erase(it);
+    if (!forced) {
+        return "Failed to force log for transaction " + std::to_string(transaction_id);
+    }
+    LOG_DEBUG("Transaction " + std::to_string(transaction_id) + " commit record forced to log");
+    return std::nullopt;
 }
 
 std::optional<std::string> RecoveryManager::abort_transaction(uint64_t transaction_id) {
-    LogRecord record{LogRecordType::ABORT, transaction_id, "", 0, "", ""};
-    return log_operation(record);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = active_transactions_.find(transaction_id);
+    if (it == active_transactions_.end()) {
+        return "Transaction " + std::to_string(transaction_id) + " is not active";
+    }
+    append_log_record(LogRecord{LogRecordType::ABORT, transaction_id, "", 0, "", ""});
+    active_transactions_.erase(it);
+    return std::nullopt;
 }
 
 std::optional<std::string> RecoveryManager::log_operation(const LogRecord& record) {
     std::lock_guard<std::mutex> lock(mutex_);
-    write_log_to_disk(record);
-    in_memory_log_.push_back(record);
-    LOG_INFO("Logged operation for transaction " + std::to_string(record.transaction_id));
+    auto it = active_transactions_.find(record.transaction_id);
+    if (it == active_transactions_.end()) {
+        return "Transaction " + std::to_string(record.transaction_id) + " is not active";
+    }
+    it->second.push_back(in_memory_log_.size());
+    append_log_record(record);
+    LOG_DEBUG("Logged operation for transaction " + std::to_string(record.transaction_id));
     return std::nullopt;
 }
 
+std::optional<std::string> RecoveryManager::force_log() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!force_log_locked()) {
+        return "Failed to force log to " + log_file_path_;
+    }
+    return std::nullopt;
+}
+
+uint64_t RecoveryManager::get_max_logged_transaction_id() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_logged_transaction_id_;
+}
+
+std::vector<LogRecord> RecoveryManager::get_transaction_records(uint64_t transaction_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<LogRecord> records;
+    auto it = active_transactions_.find(transaction_id);
+    if (it != active_transactions_.end()) {
+        records.reserve(it->second.size());
+        for (size_t index : it->second) {
+            records.push_back(in_memory_log_[index]);
+        }
+    }
+    return records;
+}
+
 std::optional<std::string> RecoveryManager::recover() {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Starting recovery process...");
@@ -78,70 +174,145 @@ std::optional<std::string> RecoveryManager::recover() {
     return std::nullopt;
 }
 
+std::optional<std::string> RecoveryManager::truncate_log() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_transactions_.empty()) {
+        return "Cannot truncate the log while transactions are active";
+    }
+
+    log_file_.close();
+    log_file_.open(log_file_path_, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!log_file_.is_open()) {
+        return "Failed to truncate log file: " + log_file_path_;
+    }
+    log_dirty_ = true;
+    if (!force_log_locked()) {
+        return "Failed to force truncated log file: " + log_file_path_;
+    }
+    in_memory_log_.clear();
+    LOG_INFO("Log truncated after recovery");
+    return std::nullopt;
+}
+
+void RecoveryManager::append_log_record(const LogRecord& record) {
+    write_log_to_disk(record);
+    in_memory_log_.push_back(record);
+}
+
+// Records are buffered by the stream and only reach the disk on force_log_locked()
 void RecoveryManager::write_log_to_disk(const LogRecord& record) {
-    log_file_.write(reinterpret_cast<const char*>(&record), sizeof(LogRecord));
+    log_dirty_ = true;
+    write_u64(log_file_, static_cast<uint64_t>(record.type));
+    write_u64(log_file_, record.transaction_id);
+    write_string(log_file_, record.table_name);
+    write_u64(log_file_, record.record_id);
+    write_string(log_file_, record.before_image);
+    write_string(log_file_, record.after_image);
+}
+
+bool RecoveryManager::force_log_locked() {
+    if (!log_dirty_) {
+        return true;
+    }
     log_file_.flush();
+    if (!log_file_.good() || ::fsync(log_sync_fd_) != 0) {
+        return false;
+    }
+    log_dirty_ = false;
+    return true;
+}
+
+void RecoveryManager::read_log_from_disk(const std::string& log_file_path) {
+    std::ifstream in(log_file_path, std::ios::binary);
+    if (!in.is_open()) {
+        return;
+    }
+
+    in_memory_log_.clear();
+    while (true) {
+        LogRecord record;
+        uint64_t type;
+        if (!read_u64(in, type) || !read_u64(in, record.transaction_id) || !read_string(in, record.table_name) ||
+            !read_u64(in, record.record_id) || !read_string(in, record.before_image) || !read_string(in, record.after_image)) {
+            break;  // End of log or a torn final record
+        }
+        record.type = static_cast<LogRecordType>(type);
+        in_memory_log_.push_back(std::move(record));
+    }
+    LOG_INFO("Loaded " + std::to_string(in_memory_log_.size()) + " log records from " + log_file_path);
 }
 
-void RecoveryManager::apply_log_record(const LogRecord& record) {
-    switch (record.type) {
-        case LogRecordType::UPDATE:
-            storage_engine_->update_record(record.table_name, record.record_id, {record.after_image});
-            break;
-        case LogRecordType::INSERT:
-            storage_engine_->insert_record(record.table_name, {record.after_image});
-            break;
-        case LogRecordType::DELETE:
-            storage_engine_->delete_record(record.table_name, record.record_id);
-            break;
-        default:
-            // BEGIN, COMMIT, and ABORT don't require direct action on the storage engine
-            break;
+std::optional<std::string> RecoveryManager::apply_log_record(const LogRecord& record, bool undo) {
+    auto result = storage_engine_->replay_log_record(record, undo);
+    if (result.has_value()) {
+        return std::string(undo ? "Failed to undo" : "Failed to redo") + " log record of transaction " +
+               std::to_string(record.transaction_id) + " on " + record.table_name + ": " + *result;
     }
+    return std::nullopt;
 }
 
 std::optional<std::string> RecoveryManager::redo() {
     LOG_INFO("Starting redo phase...");
-    
+
+    // History is repeated in log order. An aborted transaction was rolled
+    // back just before its ABORT record was written, so its changes are
+    // reverted there, before any later transaction touched the same records.
+    std::unordered_map<uint64_t, std::vector<const LogRecord*>> changes;
     for (const auto& record : in_memory_log_) {
-        if (record.type != LogRecordType::BEGIN && record.type != LogRecordType::COMMIT && record.type != LogRecordType::ABORT) {
-            apply_log_record(record);
+        switch (record.type) {
+            case LogRecordType::BEGIN:
+                break;
+            case LogRecordType::COMMIT:
+                changes.erase(record.transaction_id);
+                break;
+            case LogRecordType::ABORT: {
+                auto it = changes.find(record.transaction_id);
+                if (it != changes.end()) {
+                    for (auto change = it->second.rbegin(); change != it->second.rend(); ++change) {
+                        auto result = apply_log_record(**change, true);
+                        if (result.has_value()) {
+                            return result;
+                        }
+                    }
+                    changes.erase(it);
+                }
+                break;
+            }
+            default: {
+                auto result = apply_log_record(record, false);
+                if (result.has_value()) {
+                    return result;
+                }
+                changes[record.transaction_id].push_back(&record);
+                break;
+            }
         }
     }
-    
     return std::nullopt;
 }
 
 std::optional<std::string> RecoveryManager::undo() {
     LOG_INFO("Starting undo phase...");
     
-    std::unordered_set<uint64_t> committed_transactions;
+    std::unordered_set<uint64_t> finished_transactions;
     std::vector<LogRecord> undo_list;
 
     // Scan the log backwards to determine which transactions need to be undone
     for (auto it = in_memory_log_.rbegin(); it != in_memory_log_.rend(); ++it) {
-        if (it->type == LogRecordType::COMMIT) {
-            committed_transactions.insert(it->transaction_id);
-        } else if (it->type == LogRecordType::BEGIN) {
-            if (committed_transactions.find(it->transaction_id) == committed_transactions.end()) {
-                // This transaction was not committed, add its records to the undo list
-                undo_list.push_back(*it);
-            }
-        } else if (it->type != LogRecordType::ABORT) {
-            if (committed_transactions.find(it->transaction_id) == committed_transactions.end()) {
-                undo_list.push_back(*it);
-            }
+        if (it->type == LogRecordType::COMMIT || it->type == LogRecordType::ABORT) {
+            finished_transactions.insert(it->transaction_id);
+        } else if (it->type != LogRecordType::BEGIN &&
+                   finished_transactions.find(it->transaction_id) == finished_transactions.end()) {
+            // This transaction never finished, so its change is reverted
+            undo_list.push_back(*it);
         }
     }
 
-    // Perform the undo operations
+    // Perform the undo operations, newest first
     for (const auto& record : undo_list) {
-        if (record.type == LogRecordType::UPDATE) {
-            storage_engine_->update_record(record.table_name, record.record_id, {record.before_image});
-        } else if (record.type == LogRecordType::INSERT) {
-            storage_engine_->delete_record(record.table_name, record.record_id);
-        } else if (record.type == LogRecordType::DELETE) {
-            storage_engine_->insert_record(record.table_name, {record.before_image});
+        auto result = apply_log_record(record, true);
+        if (result.has_value()) {
+            return result;
         }
     }
 
@@ -0,0 +1,706 @@
+#include "nexusdb/roaring_bitmap.h"
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NEXUSDB_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace nexusdb {
+
+namespace {
+
+// An array of this many times fewer values than the other side is
+// intersected by binary searches instead of a merge
+constexpr size_t GALLOP_RATIO = 32;
+
+uint32_t popcount(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#else
+    return static_cast<uint32_t>(std::bitset<64>(word).count());
+#endif
+}
+
+unsigned trailing_zeros(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned count = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Sets bits first through last, inclusive
+void set_range(std::vector<uint64_t>& words, uint32_t first, uint32_t last) {
+    size_t first_word = first >> 6;
+    size_t last_word = last >> 6;
+    uint64_t first_mask = ~uint64_t{0} << (first & 63);
+    uint64_t last_mask = ~uint64_t{0} >> (63 - (last & 63));
+    if (first_word == last_word) {
+        words[first_word] |= first_mask & last_mask;
+        return;
+    }
+    words[first_word] |= first_mask;
+    for (size_t i = first_word + 1; i < last_word; ++i) {
+        words[i] = ~uint64_t{0};
+    }
+    words[last_word] |= last_mask;
+}
+
+enum class WordOp {
+    AND,
+    OR,
+    ANDNOT
+};
+
+// Combines count words of left and right into out, unless out is null,
+// and returns the number of bits set in the result
+using CombineFunction = uint32_t (*)(const uint64_t* left, const uint64_t* right, uint64_t* out, size_t count);
+
+template<WordOp Op>
+uint32_t combine_scalar(const uint64_t* left, const uint64_t* right, uint64_t* out, size_t count) {
+    uint32_t cardinality = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t word;
+        if constexpr (Op == WordOp::AND) {
+            word = left[i] & right[i];
+        } else if constexpr (Op == WordOp::OR) {
+            word = left[i] | right[i];
+        } else {
+            word = left[i] & ~right[i];
+        }
+        if (out != nullptr) {
+            out[i] = word;
+        }
+        cardinality += popcount(word);
+    }
+    return cardinality;
+}
+
+#ifdef NEXUSDB_X86_DISPATCH
+
+// Bits set in each byte, looked up a nibble at a time with byte shuffles
+__attribute__((target("avx2")))
+__m256i popcount_bytes_avx2(__m256i words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_and_si256(words, low_nibbles);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(words, 4), low_nibbles);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+}
+
+template<WordOp Op>
+__attribute__((target("avx2")))
+uint32_t combine_avx2(const uint64_t* left, const uint64_t* right, uint64_t* out, size_t count) {
+    __m256i totals = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i left_words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+        __m256i right_words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+        __m256i words;
+        if constexpr (Op == WordOp::AND) {
+            words = _mm256_and_si256(left_words, right_words);
+        } else if constexpr (Op == WordOp::OR) {
+            words = _mm256_or_si256(left_words, right_words);
+        } else {
+            words = _mm256_andnot_si256(right_words, left_words);
+        }
+        if (out != nullptr) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), words);
+        }
+        // Sums the byte counts of each 64-bit lane
+        totals = _mm256_add_epi64(totals, _mm256_sad_epu8(popcount_bytes_avx2(words), _mm256_setzero_si256()));
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), totals);
+    uint64_t cardinality = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return static_cast<uint32_t>(cardinality) + combine_scalar<Op>(left + i, right + i, out != nullptr ? out + i : nullptr, count - i);
+}
+
+#endif
+
+struct WordKernels {
+    CombineFunction and_words;
+    CombineFunction or_words;
+    CombineFunction andnot_words;
+    const char* isa;
+};
+
+WordKernels select_kernels() {
+#ifdef NEXUSDB_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {combine_avx2<WordOp::AND>, combine_avx2<WordOp::OR>, combine_avx2<WordOp::ANDNOT>, "avx2"};
+    }
+#endif
+    return {combine_scalar<WordOp::AND>, combine_scalar<WordOp::OR>, combine_scalar<WordOp::ANDNOT>, "scalar"};
+}
+
+const WordKernels& kernels() {
+    static const WordKernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+bool RoaringContainer::add(uint16_t value) {
+    if (kind_ == Kind::ARRAY) {
+        auto it = std::lower_bound(values_.begin(), values_.end(), value);
+        if (it != values_.end() && *it == value) {
+            return false;
+        }
+        values_.insert(it, value);
+        if (++cardinality_ > ARRAY_MAX_SIZE) {
+            convert_to(Kind::BITMAP);
+        }
+        return true;
+    }
+
+    if (kind_ == Kind::BITMAP) {
+        uint64_t& word = words_[value >> 6];
+        uint64_t bit = uint64_t{1} << (value & 63);
+        if ((word & bit) != 0) {
+            return false;
+        }
+        word |= bit;
+        ++cardinality_;
+        return true;
+    }
+
+    size_t count = runs_.size();
+    size_t index = find_run(value);
+    bool has_previous = index < count;
+    if (has_previous && value <= uint32_t{runs_[index].start} + runs_[index].length) {
+        return false;
+    }
+    size_t next = has_previous ? index + 1 : 0;
+    bool joins_previous = has_previous && uint32_t{runs_[index].start} + runs_[index].length + 1 == value;
+    bool joins_next = next < count && uint32_t{value} + 1 == runs_[next].start;
+    if (joins_previous && joins_next) {
+        runs_[index].length = static_cast<uint16_t>(runs_[next].start + runs_[next].length - runs_[index].start);
+        runs_.erase(runs_.begin() + next);
+    } else if (joins_previous) {
+        ++runs_[index].length;
+    } else if (joins_next) {
+        --runs_[next].start;
+        ++runs_[next].length;
+    } else {
+        runs_.insert(runs_.begin() + next, Run{value, 0});
+    }
+    ++cardinality_;
+
+    // Scattered values make runs bigger than the other layouts
+    if (runs_.size() * sizeof(Run) > std::min(cardinality_ * sizeof(uint16_t), BITMAP_WORDS * sizeof(uint64_t))) {
+        convert_to(cardinality_ <= ARRAY_MAX_SIZE ? Kind::ARRAY : Kind::BITMAP);
+    }
+    return true;
+}
+
+bool RoaringContainer::remove(uint16_t value) {
+    if (kind_ == Kind::ARRAY) {
+        auto it = std::lower_bound(values_.begin(), values_.end(), value);
+        if (it == values_.end() || *it != value) {
+            return false;
+        }
+        values_.erase(it);
+        --cardinality_;
+        return true;
+    }
+
+    if (kind_ == Kind::BITMAP) {
+        uint64_t& word = words_[value >> 6];
+        uint64_t bit = uint64_t{1} << (value & 63);
+        if ((word & bit) == 0) {
+            return false;
+        }
+        word &= ~bit;
+        if (--cardinality_ <= ARRAY_MAX_SIZE) {
+            convert_to(Kind::ARRAY);
+        }
+        return true;
+    }
+
+    size_t index = find_run(value);
+    if (index == runs_.size()) {
+        return false;
+    }
+    Run& run = runs_[index];
+    uint32_t end = uint32_t{run.start} + run.length;
+    if (value > end) {
+        return false;
+    }
+    if (run.length == 0) {
+        runs_.erase(runs_.begin() + index);
+    } else if (value == run.start) {
+        ++run.start;
+        --run.length;
+    } else if (value == end) {
+        --run.length;
+    } else {
+        Run tail{static_cast<uint16_t>(value + 1), static_cast<uint16_t>(end - value - 1)};
+        run.length = static_cast<uint16_t>(value - run.start - 1);
+        runs_.insert(runs_.begin() + index + 1, tail);
+    }
+    --cardinality_;
+    return true;
+}
+
+bool RoaringContainer::contains(uint16_t value) const {
+    switch (kind_) {
+        case Kind::ARRAY:
+            return std::binary_search(values_.begin(), values_.end(), value);
+        case Kind::BITMAP:
+            return (words_[value >> 6] & (uint64_t{1} << (value & 63))) != 0;
+        case Kind::RUN: {
+            size_t index = find_run(value);
+            return index < runs_.size() && value <= uint32_t{runs_[index].start} + runs_[index].length;
+        }
+    }
+    return false;
+}
+
+void RoaringContainer::for_each(const std::function<void(uint16_t value)>& visitor) const {
+    switch (kind_) {
+        case Kind::ARRAY:
+            for (uint16_t value : values_) {
+                visitor(value);
+            }
+            break;
+        case Kind::BITMAP:
+            for (size_t i = 0; i < BITMAP_WORDS; ++i) {
+                for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                    visitor(static_cast<uint16_t>(i * 64 + trailing_zeros(word)));
+                }
+            }
+            break;
+        case Kind::RUN:
+            for (const Run& run : runs_) {
+                for (uint32_t value = run.start; value <= uint32_t{run.start} + run.length; ++value) {
+                    visitor(static_cast<uint16_t>(value));
+                }
+            }
+            break;
+    }
+}
+
+void RoaringContainer::append_to(std::vector<uint64_t>& out, uint64_t base) const {
+    switch (kind_) {
+        case Kind::ARRAY:
+            for (uint16_t value : values_) {
+                out.push_back(base + value);
+            }
+            break;
+        case Kind::BITMAP:
+            for (size_t i = 0; i < BITMAP_WORDS; ++i) {
+                for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                    out.push_back(base + i * 64 + trailing_zeros(word));
+                }
+            }
+            break;
+        case Kind::RUN:
+            for (const Run& run : runs_) {
+                for (uint32_t value = run.start; value <= uint32_t{run.start} + run.length; ++value) {
+                    out.push_back(base + value);
+                }
+            }
+            break;
+    }
+}
+
+void RoaringContainer::run_optimize() {
+    size_t run_bytes = count_runs() * sizeof(Run);
+    size_t other_bytes = cardinality_ <= ARRAY_MAX_SIZE ? cardinality_ * sizeof(uint16_t) : BITMAP_WORDS * sizeof(uint64_t);
+    if (run_bytes < other_bytes) {
+        convert_to(Kind::RUN);
+    } else if (kind_ == Kind::RUN) {
+        convert_to(cardinality_ <= ARRAY_MAX_SIZE ? Kind::ARRAY : Kind::BITMAP);
+    }
+}
+
+size_t RoaringContainer::memory_usage() const {
+    return sizeof(*this) + values_.capacity() * sizeof(uint16_t) + words_.capacity() * sizeof(uint64_t) + runs_.capacity() * sizeof(Run);
+}
+
+RoaringContainer RoaringContainer::intersect(const RoaringContainer& left, const RoaringContainer& right) {
+    if (left.kind_ == Kind::ARRAY || right.kind_ == Kind::ARRAY) {
+        const RoaringContainer& array = left.kind_ == Kind::ARRAY ? left : right;
+        const RoaringContainer& other = &array == &left ? right : left;
+        std::vector<uint16_t> values;
+        if (other.kind_ == Kind::ARRAY && array.cardinality_ * GALLOP_RATIO >= other.cardinality_ &&
+            other.cardinality_ * GALLOP_RATIO >= array.cardinality_) {
+            std::set_intersection(array.values_.begin(), array.values_.end(), other.values_.begin(), other.values_.end(),
+                                  std::back_inserter(values));
+        } else {
+            const RoaringContainer& smaller = other.kind_ == Kind::ARRAY && other.cardinality_ < array.cardinality_ ? other : array;
+            const RoaringContainer& larger = &smaller == &array ? other : array;
+            for (uint16_t value : smaller.values_) {
+                if (larger.contains(value)) {
+                    values.push_back(value);
+                }
+            }
+        }
+        return from_values(std::move(values));
+    }
+
+    std::vector<uint64_t> words = left.to_words();
+    std::vector<uint64_t> scratch;
+    uint32_t cardinality = kernels().and_words(words.data(), right.word_data(scratch), words.data(), BITMAP_WORDS);
+    return from_words(std::move(words), cardinality);
+}
+
+RoaringContainer RoaringContainer::unite(const RoaringContainer& left, const RoaringContainer& right) {
+    if (left.kind_ == Kind::ARRAY && right.kind_ == Kind::ARRAY) {
+        std::vector<uint16_t> values;
+        values.reserve(left.cardinality_ + right.cardinality_);
+        std::set_union(left.values_.begin(), left.values_.end(), right.values_.begin(), right.values_.end(), std::back_inserter(values));
+        return from_values(std::move(values));
+    }
+
+    const RoaringContainer& wide = left.kind_ != Kind::ARRAY ? left : right;
+    const RoaringContainer& other = &wide == &left ? right : left;
+    std::vector<uint64_t> words = wide.to_words();
+    uint32_t cardinality;
+    if (other.kind_ == Kind::ARRAY) {
+        cardinality = wide.cardinality_;
+        for (uint16_t value : other.values_) {
+            uint64_t bit = uint64_t{1} << (value & 63);
+            cardinality += (words[value >> 6] & bit) == 0 ? 1 : 0;
+            words[value >> 6] |= bit;
+        }
+    } else {
+        std::vector<uint64_t> scratch;
+        cardinality = kernels().or_words(words.data(), other.word_data(scratch), words.data(), BITMAP_WORDS);
+    }
+    return from_words(std::move(words), cardinality);
+}
+
+RoaringContainer RoaringContainer::subtract(const RoaringContainer& left, const RoaringContainer& right) {
+    if (left.kind_ == Kind::ARRAY) {
+        std::vector<uint16_t> values;
+        if (right.kind_ == Kind::ARRAY) {
+            std::set_difference(left.values_.begin(), left.values_.end(), right.values_.begin(), right.values_.end(),
+                                std::back_inserter(values));
+        } else {
+            for (uint16_t value : left.values_) {
+                if (!right.contains(value)) {
+                    values.push_back(value);
+                }
+            }
+        }
+        return from_values(std::move(values));
+    }
+
+    std::vector<uint64_t> words = left.to_words();
+    uint32_t cardinality;
+    if (right.kind_ == Kind::ARRAY) {
+        cardinality = left.cardinality_;
+        for (uint16_t value : right.values_) {
+            uint64_t bit = uint64_t{1} << (value & 63);
+            cardinality -= (words[value >> 6] & bit) != 0 ? 1 : 0;
+            words[value >> 6] &= ~bit;
+        }
+    } else {
+        std::vector<uint64_t> scratch;
+        cardinality = kernels().andnot_words(words.data(), right.word_data(scratch), words.data(), BITMAP_WORDS);
+    }
+    return from_words(std::move(words), cardinality);
+}
+
+uint32_t RoaringContainer::intersect_cardinality(const RoaringContainer& left, const RoaringContainer& right) {
+    if (left.kind_ == Kind::ARRAY || right.kind_ == Kind::ARRAY) {
+        const RoaringContainer& array = left.kind_ == Kind::ARRAY ? left : right;
+        const RoaringContainer& other = &array == &left ? right : left;
+        uint32_t cardinality = 0;
+        for (uint16_t value : array.values_) {
+            cardinality += other.contains(value) ? 1 : 0;
+        }
+        return cardinality;
+    }
+
+    std::vector<uint64_t> left_scratch;
+    std::vector<uint64_t> right_scratch;
+    return kernels().and_words(left.word_data(left_scratch), right.word_data(right_scratch), nullptr, BITMAP_WORDS);
+}
+
+std::vector<uint64_t> RoaringContainer::to_words() const {
+    if (kind_ == Kind::BITMAP) {
+        return words_;
+    }
+    std::vector<uint64_t> words(BITMAP_WORDS, 0);
+    if (kind_ == Kind::ARRAY) {
+        for (uint16_t value : values_) {
+            words[value >> 6] |= uint64_t{1} << (value & 63);
+        }
+    } else {
+        for (const Run& run : runs_) {
+            set_range(words, run.start, uint32_t{run.start} + run.length);
+        }
+    }
+    return words;
+}
+
+const uint64_t* RoaringContainer::word_data(std::vector<uint64_t>& scratch) const {
+    if (kind_ == Kind::BITMAP) {
+        return words_.data();
+    }
+    scratch = to_words();
+    return scratch.data();
+}
+
+RoaringContainer RoaringContainer::from_words(std::vector<uint64_t> words, uint32_t cardinality) {
+    RoaringContainer container;
+    container.cardinality_ = cardinality;
+    if (cardinality > ARRAY_MAX_SIZE) {
+        container.kind_ = Kind::BITMAP;
+        container.words_ = std::move(words);
+        return container;
+    }
+    container.values_.reserve(cardinality);
+    for (size_t i = 0; i < BITMAP_WORDS; ++i) {
+        for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+            container.values_.push_back(static_cast<uint16_t>(i * 64 + trailing_zeros(word)));
+        }
+    }
+    return container;
+}
+
+RoaringContainer RoaringContainer::from_values(std::vector<uint16_t> values) {
+    RoaringContainer container;
+    container.cardinality_ = static_cast<uint32_t>(values.size());
+    container.values_ = std::move(values);
+    if (container.cardinality_ > ARRAY_MAX_SIZE) {
+        container.convert_to(Kind::BITMAP);
+    }
+    return container;
+}
+
+size_t RoaringContainer::find_run(uint16_t value) const {
+    auto it = std::upper_bound(runs_.begin(), runs_.end(), value, [](uint16_t target, const Run& run) { return target < run.start; });
+    return it == runs_.begin() ? runs_.size() : static_cast<size_t>(it - runs_.begin() - 1);
+}
+
+size_t RoaringContainer::count_runs() const {
+    switch (kind_) {
+        case Kind::ARRAY: {
+            size_t runs = 0;
+            for (size_t i = 0; i < values_.size(); ++i) {
+                runs += i == 0 || values_[i] != values_[i - 1] + 1 ? 1 : 0;
+            }
+            return runs;
+        }
+        case Kind::BITMAP: {
+            // A run starts at every set bit whose lower neighbour is clear
+            size_t runs = 0;
+            uint64_t carry = 0;
+            for (uint64_t word : words_) {
+                runs += popcount(word & ~((word << 1) | carry));
+                carry = word >> 63;
+            }
+            return runs;
+        }
+        case Kind::RUN:
+            return runs_.size();
+    }
+    return 0;
+}
+
+void RoaringContainer::convert_to(Kind kind) {
+    if (kind == kind_) {
+        return;
+    }
+
+    RoaringContainer converted;
+    converted.kind_ = kind;
+    converted.cardinality_ = cardinality_;
+    switch (kind) {
+        case Kind::ARRAY:
+            converted.values_.reserve(cardinality_);
+            for_each([&](uint16_t value) { converted.values_.push_back(value); });
+            break;
+        case Kind::BITMAP:
+            converted.words_ = to_words();
+            break;
+        case Kind::RUN:
+            for_each([&](uint16_t value) {
+                if (!converted.runs_.empty() && uint32_t{converted.runs_.back().start} + converted.runs_.back().length + 1 == value) {
+                    ++converted.runs_.back().length;
+                } else {
+                    converted.runs_.push_back(Run{value, 0});
+                }
+            });
+            break;
+    }
+    *this = std::move(converted);
+}
+
+RoaringBitmap::RoaringBitmap(const std::vector<uint64_t>& record_ids) {
+    std::vector<uint64_t> sorted = record_ids;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint64_t record_id : sorted) {
+        add(record_id);
+    }
+}
+
+bool RoaringBitmap::add(uint64_t record_id) {
+    uint64_t key = record_id >> 16;
+    size_t index = find_key(key);
+    if (index == keys_.size() || keys_[index] != key) {
+        keys_.insert(keys_.begin() + index, key);
+        containers_.insert(containers_.begin() + index, RoaringContainer());
+    }
+    return containers_[index].add(static_cast<uint16_t>(record_id));
+}
+
+bool RoaringBitmap::remove(uint64_t record_id) {
+    uint64_t key = record_id >> 16;
+    size_t index = find_key(key);
+    if (index == keys_.size() || keys_[index] != key || !containers_[index].remove(static_cast<uint16_t>(record_id))) {
+        return false;
+    }
+    if (containers_[index].empty()) {
+        keys_.erase(keys_.begin() + index);
+        containers_.erase(containers_.begin() + index);
+    }
+    return true;
+}
+
+bool RoaringBitmap::contains(uint64_t record_id) const {
+    uint64_t key = record_id >> 16;
+    size_t index = find_key(key);
+    return index < keys_.size() && keys_[index] == key && containers_[index].contains(static_cast<uint16_t>(record_id));
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t cardinality = 0;
+    for (const auto& container : containers_) {
+        cardinality += container.cardinality();
+    }
+    return cardinality;
+}
+
+size_t RoaringBitmap::memory_usage() const {
+    size_t bytes = keys_.capacity() * sizeof(uint64_t);
+    for (const auto& container : containers_) {
+        bytes += container.memory_usage();
+    }
+    return bytes;
+}
+
+void RoaringBitmap::for_each(const Visitor& visitor) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        uint64_t base = keys_[i] << 16;
+        containers_[i].for_each([&](uint16_t value) { visitor(base + value); });
+    }
+}
+
+std::vector<uint64_t> RoaringBitmap::to_vector() const {
+    std::vector<uint64_t> record_ids;
+    record_ids.reserve(cardinality());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        containers_[i].append_to(record_ids, keys_[i] << 16);
+    }
+    return record_ids;
+}
+
+void RoaringBitmap::run_optimize() {
+    for (auto& container : containers_) {
+        container.run_optimize();
+    }
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& left, const RoaringBitmap& right) {
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < left.keys_.size() && j < right.keys_.size()) {
+        if (left.keys_[i] < right.keys_[j]) {
+            ++i;
+        } else if (right.keys_[j] < left.keys_[i]) {
+            ++j;
+        } else {
+            RoaringContainer container = RoaringContainer::intersect(left.containers_[i], right.containers_[j]);
+            if (!container.empty()) {
+                result.keys_.push_back(left.keys_[i]);
+                result.containers_.push_back(std::move(container));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& left, const RoaringBitmap& right) {
+    RoaringBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < left.keys_.size() || j < right.keys_.size()) {
+        if (j == right.keys_.size() || (i < left.keys_.size() && left.keys_[i] < right.keys_[j])) {
+            result.keys_.push_back(left.keys_[i]);
+            result.containers_.push_back(left.containers_[i++]);
+        } else if (i == left.keys_.size() || right.keys_[j] < left.keys_[i]) {
+            result.keys_.push_back(right.keys_[j]);
+            result.containers_.push_back(right.containers_[j++]);
+        } else {
+            result.keys_.push_back(left.keys_[i]);
+            result.containers_.push_back(RoaringContainer::unite(left.containers_[i++], right.containers_[j++]));
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::subtract(const RoaringBitmap& left, const RoaringBitmap& right) {
+    RoaringBitmap result;
+    size_t j = 0;
+    for (size_t i = 0; i < left.keys_.size(); ++i) {
+        while (j < right.keys_.size() && right.keys_[j] < left.keys_[i]) {
+            ++j;
+        }
+        if (j == right.keys_.size() || right.keys_[j] != left.keys_[i]) {
+            result.keys_.push_back(left.keys_[i]);
+            result.containers_.push_back(left.containers_[i]);
+            continue;
+        }
+        RoaringContainer container = RoaringContainer::subtract(left.containers_[i], right.containers_[j]);
+        if (!container.empty()) {
+            result.keys_.push_back(left.keys_[i]);
+            result.containers_.push_back(std::move(container));
+        }
+    }
+    return result;
+}
+
+uint64_t RoaringBitmap::intersect_cardinality(const RoaringBitmap& left, const RoaringBitmap& right) {
+    uint64_t cardinality = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < left.keys_.size() && j < right.keys_.size()) {
+        if (left.keys_[i] < right.keys_[j]) {
+            ++i;
+        } else if (right.keys_[j] < left.keys_[i]) {
+            ++j;
+        } else {
+            cardinality += RoaringContainer::intersect_cardinality(left.containers_[i++], right.containers_[j++]);
+        }
+    }
+    return cardinality;
+}
+
+const char* RoaringBitmap::simd_isa() {
+    return kernels().isa;
+}
+
+size_t RoaringBitmap::find_key(uint64_t key) const {
+    return static_cast<size_t>(std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin());
+}
+
+} // namespace nexusdb
@@ -0,0 +1,516 @@
+#include "nexusdb/rtree_index.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+namespace nexusdb {
+
+namespace {
+
+double low(const Rect& rect, size_t axis) {
+    return axis == 0 ? rect.min_x : rect.min_y;
+}
+
+double high(const Rect& rect, size_t axis) {
+    return axis == 0 ? rect.max_x : rect.max_y;
+}
+
+double center(const Rect& rect, size_t axis) {
+    return (low(rect, axis) + high(rect, axis)) / 2;
+}
+
+} // namespace
+
+Rect RTreeIndex::Node::bounds() const {
+    if (entries.empty()) {
+        return Rect{0, 0, 0, 0};
+    }
+    Rect rect = entries.front().rect;
+    for (const auto& entry : entries) {
+        rect = rect.united(entry.rect);
+    }
+    return rect;
+}
+
+template<typename Filter, typename Visitor>
+void RTreeIndex::visit_entries(const Filter& filter, const Visitor& visitor) const {
+    std::vector<const Node*> stack{root_.get()};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        for (const auto& entry : node->entries) {
+            if (!filter(entry.rect)) {
+                continue;
+            }
+            if (node->level > 0) {
+                stack.push_back(entry.child.get());
+            } else if (!visitor(entry)) {
+                return;
+            }
+        }
+    }
+}
+
+RTreeIndex::RTreeIndex()
+    : root_(std::make_unique<Node>()) {}
+
+std::optional<std::string> RTreeIndex::insert(const std::string& key, uint64_t record_id) {
+    auto rect = parse_geometry(key);
+    if (!rect.has_value()) {
+        return "Not a geometry: " + key.substr(0, 64);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (contains_entry(*root_, *rect, key, record_id)) {
+        return std::nullopt;
+    }
+    Entry entry;
+    entry.rect = *rect;
+    entry.key = key;
+    entry.record_id = record_id;
+    insert_entry(std::move(entry), 0);
+    ++entry_count_;
+    return std::nullopt;
+}
+
+std::optional<std::string> RTreeIndex::remove(const std::string& key, uint64_t record_id) {
+    auto rect = parse_geometry(key);
+    if (!rect.has_value()) {
+        return std::nullopt;  // Never inserted
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::vector<PendingEntry> orphans;
+    if (!remove_from(*root_, *rect, key, record_id, orphans)) {
+        return std::nullopt;
+    }
+    --entry_count_;
+
+    while (root_->level > 0 && root_->entries.size() == 1) {
+        auto child = std::move(root_->entries.front().child);
+        root_ = std::move(child);
+        --node_count_;
+    }
+    if (root_->level > 0 && root_->entries.empty()) {
+        root_ = std::make_unique<Node>();
+    }
+    for (auto& orphan : orphans) {
+        insert_entry(std::move(orphan.entry), orphan.level);
+    }
+    return std::nullopt;
+}
+
+std::vector<uint64_t> RTreeIndex::search(const std::string& key) const {
+    std::vector<uint64_t> record_ids;
+    auto rect = parse_geometry(key);
+    if (!rect.has_value()) {
+        return record_ids;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    visit_entries([&](const Rect& bounds) { return bounds.contains(*rect); }, [&](const Entry& entry) {
+        if (entry.key == key) {
+            record_ids.push_back(entry.record_id);
+        }
+        return true;
+    });
+    std::sort(record_ids.begin(), record_ids.end());
+    return record_ids;
+}
+
+PostingList RTreeIndex::postings(const std::string& key) const {
+    PostingList record_ids;
+    for (uint64_t record_id : search(key)) {
+        record_ids.add(record_id);
+    }
+    return record_ids;
+}
+
+std::optional<std::string> RTreeIndex::bulk_load(const std::vector<std::pair<std::string, uint64_t>>& entries, double fill_factor) {
+    std::vector<Entry> leaf_entries;
+    leaf_entries.reserve(entries.size());
+    for (const auto& [key, record_id] : entries) {
+        auto rect = parse_geometry(key);
+        if (!rect.has_value()) {
+            return "Not a geometry: " + key.substr(0, 64);
+        }
+        Entry entry;
+        entry.rect = *rect;
+        entry.key = key;
+        entry.record_id = record_id;
+        leaf_entries.push_back(std::move(entry));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (entry_count_ != 0) {
+        return "Bulk load requires an empty index";
+    }
+    if (leaf_entries.empty()) {
+        return std::nullopt;
+    }
+
+    size_t capacity = std::clamp(static_cast<size_t>(MAX_ENTRIES * fill_factor), MIN_ENTRIES, MAX_ENTRIES);
+    node_count_ = 0;
+    std::vector<Entry> level_entries = std::move(leaf_entries);
+    for (size_t level = 0;; ++level) {
+        auto nodes = pack(std::move(level_entries), level, capacity);
+        if (nodes.size() == 1) {
+            root_ = std::move(nodes.front());
+            break;
+        }
+        level_entries.clear();
+        for (auto& node : nodes) {
+            Entry entry;
+            entry.rect = node->bounds();
+            entry.child = std::move(node);
+            level_entries.push_back(std::move(entry));
+        }
+    }
+    entry_count_ = entries.size();
+    return std::nullopt;
+}
+
+void RTreeIndex::scan(const std::optional<std::string>& lower, bool lower_inclusive,
+                      const std::optional<std::string>& upper, bool upper_inclusive,
+                      const ScanVisitor& visitor) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    visit_entries([](const Rect&) { return true; }, [&](const Entry& entry) {
+        if (lower.has_value() && (entry.key < *lower || (!lower_inclusive && entry.key == *lower))) {
+            return true;
+        }
+        if (upper.has_value() && (*upper < entry.key || (!upper_inclusive && entry.key == *upper))) {
+            return true;
+        }
+        return visitor(entry.key, entry.record_id);
+    });
+}
+
+size_t RTreeIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entry_count_;
+}
+
+size_t RTreeIndex::height() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return root_->level + 1;
+}
+
+size_t RTreeIndex::node_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return node_count_;
+}
+
+std::vector<uint64_t> RTreeIndex::search_box(const Rect& box) const {
+    std::vector<uint64_t> record_ids;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    visit_entries([&](const Rect& bounds) { return bounds.intersects(box); }, [&](const Entry& entry) {
+        record_ids.push_back(entry.record_id);
+        return true;
+    });
+    std::sort(record_ids.begin(), record_ids.end());
+    return record_ids;
+}
+
+std::vector<uint64_t> RTreeIndex::search_radius(const Point& center, double radius) const {
+    std::vector<uint64_t> record_ids;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    visit_entries([&](const Rect& bounds) { return bounds.distance_to(center) <= radius; }, [&](const Entry& entry) {
+        record_ids.push_back(entry.record_id);
+        return true;
+    });
+    std::sort(record_ids.begin(), record_ids.end());
+    return record_ids;
+}
+
+// Best-first search: nodes and records share one queue ordered by distance,
+// so a record comes off it only once nothing unexplored can be closer
+std::vector<std::pair<uint64_t, double>> RTreeIndex::nearest(const Point& point, size_t k) const {
+    struct Item {
+        double distance;
+        const Node* node;  // null for a record
+        const Entry* entry;
+
+        bool operator>(const Item& other) const { return distance > other.distance; }
+    };
+
+    std::vector<std::pair<uint64_t, double>> nearest;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    queue.push(Item{0, root_.get(), nullptr});
+    while (!queue.empty() && nearest.size() < k) {
+        Item item = queue.top();
+        queue.pop();
+        if (item.node == nullptr) {
+            nearest.emplace_back(item.entry->record_id, item.distance);
+            continue;
+        }
+        for (const auto& entry : item.node->entries) {
+            queue.push(Item{entry.rect.distance_to(point), entry.child.get(), &entry});
+        }
+    }
+    return nearest;
+}
+
+void RTreeIndex::insert_entry(Entry entry, size_t level) {
+    std::vector<PendingEntry> pending;
+    pending.push_back(PendingEntry{std::move(entry), level});
+    // Levels that have already shed entries during this insert
+    std::vector<bool> overflowed(root_->level + 1, false);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        PendingEntry current = std::move(pending[i]);
+        if (current.level > root_->level) {
+            // A subtree orphaned above a root that has since shrunk; its
+            // children fit one level down
+            for (auto& child_entry : current.entry.child->entries) {
+                pending.push_back(PendingEntry{std::move(child_entry), current.level - 1});
+            }
+            --node_count_;
+            continue;
+        }
+
+        auto sibling = insert_into(*root_, current.entry, current.level, overflowed, pending);
+        if (sibling) {
+            auto new_root = std::make_unique<Node>();
+            new_root->level = root_->level + 1;
+            for (auto* child : {&root_, &sibling}) {
+                Entry child_entry;
+                child_entry.rect = (*child)->bounds();
+                child_entry.child = std::move(*child);
+                new_root->entries.push_back(std::move(child_entry));
+            }
+            root_ = std::move(new_root);
+            ++node_count_;
+            overflowed.resize(root_->level + 1, false);
+        }
+    }
+}
+
+std::unique_ptr<RTreeIndex::Node> RTreeIndex::insert_into(Node& node, Entry& entry, size_t level, std::vector<bool>& overflowed,
+                                                          std::vector<PendingEntry>& pending) {
+    if (node.level == level) {
+        node.entries.push_back(std::move(entry));
+    } else {
+        size_t index = choose_subtree(node, entry.rect);
+        Node& child = *node.entries[index].child;
+        auto sibling = insert_into(child, entry, level, overflowed, pending);
+        node.entries[index].rect = child.bounds();
+        if (sibling) {
+            Entry sibling_entry;
+            sibling_entry.rect = sibling->bounds();
+            sibling_entry.child = std::move(sibling);
+            node.entries.push_back(std::move(sibling_entry));
+        }
+    }
+
+    if (node.entries.size() <= MAX_ENTRIES) {
+        return nullptr;
+    }
+    if (&node != root_.get() && !overflowed[node.level]) {
+        overflowed[node.level] = true;
+        shed_for_reinsert(node, pending);
+        return nullptr;
+    }
+    return split(node);
+}
+
+size_t RTreeIndex::choose_subtree(const Node& node, const Rect& rect) {
+    // Just above the leaves, overlap between siblings is what slows queries
+    // down, so it is weighed first
+    bool weigh_overlap = node.level == 1;
+    size_t best = 0;
+    std::tuple<double, double, double> best_cost;
+    for (size_t i = 0; i < node.entries.size(); ++i) {
+        const Rect& current = node.entries[i].rect;
+        Rect grown = current.united(rect);
+        double overlap_growth = 0;
+        if (weigh_overlap) {
+            for (size_t j = 0; j < node.entries.size(); ++j) {
+                if (j != i) {
+                    overlap_growth += grown.overlap(node.entries[j].rect) - current.overlap(node.entries[j].rect);
+                }
+            }
+        }
+        auto cost = std::make_tuple(overlap_growth, grown.area() - current.area(), current.area());
+        if (i == 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+std::unique_ptr<RTreeIndex::Node> RTreeIndex::split(Node& node) {
+    auto& entries = node.entries;
+    size_t count = entries.size();
+    auto sorted = [&](size_t axis, bool by_high) {
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const Rect& left = entries[a].rect;
+            const Rect& right = entries[b].rect;
+            return by_high ? std::make_pair(high(left, axis), low(left, axis)) < std::make_pair(high(right, axis), low(right, axis))
+                           : std::make_pair(low(left, axis), high(left, axis)) < std::make_pair(low(right, axis), high(right, axis));
+        });
+        return order;
+    };
+    // Calls visit with the bounds of the two groups for every split point
+    // that leaves MIN_ENTRIES on each side
+    auto for_each_split = [&](const std::vector<size_t>& order, const std::function<void(size_t, const Rect&, const Rect&)>& visit) {
+        std::vector<Rect> prefix(count);
+        std::vector<Rect> suffix(count);
+        prefix[0] = entries[order[0]].rect;
+        for (size_t i = 1; i < count; ++i) {
+            prefix[i] = prefix[i - 1].united(entries[order[i]].rect);
+        }
+        suffix[count - 1] = entries[order[count - 1]].rect;
+        for (size_t i = count - 1; i-- > 0;) {
+            suffix[i] = suffix[i + 1].united(entries[order[i]].rect);
+        }
+        for (size_t split_at = MIN_ENTRIES; split_at + MIN_ENTRIES <= count; ++split_at) {
+            visit(split_at, prefix[split_at - 1], suffix[split_at]);
+        }
+    };
+
+    size_t axis = 0;
+    double best_margin = std::numeric_limits<double>::infinity();
+    for (size_t candidate_axis = 0; candidate_axis < 2; ++candidate_axis) {
+        double margin = 0;
+        for (bool by_high : {false, true}) {
+            for_each_split(sorted(candidate_axis, by_high), [&](size_t, const Rect& first, const Rect& second) {
+                margin += first.margin() + second.margin();
+            });
+        }
+        if (margin < best_margin) {
+            best_margin = margin;
+            axis = candidate_axis;
+        }
+    }
+
+    std::vector<size_t> best_order;
+    size_t best_split = 0;
+    std::pair<double, double> best_cost{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    for (bool by_high : {false, true}) {
+        auto order = sorted(axis, by_high);
+        for_each_split(order, [&](size_t split_at, const Rect& first, const Rect& second) {
+            auto cost = std::make_pair(first.overlap(second), first.area() + second.area());
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_order = order;
+                best_split = split_at;
+            }
+        });
+    }
+
+    auto sibling = std::make_unique<Node>();
+    sibling->level = node.level;
+    std::vector<Entry> kept;
+    kept.reserve(best_split);
+    for (size_t i = 0; i < count; ++i) {
+        (i < best_split ? kept : sibling->entries).push_back(std::move(entries[best_order[i]]));
+    }
+    node.entries = std::move(kept);
+    ++node_count_;
+    return sibling;
+}
+
+void RTreeIndex::shed_for_reinsert(Node& node, std::vector<PendingEntry>& pending) {
+    Point node_center = node.bounds().center();
+    auto distance = [&](const Entry& entry) {
+        Point entry_center = entry.rect.center();
+        double dx = entry_center.x - node_center.x;
+        double dy = entry_center.y - node_center.y;
+        return dx * dx + dy * dy;
+    };
+    std::sort(node.entries.begin(), node.entries.end(), [&](const Entry& a, const Entry& b) { return distance(a) < distance(b); });
+
+    // The nearest of the shed entries go back in first
+    size_t kept = node.entries.size() - REINSERT_ENTRIES;
+    for (size_t i = kept; i < node.entries.size(); ++i) {
+        pending.push_back(PendingEntry{std::move(node.entries[i]), node.level});
+    }
+    node.entries.erase(node.entries.begin() + kept, node.entries.end());
+}
+
+bool RTreeIndex::remove_from(Node& node, const Rect& rect, const std::string& key, uint64_t record_id, std::vector<PendingEntry>& orphans) {
+    if (node.level == 0) {
+        auto it = std::find_if(node.entries.begin(), node.entries.end(), [&](const Entry& entry) {
+            return entry.record_id == record_id && entry.key == key;
+        });
+        if (it == node.entries.end()) {
+            return false;
+        }
+        node.entries.erase(it);
+        return true;
+    }
+
+    for (size_t i = 0; i < node.entries.size(); ++i) {
+        Entry& entry = node.entries[i];
+        if (!entry.rect.contains(rect) || !remove_from(*entry.child, rect, key, record_id, orphans)) {
+            continue;
+        }
+        if (entry.child->entries.size() < MIN_ENTRIES) {
+            for (auto& orphan : entry.child->entries) {
+                orphans.push_back(PendingEntry{std::move(orphan), entry.child->level});
+            }
+            node.entries.erase(node.entries.begin() + i);
+            --node_count_;
+        } else {
+            entry.rect = entry.child->bounds();
+        }
+        return true;
+    }
+    return false;
+}
+
+// Sort-Tile-Recursive: entries are sorted by x and cut into about sqrt(n)
+// vertical slices, each sorted by y and cut into nodes
+std::vector<std::unique_ptr<RTreeIndex::Node>> RTreeIndex::pack(std::vector<Entry> entries, size_t level, size_t capacity) {
+    size_t count = entries.size();
+    size_t node_total = (count + capacity - 1) / capacity;
+    size_t slice_count = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(node_total))));
+    size_t slice_size = (node_total + slice_count - 1) / slice_count * capacity;
+    auto by_center = [](size_t axis) {
+        return [axis](const Entry& a, const Entry& b) { return center(a.rect, axis) < center(b.rect, axis); };
+    };
+
+    std::sort(entries.begin(), entries.end(), by_center(0));
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (size_t start = 0; start < count; start += slice_size) {
+        size_t end = std::min(start + slice_size, count);
+        std::sort(entries.begin() + start, entries.begin() + end, by_center(1));
+        // The slice is spread evenly so its last node is not left nearly empty
+        size_t slice_nodes = (end - start + capacity - 1) / capacity;
+        for (size_t first = start; slice_nodes > 0; --slice_nodes) {
+            size_t taken = (end - first) / slice_nodes;
+            auto node = std::make_unique<Node>();
+            node->level = level;
+            node->entries.reserve(taken);
+            for (size_t i = first; i < first + taken; ++i) {
+                node->entries.push_back(std::move(entries[i]));
+            }
+            first += taken;
+            nodes.push_back(std::move(node));
+            ++node_count_;
+        }
+    }
+    return nodes;
+}
+
+bool RTreeIndex::contains_entry(const Node& node, const Rect& rect, const std::string& key, uint64_t record_id) const {
+    for (const auto& entry : node.entries) {
+        if (node.level == 0) {
+            if (entry.record_id == record_id && entry.key == key) {
+                return true;
+            }
+        } else if (entry.rect.contains(rect) && contains_entry(*entry.child, rect, key, record_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace nexusdb
@@ -113,18 +113,25 @@ public:
                 continue;
             }
 
-            SSL* ssl = SSL_new(ctx_);
-            SSL_set_fd(ssl, client_fd);
+            // Each connection blocks in the handshake and in receive(), so it
+            // gets its own thread rather than a scheduler worker; a slow or
+            // idle client must not hold up the accept loop or the pool
+            std::thread([this, client_fd, connection_handler]() {
+                SSL* ssl = SSL_new(ctx_);
+                SSL_set_fd(ssl, client_fd);
+
+                if (SSL_accept(ssl) <= 0) {
+                    SSL_free(ssl);
+                    ::close(client_fd);
+                    return;
+                }
 
-            if (SSL_accept(ssl) <= 0) {
-                SSL_free(ssl);
-                ::close(client_fd);
-                continue;
-            }
-
-            std::thread([this, ssl, client_fd, connection_handler]() {
                 auto socket = std::make_unique<OpenSSLSocket>(ssl, client_fd);
-                connection_handler(std::move(socket));
+                try {
+                    connection_handler(std::move(socket));
+                } catch (const std::exception&) {
+                    // The client went away; its socket is closed on unwind
+                }
             }).detach();
         }
     }
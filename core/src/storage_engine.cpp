@@ -1,12 +1,23 @@
 #include "nexusdb/storage_engine.h"
+#include "nexusdb/task_scheduler.h"
 #include "nexusdb/utils/logger.h"
 #include <sstream>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <thread>
 
 namespace nexusdb {
 
 StorageEngine::StorageEngine(const StorageConfig& config) 
     : config_(config), consistency_level_(ConsistencyLevel::ONE) {
+    for (auto& seq : page_write_seq_) {
+        seq.store(0, std::memory_order_relaxed);
+    }
     LOG_DEBUG("StorageEngine constructor called");
 }
 
@@ -21,18 +32,48 @@ std::optional<std::string> StorageEngine::initialize(const std::string& data_dir
         LOG_INFO("Initializing StorageEngine...");
         data_directory_ = data_directory;
         file_manager_ = std::make_unique<FileManager>(data_directory_);
-        
+        auto table_result = load_table_catalog();
+        if (table_result.has_value()) {
+            return table_result;
+        }
+        publish_table_snapshot();
+
         index_manager_ = std::make_shared<IndexManager>(shared_from_this());
         auto index_init_result = index_manager_->initialize();
         if (index_init_result.has_value()) {
             return index_init_result;
         }
 
+        auto bloom_result = load_bloom_filters();
+        if (bloom_result.has_value()) {
+            return bloom_result;
+        }
+
         recovery_manager_ = std::make_shared<RecoveryManager>(shared_from_this());
         auto recovery_init_result = recovery_manager_->initialize(data_directory_ + "/recovery.log");
         if (recovery_init_result.has_value()) {
             return recovery_init_result;
         }
+        // Index pages may hold uncommitted changes, which the log must be
+        // able to undo once they are on disk
+        std::weak_ptr<RecoveryManager> recovery_manager = recovery_manager_;
+        index_manager_->set_write_ahead([recovery_manager]() -> std::optional<std::string> {
+            auto manager = recovery_manager.lock();
+            if (!manager) {
+                return "Recovery manager is shut down";
+            }
+            return manager->force_log();
+        });
+
+        transaction_manager_ = std::make_unique<TransactionManager>();
+        auto transaction_init_result = transaction_manager_->initialize();
+        if (transaction_init_result.has_value()) {
+            return transaction_init_result;
+        }
+        transaction_manager_->reserve_transaction_ids(recovery_manager_->get_max_logged_transaction_id());
+
+        version_store_ = std::make_shared<VersionStore>();
+        publish_table_snapshot();
 
         LOG_INFO("StorageEngine initialized successfully");
         return std::nullopt;
@@ -45,13 +86,35 @@ std::optional<std::string> StorageEngine::initialize(const std::string& data_dir
 void StorageEngine::shutdown() {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Shutting down StorageEngine...");
+    for (auto& [table_name, columns] : bloom_filters_) {
+        for (auto& [column_name, entry] : columns) {
+            auto save_result = save_bloom_filter(table_name, column_name, entry);
+            if (save_result.has_value()) {
+                LOG_ERROR(*save_result);
+            }
+        }
+    }
+    bloom_filters_.clear();
+    zone_maps_.clear();
+    table_indexes_.clear();
+    // Changes of transactions still running are dropped with their pages
+    auto write_result = write_released_pages();
+    if (write_result.has_value()) {
+        LOG_ERROR(*write_result);
+    }
+    dirty_pages_.clear();
+    transaction_pages_.clear();
     for (const auto& [table_name, file_name] : table_files_) {
         file_manager_->close_file(file_name);
     }
     table_files_.clear();
+    publish_table_snapshot();
     file_manager_.reset();
     index_manager_->shutdown();
     recovery_manager_->shutdown();
+    if (transaction_manager_) {
+        transaction_manager_->shutdown();
+    }
     LOG_INFO("StorageEngine shut down successfully");
 }
 
@@ -68,6 +131,7 @@ std::optional<std::string> StorageEngine::create_table(const std::string& table_
     }
 
     table_files_[table_name] = file_name;
+    publish_table_snapshot();
 
     auto page = allocate_page(table_name);
     if (!page) {
@@ -89,6 +153,18 @@ std::optional<std::string> StorageEngine::create_table(const std::string& table_
     if (write_result.has_value()) {
         return write_result;
     }
+    // Recovery finds the table through the catalog, so its schema page must
+    // be on disk before the catalog names it
+    if (!file_manager_->sync_file(file_name)) {
+        return "Failed to sync file for table";
+    }
+    auto catalog_result = save_table_catalog();
+    if (catalog_result.has_value()) {
+        table_files_.erase(table_name);
+        publish_table_snapshot();
+        return catalog_result;
+    }
+    zone_maps_[table_name] = ZoneMap(schema.size());
 
     LOG_INFO("Table created successfully: " + table_name);
     return std::nullopt;
@@ -103,19 +179,54 @@ std::optional<std::string> StorageEngine::delete_table(const std::string& table_
     }
 
     file_manager_->close_file(it->second);
+    {
+        std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+        dirty_pages_.erase(it->second);
+    }
     // Here we should also delete the file, but that's not implemented in our FileManager yet
     // For now, we'll just remove it from our map
     table_files_.erase(it);
+    publish_table_snapshot();
+    auto catalog_result = save_table_catalog();
+    if (catalog_result.has_value()) {
+        return catalog_result;
+    }
 
     // Remove all indexes for this table
     index_manager_->drop_all_indexes(table_name);
+    cancel_index_builds(table_name);
+    zone_maps_.erase(table_name);
+    table_indexes_.erase(table_name);
+
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it != bloom_filters_.end()) {
+        for (const auto& [column_name, entry] : filters_it->second) {
+            std::remove(get_bloom_file_path(table_name, column_name).c_str());
+        }
+        bloom_filters_.erase(filters_it);
+        save_bloom_catalog();
+    }
 
     LOG_INFO("Table deleted successfully: " + table_name);
     return std::nullopt;
 }
 
 std::optional<std::string> StorageEngine::insert_record(const std::string& table_name, const std::vector<std::string>& record) {
+    return run_autocommit([&](const std::shared_ptr<Transaction>& txn) {
+        return insert_record(txn, table_name, record);
+    });
+}
+
+std::optional<std::string> StorageEngine::insert_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::vector<std::string>& record) {
+    auto txn_result = check_transaction(txn, true);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
+    return insert_record_locked(table_name, record, txn->get_id());
+}
+
+std::optional<std::string> StorageEngine::insert_record_locked(const std::string& table_name, const std::vector<std::string>& record, std::optional<transaction_id_t> txn_id) {
     LOG_INFO("Inserting record into table: " + table_name);
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
@@ -138,28 +249,40 @@ std::optional<std::string> StorageEngine::insert_record(const std::string& table
 
         int offset = page->add_record(record_data);
         if (offset != -1) {
+            uint64_t record_id = (page_id - 1) * (Page::PAGE_SIZE / sizeof(uint64_t)) + offset;
+
+            // Log the operation; the page stays in memory until the transaction finishes
+            if (txn_id.has_value()) {
+                LogRecord log_record{
+                    LogRecordType::INSERT,
+                    *txn_id,
+                    table_name,
+                    record_id,
+                    "", // before_image (empty for insert)
+                    record_str // after_image
+                };
+                auto log_result = recovery_manager_->log_operation(log_record);
+                if (log_result.has_value()) {
+                    return log_result;
+                }
+                version_store_->record_before_image(*txn_id, table_name, record_id, std::nullopt);
+            }
+
             if (config_.use_compression) {
                 page->compress();
             }
-            auto write_result = write_page(table_name, *page);
+            auto write_result = write_page(table_name, *page, txn_id);
             if (write_result.has_value()) {
                 return write_result;
             }
-            
-            // Update indexes
-            uint64_t record_id = (page_id - 1) * (Page::PAGE_SIZE / sizeof(uint64_t)) + offset;
-            update_indexes(table_name, record, record_id);
 
-            // Log the operation
-            LogRecord log_record{
-                LogRecordType::INSERT,
-                0, // transaction_id (0 for now, as we're not handling transactions in this example)
-                table_name,
-                record_id,
-                "", // before_image (empty for insert)
-                record_str // after_image
-            };
-            recovery_manager_->log_operation(log_record);
+            // Update indexes
+            auto index_result = update_indexes(table_name, record, record_id, txn_id);
+            if (index_result.has_value()) {
+                return index_result;
+            }
+            update_bloom_filters(table_name, record, page_id);
+            update_zone_map(table_name, record, page_id);
 
             LOG_INFO("Record inserted successfully into table: " + table_name);
             return std::nullopt;
@@ -201,8 +324,173 @@ std::optional<std::string> StorageEngine::read_record(const std::string& table_n
     return std::nullopt;
 }
 
+std::optional<std::string> StorageEngine::read_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, std::vector<std::string>& record) const {
+    auto txn_result = check_transaction(txn);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
+    if (!txn->is_read_only()) {
+        return read_record(table_name, record_id, record);
+    }
+    return read_record_snapshot(*txn, table_name, record_id, record);
+}
+
+std::optional<std::string> StorageEngine::read_record_snapshot(const Transaction& txn, const std::string& table_name, uint64_t record_id, std::vector<std::string>& record) const {
+    auto tables = std::atomic_load(&table_snapshot_);
+    auto it = tables->find(table_name);
+    if (it == tables->end()) {
+        return "Table doesn't exist";
+    }
+
+    uint64_t page_id = record_id / (Page::PAGE_SIZE / sizeof(uint64_t)) + 1;
+    uint64_t offset = record_id % (Page::PAGE_SIZE / sizeof(uint64_t));
+
+    // Optimistic read: retry if a writer touched the table while the page was read
+    std::atomic<uint64_t>& write_seq = page_write_seq_for(table_name);
+    std::optional<std::string> record_str;
+    while (true) {
+        uint64_t seq = write_seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        auto page = read_page_from(*txn.get_read_view(), it->second, page_id);
+        std::vector<char> record_data;
+        if (page) {
+            record_data = page->get_record(offset);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (write_seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        if (!record_data.empty()) {
+            record_str = std::string(record_data.begin(), record_data.end());
+        }
+        break;
+    }
+
+    // Changes committed after the snapshot (or not committed at all) are
+    // replaced by the before-image the snapshot is entitled to see
+    std::optional<std::string> before_image;
+    if (version_store_->find_version(table_name, record_id, txn.get_snapshot_timestamp(), before_image)) {
+        record_str = before_image;
+    }
+    if (!record_str.has_value()) {
+        return "Record not found";
+    }
+
+    std::istringstream record_stream(*record_str);
+    std::string field;
+    record.clear();
+    while (std::getline(record_stream, field)) {
+        record.push_back(field);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::vector<std::string>> StorageEngine::read_schema_snapshot(const Transaction& txn, const std::string& table_name, const std::string& file_name) const {
+    auto page = read_page_consistent(*txn.get_read_view(), table_name, file_name, 0);
+    if (!page) {
+        return std::nullopt;
+    }
+
+    std::vector<char> schema_data = page->get_record(0);
+    if (schema_data.empty()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> schema;
+    std::istringstream schema_stream(std::string(schema_data.begin(), schema_data.end()));
+    std::string field;
+    while (std::getline(schema_stream, field)) {
+        schema.push_back(field);
+    }
+    return schema;
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::scan_table_snapshot(const Transaction& txn, const std::string& table_name,
+                                                                                                            const std::vector<ColumnPredicate>& predicates) const {
+    auto tables = std::atomic_load(&table_snapshot_);
+    auto it = tables->find(table_name);
+    if (it == tables->end()) {
+        return std::nullopt;
+    }
+    auto schema = read_schema_snapshot(txn, table_name, it->second);
+    if (!schema.has_value()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<size_t, ColumnPredicate>> resolved;
+    for (const auto& predicate : predicates) {
+        size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), predicate.column));
+        if (column_index == schema->size()) {
+            return std::nullopt;
+        }
+        resolved.emplace_back(column_index, predicate);
+    }
+    auto matches = [&](const std::vector<std::string>& record) {
+        for (const auto& [column_index, predicate] : resolved) {
+            const std::string& field = column_index < record.size() ? record[column_index] : std::string();
+            if (!predicate_holds(field, predicate.op, predicate.value)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::map<uint64_t, std::vector<std::string>> visible;
+    for (uint64_t page_id = 1;; ++page_id) {
+        auto page = read_page_consistent(*txn.get_read_view(), table_name, it->second, page_id);
+        if (!page) {
+            break;
+        }
+        for_each_record_in_page(*page, page_id, [&](uint64_t record_id, const std::vector<std::string>& record) {
+            if (matches(record)) {
+                visible.emplace(record_id, record);
+            }
+        });
+    }
+
+    // Writers version a record before changing its page, so the changes
+    // collected after the pages were read cover every one they reflect.
+    // Each changed record is seen as its before-image, including records
+    // deleted since the snapshot.
+    for (const auto& [record_id, before_image] : version_store_->changed_records(table_name, txn.get_snapshot_timestamp())) {
+        visible.erase(record_id);
+        if (!before_image.has_value()) {
+            continue;
+        }
+        std::vector<std::string> record;
+        std::istringstream record_stream(*before_image);
+        std::string field;
+        while (std::getline(record_stream, field)) {
+            record.push_back(field);
+        }
+        if (matches(record)) {
+            visible.emplace(record_id, std::move(record));
+        }
+    }
+    return std::vector<std::pair<uint64_t, std::vector<std::string>>>(std::make_move_iterator(visible.begin()), std::make_move_iterator(visible.end()));
+}
+
 std::optional<std::string> StorageEngine::update_record(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record) {
+    return run_autocommit([&](const std::shared_ptr<Transaction>& txn) {
+        return update_record(txn, table_name, record_id, new_record);
+    });
+}
+
+std::optional<std::string> StorageEngine::update_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record) {
+    auto txn_result = check_transaction(txn, true);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
+    return update_record_locked(table_name, record_id, new_record, txn->get_id());
+}
+
+std::optional<std::string> StorageEngine::update_record_locked(const std::string& table_name, uint64_t record_id, const std::vector<std::string>& new_record, std::optional<transaction_id_t> txn_id) {
     LOG_INFO("Updating record in table: " + table_name + ", record_id: " + std::to_string(record_id));
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
@@ -227,10 +515,27 @@ std::optional<std::string> StorageEngine::update_record(const std::string& table
     std::vector<char> new_record_data(new_record_str.begin(), new_record_str.end());
 
     if (page->update_record(offset, new_record_data)) {
+        // Log the operation; the page stays in memory until the transaction finishes
+        if (txn_id.has_value()) {
+            LogRecord log_record{
+                LogRecordType::UPDATE,
+                *txn_id,
+                table_name,
+                record_id,
+                std::string(old_record_data.begin(), old_record_data.end()), // before_image
+                new_record_str // after_image
+            };
+            auto log_result = recovery_manager_->log_operation(log_record);
+            if (log_result.has_value()) {
+                return log_result;
+            }
+            version_store_->record_before_image(*txn_id, table_name, record_id, log_record.before_image);
+        }
+
         if (config_.use_compression) {
             page->compress();
         }
-        auto write_result = write_page(table_name, *page);
+        auto write_result = write_page(table_name, *page, txn_id);
         if (write_result.has_value()) {
             return write_result;
         }
@@ -242,19 +547,15 @@ std::optional<std::string> StorageEngine::update_record(const std::string& table
         while (std::getline(old_record_stream, field)) {
             old_record.push_back(field);
         }
-        remove_from_indexes(table_name, old_record, record_id);
-        update_indexes(table_name, new_record, record_id);
-
-        // Log the operation
-        LogRecord log_record{
-            LogRecordType::UPDATE,
-            0, // transaction_id (0 for now, as we're not handling transactions in this example)
-            table_name,
-            record_id,
-            std::string(old_record_data.begin(), old_record_data.end()), // before_image
-            new_record_str // after_image
-        };
-        recovery_manager_->log_operation(log_record);
+        auto index_result = remove_from_indexes(table_name, old_record, record_id, txn_id);
+        if (!index_result.has_value()) {
+            index_result = update_indexes(table_name, new_record, record_id, txn_id);
+        }
+        if (index_result.has_value()) {
+            return index_result;
+        }
+        update_bloom_filters(table_name, new_record, page_id);
+        update_zone_map(table_name, new_record, page_id);
 
         LOG_INFO("Record updated successfully in table: " + table_name);
         return std::nullopt;
@@ -264,7 +565,21 @@ std::optional<std::string> StorageEngine::update_record(const std::string& table
 }
 
 std::optional<std::string> StorageEngine::delete_record(const std::string& table_name, uint64_t record_id) {
+    return run_autocommit([&](const std::shared_ptr<Transaction>& txn) {
+        return delete_record(txn, table_name, record_id);
+    });
+}
+
+std::optional<std::string> StorageEngine::delete_record(const std::shared_ptr<Transaction>& txn, const std::string& table_name, uint64_t record_id) {
+    auto txn_result = check_transaction(txn, true);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
+    return delete_record_locked(table_name, record_id, txn->get_id());
+}
+
+std::optional<std::string> StorageEngine::delete_record_locked(const std::string& table_name, uint64_t record_id, std::optional<transaction_id_t> txn_id) {
     LOG_INFO("Deleting record from table: " + table_name + ", record_id: " + std::to_string(record_id));
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
@@ -285,10 +600,27 @@ std::optional<std::string> StorageEngine::delete_record(const std::string& table
     }
 
     if (page->delete_record(offset)) {
+        // Log the operation; the page stays in memory until the transaction finishes
+        if (txn_id.has_value()) {
+            LogRecord log_record{
+                LogRecordType::DELETE,
+                *txn_id,
+                table_name,
+                record_id,
+                std::string(record_data.begin(), record_data.end()), // before_image
+                "" // after_image (empty for delete)
+            };
+            auto log_result = recovery_manager_->log_operation(log_record);
+            if (log_result.has_value()) {
+                return log_result;
+            }
+            version_store_->record_before_image(*txn_id, table_name, record_id, log_record.before_image);
+        }
+
         if (config_.use_compression) {
             page->compress();
         }
-        auto write_result = write_page(table_name, *page);
+        auto write_result = write_page(table_name, *page, txn_id);
         if (write_result.has_value()) {
             return write_result;
         }
@@ -300,18 +632,10 @@ std::optional<std::string> StorageEngine::delete_record(const std::string& table
         while (std::getline(old_record_stream, field)) {
             old_record.push_back(field);
         }
-        remove_from_indexes(table_name, old_record, record_id);
-
-        // Log the operation
-        LogRecord log_record{
-            LogRecordType::DELETE,
-            0, // transaction_id (0 for now, as we're not handling transactions in this example)
-            table_name,
-            record_id,
-            std::string(record_data.begin(), record_data.end()), // before_image
-            "" // after_image (empty for delete)
-        };
-        recovery_manager_->log_operation(log_record);
+        auto index_result = remove_from_indexes(table_name, old_record, record_id, txn_id);
+        if (index_result.has_value()) {
+            return index_result;
+        }
 
         LOG_INFO("Record deleted successfully from table: " + table_name);
         return std::nullopt;
@@ -322,6 +646,10 @@ std::optional<std::string> StorageEngine::delete_record(const std::string& table
 
 std::optional<std::vector<std::string>> StorageEngine::get_table_schema(const std::string& table_name) const {
     std::lock_guard<std::mutex> lock(mutex_);
+    return read_schema_locked(table_name);
+}
+
+std::optional<std::vector<std::string>> StorageEngine::read_schema_locked(const std::string& table_name) const {
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
         return std::nullopt;
@@ -347,62 +675,285 @@ std::optional<std::vector<std::string>> StorageEngine::get_table_schema(const st
     return schema;
 }
 
-std::optional<std::string> StorageEngine::create_index(const std::string& table_name, const std::string& column_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void StorageEngine::for_each_record_locked(const std::string& table_name, const std::function<void(uint64_t, const std::vector<std::string>&)>& visitor) const {
+    uint64_t page_id = 1;  // Start from the second page (first page is for schema)
+    while (true) {
+        auto page = read_page(table_name, page_id);
+        if (!page) {
+            break;  // No more pages
+        }
+        for_each_record_in_page(*page, page_id, visitor);
+        ++page_id;
+    }
+}
+
+void StorageEngine::for_each_record_in_page(const Page& page, uint64_t page_id, const std::function<void(uint64_t, const std::vector<std::string>&)>& visitor) const {
+    size_t offset = 0;
+    while (offset < Page::PAGE_SIZE) {
+        size_t deleted_size = page.tombstone_size(offset);
+        if (deleted_size != 0) {
+            offset += sizeof(size_t) + deleted_size;
+            continue;
+        }
+        std::vector<char> record_data = page.get_record(offset);
+        if (record_data.empty()) {
+            break;  // No more records in this page
+        }
+
+        std::vector<std::string> record;
+        std::istringstream record_stream(std::string(record_data.begin(), record_data.end()));
+        std::string field;
+        while (std::getline(record_stream, field)) {
+            record.push_back(field);
+        }
+
+        uint64_t record_id = (page_id - 1) * (Page::PAGE_SIZE / sizeof(uint64_t)) + offset;
+        visitor(record_id, record);
+
+        offset += sizeof(size_t) + record_data.size();
+    }
+}
+
+std::optional<std::string> StorageEngine::create_index(const std::string& table_name, const std::string& column_name, IndexType type, IndexBuildMode mode) {
+    std::unique_lock<std::mutex> lock(mutex_);
     LOG_INFO("Creating index on table: " + table_name + ", column: " + column_name);
 
-    auto schema = get_table_schema(table_name);
+    auto schema = read_schema_locked(table_name);
     if (!schema.has_value()) {
         return "Table doesn't exist or schema not found";
     }
 
-    size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
-    if (column_index == schema->size()) {
+    if (std::find(schema->begin(), schema->end(), column_name) == schema->end()) {
         return "Column not found in table schema";
     }
 
-    auto result = index_manager_->create_index(table_name, column_name);
+    if (index_manager_->has_index(table_name, column_name)) {
+        return "Index already exists for this table and column";
+    }
+
+    IndexManager::IndexDefinition definition{column_name, {column_name}, {}, type};
+    auto result = build_index(lock, table_name, *schema, definition, mode, [&](std::vector<std::pair<std::string, uint64_t>> entries) {
+        return index_manager_->bulk_load_index(table_name, column_name, std::move(entries), type);
+    });
     if (result.has_value()) {
         return result;
     }
 
-    // Populate the index with existing data
-    uint64_t page_id = 1;  // Start from the second page (first page is for schema)
-    while (true) {
-        auto page = read_page(table_name, page_id);
-        if (!page) {
-            break;  // No more pages
-        }
+    LOG_INFO("Index created successfully on table: " + table_name + ", column: " + column_name);
+    return std::nullopt;
+}
 
-        size_t offset = 0;
-        while (offset < Page::PAGE_SIZE) {
-            std::vector<char> record_data = page->get_record(offset);
-            if (record_data.empty()) {
-                break;  // No more records in this page
-            }
+std::optional<std::string> StorageEngine::create_composite_index(const std::string& table_name, const std::vector<std::string>& key_columns,
+                                                                  const std::vector<std::string>& include_columns, IndexBuildMode mode) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::string index_name = IndexManager::composite_index_name(key_columns, include_columns);
+    LOG_INFO("Creating composite index on table: " + table_name + ", columns: " + index_name);
 
-            std::vector<std::string> record;
-            std::istringstream record_stream(std::string(record_data.begin(), record_data.end()));
-            std::string field;
-            while (std::getline(record_stream, field)) {
-                record.push_back(field);
-            }
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return "Table doesn't exist or schema not found";
+    }
 
-            if (column_index < record.size()) {
-                uint64_t record_id = (page_id - 1) * (Page::PAGE_SIZE / sizeof(uint64_t)) + offset;
-                index_manager_->insert_into_index(table_name, column_name, record[column_index], record_id);
+    IndexManager::IndexDefinition definition{index_name, key_columns, include_columns, IndexType::BTREE};
+    for (const auto* columns : {&key_columns, &include_columns}) {
+        for (const auto& column : *columns) {
+            if (std::find(schema->begin(), schema->end(), column) == schema->end()) {
+                return "Column not found in table schema: " + column;
             }
+        }
+    }
 
-            offset += sizeof(size_t) + record_data.size();
+    if (index_manager_->has_index(table_name, index_name)) {
+        return "Index already exists for these columns";
+    }
+
+    auto result = build_index(lock, table_name, *schema, definition, mode, [&](std::vector<std::pair<std::string, uint64_t>> entries) {
+        return index_manager_->bulk_load_composite_index(table_name, key_columns, include_columns, std::move(entries));
+    });
+    if (result.has_value()) {
+        return result;
+    }
+
+    LOG_INFO("Composite index created successfully on table: " + table_name + ", columns: " + index_name);
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::build_index(std::unique_lock<std::mutex>& lock, const std::string& table_name, const std::vector<std::string>& schema,
+                                                      const IndexManager::IndexDefinition& definition, IndexBuildMode mode,
+                                                      const std::function<std::optional<std::string>(std::vector<std::pair<std::string, uint64_t>>)>& load) {
+    std::string file_name = table_files_.at(table_name);
+    std::vector<std::pair<std::string, uint64_t>> entries;
+    if (mode == IndexBuildMode::OFFLINE) {
+        auto scan_result = collect_index_entries(table_name, file_name, schema, definition, entries);
+        if (scan_result.has_value()) {
+            return scan_result;
         }
+        return load(std::move(entries));
+    }
 
-        ++page_id;
+    auto build_log = std::make_shared<IndexBuildLog>();
+    build_log->definition = definition;
+    index_builds_[table_name].push_back(build_log);
+
+    lock.unlock();
+    LOG_INFO("Scanning " + table_name + " for online build of index " + definition.name);
+    auto scan_result = collect_index_entries(table_name, file_name, schema, definition, entries);
+    lock.lock();
+
+    auto builds_it = index_builds_.find(table_name);
+    if (builds_it != index_builds_.end()) {
+        auto& builds = builds_it->second;
+        builds.erase(std::remove(builds.begin(), builds.end(), build_log), builds.end());
+        if (builds.empty()) {
+            index_builds_.erase(builds_it);
+        }
+    }
+    if (scan_result.has_value()) {
+        return scan_result;
+    }
+    if (build_log->cancelled) {
+        return "Index build was cancelled: the table was compacted or deleted while it was scanned";
     }
 
-    LOG_INFO("Index created successfully on table: " + table_name + ", column: " + column_name);
+    // Replaying the captured changes in order leaves every (key, record id)
+    // pair they touched as the last change made it, whatever the scan saw
+    auto load_result = load(std::move(entries));
+    if (load_result.has_value()) {
+        return load_result;
+    }
+    for (const auto& change : build_log->changes) {
+        auto change_result = change.insert ? index_manager_->insert_into_index(table_name, definition.name, change.key, change.record_id)
+                                           : index_manager_->remove_from_index(table_name, definition.name, change.key, change.record_id);
+        if (change_result.has_value()) {
+            return change_result;
+        }
+    }
+    LOG_INFO("Merged " + std::to_string(build_log->changes.size()) + " concurrent changes into index " + definition.name);
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::collect_index_entries(const std::string& table_name, const std::string& file_name, const std::vector<std::string>& schema,
+                                                                const IndexManager::IndexDefinition& definition,
+                                                                std::vector<std::pair<std::string, uint64_t>>& entries) const {
+    TaskScheduler& scheduler = TaskScheduler::get_instance();
+    size_t workers = scheduler.is_running() ? scheduler.get_worker_count() : 1;
+
+    // Workers claim batches of pages until one of them reads past the end
+    std::atomic<uint64_t> next_page{1};
+    std::atomic<uint64_t> end_page{UINT64_MAX};
+    std::vector<std::vector<std::pair<std::string, uint64_t>>> partitions(workers);
+    {
+        TaskGroup group(scheduler, TaskPriority::BACKGROUND);
+        for (size_t worker = 0; worker < workers; ++worker) {
+            group.run([&, worker]() {
+                FileManager read_view(data_directory_);
+                auto& partition = partitions[worker];
+                while (true) {
+                    uint64_t first_page = next_page.fetch_add(INDEX_BUILD_BATCH_PAGES, std::memory_order_relaxed);
+                    for (uint64_t page_id = first_page; page_id < first_page + INDEX_BUILD_BATCH_PAGES; ++page_id) {
+                        if (page_id >= end_page.load(std::memory_order_relaxed)) {
+                            return;
+                        }
+                        auto page = read_page_consistent(read_view, table_name, file_name, page_id);
+                        if (!page) {
+                            uint64_t end = end_page.load(std::memory_order_relaxed);
+                            while (page_id < end && !end_page.compare_exchange_weak(end, page_id, std::memory_order_relaxed)) {
+                                // end was reloaded; retry unless another worker found an earlier end
+                            }
+                            return;
+                        }
+                        for_each_record_in_page(*page, page_id, [&](uint64_t record_id, const std::vector<std::string>& record) {
+                            auto key = definition.key_for(schema, record);
+                            if (key.has_value()) {
+                                partition.emplace_back(std::move(*key), record_id);
+                            }
+                        });
+                    }
+                }
+            });
+        }
+        auto error = group.wait();
+        if (error.has_value()) {
+            return "Failed to scan table for index build: " + *error;
+        }
+    }
+
+    size_t count = 0;
+    for (const auto& partition : partitions) {
+        count += partition.size();
+    }
+    entries.reserve(count);
+    for (auto& partition : partitions) {
+        std::move(partition.begin(), partition.end(), std::back_inserter(entries));
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<Page> StorageEngine::read_page_consistent(FileManager& file_manager, const std::string& table_name, const std::string& file_name, uint64_t page_id) const {
+    std::atomic<uint64_t>& write_seq = page_write_seq_for(table_name);
+    while (true) {
+        uint64_t seq = write_seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        auto page = read_page_from(file_manager, file_name, page_id);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (write_seq.load(std::memory_order_relaxed) == seq) {
+            return page;
+        }
+    }
+}
+
+std::optional<std::string> StorageEngine::rebuild_indexes() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& [table_name, definition] : index_manager_->take_indexes_to_rebuild()) {
+        auto schema = read_schema_locked(table_name);
+        if (!schema.has_value()) {
+            LOG_WARNING("Dropping index " + definition.name + " of missing table " + table_name);
+            index_manager_->drop_index(table_name, definition.name);
+            continue;
+        }
+        auto result = build_index(lock, table_name, *schema, definition, IndexBuildMode::OFFLINE, [&](std::vector<std::pair<std::string, uint64_t>> entries) {
+            return index_manager_->reload_index(table_name, definition.name, std::move(entries));
+        });
+        if (result.has_value()) {
+            return "Failed to rebuild index " + definition.name + " on " + table_name + ": " + *result;
+        }
+        LOG_INFO("Rebuilt index " + definition.name + " on " + table_name);
+    }
     return std::nullopt;
 }
 
+void StorageEngine::log_index_build_change(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, bool insert) {
+    auto builds_it = index_builds_.find(table_name);
+    if (builds_it == index_builds_.end()) {
+        return;
+    }
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return;
+    }
+    for (const auto& build : builds_it->second) {
+        auto key = build->definition.key_for(*schema, record);
+        if (key.has_value()) {
+            build->changes.push_back(IndexBuildLog::Change{insert, std::move(*key), record_id});
+        }
+    }
+}
+
+void StorageEngine::cancel_index_builds(const std::string& table_name) {
+    auto builds_it = index_builds_.find(table_name);
+    if (builds_it == index_builds_.end()) {
+        return;
+    }
+    for (const auto& build : builds_it->second) {
+        build->cancelled = true;
+    }
+}
+
 std::optional<std::string> StorageEngine::drop_index(const std::string& table_name, const std::string& column_name) {
     std::lock_guard<std::mutex> lock(mutex_);
     LOG_INFO("Dropping index on table: " + table_name + ", column: " + column_name);
@@ -423,20 +974,494 @@ std::optional<std::vector<uint64_t>> StorageEngine::search_index(const std::stri
     return index_manager_->search_index(table_name, column_name, value);
 }
 
-std::optional<std::string> StorageEngine::begin_transaction() {
-    return recovery_manager_->begin_transaction(0);  // Using 0 as a placeholder for transaction ID
-}
-
-std::optional<std::string> StorageEngine::commit_transaction() {
-    return recovery_manager_->commit_transaction(0);  // Using 0 as a placeholder for transaction ID
+std::optional<std::vector<PostingList>> StorageEngine::search_index_batch(const std::string& table_name, const std::string& column_name,
+                                                                          const std::vector<std::string>& values) const {
+    return index_manager_->search_index_batch(table_name, column_name, values);
 }
 
-std::optional<std::string> StorageEngine::abort_transaction() {
-    return recovery_manager_->abort_transaction(0);  // Using 0 as a placeholder for transaction ID
+std::optional<std::vector<IndexManager::IndexRow>> StorageEngine::scan_covering_index(const std::string& table_name, const std::string& index_name,
+                                                                                     const std::vector<std::string>& leading_values,
+                                                                                     const std::optional<std::string>& lower,
+                                                                                     const std::optional<std::string>& upper,
+                                                                                     bool lower_inclusive, bool upper_inclusive) const {
+    return index_manager_->scan_covering_index(table_name, index_name, leading_values, lower, upper, lower_inclusive, upper_inclusive);
 }
 
-std::optional<std::string> StorageEngine::recover() {
+std::optional<std::string> StorageEngine::create_bloom_filter(const std::string& table_name, const std::string& column_name) {
     std::lock_guard<std::mutex> lock(mutex_);
+    LOG_INFO("Creating Bloom filter on table: " + table_name + ", column: " + column_name);
+
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return "Table doesn't exist or schema not found";
+    }
+
+    size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
+    if (column_index == schema->size()) {
+        return "Column not found in table schema";
+    }
+
+    // A filter whose file was lost is rebuilt in place
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it != bloom_filters_.end()) {
+        auto entry_it = filters_it->second.find(column_name);
+        if (entry_it != filters_it->second.end() && entry_it->second.filter.has_value()) {
+            return "Bloom filter already exists for this table and column";
+        }
+    }
+
+    BloomFilterEntry entry;
+    entry.filter.emplace();
+    uint64_t page_id = 1;
+    while (true) {
+        auto page = read_page(table_name, page_id);
+        if (!page) {
+            break;
+        }
+        for_each_record_in_page(*page, page_id, [&](uint64_t, const std::vector<std::string>& record) {
+            if (column_index < record.size()) {
+                entry.filter->add(page_id, record[column_index]);
+            }
+        });
+        ++page_id;
+    }
+
+    auto save_result = save_bloom_filter(table_name, column_name, entry);
+    if (save_result.has_value()) {
+        return save_result;
+    }
+    bloom_filters_[table_name][column_name] = std::move(entry);
+    auto catalog_result = save_bloom_catalog();
+    if (catalog_result.has_value()) {
+        return catalog_result;
+    }
+
+    LOG_INFO("Bloom filter created successfully on table: " + table_name + ", column: " + column_name);
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::drop_bloom_filter(const std::string& table_name, const std::string& column_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it == bloom_filters_.end() || filters_it->second.erase(column_name) == 0) {
+        return "Bloom filter does not exist for this table and column";
+    }
+    if (filters_it->second.empty()) {
+        bloom_filters_.erase(filters_it);
+    }
+    std::remove(get_bloom_file_path(table_name, column_name).c_str());
+    return save_bloom_catalog();
+}
+
+bool StorageEngine::might_contain(const std::string& table_name, const std::string& column_name, const std::string& value) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it == bloom_filters_.end()) {
+        return true;
+    }
+    auto entry_it = filters_it->second.find(column_name);
+    if (entry_it == filters_it->second.end() || !entry_it->second.filter.has_value()) {
+        return true;
+    }
+    return entry_it->second.filter->might_contain(value);
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::find_records(const std::string& table_name, const std::string& column_name,
+                                                                                                     const std::string& value) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return std::nullopt;
+    }
+    size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
+    if (column_index == schema->size()) {
+        return std::nullopt;
+    }
+
+    const ColumnBloomFilter* filter = nullptr;
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it != bloom_filters_.end()) {
+        auto entry_it = filters_it->second.find(column_name);
+        if (entry_it != filters_it->second.end() && entry_it->second.filter.has_value()) {
+            filter = &*entry_it->second.filter;
+        }
+    }
+
+    std::vector<std::pair<uint64_t, std::vector<std::string>>> records;
+    if (filter != nullptr && !filter->might_contain(value)) {
+        return records;
+    }
+
+    uint64_t page_id = 1;
+    while (true) {
+        if (filter != nullptr) {
+            uint64_t group = ColumnBloomFilter::group_of(page_id);
+            if (group >= filter->group_count()) {
+                break;  // No record past here has the column
+            }
+            if (!filter->group_might_contain(page_id, value)) {
+                page_id = (group + 1) * ColumnBloomFilter::PAGES_PER_GROUP + 1;
+                continue;
+            }
+        }
+
+        auto page = read_page(table_name, page_id);
+        if (!page) {
+            break;
+        }
+        for_each_record_in_page(*page, page_id, [&](uint64_t record_id, const std::vector<std::string>& record) {
+            if (column_index < record.size() && record[column_index] == value) {
+                records.emplace_back(record_id, record);
+            }
+        });
+        ++page_id;
+    }
+    return records;
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::select_records(const std::string& table_name,
+                                                                                                       const std::vector<IndexManager::BitmapCondition>& conditions) const {
+    auto matches = index_manager_->search_bitmaps(table_name, conditions);
+    if (!matches.has_value()) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_records_locked(table_name, matches->to_vector());
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::match_records(const std::string& table_name, const std::string& column_name,
+                                                                                                      const std::string& query) const {
+    auto matches = index_manager_->search_full_text(table_name, column_name, query);
+    if (!matches.has_value()) {
+        return scan_table(table_name, {ColumnPredicate{column_name, PredicateOp::MATCH, query}});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_records_locked(table_name, *matches);
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::nearest_records(const std::string& table_name, const std::string& column_name,
+                                                                                                        const std::vector<float>& query, size_t k) const {
+    auto nearest = index_manager_->search_nearest(table_name, column_name, query, k);
+    if (!nearest.has_value()) {
+        return std::nullopt;
+    }
+
+    std::vector<uint64_t> record_ids;
+    record_ids.reserve(nearest->size());
+    for (const auto& [record_id, distance] : *nearest) {
+        record_ids.push_back(record_id);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_records_locked(table_name, record_ids);
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::spatial_records(const std::string& table_name,
+                                                                                                        const ColumnPredicate& predicate) const {
+    std::optional<std::vector<uint64_t>> matches;
+    if (predicate.op == PredicateOp::INTERSECTS) {
+        auto box = parse_geometry(predicate.value);
+        if (box.has_value()) {
+            matches = index_manager_->search_box(table_name, predicate.column, *box);
+        }
+    } else if (predicate.op == PredicateOp::DWITHIN) {
+        auto query = parse_distance_query(predicate.value);
+        if (query.has_value()) {
+            matches = index_manager_->search_radius(table_name, predicate.column, query->first, query->second);
+        }
+    }
+    if (!matches.has_value()) {
+        return scan_table(table_name, {predicate});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_records_locked(table_name, *matches);
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::nearest_geometries(const std::string& table_name, const std::string& column_name,
+                                                                                                           const Point& point, size_t k) const {
+    auto nearest = index_manager_->search_nearest_geometries(table_name, column_name, point, k);
+    if (!nearest.has_value()) {
+        return std::nullopt;
+    }
+
+    std::vector<uint64_t> record_ids;
+    record_ids.reserve(nearest->size());
+    for (const auto& [record_id, distance] : *nearest) {
+        record_ids.push_back(record_id);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_records_locked(table_name, record_ids);
+}
+
+std::vector<std::pair<uint64_t, std::vector<std::string>>> StorageEngine::read_records_locked(const std::string& table_name,
+                                                                                             const std::vector<uint64_t>& record_ids) const {
+    std::vector<std::pair<uint64_t, std::vector<std::string>>> records;
+    std::unique_ptr<Page> page;
+    uint64_t current_page_id = 0;
+    for (uint64_t record_id : record_ids) {
+        uint64_t page_id = record_id / (Page::PAGE_SIZE / sizeof(uint64_t)) + 1;
+        if (page_id != current_page_id) {
+            page = read_page(table_name, page_id);
+            current_page_id = page_id;
+        }
+        if (!page) {
+            continue;
+        }
+        std::vector<char> record_data = page->get_record(record_id % (Page::PAGE_SIZE / sizeof(uint64_t)));
+        if (record_data.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> record;
+        std::istringstream record_stream(std::string(record_data.begin(), record_data.end()));
+        std::string field;
+        while (std::getline(record_stream, field)) {
+            record.push_back(field);
+        }
+        records.emplace_back(record_id, std::move(record));
+    }
+    return records;
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::scan_table(const std::string& table_name,
+                                                                                                   const std::vector<ColumnPredicate>& predicates) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<size_t, ColumnPredicate>> resolved;
+    for (const auto& predicate : predicates) {
+        size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), predicate.column));
+        if (column_index == schema->size()) {
+            return std::nullopt;
+        }
+        resolved.emplace_back(column_index, predicate);
+    }
+
+    auto zone_map_it = zone_maps_.find(table_name);
+    const ZoneMap* zone_map = zone_map_it != zone_maps_.end() ? &zone_map_it->second : nullptr;
+
+    std::vector<std::pair<uint64_t, std::vector<std::string>>> records;
+    for (uint64_t page_id = 1;; ++page_id) {
+        if (zone_map != nullptr && !resolved.empty() && !zone_map->page_may_match(page_id, resolved)) {
+            continue;
+        }
+        // Past the zone map, pages are read until the table ends
+        auto page = read_page(table_name, page_id);
+        if (!page) {
+            if (zone_map != nullptr && page_id <= zone_map->page_count()) {
+                continue;
+            }
+            break;
+        }
+        for_each_record_in_page(*page, page_id, [&](uint64_t record_id, const std::vector<std::string>& record) {
+            for (const auto& [column_index, predicate] : resolved) {
+                const std::string& field = column_index < record.size() ? record[column_index] : std::string();
+                if (!predicate_holds(field, predicate.op, predicate.value)) {
+                    return;
+                }
+            }
+            records.emplace_back(record_id, record);
+        });
+    }
+    return records;
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::scan_table(const std::shared_ptr<Transaction>& txn, const std::string& table_name,
+                                                                                                   const std::vector<ColumnPredicate>& predicates) const {
+    if (check_transaction(txn).has_value()) {
+        return std::nullopt;
+    }
+    if (!txn->is_read_only()) {
+        return scan_table(table_name, predicates);
+    }
+    return scan_table_snapshot(*txn, table_name, predicates);
+}
+
+std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::find_records(const std::shared_ptr<Transaction>& txn, const std::string& table_name,
+                                                                                                     const std::string& column_name, const std::string& value) const {
+    if (check_transaction(txn).has_value()) {
+        return std::nullopt;
+    }
+    if (!txn->is_read_only()) {
+        return find_records(table_name, column_name, value);
+    }
+    return scan_table_snapshot(*txn, table_name, {ColumnPredicate{column_name, PredicateOp::EQUAL, value}});
+}
+
+std::optional<std::vector<uint64_t>> StorageEngine::search_index(const std::shared_ptr<Transaction>& txn, const std::string& table_name, const std::string& column_name,
+                                                                 const std::string& value) const {
+    if (check_transaction(txn).has_value()) {
+        return std::nullopt;
+    }
+    if (!txn->is_read_only()) {
+        return search_index(table_name, column_name, value);
+    }
+
+    auto tables = std::atomic_load(&table_snapshot_);
+    auto it = tables->find(table_name);
+    if (it == tables->end()) {
+        return std::nullopt;
+    }
+    auto schema = read_schema_snapshot(*txn, table_name, it->second);
+    if (!schema.has_value()) {
+        return std::nullopt;
+    }
+    size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
+    if (column_index == schema->size()) {
+        return std::nullopt;
+    }
+
+    // The index holds current keys. A record whose key changed since the
+    // snapshot was versioned before its index entry moved, so collecting
+    // the changes after the lookup finds every record it missed.
+    auto current = index_manager_->search_index(table_name, column_name, value);
+    if (!current.has_value()) {
+        return std::nullopt;
+    }
+    auto changed = version_store_->changed_records(table_name, txn->get_snapshot_timestamp());
+
+    std::set<uint64_t> record_ids;
+    for (uint64_t record_id : *current) {
+        if (changed.count(record_id) == 0) {
+            record_ids.insert(record_id);
+        }
+    }
+    for (const auto& [record_id, before_image] : changed) {
+        if (!before_image.has_value()) {
+            continue;
+        }
+        std::istringstream record_stream(*before_image);
+        std::string field;
+        for (size_t i = 0; i <= column_index && std::getline(record_stream, field); ++i) {
+            if (i == column_index && field == value) {
+                record_ids.insert(record_id);
+            }
+        }
+    }
+    return std::vector<uint64_t>(record_ids.begin(), record_ids.end());
+}
+
+std::optional<std::string> StorageEngine::begin_transaction(std::shared_ptr<Transaction>& txn) {
+    auto txn_id = transaction_manager_->begin_transaction();
+    if (!txn_id.has_value()) {
+        return "Failed to start transaction";
+    }
+
+    auto log_result = recovery_manager_->begin_transaction(*txn_id);
+    if (log_result.has_value()) {
+        transaction_manager_->abort_transaction(*txn_id);
+        return log_result;
+    }
+
+    txn = std::make_shared<Transaction>(*txn_id);
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::begin_read_only(std::shared_ptr<Transaction>& txn) {
+    uint64_t snapshot_ts;
+    size_t slot;
+    auto snapshot_result = version_store_->acquire_snapshot(snapshot_ts, slot);
+    if (snapshot_result.has_value()) {
+        return snapshot_result;
+    }
+
+    std::shared_ptr<VersionStore> version_store = version_store_;
+    std::shared_ptr<void> registration(nullptr, [version_store, slot](void*) {
+        version_store->release_snapshot(slot);
+    });
+
+    try {
+        // A private set of file handles, so reads never share stream state with writers
+        auto read_view = std::make_shared<FileManager>(data_directory_);
+        txn = std::make_shared<Transaction>(snapshot_ts, std::move(read_view), std::move(registration));
+    } catch (const std::exception& e) {
+        return "Failed to open read view: " + std::string(e.what());
+    }
+
+    LOG_DEBUG("Read-only transaction started at snapshot " + std::to_string(snapshot_ts));
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::commit_transaction(const std::shared_ptr<Transaction>& txn) {
+    auto txn_result = check_transaction(txn);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
+    if (txn->is_read_only()) {
+        txn->set_state(TransactionState::COMMITTED);
+        return std::nullopt;
+    }
+
+    auto log_result = recovery_manager_->commit_transaction(txn->get_id());
+    if (log_result.has_value()) {
+        LOG_ERROR("Failed to commit transaction " + std::to_string(txn->get_id()) + ": " + log_result.value());
+        return log_result;
+    }
+
+    // The COMMIT record is forced, so the transaction's pages may now be
+    // written. One that fails stays in memory; the log restores it after a crash.
+    std::optional<std::string> write_result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_result = release_transaction_pages(txn->get_id());
+    }
+    if (write_result.has_value()) {
+        LOG_ERROR("Failed to write pages of committed transaction " + std::to_string(txn->get_id()) + ": " + write_result.value());
+    }
+    // Dirty index pages are only written by flushes, so flush once they outgrow the pool
+    if (index_manager_->needs_flush()) {
+        auto flush_result = index_manager_->flush_indexes();
+        if (flush_result.has_value()) {
+            LOG_ERROR("Failed to flush indexes: " + flush_result.value());
+        }
+    }
+
+    version_store_->finish_transaction(txn->get_id());
+    txn->set_state(TransactionState::COMMITTED);
+    return transaction_manager_->commit_transaction(txn->get_id());
+}
+
+std::optional<std::string> StorageEngine::abort_transaction(const std::shared_ptr<Transaction>& txn) {
+    auto txn_result = check_transaction(txn);
+    if (txn_result.has_value()) {
+        return txn_result;
+    }
+    if (txn->is_read_only()) {
+        txn->set_state(TransactionState::ABORTED);
+        return std::nullopt;
+    }
+
+    // Roll back this transaction's changes, newest first
+    auto records = recovery_manager_->get_transaction_records(txn->get_id());
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        auto undo_result = replay_log_record(*it, true);
+        if (undo_result.has_value()) {
+            LOG_ERROR("Failed to undo change of transaction " + std::to_string(txn->get_id()) + ": " + undo_result.value());
+        }
+    }
+
+    auto log_result = recovery_manager_->abort_transaction(txn->get_id());
+    std::optional<std::string> write_result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_result = release_transaction_pages(txn->get_id());
+    }
+    if (write_result.has_value()) {
+        LOG_ERROR("Failed to write pages of aborted transaction " + std::to_string(txn->get_id()) + ": " + write_result.value());
+    }
+    version_store_->finish_transaction(txn->get_id());
+    txn->set_state(TransactionState::ABORTED);
+    transaction_manager_->abort_transaction(txn->get_id());
+    return log_result;
+}
+
+std::optional<std::string> StorageEngine::recover() {
+    // Not holding mutex_ here: replaying log records takes it per change
     LOG_INFO("Starting recovery process...");
 
     auto result = recovery_manager_->recover();
@@ -445,10 +1470,203 @@ std::optional<std::string> StorageEngine::recover() {
         return result;
     }
 
+    // The log may only go once the pages and index entries it restored are
+    // on stable storage
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [table_name, file_name] : table_files_) {
+            if (!file_manager_->sync_file(file_name)) {
+                return "Failed to sync table " + table_name + " after recovery";
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rebuild_zone_maps();
+    }
+    result = index_manager_->flush_indexes();
+    if (result.has_value()) {
+        LOG_ERROR("Failed to flush indexes after recovery: " + result.value());
+        return result;
+    }
+    result = recovery_manager_->truncate_log();
+    if (result.has_value()) {
+        LOG_ERROR("Failed to truncate log after recovery: " + result.value());
+        return result;
+    }
+
+    result = rebuild_indexes();
+    if (result.has_value()) {
+        LOG_ERROR("Failed to rebuild indexes after recovery: " + result.value());
+        return result;
+    }
+
     LOG_INFO("Recovery process completed successfully");
     return std::nullopt;
 }
 
+std::optional<std::string> StorageEngine::replay_log_record(const LogRecord& record, bool undo) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (table_files_.find(record.table_name) == table_files_.end()) {
+        LOG_DEBUG("Table " + record.table_name + " was dropped since; not replaying its change");
+        return std::nullopt;
+    }
+    std::optional<std::string> before;
+    std::optional<std::string> after;
+    switch (record.type) {
+        case LogRecordType::INSERT:
+        case LogRecordType::UPDATE:
+        case LogRecordType::DELETE:
+            if (record.type != LogRecordType::INSERT) {
+                before = record.before_image;
+            }
+            if (record.type != LogRecordType::DELETE) {
+                after = record.after_image;
+            }
+            if (!undo) {
+                return restore_record_locked(record.table_name, record.record_id, before, after);
+            }
+            {
+                auto restore_result = restore_record_locked(record.table_name, record.record_id, after, before);
+                if (restore_result.has_value()) {
+                    return restore_result;
+                }
+                return reindex_record_locked(record.table_name, record.record_id, after, before);
+            }
+        case LogRecordType::INDEX_INSERT:
+        case LogRecordType::INDEX_DELETE:
+            // Changes to an index dropped since then have nothing to apply to,
+            // and an index awaiting its rebuild gets them from the table
+            if (!index_manager_->has_index(record.table_name, record.before_image) ||
+                index_manager_->awaits_rebuild(record.table_name, record.before_image)) {
+                return std::nullopt;
+            }
+            if ((record.type == LogRecordType::INDEX_INSERT) != undo) {
+                return index_manager_->insert_into_index(record.table_name, record.before_image, record.after_image, record.record_id);
+            }
+            return index_manager_->remove_from_index(record.table_name, record.before_image, record.after_image, record.record_id);
+        default:
+            // BEGIN, COMMIT, and ABORT don't require direct action on the storage engine
+            return std::nullopt;
+    }
+}
+
+std::optional<std::string> StorageEngine::restore_record_locked(const std::string& table_name, uint64_t record_id,
+                                                                const std::optional<std::string>& expected,
+                                                                const std::optional<std::string>& image) {
+    if (table_files_.find(table_name) == table_files_.end()) {
+        return "Table doesn't exist";
+    }
+
+    uint64_t page_id = record_id / (Page::PAGE_SIZE / sizeof(uint64_t)) + 1;
+    uint64_t offset = record_id % (Page::PAGE_SIZE / sizeof(uint64_t));
+
+    auto page = read_page(table_name, page_id);
+    std::optional<std::string> current;
+    if (page) {
+        std::vector<char> record_data = page->get_record(offset);
+        if (!record_data.empty()) {
+            current = std::string(record_data.begin(), record_data.end());
+        }
+    }
+    if (current == image) {
+        return std::nullopt;  // Already applied
+    }
+    if (current != expected) {
+        LOG_DEBUG("Record " + std::to_string(record_id) + " in table " + table_name + " has changed since; not restoring it");
+        return std::nullopt;
+    }
+
+    // A page allocated before the crash may not have reached the file
+    while (!page) {
+        auto allocated = allocate_page(table_name);
+        if (!allocated || allocated->get_page_id() > page_id) {
+            return "Failed to allocate page " + std::to_string(page_id) + " of table " + table_name;
+        }
+        if (allocated->get_page_id() == page_id) {
+            page = std::move(allocated);
+        }
+    }
+
+    bool restored = image.has_value() ? page->put_record(offset, std::vector<char>(image->begin(), image->end()))
+                                      : page->delete_record(offset);
+    if (!restored) {
+        return "Failed to restore record " + std::to_string(record_id) + " in table " + table_name;
+    }
+    if (config_.use_compression) {
+        page->compress();
+    }
+    auto write_result = write_page(table_name, *page);
+    if (write_result.has_value()) {
+        return write_result;
+    }
+
+    if (image.has_value()) {
+        std::vector<std::string> record;
+        std::istringstream record_stream(*image);
+        std::string field;
+        while (std::getline(record_stream, field)) {
+            record.push_back(field);
+        }
+        update_bloom_filters(table_name, record, page_id);
+        update_zone_map(table_name, record, page_id);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::reindex_record_locked(const std::string& table_name, uint64_t record_id,
+                                                                const std::optional<std::string>& from, const std::optional<std::string>& to) {
+    auto fields_of = [](const std::optional<std::string>& image) {
+        std::vector<std::string> record;
+        if (image.has_value()) {
+            std::istringstream record_stream(*image);
+            std::string field;
+            while (std::getline(record_stream, field)) {
+                record.push_back(field);
+            }
+        }
+        return record;
+    };
+    std::vector<std::string> from_record = fields_of(from);
+    std::vector<std::string> to_record = fields_of(to);
+    if (from.has_value()) {
+        log_index_build_change(table_name, from_record, record_id, false);
+    }
+    if (to.has_value()) {
+        log_index_build_change(table_name, to_record, record_id, true);
+    }
+
+    const auto* indexes = resolve_table_indexes(table_name);
+    if (indexes == nullptr) {
+        return "Table schema not found";
+    }
+    for (const auto& index : *indexes) {
+        // An index awaiting its rebuild gets its entries from the table
+        if (index_manager_->awaits_rebuild(table_name, index.definition.name)) {
+            continue;
+        }
+        if (from.has_value()) {
+            auto key = index.definition.key_at(index.positions, from_record);
+            if (key.has_value()) {
+                auto index_result = index_manager_->remove_from_index(index.id, *key, record_id);
+                if (index_result.has_value()) {
+                    return index_result;
+                }
+            }
+        }
+        if (to.has_value()) {
+            auto key = index.definition.key_at(index.positions, to_record);
+            if (key.has_value()) {
+                auto index_result = index_manager_->insert_into_index(index.id, *key, record_id);
+                if (index_result.has_value()) {
+                    return index_result;
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
 void StorageEngine::enable_encryption(const EncryptionKey& key) {
     std::lock_guard<std::mutex> lock(mutex_);
     encryptor_ = std::make_unique<Encryptor>(key);
@@ -493,25 +1711,118 @@ std::unique_ptr<Page> StorageEngine::allocate_page(const std::string& table_name
     return file_manager_->allocate_page(it->second);
 }
 
-std::optional<std::string> StorageEngine::write_page(const std::string& table_name, const Page& page) {
+std::optional<std::string> StorageEngine::write_page(const std::string& table_name, const Page& page, std::optional<transaction_id_t> txn_id) {
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
         return "Table doesn't exist";
     }
 
-    std::vector<unsigned char> page_data(page.get_data(), page.get_data() + Page::PAGE_SIZE);
+    {
+        std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+        auto file_it = dirty_pages_.find(it->second);
+        bool held = file_it != dirty_pages_.end() && file_it->second.count(page.get_page_id()) != 0;
+        if (held || txn_id.has_value()) {
+            std::atomic<uint64_t>& write_seq = page_write_seq_for(table_name);
+            write_seq.fetch_add(1, std::memory_order_acq_rel);
+            DirtyPage& dirty = dirty_pages_[it->second][page.get_page_id()];
+            dirty.data.assign(page.get_data(), page.get_data() + Page::PAGE_SIZE);
+            if (txn_id.has_value() && dirty.writers.insert(*txn_id).second) {
+                transaction_pages_[*txn_id].emplace_back(table_name, page.get_page_id());
+            }
+            write_seq.fetch_add(1, std::memory_order_release);
+            return std::nullopt;
+        }
+    }
+
+    return write_page_to_file(table_name, it->second, page.get_page_id(), page.get_data());
+}
+
+std::optional<std::string> StorageEngine::write_page_to_file(const std::string& table_name, const std::string& file_name, uint64_t page_id, const char* data) {
+    std::vector<unsigned char> page_data(data, data + Page::PAGE_SIZE);
     
     if (config_.use_encryption) {
         page_data = encrypt_page(page_data);
     }
 
-    if (!file_manager_->write_page(it->second, Page(page.get_page_id(), page_data.data()))) {
+    std::atomic<uint64_t>& write_seq = page_write_seq_for(table_name);
+    write_seq.fetch_add(1, std::memory_order_acq_rel);
+    bool written = file_manager_->write_page(file_name, Page(page_id, reinterpret_cast<const char*>(page_data.data())));
+    write_seq.fetch_add(1, std::memory_order_release);
+    if (!written) {
         return "Failed to write page";
     }
 
     return std::nullopt;
 }
 
+std::optional<std::string> StorageEngine::release_transaction_pages(transaction_id_t txn_id) {
+    std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+    auto txn_it = transaction_pages_.find(txn_id);
+    if (txn_it == transaction_pages_.end()) {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> result;
+    for (const auto& [table_name, page_id] : txn_it->second) {
+        auto table_it = table_files_.find(table_name);
+        if (table_it == table_files_.end()) {
+            continue;  // Dropped with its pages
+        }
+        auto file_it = dirty_pages_.find(table_it->second);
+        if (file_it == dirty_pages_.end()) {
+            continue;
+        }
+        auto page_it = file_it->second.find(page_id);
+        if (page_it == file_it->second.end()) {
+            continue;
+        }
+        page_it->second.writers.erase(txn_id);
+        if (!page_it->second.writers.empty()) {
+            continue;  // Still holds another transaction's change
+        }
+        // Written before it leaves the map, so readers never see the file behind
+        auto write_result = write_page_to_file(table_name, table_it->second, page_id, page_it->second.data.data());
+        if (write_result.has_value()) {
+            result = write_result;
+            continue;
+        }
+        file_it->second.erase(page_it);
+        if (file_it->second.empty()) {
+            dirty_pages_.erase(file_it);
+        }
+    }
+    transaction_pages_.erase(txn_it);
+    return result;
+}
+
+std::optional<std::string> StorageEngine::write_released_pages() {
+    std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+    std::optional<std::string> result;
+    for (const auto& [table_name, file_name] : table_files_) {
+        auto file_it = dirty_pages_.find(file_name);
+        if (file_it == dirty_pages_.end()) {
+            continue;
+        }
+        for (auto page_it = file_it->second.begin(); page_it != file_it->second.end();) {
+            if (!page_it->second.writers.empty()) {
+                ++page_it;
+                continue;
+            }
+            auto write_result = write_page_to_file(table_name, file_name, page_it->first, page_it->second.data.data());
+            if (write_result.has_value()) {
+                result = write_result;
+                ++page_it;
+                continue;
+            }
+            page_it = file_it->second.erase(page_it);
+        }
+        if (file_it->second.empty()) {
+            dirty_pages_.erase(file_it);
+        }
+    }
+    return result;
+}
+
 std::unique_ptr<Page> StorageEngine::read_page(const std::string& table_name, uint64_t page_id) const {
     auto it = table_files_.find(table_name);
     if (it == table_files_.end()) {
@@ -519,7 +1830,27 @@ std::unique_ptr<Page> StorageEngine::read_page(const std::string& table_name, ui
         return nullptr;
     }
 
-    auto page = file_manager_->read_page(it->second, page_id);
+    return read_page_from(*file_manager_, it->second, page_id);
+}
+
+std::unique_ptr<Page> StorageEngine::read_page_from(FileManager& file_manager, const std::string& file_name, uint64_t page_id) const {
+    {
+        // A page an unfinished transaction changed is newer than the file
+        std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+        auto file_it = dirty_pages_.find(file_name);
+        if (file_it != dirty_pages_.end()) {
+            auto page_it = file_it->second.find(page_id);
+            if (page_it != file_it->second.end()) {
+                auto page = std::make_unique<Page>(page_id, page_it->second.data.data());
+                if (config_.use_compression) {
+                    page->decompress();
+                }
+                return page;
+            }
+        }
+    }
+
+    auto page = file_manager.read_page(file_name, page_id);
     if (!page) {
         return nullptr;
     }
@@ -535,16 +1866,134 @@ std::unique_ptr<Page> StorageEngine::read_page(const std::string& table_name, ui
     return page;
 }
 
-void StorageEngine::update_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id) {
-    for (size_t i = 0; i < record.size(); ++i) {
-        index_manager_->insert_into_index(table_name, std::to_string(i), record[i], record_id);
+std::optional<std::string> StorageEngine::check_transaction(const std::shared_ptr<Transaction>& txn, bool for_write) const {
+    if (!txn) {
+        return "Invalid transaction";
+    }
+    if (!txn->is_active()) {
+        return "Transaction " + std::to_string(txn->get_id()) + " is not active";
+    }
+    if (for_write && txn->is_read_only()) {
+        return "Cannot write in a read-only transaction";
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::run_autocommit(const std::function<std::optional<std::string>(const std::shared_ptr<Transaction>&)>& operation) {
+    std::shared_ptr<Transaction> txn;
+    auto begin_result = begin_transaction(txn);
+    if (begin_result.has_value()) {
+        return begin_result;
+    }
+
+    auto result = operation(txn);
+    if (result.has_value()) {
+        abort_transaction(txn);
+        return result;
+    }
+    return commit_transaction(txn);
+}
+
+std::atomic<uint64_t>& StorageEngine::page_write_seq_for(const std::string& table_name) const {
+    return page_write_seq_[std::hash<std::string>()(table_name) % PAGE_WRITE_STRIPES];
+}
+
+// Called with mutex_ held whenever table_files_ changes
+void StorageEngine::publish_table_snapshot() {
+    std::atomic_store(&table_snapshot_, std::shared_ptr<const std::unordered_map<std::string, std::string>>(
+        std::make_shared<std::unordered_map<std::string, std::string>>(table_files_)));
+}
+
+const std::vector<StorageEngine::ResolvedIndex>* StorageEngine::resolve_table_indexes(const std::string& table_name) {
+    TableIndexes& cached = table_indexes_[table_name];
+    if (cached.catalog_version == index_manager_->catalog_version()) {
+        return &cached.indexes;
+    }
+
+    uint64_t catalog_version = 0;
+    auto handles = index_manager_->get_table_index_handles(table_name, catalog_version);
+    std::vector<ResolvedIndex> indexes;
+    if (!handles.empty()) {
+        auto schema = read_schema_locked(table_name);
+        if (!schema.has_value()) {
+            return nullptr;
+        }
+        for (auto& handle : handles) {
+            std::vector<size_t> positions = handle.definition.column_positions(*schema);
+            indexes.push_back(ResolvedIndex{handle.id, std::move(handle.definition), std::move(positions)});
+        }
+    }
+    cached.catalog_version = catalog_version;
+    cached.indexes = std::move(indexes);
+    return &cached.indexes;
+}
+
+std::optional<std::string> StorageEngine::update_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, std::optional<transaction_id_t> txn_id) {
+    log_index_build_change(table_name, record, record_id, true);
+    const auto* indexes = resolve_table_indexes(table_name);
+    if (indexes == nullptr) {
+        return "Table schema not found";
     }
+
+    for (const auto& index : *indexes) {
+        auto key = index.definition.key_at(index.positions, record);
+        if (!key.has_value()) {
+            continue;
+        }
+        if (txn_id.has_value()) {
+            LogRecord log_record{
+                LogRecordType::INDEX_INSERT,
+                *txn_id,
+                table_name,
+                record_id,
+                index.definition.name, // before_image holds the index name
+                *key // after_image holds the key
+            };
+            auto log_result = recovery_manager_->log_operation(log_record);
+            if (log_result.has_value()) {
+                return log_result;
+            }
+        }
+        auto index_result = index_manager_->insert_into_index(index.id, *key, record_id);
+        if (index_result.has_value()) {
+            return index_result;
+        }
+    }
+    return std::nullopt;
 }
 
-void StorageEngine::remove_from_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id) {
-    for (size_t i = 0; i < record.size(); ++i) {
-        index_manager_->remove_from_index(table_name, std::to_string(i), record[i], record_id);
+std::optional<std::string> StorageEngine::remove_from_indexes(const std::string& table_name, const std::vector<std::string>& record, uint64_t record_id, std::optional<transaction_id_t> txn_id) {
+    log_index_build_change(table_name, record, record_id, false);
+    const auto* indexes = resolve_table_indexes(table_name);
+    if (indexes == nullptr) {
+        return "Table schema not found";
+    }
+
+    for (const auto& index : *indexes) {
+        auto key = index.definition.key_at(index.positions, record);
+        if (!key.has_value()) {
+            continue;
+        }
+        if (txn_id.has_value()) {
+            LogRecord log_record{
+                LogRecordType::INDEX_DELETE,
+                *txn_id,
+                table_name,
+                record_id,
+                index.definition.name, // before_image holds the index name
+                *key // after_image holds the key
+            };
+            auto log_result = recovery_manager_->log_operation(log_record);
+            if (log_result.has_value()) {
+                return log_result;
+            }
+        }
+        auto index_result = index_manager_->remove_from_index(index.id, *key, record_id);
+        if (index_result.has_value()) {
+            return index_result;
+        }
     }
+    return std::nullopt;
 }
 
 std::vector<unsigned char> StorageEngine::encrypt_page(const std::vector<unsigned char>& page_data) const {
@@ -579,6 +2028,165 @@ uint64_t StorageEngine::get_page_count(const std::string& table_name) const {
     return file_manager_->get_page_count(file_name);
 }
 
+std::optional<std::string> StorageEngine::load_table_catalog() {
+    std::ifstream catalog(data_directory_ + "/" + TABLE_CATALOG_FILE_NAME);
+    if (!catalog.is_open()) {
+        return std::nullopt;  // No tables yet
+    }
+
+    std::string table_name;
+    while (std::getline(catalog, table_name)) {
+        if (table_name.empty()) {
+            continue;
+        }
+        std::string file_name = get_table_file_name(table_name);
+        if (!file_manager_->open_file(file_name)) {
+            return "Failed to open file of table " + table_name;
+        }
+        table_files_[table_name] = file_name;
+    }
+    LOG_INFO("Reopened " + std::to_string(table_files_.size()) + " tables");
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::save_table_catalog() const {
+    std::string contents;
+    for (const auto& [table_name, file_name] : table_files_) {
+        contents += table_name + "\n";
+    }
+    if (!FileManager::write_file_durably(data_directory_ + "/" + TABLE_CATALOG_FILE_NAME, contents)) {
+        return "Failed to write table catalog";
+    }
+    return std::nullopt;
+}
+
+std::string StorageEngine::get_bloom_file_path(const std::string& table_name, const std::string& column_name) const {
+    return data_directory_ + "/" + table_name + "." + column_name + ".bloom";
+}
+
+std::optional<std::string> StorageEngine::load_bloom_filters() {
+    std::ifstream catalog(data_directory_ + "/" + BLOOM_CATALOG_FILE_NAME);
+    if (!catalog.is_open()) {
+        return std::nullopt;  // No filters yet
+    }
+
+    std::string line;
+    while (std::getline(catalog, line)) {
+        size_t separator = line.find('\t');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        std::string table_name = line.substr(0, separator);
+        std::string column_name = line.substr(separator + 1);
+
+        BloomFilterEntry entry;
+        std::ifstream file(get_bloom_file_path(table_name, column_name), std::ios::binary);
+        if (file.is_open()) {
+            std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            entry.filter = ColumnBloomFilter::deserialize(data);
+            entry.saved = entry.filter.has_value();
+        }
+        if (!entry.filter.has_value()) {
+            LOG_WARNING("Bloom filter for " + table_name + "." + column_name + " was not saved; it is ignored until rebuilt");
+        }
+        bloom_filters_[table_name][column_name] = std::move(entry);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::save_bloom_catalog() const {
+    std::string catalog_path = data_directory_ + "/" + BLOOM_CATALOG_FILE_NAME;
+    std::string temp_path = catalog_path + ".tmp";
+    {
+        std::ofstream catalog(temp_path, std::ios::trunc);
+        for (const auto& [table_name, columns] : bloom_filters_) {
+            for (const auto& [column_name, entry] : columns) {
+                catalog << table_name << '\t' << column_name << '\n';
+            }
+        }
+        if (!catalog.flush()) {
+            return "Failed to write Bloom filter catalog";
+        }
+    }
+    if (std::rename(temp_path.c_str(), catalog_path.c_str()) != 0) {
+        return "Failed to replace Bloom filter catalog";
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> StorageEngine::save_bloom_filter(const std::string& table_name, const std::string& column_name, BloomFilterEntry& entry) {
+    if (!entry.filter.has_value() || entry.saved) {
+        return std::nullopt;
+    }
+
+    std::string path = get_bloom_file_path(table_name, column_name);
+    std::string temp_path = path + ".tmp";
+    {
+        std::string data = entry.filter->serialize();
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.flush()) {
+            return "Failed to write Bloom filter for " + table_name + "." + column_name;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        return "Failed to replace Bloom filter for " + table_name + "." + column_name;
+    }
+    entry.saved = true;
+    return std::nullopt;
+}
+
+void StorageEngine::update_bloom_filters(const std::string& table_name, const std::vector<std::string>& record, uint64_t page_id) {
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it == bloom_filters_.end()) {
+        return;
+    }
+    auto schema = read_schema_locked(table_name);
+    if (!schema.has_value()) {
+        return;
+    }
+
+    for (auto& [column_name, entry] : filters_it->second) {
+        size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
+        if (!entry.filter.has_value() || column_index >= record.size()) {
+            continue;
+        }
+        if (entry.saved) {
+            std::remove(get_bloom_file_path(table_name, column_name).c_str());
+            entry.saved = false;
+        }
+        entry.filter->add(page_id, record[column_index]);
+    }
+}
+
+void StorageEngine::update_zone_map(const std::string& table_name, const std::vector<std::string>& record, uint64_t page_id) {
+    auto zone_map_it = zone_maps_.find(table_name);
+    if (zone_map_it != zone_maps_.end()) {
+        zone_map_it->second.add(page_id, record);
+    }
+}
+
+void StorageEngine::rebuild_zone_maps() {
+    for (const auto& [table_name, file_name] : table_files_) {
+        auto schema = read_schema_locked(table_name);
+        if (!schema.has_value()) {
+            continue;
+        }
+        ZoneMap zone_map(schema->size());
+        for (uint64_t page_id = 1;; ++page_id) {
+            auto page = read_page(table_name, page_id);
+            if (!page) {
+                break;
+            }
+            for_each_record_in_page(*page, page_id, [&](uint64_t, const std::vector<std::string>& record) {
+                zone_map.add(page_id, record);
+            });
+        }
+        zone_maps_[table_name] = std::move(zone_map);
+    }
+    LOG_INFO("Rebuilt zone maps for " + std::to_string(zone_maps_.size()) + " tables");
+}
+
 // Method to perform a full table scan (useful for queries without indexes)
 std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> StorageEngine::full_table_scan(const std::string& table_name) const {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -599,6 +2207,11 @@ std::optional<std::vector<std::pair<uint64_t, std::vector<std::string>>>> Storag
 
         size_t offset = 0;
         while (offset < Page::PAGE_SIZE) {
+            size_t deleted_size = page->tombstone_size(offset);
+            if (deleted_size != 0) {
+                offset += sizeof(size_t) + deleted_size;
+                continue;
+            }
             std::vector<char> record_data = page->get_record(offset);
             if (record_data.empty()) {
                 break;  // No more records in this page
@@ -648,76 +2261,141 @@ std::optional<DatabaseStats> StorageEngine::get_database_stats() const {
     return stats;
 }
 
-// Method to compact a table (remove deleted records and defragment pages)
 std::optional<std::string> StorageEngine::compact_table(const std::string& table_name) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (!table_exists(table_name)) {
-        return "Table does not exist: " + table_name;
+    auto table_it = table_files_.find(table_name);
+    if (table_it == table_files_.end()) {
+        return "Table doesn't exist";
     }
+    const std::string file_name = table_it->second;
 
-    LOG_INFO("Starting table compaction for: " + table_name);
+    {
+        // Compaction renumbers records, which the changes held in memory refer to
+        std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+        if (dirty_pages_.count(file_name) != 0) {
+            return "Table has changes of unfinished transactions: " + table_name;
+        }
+    }
 
-    std::vector<std::pair<uint64_t, std::vector<std::string>>> valid_records;
-    auto scan_result = full_table_scan(table_name);
-    if (!scan_result) {
-        return "Failed to scan table for compaction";
+    auto schema = read_schema_locked(table_name);
+    auto schema_page = read_page(table_name, 0);
+    if (!schema.has_value() || !schema_page) {
+        return "Table schema not found";
     }
-    valid_records = std::move(*scan_result);
 
-    // Create a new file for the compacted table
+    LOG_INFO("Starting table compaction for: " + table_name);
+    cancel_index_builds(table_name);
+
+    // A file left behind by an interrupted compaction is stale
     std::string compact_file_name = table_name + "_compact.db";
-    if (!file_manager_->create_file(compact_file_name)) {
+    if (!file_manager_->delete_file(compact_file_name) || !file_manager_->create_file(compact_file_name)) {
         return "Failed to create compact file";
     }
-
-    // Write schema page
-    auto schema_page = read_page(table_name, 0);
-    if (!schema_page) {
-        return "Failed to read schema page";
+    auto write_compact_page = [&](Page& page) {
+        if (config_.use_compression) {
+            page.compress();
+        }
+        return write_page_to_file(table_name, compact_file_name, page.get_page_id(), page.get_data());
+    };
+    auto write_result = write_compact_page(*schema_page);
+    if (write_result.has_value()) {
+        return "Failed to write schema page to compact file: " + *write_result;
     }
-    if (!file_manager_->write_page(compact_file_name, *schema_page)) {
-        return "Failed to write schema page to compact file";
+
+    // Records move to new pages and get new ids, so the zone map and Bloom
+    // filters are rebuilt as they are written, and each record's new id is
+    // kept for the indexes
+    ZoneMap rebuilt_zone_map(schema->size());
+    std::unordered_map<std::string, ColumnBloomFilter> rebuilt_filters;
+    std::vector<std::pair<size_t, ColumnBloomFilter*>> filter_columns;
+    auto filters_it = bloom_filters_.find(table_name);
+    if (filters_it != bloom_filters_.end()) {
+        for (const auto& [column_name, entry] : filters_it->second) {
+            size_t column_index = std::distance(schema->begin(), std::find(schema->begin(), schema->end(), column_name));
+            filter_columns.emplace_back(column_index, &rebuilt_filters[column_name]);
+        }
     }
 
-    // Write compacted records
+    std::vector<std::pair<uint64_t, std::vector<std::string>>> compacted;
     uint64_t current_page_id = 1;
-    std::unique_ptr<Page> current_page = std::make_unique<Page>(current_page_id);
-    for (const auto& [old_record_id, record] : valid_records) {
+    auto current_page = std::make_unique<Page>(current_page_id);
+    for_each_record_locked(table_name, [&](uint64_t, const std::vector<std::string>& record) {
+        if (write_result.has_value()) {
+            return;
+        }
         std::string record_str = std::accumulate(record.begin(), record.end(), std::string(),
             [](const std::string& a, const std::string& b) { return a + (a.empty() ? "" : "\n") + b; });
         std::vector<char> record_data(record_str.begin(), record_str.end());
 
-        if (current_page->add_record(record_data) == -1) {
-            // Page is full, write it and create a new one
-            if (!file_manager_->write_page(compact_file_name, *current_page)) {
-                return "Failed to write page during compaction";
+        int offset = current_page->add_record(record_data);
+        if (offset == -1) {
+            // Page is full, write it and start a new one
+            write_result = write_compact_page(*current_page);
+            if (write_result.has_value()) {
+                return;
             }
-            current_page_id++;
-            current_page = std::make_unique<Page>(current_page_id);
-            if (current_page->add_record(record_data) == -1) {
-                return "Failed to add record to new page during compaction";
+            current_page = std::make_unique<Page>(++current_page_id);
+            offset = current_page->add_record(record_data);
+            if (offset == -1) {
+                write_result = "Record does not fit a page";
+                return;
+            }
+        }
+        uint64_t record_id = (current_page_id - 1) * (Page::PAGE_SIZE / sizeof(uint64_t)) + static_cast<uint64_t>(offset);
+        compacted.emplace_back(record_id, record);
+        rebuilt_zone_map.add(current_page_id, record);
+        for (auto& [column_index, filter] : filter_columns) {
+            if (column_index < record.size()) {
+                filter->add(current_page_id, record[column_index]);
             }
         }
+    });
+    if (!write_result.has_value() && current_page->get_free_space() < Page::PAGE_SIZE) {
+        write_result = write_compact_page(*current_page);
+    }
+    if (write_result.has_value()) {
+        file_manager_->delete_file(compact_file_name);
+        return "Failed to write compacted records: " + *write_result;
     }
 
-    // Write the last page if it's not empty
-    if (current_page->get_free_space() < Page::PAGE_SIZE) {
-        if (!file_manager_->write_page(compact_file_name, *current_page)) {
-            return "Failed to write last page during compaction";
+    // Readers retry while the table file is swapped
+    std::atomic<uint64_t>& write_seq = page_write_seq_for(table_name);
+    write_seq.fetch_add(1, std::memory_order_acq_rel);
+    bool replaced = file_manager_->replace_file(compact_file_name, file_name);
+    write_seq.fetch_add(1, std::memory_order_release);
+    if (!replaced) {
+        return "Failed to replace " + file_name + " with its compacted copy";
+    }
+    zone_maps_[table_name] = std::move(rebuilt_zone_map);
+
+    for (auto& [column_name, filter] : rebuilt_filters) {
+        BloomFilterEntry& entry = bloom_filters_[table_name][column_name];
+        entry.filter = std::move(filter);
+        entry.saved = false;
+        auto save_result = save_bloom_filter(table_name, column_name, entry);
+        if (save_result.has_value()) {
+            LOG_ERROR(*save_result);
         }
     }
 
-    // Replace the old file with the new compact file
-    file_manager_->close_file(table_files_[table_name]);
-    file_manager_->delete_file(table_files_[table_name]);
-    file_manager_->rename_file(compact_file_name, table_files_[table_name]);
-
-    // Rebuild indexes
-    for (size_t i = 0; i < valid_records[0].second.size(); ++i) {
-        index_manager_->drop_index(table_name, std::to_string(i));
-        index_manager_->create_index(table_name, std::to_string(i));
-        for (const auto& [record_id, record] : valid_records) {
-            index_manager_->insert_into_index(table_name, std::to_string(i), record[i], record_id);
+    // Rebuild the existing indexes under the new record ids
+    for (const auto& definition : index_manager_->get_table_indexes(table_name)) {
+        std::vector<std::pair<std::string, uint64_t>> entries;
+        entries.reserve(compacted.size());
+        for (const auto& [record_id, record] : compacted) {
+            auto key = definition.key_for(*schema, record);
+            if (key.has_value()) {
+                entries.emplace_back(std::move(*key), record_id);
+            }
+        }
+        auto index_result = index_manager_->drop_index(table_name, definition.name);
+        if (!index_result.has_value()) {
+            index_result = definition.is_composite()
+                ? index_manager_->bulk_load_composite_index(table_name, definition.key_columns, definition.include_columns, std::move(entries))
+                : index_manager_->bulk_load_index(table_name, definition.name, std::move(entries), definition.type);
+        }
+        if (index_result.has_value()) {
+            return "Failed to rebuild index " + definition.name + " after compacting " + table_name + ": " + *index_result;
         }
     }
 
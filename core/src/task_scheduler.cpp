@@ -0,0 +1,337 @@
+#include "nexusdb/task_scheduler.h"
+#include "nexusdb/utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nexusdb {
+
+thread_local TaskScheduler::Worker* TaskScheduler::current_worker_ = nullptr;
+thread_local TaskScheduler* TaskScheduler::current_scheduler_ = nullptr;
+
+TaskGroup::TaskGroup(TaskPriority priority)
+    : TaskGroup(TaskScheduler::get_instance(), priority) {}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskPriority priority)
+    : scheduler_(scheduler), priority_(priority), pending_(0) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    scheduler_.submit([this, task = std::move(task)]() {
+        std::optional<std::string> error;
+        try {
+            task();
+        } catch (const std::exception& e) {
+            error = std::string(e.what());
+        } catch (...) {
+            error = "Unknown error in task";
+        }
+        finish_task(error);
+    }, priority_);
+}
+
+std::optional<std::string> TaskGroup::wait() {
+    if (scheduler_.in_worker_thread()) {
+        // Blocking a worker could starve the very tasks we wait for, so help out instead
+        while (pending_.load(std::memory_order_acquire) > 0) {
+            if (!scheduler_.run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+    } else {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void TaskGroup::finish_task(const std::optional<std::string>& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error.has_value() && !error_.has_value()) {
+        error_ = error;
+    }
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done_.notify_all();
+    }
+}
+
+TaskScheduler& TaskScheduler::get_instance() {
+    static TaskScheduler instance;
+    return instance;
+}
+
+TaskScheduler::TaskScheduler()
+    : overflow_count_(0), running_(false), stopping_(false), queued_tasks_(0), sleeping_workers_(0) {
+    LOG_DEBUG("TaskScheduler constructor called");
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+std::optional<std::string> TaskScheduler::initialize(const SchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (running_.load()) {
+        LOG_DEBUG("Task Scheduler already running");
+        return std::nullopt;
+    }
+
+    LOG_INFO("Initializing Task Scheduler...");
+    try {
+        config_ = config;
+        size_t num_workers = config_.num_workers;
+        if (num_workers == 0) {
+            num_workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        injection_queues_.clear();
+        for (size_t level = 0; level < PRIORITY_LEVELS; ++level) {
+            injection_queues_.push_back(std::make_unique<BoundedMPMCQueue<Task*>>(config_.injection_queue_capacity));
+        }
+
+        stopping_.store(false);
+        running_.store(true);
+        for (size_t i = 0; i < num_workers; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->index = i;
+            worker->rng_state = 0x9E3779B97F4A7C15ULL * (i + 1);
+            workers_.push_back(std::move(worker));
+        }
+        for (auto& worker : workers_) {
+            Worker* raw_worker = worker.get();
+            worker->thread = std::thread([this, raw_worker]() { worker_loop(raw_worker); });
+            pin_to_cpu(raw_worker);
+        }
+
+        LOG_INFO("Task Scheduler initialized successfully with " + std::to_string(num_workers) + " workers");
+        return std::nullopt;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to initialize Task Scheduler: " + std::string(e.what()));
+        return "Failed to initialize Task Scheduler: " + std::string(e.what());
+    }
+}
+
+void TaskScheduler::shutdown() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (!running_.load()) {
+        return;
+    }
+
+    LOG_INFO("Shutting down Task Scheduler...");
+    // Workers drain every queue before they exit; submits that see
+    // stopping_ run inline instead
+    stopping_.store(true, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> sleep_lock(sleep_mutex_);
+        wake_up_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    running_.store(false);
+    workers_.clear();
+    LOG_INFO("Task Scheduler shut down successfully");
+}
+
+bool TaskScheduler::is_running() const {
+    return running_.load(std::memory_order_acquire) && !stopping_.load(std::memory_order_acquire);
+}
+
+void TaskScheduler::submit(std::function<void()> task, TaskPriority priority) {
+    // Count the task before checking for shutdown: a worker that sees
+    // stopping_ keeps running until queued_tasks_ drops to zero, so either
+    // it picks this task up or we see stopping_ here and run it ourselves
+    queued_tasks_.fetch_add(1, std::memory_order_seq_cst);
+    if (!running_.load(std::memory_order_seq_cst) || stopping_.load(std::memory_order_seq_cst)) {
+        queued_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+        task();
+        return;
+    }
+
+    size_t level = static_cast<size_t>(priority);
+    Task* wrapped = new Task{std::move(task)};
+
+    if (current_scheduler_ == this && current_worker_ != nullptr) {
+        current_worker_->deques[level].push(wrapped);
+    } else if (!injection_queues_[level]->try_enqueue(wrapped)) {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_queues_[level].push_back(wrapped);
+        overflow_count_.fetch_add(1, std::memory_order_release);
+    }
+
+    notify_workers();
+}
+
+bool TaskScheduler::run_pending_task() {
+    // Only workers may walk workers_; shutdown clears it after joining them
+    if (!in_worker_thread()) {
+        return false;
+    }
+    Task* task = find_task(current_worker_);
+    if (task == nullptr) {
+        return false;
+    }
+    execute(task);
+    return true;
+}
+
+bool TaskScheduler::in_worker_thread() const {
+    return current_scheduler_ == this && current_worker_ != nullptr;
+}
+
+size_t TaskScheduler::get_worker_count() const {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    return workers_.size();
+}
+
+void TaskScheduler::worker_loop(Worker* worker) {
+    current_worker_ = worker;
+    current_scheduler_ = this;
+
+    size_t idle_rounds = 0;
+    while (true) {
+        Task* task = find_task(worker);
+        if (task != nullptr) {
+            execute(task);
+            idle_rounds = 0;
+            continue;
+        }
+
+        // A submit that counted its task before stopping_ was set is still
+        // about to enqueue it
+        if (stopping_.load(std::memory_order_seq_cst) && queued_tasks_.load(std::memory_order_seq_cst) == 0) {
+            break;
+        }
+
+        if (++idle_rounds < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+        wake_up_.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return queued_tasks_.load(std::memory_order_seq_cst) > 0 || stopping_.load(std::memory_order_acquire);
+        });
+        sleeping_workers_.fetch_sub(1, std::memory_order_seq_cst);
+        idle_rounds = 0;
+    }
+
+    current_worker_ = nullptr;
+    current_scheduler_ = nullptr;
+}
+
+TaskScheduler::Task* TaskScheduler::find_task(Worker* worker) {
+    for (size_t level = 0; level < PRIORITY_LEVELS; ++level) {
+        if (worker != nullptr) {
+            if (auto task = worker->deques[level].pop()) {
+                return *task;
+            }
+        }
+        if (Task* task = take_injected(level)) {
+            return task;
+        }
+        if (Task* task = steal_from_others(worker, level)) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+TaskScheduler::Task* TaskScheduler::take_injected(size_t level) {
+    if (injection_queues_.size() <= level) {
+        return nullptr;
+    }
+    if (auto task = injection_queues_[level]->try_dequeue()) {
+        return *task;
+    }
+    if (overflow_count_.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        if (!overflow_queues_[level].empty()) {
+            Task* task = overflow_queues_[level].front();
+            overflow_queues_[level].pop_front();
+            overflow_count_.fetch_sub(1, std::memory_order_release);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+TaskScheduler::Task* TaskScheduler::steal_from_others(Worker* thief, size_t level) {
+    size_t count = workers_.size();
+    if (count == 0) {
+        return nullptr;
+    }
+
+    size_t start = 0;
+    if (thief != nullptr) {
+        // xorshift to spread thieves over different victims
+        thief->rng_state ^= thief->rng_state << 13;
+        thief->rng_state ^= thief->rng_state >> 7;
+        thief->rng_state ^= thief->rng_state << 17;
+        start = static_cast<size_t>(thief->rng_state % count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Worker* victim = workers_[(start + i) % count].get();
+        if (victim == thief) {
+            continue;
+        }
+        if (auto task = victim->deques[level].steal()) {
+            return *task;
+        }
+    }
+    return nullptr;
+}
+
+void TaskScheduler::execute(Task* task) {
+    queued_tasks_.fetch_sub(1, std::memory_order_seq_cst);
+    std::unique_ptr<Task> owned(task);
+    try {
+        owned->function();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Unhandled exception in scheduled task: " + std::string(e.what()));
+    } catch (...) {
+        LOG_ERROR("Unhandled unknown exception in scheduled task");
+    }
+}
+
+void TaskScheduler::notify_workers() {
+    if (sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_up_.notify_one();
+    }
+}
+
+void TaskScheduler::pin_to_cpu(Worker* worker) {
+    if (config_.cpu_affinity.empty()) {
+        return;
+    }
+
+    int cpu = config_.cpu_affinity[worker->index % config_.cpu_affinity.size()];
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(worker->thread.native_handle(), sizeof(cpu_set), &cpu_set) != 0) {
+        LOG_WARNING("Failed to pin worker " + std::to_string(worker->index) + " to CPU " + std::to_string(cpu));
+    }
+#else
+    LOG_WARNING("CPU affinity is not supported on this platform; ignoring CPU " + std::to_string(cpu));
+#endif
+}
+
+} // namespace nexusdb
@@ -1,5 +1,6 @@
 #include "nexusdb/transaction_manager.h"
 #include "nexusdb/utils/logger.h"
+#include <algorithm>
 
 namespace nexusdb {
 
@@ -37,6 +38,11 @@ std::optional<transaction_id_t> TransactionManager::begin_transaction() {
     return txn_id;
 }
 
+void TransactionManager::reserve_transaction_ids(transaction_id_t last_used) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    next_transaction_id_ = std::max(next_transaction_id_, last_used + 1);
+}
+
 std::optional<std::string> TransactionManager::commit_transaction(transaction_id_t txn_id) {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = transactions_.find(txn_id);
@@ -46,9 +52,10 @@ std::optional<std::string> TransactionManager::commit_transaction(transaction_id
     if (it->second != TransactionState::ACTIVE) {
         return "Transaction is not active";
     }
-    it->second = TransactionState::COMMITTED;
+    // Finished transactions are tracked by their handles, not here
+    transactions_.erase(it);
+    transaction_logs_.erase(txn_id);
     LOG_INFO("Transaction " + std::to_string(txn_id) + " committed");
-    // Here you would apply the changes to the database
     return std::nullopt;
 }
 
@@ -61,9 +68,9 @@ std::optional<std::string> TransactionManager::abort_transaction(transaction_id_
     if (it->second != TransactionState::ACTIVE) {
         return "Transaction is not active";
     }
-    it->second = TransactionState::ABORTED;
+    transactions_.erase(it);
+    transaction_logs_.erase(txn_id);
     LOG_INFO("Transaction " + std::to_string(txn_id) + " aborted");
-    // Here you would undo any changes made by this transaction
     return std::nullopt;
 }
 
@@ -80,4 +87,13 @@ std::optional<std::string> TransactionManager::log_operation(transaction_id_t tx
     return std::nullopt;
 }
 
+std::optional<TransactionState> TransactionManager::get_state(transaction_id_t txn_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transactions_.find(txn_id);
+    if (it == transactions_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 } // namespace nexusdb
\ No newline at end of file
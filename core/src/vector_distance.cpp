@@ -0,0 +1,224 @@
+#include "nexusdb/vector_distance.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NEXUSDB_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace nexusdb {
+
+namespace {
+
+using DistanceFunction = float (*)(const float*, const float*, size_t);
+
+float l2_squared_scalar(const float* a, const float* b, size_t count) {
+    float sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        float difference = a[i] - b[i];
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+float dot_product_scalar(const float* a, const float* b, size_t count) {
+    float sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef NEXUSDB_X86_DISPATCH
+
+__attribute__((target("avx2,fma")))
+float horizontal_sum_avx2(__m256 values) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+// Two accumulators of eight lanes hide the FMA latency
+__attribute__((target("avx2,fma")))
+float l2_squared_avx2(const float* a, const float* b, size_t count) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 difference0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 difference1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        sum0 = _mm256_fmadd_ps(difference0, difference0, sum0);
+        sum1 = _mm256_fmadd_ps(difference1, difference1, sum1);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256 difference = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        sum0 = _mm256_fmadd_ps(difference, difference, sum0);
+    }
+    return horizontal_sum_avx2(_mm256_add_ps(sum0, sum1)) + l2_squared_scalar(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2,fma")))
+float dot_product_avx2(const float* a, const float* b, size_t count) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+    }
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    }
+    return horizontal_sum_avx2(_mm256_add_ps(sum0, sum1)) + dot_product_scalar(a + i, b + i, count - i);
+}
+
+#endif
+
+struct DistanceKernels {
+    DistanceFunction l2_squared;
+    DistanceFunction dot_product;
+    const char* isa;
+};
+
+DistanceKernels select_kernels() {
+#ifdef NEXUSDB_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {l2_squared_avx2, dot_product_avx2, "avx2"};
+    }
+#endif
+    return {l2_squared_scalar, dot_product_scalar, "scalar"};
+}
+
+const DistanceKernels& kernels() {
+    static const DistanceKernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+std::string encode_vector(const std::vector<float>& values) {
+    std::ostringstream out;
+    out.precision(9);  // Enough digits to read every float back exactly
+    out << '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            out << ',';
+        }
+        out << values[i];
+    }
+    out << ']';
+    return out.str();
+}
+
+std::optional<std::vector<float>> decode_vector(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    size_t end = text.find_last_not_of(" \t");
+    if (begin == std::string::npos || text[begin] != '[' || text[end] != ']') {
+        return std::nullopt;
+    }
+
+    std::vector<float> values;
+    const char* cursor = text.c_str() + begin + 1;
+    const char* last = text.c_str() + end;
+    while (true) {
+        while (cursor < last && (*cursor == ' ' || *cursor == '\t')) {
+            ++cursor;
+        }
+        if (cursor == last) {
+            // Only "[]" may end without a number
+            return values.empty() ? std::optional<std::vector<float>>(values) : std::nullopt;
+        }
+        char* number_end = nullptr;
+        errno = 0;
+        float value = std::strtof(cursor, &number_end);
+        if (number_end == cursor || number_end > last || errno == ERANGE || !std::isfinite(value)) {
+            return std::nullopt;
+        }
+        values.push_back(value);
+        cursor = number_end;
+        while (cursor < last && (*cursor == ' ' || *cursor == '\t')) {
+            ++cursor;
+        }
+        if (cursor == last) {
+            return values;
+        }
+        if (*cursor != ',') {
+            return std::nullopt;
+        }
+        ++cursor;
+    }
+}
+
+std::optional<size_t> parse_vector_type(const std::string& type) {
+    const std::string prefix = "vector(";
+    if (type.size() <= prefix.size() + 1 || type.compare(0, prefix.size(), prefix) != 0 || type.back() != ')') {
+        return std::nullopt;
+    }
+    std::string digits = type.substr(prefix.size(), type.size() - prefix.size() - 1);
+    if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos || digits.size() > 9) {
+        return std::nullopt;
+    }
+    size_t dimension = std::stoul(digits);
+    return dimension > 0 ? std::optional<size_t>(dimension) : std::nullopt;
+}
+
+const char* distance_metric_name(DistanceMetric metric) {
+    switch (metric) {
+        case DistanceMetric::L2:
+            return "l2";
+        case DistanceMetric::COSINE:
+            return "cosine";
+        case DistanceMetric::DOT:
+            return "dot";
+    }
+    return "l2";
+}
+
+std::optional<DistanceMetric> parse_distance_metric(const std::string& name) {
+    if (name == "l2") {
+        return DistanceMetric::L2;
+    }
+    if (name == "cosine") {
+        return DistanceMetric::COSINE;
+    }
+    if (name == "dot") {
+        return DistanceMetric::DOT;
+    }
+    return std::nullopt;
+}
+
+float l2_squared(const float* a, const float* b, size_t count) {
+    return kernels().l2_squared(a, b, count);
+}
+
+float dot_product(const float* a, const float* b, size_t count) {
+    return kernels().dot_product(a, b, count);
+}
+
+float inverse_norm(const float* values, size_t count) {
+    float norm = std::sqrt(dot_product(values, values, count));
+    return norm > 0 ? 1.0f / norm : 0.0f;
+}
+
+float vector_distance(DistanceMetric metric, const float* a, const float* b, size_t count) {
+    switch (metric) {
+        case DistanceMetric::L2:
+            return l2_squared(a, b, count);
+        case DistanceMetric::COSINE:
+            return cosine_distance(dot_product(a, b, count), inverse_norm(a, count), inverse_norm(b, count));
+        case DistanceMetric::DOT:
+            return -dot_product(a, b, count);
+    }
+    return l2_squared(a, b, count);
+}
+
+const char* distance_simd_isa() {
+    return kernels().isa;
+}
+
+} // namespace nexusdb
@@ -0,0 +1,165 @@
+#include "nexusdb/version_store.h"
+#include "nexusdb/utils/logger.h"
+#include <functional>
+#include <thread>
+
+namespace nexusdb {
+
+VersionStore::VersionStore()
+    : buckets_(new std::atomic<Version*>[BUCKET_COUNT]),
+      snapshot_slots_(new std::atomic<uint64_t>[MAX_SNAPSHOTS]),
+      visible_ts_(0), finished_since_gc_(0) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < MAX_SNAPSHOTS; ++i) {
+        snapshot_slots_[i].store(FREE_SLOT, std::memory_order_relaxed);
+    }
+}
+
+VersionStore::~VersionStore() {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        Version* version = buckets_[i].load(std::memory_order_relaxed);
+        while (version != nullptr) {
+            Version* next = version->next.load(std::memory_order_relaxed);
+            delete version;
+            version = next;
+        }
+    }
+    epoch_manager_.reclaim_all();
+}
+
+void VersionStore::record_before_image(transaction_id_t txn_id, const std::string& table_name, uint64_t record_id,
+                                       const std::optional<std::string>& before_image) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    Version* version = new Version{table_name, record_id, before_image, {PENDING_TIMESTAMP}, {nullptr}};
+
+    std::atomic<Version*>& bucket = buckets_[bucket_for(table_name, record_id)];
+    version->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucket.store(version, std::memory_order_release);
+    pending_versions_[txn_id].push_back(version);
+}
+
+void VersionStore::finish_transaction(transaction_id_t txn_id) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    uint64_t commit_ts = visible_ts_.load(std::memory_order_relaxed) + 1;
+
+    auto it = pending_versions_.find(txn_id);
+    if (it != pending_versions_.end()) {
+        for (Version* version : it->second) {
+            version->commit_ts.store(commit_ts, std::memory_order_release);
+        }
+        pending_versions_.erase(it);
+    }
+    // Versions are stamped before the timestamp is published, so a snapshot
+    // taken at commit_ts never sees them as pending
+    visible_ts_.store(commit_ts, std::memory_order_seq_cst);
+
+    if (++finished_since_gc_ >= GC_INTERVAL) {
+        finished_since_gc_ = 0;
+        collect_garbage();
+    }
+}
+
+std::optional<std::string> VersionStore::acquire_snapshot(uint64_t& snapshot_ts, size_t& slot) {
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_SNAPSHOTS;
+    for (size_t i = 0; i < MAX_SNAPSHOTS; ++i) {
+        size_t candidate = (start + i) % MAX_SNAPSHOTS;
+        uint64_t expected = FREE_SLOT;
+        // Claim the slot before reading the timestamp so garbage collection
+        // either sees the claim or runs entirely before this snapshot
+        if (snapshot_slots_[candidate].compare_exchange_strong(expected, CLAIMING_SLOT, std::memory_order_seq_cst)) {
+            snapshot_ts = visible_ts_.load(std::memory_order_seq_cst);
+            snapshot_slots_[candidate].store(snapshot_ts, std::memory_order_seq_cst);
+            slot = candidate;
+            return std::nullopt;
+        }
+    }
+    return "Too many concurrent read-only transactions";
+}
+
+void VersionStore::release_snapshot(size_t slot) {
+    snapshot_slots_[slot].store(FREE_SLOT, std::memory_order_release);
+}
+
+bool VersionStore::find_version(const std::string& table_name, uint64_t record_id, uint64_t snapshot_ts,
+                                std::optional<std::string>& before_image) const {
+    auto guard = epoch_manager_.pin();
+    const Version* visible = nullptr;
+
+    // Chains are newest first, so the last match newer than the snapshot is
+    // the oldest change the snapshot must not see
+    for (const Version* version = buckets_[bucket_for(table_name, record_id)].load(std::memory_order_acquire);
+         version != nullptr; version = version->next.load(std::memory_order_acquire)) {
+        if (version->record_id == record_id && version->table_name == table_name &&
+            version->commit_ts.load(std::memory_order_acquire) > snapshot_ts) {
+            visible = version;
+        }
+    }
+
+    if (visible == nullptr) {
+        return false;
+    }
+    before_image = visible->before_image;
+    return true;
+}
+
+std::map<uint64_t, std::optional<std::string>> VersionStore::changed_records(const std::string& table_name, uint64_t snapshot_ts) const {
+    auto guard = epoch_manager_.pin();
+    std::map<uint64_t, std::optional<std::string>> changed;
+
+    // A record's versions share one bucket and run newest first, so the
+    // last one assigned is the oldest change, as in find_version
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        for (const Version* version = buckets_[i].load(std::memory_order_acquire);
+             version != nullptr; version = version->next.load(std::memory_order_acquire)) {
+            if (version->table_name == table_name && version->commit_ts.load(std::memory_order_acquire) > snapshot_ts) {
+                changed[version->record_id] = version->before_image;
+            }
+        }
+    }
+    return changed;
+}
+
+size_t VersionStore::bucket_for(const std::string& table_name, uint64_t record_id) const {
+    size_t hash = std::hash<std::string>()(table_name) ^ (std::hash<uint64_t>()(record_id) * 0x9E3779B97F4A7C15ULL);
+    return hash % BUCKET_COUNT;
+}
+
+// Called with writer_mutex_ held
+void VersionStore::collect_garbage() {
+    uint64_t oldest = visible_ts_.load(std::memory_order_seq_cst);
+    for (size_t i = 0; i < MAX_SNAPSHOTS; ++i) {
+        uint64_t slot = snapshot_slots_[i].load(std::memory_order_seq_cst);
+        if (slot == CLAIMING_SLOT) {
+            return;  // Snapshot timestamp not known yet; try again next time
+        }
+        if (slot != FREE_SLOT && slot < oldest) {
+            oldest = slot;
+        }
+    }
+
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        std::atomic<Version*>* link = &buckets_[i];
+        Version* version = link->load(std::memory_order_relaxed);
+        while (version != nullptr) {
+            Version* next = version->next.load(std::memory_order_relaxed);
+            // No registered snapshot is older than this version any more
+            if (version->commit_ts.load(std::memory_order_relaxed) <= oldest) {
+                link->store(next, std::memory_order_release);
+                epoch_manager_.retire(version);
+                ++reclaimed;
+            } else {
+                link = &version->next;
+            }
+            version = next;
+        }
+    }
+
+    if (reclaimed > 0) {
+        LOG_DEBUG("Version store reclaimed " + std::to_string(reclaimed) + " record versions");
+    }
+}
+
+} // namespace nexusdb
@@ -0,0 +1,110 @@
+#include "nexusdb/zone_map.h"
+#include "nexusdb/full_text_index.h"
+#include "nexusdb/geometry.h"
+
+namespace nexusdb {
+
+bool predicate_holds(const std::string& field, PredicateOp op, const std::string& value) {
+    switch (op) {
+        case PredicateOp::EQUAL:
+            return field == value;
+        case PredicateOp::LESS:
+            return field < value;
+        case PredicateOp::LESS_EQUAL:
+            return field <= value;
+        case PredicateOp::GREATER:
+            return field > value;
+        case PredicateOp::GREATER_EQUAL:
+            return field >= value;
+        case PredicateOp::MATCH: {
+            SimpleTokenizer tokenizer;
+            return FullTextQuery::parse(value, tokenizer).matches(field, tokenizer);
+        }
+        case PredicateOp::INTERSECTS: {
+            auto geometry = parse_geometry(field);
+            auto box = parse_geometry(value);
+            return geometry.has_value() && box.has_value() && geometry->intersects(*box);
+        }
+        case PredicateOp::DWITHIN: {
+            auto geometry = parse_geometry(field);
+            auto query = parse_distance_query(value);
+            return geometry.has_value() && query.has_value() && geometry->distance_to(query->first) <= query->second;
+        }
+    }
+    return true;
+}
+
+void ColumnZone::add(const std::string& value) {
+    if (value.empty()) {
+        ++null_count;
+        return;
+    }
+    if (value_count == 0 || value < min) {
+        min = value;
+    }
+    if (value_count == 0 || value > max) {
+        max = value;
+    }
+    ++value_count;
+}
+
+bool ColumnZone::may_match(PredicateOp op, const std::string& value) const {
+    if (null_count > 0 && predicate_holds(std::string(), op, value)) {
+        return true;
+    }
+    if (value_count == 0) {
+        return false;
+    }
+    switch (op) {
+        case PredicateOp::EQUAL:
+            return min <= value && value <= max;
+        case PredicateOp::LESS:
+            return min < value;
+        case PredicateOp::LESS_EQUAL:
+            return min <= value;
+        case PredicateOp::GREATER:
+            return max > value;
+        case PredicateOp::GREATER_EQUAL:
+            return max >= value;
+        case PredicateOp::MATCH:
+        case PredicateOp::INTERSECTS:
+        case PredicateOp::DWITHIN:
+            return true;  // Bounds say nothing about words or shapes
+    }
+    return true;
+}
+
+ZoneMap::ZoneMap(size_t column_count) : column_count_(column_count) {}
+
+void ZoneMap::add(uint64_t page_id, const std::vector<std::string>& record) {
+    if (page_id == 0) {
+        return;
+    }
+    if (pages_.size() < page_id) {
+        pages_.resize(page_id, std::vector<ColumnZone>(column_count_));
+    }
+    std::vector<ColumnZone>& zones = pages_[page_id - 1];
+    for (size_t column = 0; column < column_count_; ++column) {
+        // Trailing empty fields are dropped when a record is parsed
+        zones[column].add(column < record.size() ? record[column] : std::string());
+    }
+}
+
+bool ZoneMap::page_may_match(uint64_t page_id, const std::vector<std::pair<size_t, ColumnPredicate>>& predicates) const {
+    for (const auto& [column, predicate] : predicates) {
+        const ColumnZone* column_zone = zone(page_id, column);
+        if (column_zone != nullptr && !column_zone->may_match(predicate.op, predicate.value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const ColumnZone* ZoneMap::zone(uint64_t page_id, size_t column) const {
+    if (page_id == 0 || page_id > pages_.size() || column >= column_count_) {
+        return nullptr;
+    }
+    return &pages_[page_id - 1][column];
+}
+
+} // namespace nexusdb